@@ -0,0 +1,1070 @@
+/*************************************************************************
+
+   Program:    hsbench
+   File:       bench.c
+
+   Version:    V1.5
+   Date:       18.10.26
+   Function:   Benchmarks and performance regression checks for
+               hsubgroup
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Runs micro-benchmarks of the profile table scoring kernel for the
+   built-in data and mouse_full.dat, the data file readers and PIR
+   parsing, followed by end-to-end runs of the hsubgroup executable
+   over a synthetic corpus with every combination of -x, -p and -v for
+   the built-in data, human.dat and mouse_full.dat (-f). The corpus is
+   generated by hsgen from human.dat with N-terminal truncations and
+   extensions.
+
+   Results are written as a flat JSON object with one metric per line.
+   If a baseline file is given, each metric is compared with it and the
+   program exits with status 1 if any is worse by more than the
+   tolerance. Metrics ending in seqs_per_s are better when higher; all
+   others are better when lower.
+
+   A fixed loop of arithmetic and memory reads is timed between the
+   groups of benchmarks (calibration.ns) and times are compared relative
+   to it, so a baseline from a faster or slower machine, or a busier
+   one, is scaled to this one. Memory (peak_rss_kb) is compared
+   directly. "make bench" records bench/baseline.json on this machine
+   the first time it is run and compares with it after that.
+
+**************************************************************************
+
+   Usage:
+   ======
+   hsbench [-e exe] [-g hsgen] [-D datadir] [-n nentries] [-r repeats]
+           [-o out.json] [-c baseline.json] [-t tolerance]
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0  18.10.26   Original
+   V1.1  18.10.26   The corpus is made by hsgen rather than by copying
+                    a template file
+   V1.2  18.10.26   Frees the subgroup data which is now allocated
+   V1.3  18.10.26   The readers allocate the arrays of subgroups
+   V1.4  18.10.26   Times a calibration loop and compares with the
+                    baseline relative to it
+   V1.5  18.10.26   Times the profile table kernel instead of
+                    CalcScore() and CalcFullScore()
+
+*************************************************************************/
+/* Includes
+*/
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "bioplib/MathType.h"
+#include "bioplib/SysDefs.h"
+#include "bioplib/seq.h"
+#include "../subgroup.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXCHAINS    200000  /* Max chains held for micro-benchmarks    */
+#define MAXSEQ            8  /* Max chains in a PIR entry               */
+#define MAXMETRICS      256
+#define MAXMETRICNAME    80
+#define CORPUSFILE   "bench_corpus.pir"
+#define EMPTYFILE    "bench_empty.pir"
+#define READERLOADS     100  /* Loads of a data file per batch          */
+#define STARTUPRUNS      10  /* Start-up runs per repeat                */
+#define CALIBRATIONLOOPS 10000000L /* Iterations of calibration loop    */
+#define CALIBRATIONTABLE (1L<<20)  /* Entries in calibration table      */
+#define CALIBRATIONMETRIC "calibration.ns"
+
+typedef struct
+{
+   char name[MAXMETRICNAME];
+   REAL value;
+}  METRIC;
+
+/************************************************************************/
+/* Globals
+*/
+static METRIC sMetrics[MAXMETRICS];
+static int    sNMetrics        = 0;
+static REAL   sCalibrationTime = 0.0;  /* Total time in Calibrate()     */
+static int    sNCalibrations   = 0;
+static volatile REAL sSink = 0.0;  /* Stops the kernels being optimized
+                                      away                              */
+
+/************************************************************************/
+/* Prototypes
+*/
+int main(int argc, char **argv);
+static BOOL ParseCmdLine(int argc, char **argv, char *exe, char *dataDir,
+                         char *genExe, int *nEntries, int *repeats,
+                         char *outFile, char *baseFile, REAL *tolerance);
+static void Usage(void);
+static REAL Now(void);
+static void AddMetric(char *name, REAL value);
+static REAL FindMetric(char *name);
+static void Calibrate(void);
+static void AddCalibration(void);
+static BOOL MakeCorpus(char *genExe, char *dataDir, int nEntries);
+static int  ReadChains(char *fileName, char **chains, int maxChains);
+static void BenchProfileKernel(char *dataDir, char *dataFile,
+                               BOOL fullMatrix, char *name,
+                               char **chains, int nChains);
+static void BenchReaders(char *dataDir, int repeats);
+static void BenchReadPIR(int repeats);
+static BOOL RunExe(char *exe, char **args, char *inFile, REAL *seconds,
+                   long *maxRSS);
+static void BenchEndToEnd(char *exe, char *dataDir, int nChains,
+                          int repeats);
+static BOOL WriteMetrics(char *outFile);
+static int  CompareBaseline(char *baseFile, REAL tolerance);
+
+
+/************************************************************************/
+/*>int main(int argc, char **argv)
+   -------------------------------
+*//**
+   Main program for the benchmarks
+
+-  18.10.26 Original   By: ACRM
+*/
+int main(int argc, char **argv)
+{
+   char exe[MAXBUFF],
+        dataDir[MAXBUFF],
+        genExe[MAXBUFF],
+        outFile[MAXBUFF],
+        baseFile[MAXBUFF],
+        **chains;
+   int  nEntries, repeats, nChains, i;
+   REAL tolerance;
+
+   if(!ParseCmdLine(argc, argv, exe, dataDir, genExe, &nEntries,
+                    &repeats, outFile, baseFile, &tolerance))
+   {
+      Usage();
+      return(0);
+   }
+
+   if(!MakeCorpus(genExe, dataDir, nEntries))
+   {
+      fprintf(stderr, "hsbench Error: Unable to build corpus with %s\n",
+              genExe);
+      return(1);
+   }
+
+   if((chains = (char **)malloc(MAXCHAINS * sizeof(char *)))==NULL)
+   {
+      fprintf(stderr, "hsbench Error: No memory for chains\n");
+      return(1);
+   }
+   nChains = ReadChains(CORPUSFILE, chains, MAXCHAINS);
+   AddMetric("corpus.chains", (REAL)nChains);
+
+   Calibrate();
+   BenchProfileKernel(dataDir, NULL, FALSE, "profile", chains, nChains);
+   Calibrate();
+   BenchProfileKernel(dataDir, "mouse_full.dat", TRUE, "profilefull",
+                      chains, nChains);
+   Calibrate();
+   BenchReaders(dataDir, repeats);
+   Calibrate();
+   BenchReadPIR(repeats);
+   Calibrate();
+   BenchEndToEnd(exe, dataDir, nChains, repeats);
+   Calibrate();
+   AddCalibration();
+
+   for(i=0; i<nChains; i++)
+      free(chains[i]);
+   free(chains);
+   unlink(CORPUSFILE);
+   unlink(EMPTYFILE);
+
+   if(!WriteMetrics(outFile))
+   {
+      fprintf(stderr, "hsbench Error: Unable to write %s\n", outFile);
+      return(1);
+   }
+
+   if(baseFile[0])
+      return(CompareBaseline(baseFile, tolerance));
+
+   return(0);
+}
+
+
+/************************************************************************/
+/*>static BOOL ParseCmdLine(int argc, char **argv, char *exe,
+                            char *dataDir, char *genExe, int *nEntries,
+                            int *repeats, char *outFile, char *baseFile,
+                            REAL *tolerance)
+   ---------------------------------------------------------------------
+*//**
+   Parse the command line
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 -g replaces -i
+*/
+static BOOL ParseCmdLine(int argc, char **argv, char *exe, char *dataDir,
+                         char *genExe, int *nEntries, int *repeats,
+                         char *outFile, char *baseFile, REAL *tolerance)
+{
+   strcpy(exe,     "../hsubgroup");
+   strcpy(dataDir, "../../data");
+   strcpy(genExe,  "../hsgen");
+   outFile[0]  = baseFile[0] = '\0';
+   *nEntries   = 10000;
+   *repeats    = 3;
+   *tolerance  = 0.20;
+
+   argc--;
+   argv++;
+
+   while(argc)
+   {
+      if((argv[0][0] != '-') || (argc < 2))
+         return(FALSE);
+
+      switch(argv[0][1])
+      {
+      case 'e':
+         strncpy(exe, argv[1], MAXBUFF-1);
+         break;
+      case 'D':
+         strncpy(dataDir, argv[1], MAXBUFF-1);
+         break;
+      case 'g':
+         strncpy(genExe, argv[1], MAXBUFF-1);
+         break;
+      case 'n':
+         if(sscanf(argv[1], "%d", nEntries) != 1)
+            return(FALSE);
+         break;
+      case 'r':
+         if((sscanf(argv[1], "%d", repeats) != 1) || (*repeats < 1))
+            return(FALSE);
+         break;
+      case 'o':
+         strncpy(outFile, argv[1], MAXBUFF-1);
+         break;
+      case 'c':
+         strncpy(baseFile, argv[1], MAXBUFF-1);
+         break;
+      case 't':
+         if(sscanf(argv[1], "%lf", tolerance) != 1)
+            return(FALSE);
+         break;
+      default:
+         return(FALSE);
+      }
+      argc -= 2;
+      argv += 2;
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static void Usage(void)
+   -----------------------
+*//**
+   Prints a usage message
+
+-  18.10.26 Original   By: ACRM
+*/
+static void Usage(void)
+{
+   fprintf(stderr,"\nhsbench V1.0 (c) 2026, Andrew C.R. Martin, UCL\n");
+   fprintf(stderr,"\nUsage: hsbench [-e exe] [-g hsgen] [-D datadir] \
+[-n nentries] [-r repeats]\n");
+   fprintf(stderr,"               [-o out.json] [-c baseline.json] \
+[-t tolerance]\n");
+   fprintf(stderr,"       -e hsubgroup executable (default \
+../hsubgroup)\n");
+   fprintf(stderr,"       -D Directory containing human.dat and \
+mouse_full.dat (default ../../data)\n");
+   fprintf(stderr,"       -g hsgen executable used to build the corpus \
+(default ../hsgen)\n");
+   fprintf(stderr,"       -n Number of PIR entries in the corpus \
+(default 10000)\n");
+   fprintf(stderr,"       -r Repeats - the best time is used \
+(default 3)\n");
+   fprintf(stderr,"       -o Write JSON results to this file \
+(default stdout)\n");
+   fprintf(stderr,"       -c Compare with a baseline JSON file\n");
+   fprintf(stderr,"       -t Fractional tolerance for the comparison \
+(default 0.20)\n");
+   fprintf(stderr,"\nBenchmarks hsubgroup and checks for performance \
+regressions\n\n");
+}
+
+
+/************************************************************************/
+/*>static REAL Now(void)
+   ---------------------
+*//**
+   \return     Monotonic time in seconds
+
+-  18.10.26 Original   By: ACRM
+*/
+static REAL Now(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return((REAL)ts.tv_sec + ((REAL)ts.tv_nsec * 1.0e-9));
+}
+
+
+/************************************************************************/
+/*>static void AddMetric(char *name, REAL value)
+   ---------------------------------------------
+*//**
+   \param[in]   name    Metric name
+   \param[in]   value   Value
+
+   Records a result and reports it on stderr
+
+-  18.10.26 Original   By: ACRM
+*/
+static void AddMetric(char *name, REAL value)
+{
+   if(sNMetrics < MAXMETRICS)
+   {
+      strncpy(sMetrics[sNMetrics].name, name, MAXMETRICNAME-1);
+      sMetrics[sNMetrics].name[MAXMETRICNAME-1] = '\0';
+      sMetrics[sNMetrics].value = value;
+      sNMetrics++;
+   }
+   fprintf(stderr, "%-40s %14.3f\n", name, value);
+}
+
+
+/************************************************************************/
+/*>static REAL FindMetric(char *name)
+   ----------------------------------
+*//**
+   \param[in]   name    Metric name
+   \return              Its value (-1 if it hasn't been recorded)
+
+-  18.10.26 Original   By: ACRM
+*/
+static REAL FindMetric(char *name)
+{
+   int i;
+
+   for(i=0; i<sNMetrics; i++)
+   {
+      if(!strcmp(sMetrics[i].name, name))
+         return(sMetrics[i].value);
+   }
+   return(-1.0);
+}
+
+
+/************************************************************************/
+/*>static void Calibrate(void)
+   ---------------------------
+*//**
+   Times a fixed loop of integer and floating point arithmetic with
+   random reads from a 4Mb table, which gives the speed of this machine
+   as it is loaded now. It is called between each group of benchmarks
+   and the mean is recorded by AddCalibration() so that it follows the
+   load on the machine over the whole run.
+
+-  18.10.26 Original   By: ACRM
+*/
+static void Calibrate(void)
+{
+   static unsigned int table[CALIBRATIONTABLE];
+   unsigned long state = 1;
+   long          i;
+   REAL          sum   = 0.0,
+                 start;
+
+   for(i=0; i<CALIBRATIONTABLE; i++)
+      table[i] = (unsigned int)(i * 2654435761UL);
+
+   start = Now();
+   for(i=0; i<CALIBRATIONLOOPS; i++)
+   {
+      state = state * 1103515245UL + 12345UL;
+      sum   = sum * 0.5 +
+              (REAL)table[(state >> 8) & (CALIBRATIONTABLE - 1)];
+   }
+   sCalibrationTime += Now() - start;
+   sNCalibrations++;
+   sSink += sum;
+}
+
+
+/************************************************************************/
+/*>static void AddCalibration(void)
+   --------------------------------
+*//**
+   Records the mean time for one iteration of the calibration loop
+
+-  18.10.26 Original   By: ACRM
+*/
+static void AddCalibration(void)
+{
+   if(sNCalibrations)
+      AddMetric(CALIBRATIONMETRIC, sCalibrationTime * 1.0e9 /
+                ((REAL)sNCalibrations * CALIBRATIONLOOPS));
+}
+
+
+/************************************************************************/
+/*>static BOOL MakeCorpus(char *genExe, char *dataDir, int nEntries)
+   -----------------------------------------------------------------
+*//**
+   \param[in]   genExe     hsgen executable
+   \param[in]   dataDir    Data directory
+   \param[in]   nEntries   Number of entries to write
+   \return                 Success
+
+   Builds the synthetic corpus by sampling from human.dat with hsgen
+   using a fixed seed. Chains are truncated or extended at the
+   N-terminus by up to the amounts that hsubgroup searches. An empty
+   file is also created for measuring start-up time.
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Uses hsgen rather than copying a template file
+*/
+static BOOL MakeCorpus(char *genExe, char *dataDir, int nEntries)
+{
+   FILE *out;
+   char dataFile[MAXBUFF],
+        count[MAXWORD*2],
+        truncation[MAXWORD],
+        extension[MAXWORD],
+        *args[16];
+   REAL seconds;
+   long maxRSS;
+
+   if((out = fopen(EMPTYFILE, "w"))==NULL)
+      return(FALSE);
+   fclose(out);
+
+   sprintf(dataFile,   "%s/human.dat", dataDir);
+   sprintf(count,      "%d", nEntries);
+   sprintf(truncation, "%d", MAXTRUNCATION);
+   sprintf(extension,  "%d", MAXEXTENSION);
+   args[0] = "-d"; args[1] = dataFile;
+   args[2] = "-n"; args[3] = count;
+   args[4] = "-s"; args[5] = "1";
+   args[6] = "-t"; args[7] = truncation;
+   args[8] = "-e"; args[9] = extension;
+   args[10] = NULL;
+
+   /* The output file is the final argument                             */
+   if(!RunExe(genExe, args, CORPUSFILE, &seconds, &maxRSS))
+      return(FALSE);
+   if(nEntries > 0)
+      AddMetric("gen.ns_per_chain", (seconds * 1.0e9) / nEntries);
+   
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static int ReadChains(char *fileName, char **chains, int maxChains)
+   -------------------------------------------------------------------
+*//**
+   \param[in]   fileName   PIR file
+   \param[out]  chains     Array of sequences
+   \param[in]   maxChains  Size of array
+   \return                 Number of chains read
+
+-  18.10.26 Original   By: ACRM
+*/
+static int ReadChains(char *fileName, char **chains, int maxChains)
+{
+   FILE *fp;
+   char *seqs[MAXSEQ];
+   int  nChains = 0,
+        nchain, i;
+   BOOL punct, error;
+
+   if((fp = fopen(fileName, "r"))==NULL)
+      return(0);
+
+   while((nchain = blReadPIR(fp, FALSE, seqs, MAXSEQ, NULL,
+                             &punct, &error)))
+   {
+      for(i=0; i<nchain; i++)
+      {
+         if(nChains < maxChains)
+            chains[nChains++] = seqs[i];
+         else
+            free(seqs[i]);
+      }
+   }
+   fclose(fp);
+   return(nChains);
+}
+
+
+/************************************************************************/
+/*>static void BenchProfileKernel(char *dataDir, char *dataFile,
+                                  BOOL fullMatrix, char *name,
+                                  char **chains, int nChains)
+   ---------------------------------------------------------------
+*//**
+   \param[in]   dataDir    Data directory
+   \param[in]   dataFile   Data file in dataDir (NULL for the built-in
+                           data)
+   \param[in]   fullMatrix Data file is a full matrix
+   \param[in]   name       Prefix for the metrics
+   \param[in]   chains     Sequences
+   \param[in]   nChains    Number of sequences
+
+   Times the profile table kernel (EncodeProfileChain() and
+   ScoreProfileStarts()) over every subgroup and window start, as done
+   by ScoreModel() when there is no index
+
+-  18.10.26 Original   By: ACRM
+*/
+static void BenchProfileKernel(char *dataDir, char *dataFile,
+                               BOOL fullMatrix, char *name,
+                               char **chains, int nChains)
+{
+   SUBGROUPMODEL *model;
+   unsigned char *code;
+   char fileName[MAXBUFF],
+        metric[MAXMETRICNAME];
+   FILE *fp = NULL;
+   int  nCodes, chainNum, length, nExtension, nStarts, sg;
+   long nScored = 0;
+   REAL start, elapsed,
+        sum = 0.0,
+        score[PROFSTARTS],
+        scoreMax[PROFSTARTS];
+
+   if(dataFile != NULL)
+   {
+      sprintf(fileName, "%s/%s", dataDir, dataFile);
+      if((fp = fopen(fileName, "r"))==NULL)
+      {
+         fprintf(stderr, "hsbench Warning: Unable to open %s\n",
+                 fileName);
+         return;
+      }
+   }
+   model = ReadSubgroupModel(fp, fullMatrix, name);
+   if(fp != NULL)
+      fclose(fp);
+   if(model == NULL)
+      return;
+
+   nCodes = PROFSTARTS + model->refLength - 1;
+   if((code = (unsigned char *)malloc(nCodes))==NULL)
+   {
+      FreeSubgroupModel(model);
+      return;
+   }
+
+   start = Now();
+   for(chainNum=0; chainNum<nChains; chainNum++)
+   {
+      length = strlen(chains[chainNum]);
+      EncodeProfileChain(chains[chainNum], length, code, nCodes);
+
+      nExtension = length - model->refLength + 1;
+      if(nExtension < 0)
+         nExtension = 0;
+      if(nExtension > MAXEXTENSION)
+         nExtension = MAXEXTENSION;
+      nStarts = PROFPADDING + ((nExtension > 0) ? nExtension : 1);
+
+      for(sg=0; sg<model->nSubGroups; sg++)
+      {
+         ScoreProfileStarts(model, sg, code, nStarts, score, scoreMax);
+         sum += score[0] + scoreMax[nStarts-1];
+      }
+      nScored += (long)nStarts * model->nSubGroups;
+   }
+   elapsed = Now() - start;
+   sSink += sum;
+   free(code);
+   FreeSubgroupModel(model);
+
+   if(nScored)
+   {
+      sprintf(metric, "%s.ns_per_start", name);
+      AddMetric(metric, elapsed * 1.0e9 / nScored);
+      sprintf(metric, "%s.ns_per_chain", name);
+      AddMetric(metric, elapsed * 1.0e9 / nChains);
+   }
+}
+
+
+/************************************************************************/
+/*>static void BenchReaders(char *dataDir, int repeats)
+   ----------------------------------------------------
+*//**
+   \param[in]   dataDir    Data directory
+   \param[in]   repeats    Number of batches of loads (best is used)
+
+   Times ReadSubgroupData() on human.dat and ReadFullMatrix() on
+   mouse_full.dat. Each load is freed before the next
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Frees each load
+-  18.10.26 The readers allocate the arrays
+-  18.10.26 Best of the batches rather than the mean
+*/
+static void BenchReaders(char *dataDir, int repeats)
+{
+   SUBGROUPINFO   *subGroupInfo;
+   FMSUBGROUPINFO *fmInfo;
+   char fileName[MAXBUFF];
+   FILE *fp;
+   int  i, n, pass;
+   REAL start, elapsed, best;
+
+   sprintf(fileName, "%s/human.dat", dataDir);
+   if((fp = fopen(fileName, "r"))!=NULL)
+   {
+      best = -1.0;
+      for(pass=0; pass<repeats; pass++)
+      {
+         start = Now();
+         for(i=0; i<READERLOADS; i++)
+         {
+            rewind(fp);
+            if((n = ReadSubgroupData(fp, &subGroupInfo)) != 0)
+            {
+               FreeSubgroupData(subGroupInfo, n);
+               free(subGroupInfo);
+            }
+         }
+         elapsed = Now() - start;
+         if((best < 0.0) || (elapsed < best))
+            best = elapsed;
+      }
+      AddMetric("readsubgroupdata.us_per_load",
+                best * 1.0e6 / READERLOADS);
+      fclose(fp);
+   }
+
+   sprintf(fileName, "%s/mouse_full.dat", dataDir);
+   if((fp = fopen(fileName, "r"))!=NULL)
+   {
+      best = -1.0;
+      for(pass=0; pass<repeats; pass++)
+      {
+         start = Now();
+         for(i=0; i<READERLOADS; i++)
+         {
+            rewind(fp);
+            if((n = ReadFullMatrix(fp, &fmInfo)) != 0)
+            {
+               fmFreeSubgroupData(fmInfo, n);
+               free(fmInfo);
+            }
+         }
+         elapsed = Now() - start;
+         if((best < 0.0) || (elapsed < best))
+            best = elapsed;
+      }
+      AddMetric("readfullmatrix.us_per_load",
+                best * 1.0e6 / READERLOADS);
+      fclose(fp);
+   }
+}
+
+
+/************************************************************************/
+/*>static void BenchReadPIR(int repeats)
+   -------------------------------------
+*//**
+   \param[in]   repeats    Number of passes over the corpus
+
+   Times parsing of the corpus with blReadPIR()
+
+-  18.10.26 Original   By: ACRM
+*/
+static void BenchReadPIR(int repeats)
+{
+   REAL best = -1.0;
+   int  nChains = 0,
+        pass;
+
+   for(pass=0; pass<repeats; pass++)
+   {
+      FILE *fp;
+      char *seqs[MAXSEQ];
+      int  nchain, i;
+      BOOL punct, error;
+      REAL start, elapsed;
+
+      if((fp = fopen(CORPUSFILE, "r"))==NULL)
+         return;
+
+      nChains = 0;
+      start   = Now();
+      while((nchain = blReadPIR(fp, FALSE, seqs, MAXSEQ, NULL,
+                                &punct, &error)))
+      {
+         for(i=0; i<nchain; i++)
+            free(seqs[i]);
+         nChains += nchain;
+      }
+      elapsed = Now() - start;
+      fclose(fp);
+
+      if((best < 0.0) || (elapsed < best))
+         best = elapsed;
+   }
+
+   if(nChains)
+      AddMetric("readpir.ns_per_chain", best * 1.0e9 / nChains);
+}
+
+
+/************************************************************************/
+/*>static BOOL RunExe(char *exe, char **args, char *inFile,
+                      REAL *seconds, long *maxRSS)
+   ---------------------------------------------------------
+*//**
+   \param[in]   exe       Executable
+   \param[in]   args      NULL terminated argument list (not including
+                          the program name or input file)
+   \param[in]   inFile    Input file
+   \param[out]  seconds   Wall clock time
+   \param[out]  maxRSS    Peak resident set size (KB)
+   \return                Program ran and exited with status 0
+
+   Runs the executable with output discarded
+
+-  18.10.26 Original   By: ACRM
+*/
+static BOOL RunExe(char *exe, char **args, char *inFile, REAL *seconds,
+                   long *maxRSS)
+{
+   char          *argv[32];
+   int           argc = 0,
+                 status;
+   pid_t         pid;
+   struct rusage usage;
+   REAL          start;
+
+   argv[argc++] = exe;
+   while(*args && (argc < 30))
+      argv[argc++] = *(args++);
+   argv[argc++] = inFile;
+   argv[argc]   = NULL;
+
+   start = Now();
+   if((pid = fork()) < 0)
+      return(FALSE);
+
+   if(pid == 0)
+   {
+      int devNull = open("/dev/null", O_WRONLY);
+      if(devNull >= 0)
+         dup2(devNull, 1);
+      execv(exe, argv);
+      _exit(127);
+   }
+
+   if(wait4(pid, &status, 0, &usage) != pid)
+      return(FALSE);
+   *seconds = Now() - start;
+   *maxRSS  = usage.ru_maxrss;
+
+   return(WIFEXITED(status) && (WEXITSTATUS(status) == 0));
+}
+
+
+/************************************************************************/
+/*>static void BenchEndToEnd(char *exe, char *dataDir, int nChains,
+                             int repeats)
+   ----------------------------------------------------------------
+*//**
+   \param[in]   exe        hsubgroup executable
+   \param[in]   dataDir    Data directory
+   \param[in]   nChains    Number of chains in the corpus
+   \param[in]   repeats    Runs of each configuration (best is used)
+
+   Runs hsubgroup over the corpus for each data file with every
+   combination of -x, -p and -v, and on an empty file to measure
+   start-up time.
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 More runs for the start-up time
+*/
+static void BenchEndToEnd(char *exe, char *dataDir, int nChains,
+                          int repeats)
+{
+   static char *modelNames[] = {"builtin", "human", "mouse_full"};
+   char humanFile[MAXBUFF],
+        mouseFile[MAXBUFF],
+        metricName[MAXMETRICNAME];
+   int  model, flags, pass, i;
+   REAL seconds, best;
+   long maxRSS, bestRSS;
+   char *args[16];
+
+   sprintf(humanFile, "%s/human.dat",      dataDir);
+   sprintf(mouseFile, "%s/mouse_full.dat", dataDir);
+
+   /* Start-up time. This is short and noisy so is run more often      */
+   best = -1.0;
+   for(pass=0; pass<repeats*STARTUPRUNS; pass++)
+   {
+      args[0] = NULL;
+      if(!RunExe(exe, args, EMPTYFILE, &seconds, &maxRSS))
+      {
+         fprintf(stderr, "hsbench Error: Unable to run %s\n", exe);
+         return;
+      }
+      if((best < 0.0) || (seconds < best))
+         best = seconds;
+   }
+   AddMetric("startup.ms", best * 1000.0);
+   AddMetric("startup.peak_rss_kb", (REAL)maxRSS);
+
+   for(model=0; model<3; model++)
+   {
+      for(flags=0; flags<8; flags++)
+      {
+         char flagText[8];
+         int  nArgs = 0,
+              nFlag = 0;
+
+         if(model == 1)
+         {
+            args[nArgs++] = "-d";
+            args[nArgs++] = humanFile;
+         }
+         else if(model == 2)
+         {
+            args[nArgs++] = "-d";
+            args[nArgs++] = mouseFile;
+            args[nArgs++] = "-f";
+         }
+         if(flags & 1)
+         {
+            args[nArgs++] = "-x";
+            flagText[nFlag++] = 'x';
+         }
+         if(flags & 2)
+         {
+            args[nArgs++] = "-p";
+            flagText[nFlag++] = 'p';
+         }
+         if(flags & 4)
+         {
+            args[nArgs++] = "-v";
+            flagText[nFlag++] = 'v';
+         }
+         if(!nFlag)
+            flagText[nFlag++] = '-';
+         flagText[nFlag] = '\0';
+         args[nArgs]     = NULL;
+
+         best    = -1.0;
+         bestRSS = 0;
+         for(pass=0; pass<repeats; pass++)
+         {
+            if(!RunExe(exe, args, CORPUSFILE, &seconds, &maxRSS))
+            {
+               fprintf(stderr, "hsbench Error: %s failed with", exe);
+               for(i=0; i<nArgs; i++)
+                  fprintf(stderr, " %s", args[i]);
+               fprintf(stderr, "\n");
+               break;
+            }
+            if((best < 0.0) || (seconds < best))
+               best = seconds;
+            if(maxRSS > bestRSS)
+               bestRSS = maxRSS;
+         }
+         if(best <= 0.0)
+            continue;
+
+         sprintf(metricName, "e2e.%s.%s.seqs_per_s",
+                 modelNames[model], flagText);
+         AddMetric(metricName, nChains / best);
+         sprintf(metricName, "e2e.%s.%s.ns_per_chain",
+                 modelNames[model], flagText);
+         AddMetric(metricName, best * 1.0e9 / nChains);
+         sprintf(metricName, "e2e.%s.%s.peak_rss_kb",
+                 modelNames[model], flagText);
+         AddMetric(metricName, (REAL)bestRSS);
+      }
+   }
+}
+
+
+/************************************************************************/
+/*>static BOOL WriteMetrics(char *outFile)
+   ---------------------------------------
+*//**
+   \param[in]   outFile    File for results (blank for stdout)
+   \return                 Success
+
+   Writes the metrics as a flat JSON object, one per line
+
+-  18.10.26 Original   By: ACRM
+*/
+static BOOL WriteMetrics(char *outFile)
+{
+   FILE *fp = stdout;
+   int  i;
+
+   if(outFile[0] && ((fp = fopen(outFile, "w"))==NULL))
+      return(FALSE);
+
+   fprintf(fp, "{\n");
+   for(i=0; i<sNMetrics; i++)
+   {
+      fprintf(fp, "\"%s\": %.3f%s\n", sMetrics[i].name, sMetrics[i].value,
+              (i < sNMetrics-1) ? "," : "");
+   }
+   fprintf(fp, "}\n");
+
+   if(fp != stdout)
+      fclose(fp);
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static int CompareBaseline(char *baseFile, REAL tolerance)
+   ----------------------------------------------------------
+*//**
+   \param[in]   baseFile   Baseline JSON file as written by
+                           WriteMetrics()
+   \param[in]   tolerance  Fractional change allowed
+   \return                 0 if no regressions, 1 otherwise
+
+   Compares the metrics with the baseline. Metrics missing from the
+   baseline are ignored. Times are scaled by the ratio of this run's
+   calibration time to the baseline's, if it has one, so only changes
+   relative to the speed of the machine count.
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Relative to the calibration loop
+*/
+static int CompareBaseline(char *baseFile, REAL tolerance)
+{
+   FILE *fp;
+   char buffer[MAXBUFF];
+   int  nRegressions = 0,
+        nCompared    = 0;
+   REAL calibration  = FindMetric(CALIBRATIONMETRIC),
+        speed        = 1.0;   /* Time here for a unit of baseline time  */
+
+   if((fp = fopen(baseFile, "r"))==NULL)
+   {
+      fprintf(stderr, "hsbench Error: Unable to open baseline %s\n",
+              baseFile);
+      return(1);
+   }
+
+   /* The baseline's calibration time                                  */
+   while(fgets(buffer, MAXBUFF, fp))
+   {
+      char name[MAXMETRICNAME];
+      REAL baseValue;
+
+      if((sscanf(buffer, " \"%79[^\"]\": %lf", name, &baseValue) == 2) &&
+         !strcmp(name, CALIBRATIONMETRIC) && (baseValue > 0.0) &&
+         (calibration > 0.0))
+         speed = calibration / baseValue;
+   }
+   rewind(fp);
+
+   fprintf(stderr, "\nComparison with %s (tolerance %.0f%%, this machine \
+%.2fx the baseline's time)\n", baseFile, tolerance * 100.0, speed);
+
+   while(fgets(buffer, MAXBUFF, fp))
+   {
+      char name[MAXMETRICNAME];
+      REAL baseValue;
+      int  i;
+
+      if(sscanf(buffer, " \"%79[^\"]\": %lf", name, &baseValue) != 2)
+         continue;
+      if(!strncmp(name, "corpus.", 7) ||
+         !strcmp(name, CALIBRATIONMETRIC))
+         continue;
+
+      for(i=0; i<sNMetrics; i++)
+      {
+         if(!strcmp(name, sMetrics[i].name))
+         {
+            REAL value     = sMetrics[i].value,
+                 change;
+            BOOL higherBetter =
+               (strstr(name, "seqs_per_s") != NULL);
+
+            if(baseValue <= 0.0)
+               break;
+
+            /* Scale the baseline to this machine                       */
+            if(higherBetter)
+               baseValue /= speed;
+            else if(strstr(name, "peak_rss_kb") == NULL)
+               baseValue *= speed;
+
+            change = (value - baseValue) / baseValue;
+            if(higherBetter)
+               change = -change;
+
+            nCompared++;
+            if(change > tolerance)
+            {
+               fprintf(stderr, "REGRESSION %-40s %14.3f -> %14.3f \
+(%+.1f%%)\n", name, baseValue, value, change * 100.0);
+               nRegressions++;
+            }
+            break;
+         }
+      }
+   }
+   fclose(fp);
+
+   fprintf(stderr, "%d metrics compared, %d regressions\n",
+           nCompared, nRegressions);
+   return(nRegressions ? 1 : 0);
+}
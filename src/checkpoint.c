@@ -0,0 +1,378 @@
+/*************************************************************************
+
+   Program:    hsubgroup
+   File:       checkpoint.c
+
+   Version:    V3.26
+   Date:       18.10.26
+   Function:   Checkpoint and resume for long runs
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Every so often hsubgroup flushes and syncs its output and writes a
+   small sidecar file (the output file name with CKPTSUFFIX added)
+   giving the input byte offset of the next entry to be read, the
+   number of records and the size of the output at that point.
+
+   The sidecar is written to a temporary file which is synced and then
+   renamed over the old one, so there is always a complete checkpoint
+   even if the program is killed while writing it. On --resume the
+   output is truncated back to the checkpoint and reading restarts at
+   the recorded input offset.
+
+   The sidecar is a short text file:
+      hsubgroup checkpoint <version>
+      input <input file>
+      shard <i>/<N>
+      options <format> <topK> <verbose>
+      data <data file>
+      scoring <full matrix> <include X> <product>
+      gaps <open> <extend>
+      pvalues <p-values>
+      position <input offset> <output offset> <records>
+   The data file is empty for the built-in data and the gap opening
+   penalty is negative without --gapped. --resume refuses a
+   checkpoint unless all of these match the options it is given.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V3.9  18.10.26   Original
+   V3.25 18.10.26   Records the data file, -f, -x and -p
+   V3.26 18.10.26   Records the --gapped penalties and --pvalues
+
+*************************************************************************/
+/* Includes
+*/
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "bioplib/MathType.h"
+#include "bioplib/SysDefs.h"
+#include "subgroup.h"
+#include "output.h"
+#include "seqio.h"
+#include "checkpoint.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define CKPTMAGIC "hsubgroup checkpoint"
+
+/************************************************************************/
+/* Prototypes
+*/
+static BOOL SyncDirectory(char *fileName);
+
+
+/************************************************************************/
+/*>BOOL SaveCheckpoint(char *ckptFile, CHECKPOINT *ckpt,
+                       OUTWRITER *writer, SEQREADER *reader)
+   -----------------------------------------------------------
+*//**
+   \param[in]     ckptFile  Sidecar file
+   \param[in,out] ckpt      The checkpoint (run details must be filled
+                            in; the offsets and count are set here)
+   \param[in]     writer    The output writer
+   \param[in]     reader    The sequence reader
+   \return                  Success
+
+   Flushes and syncs the output then records the position. Must be
+   called between entries so that the output matches the input
+   offset.
+
+-  18.10.26 Original   By: ACRM
+*/
+BOOL SaveCheckpoint(char *ckptFile, CHECKPOINT *ckpt, OUTWRITER *writer,
+                    SEQREADER *reader)
+{
+   if(!FlushOutputWriter(writer) || fsync(fileno(writer->fp)))
+      return(FALSE);
+
+   ckpt->inOffset  = SeqReaderOffset(reader);
+   ckpt->outOffset = ftell(writer->fp);
+   ckpt->nRecords  = writer->nRecords;
+   if(ckpt->outOffset < 0)
+      return(FALSE);
+
+   return(WriteCheckpoint(ckptFile, ckpt));
+}
+
+
+/************************************************************************/
+/*>BOOL WriteCheckpoint(char *ckptFile, CHECKPOINT *ckpt)
+   ------------------------------------------------------
+*//**
+   \param[in]   ckptFile  Sidecar file
+   \param[in]   ckpt      The checkpoint
+   \return                Success
+
+   Writes the sidecar atomically by writing and syncing a temporary
+   file which is then renamed
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Writes the data file and scoring options
+*/
+BOOL WriteCheckpoint(char *ckptFile, CHECKPOINT *ckpt)
+{
+   char tmpFile[MAXBUFF+8];
+   FILE *fp;
+   BOOL ok;
+
+   sprintf(tmpFile, "%s.tmp", ckptFile);
+   if((fp = fopen(tmpFile, "w"))==NULL)
+      return(FALSE);
+
+   fprintf(fp, "%s %d\n", CKPTMAGIC, CKPTVERSION);
+   fprintf(fp, "input %s\n", ckpt->inFile);
+   fprintf(fp, "shard %d/%d\n", ckpt->shard, ckpt->nShards);
+   fprintf(fp, "options %d %d %d\n", ckpt->format, ckpt->topK,
+           ckpt->verbose);
+   fprintf(fp, "data %s\n", ckpt->dataFile);
+   fprintf(fp, "scoring %d %d %d\n", (int)ckpt->fullMatrix,
+           (int)ckpt->includeX, (int)ckpt->doProduct);
+   fprintf(fp, "gaps %.17g %.17g\n", ckpt->gapOpen, ckpt->gapExtend);
+   fprintf(fp, "pvalues %d\n", (int)ckpt->pValues);
+   fprintf(fp, "position %ld %ld %ld\n", ckpt->inOffset,
+           ckpt->outOffset, ckpt->nRecords);
+
+   ok = ((fflush(fp) == 0) && (fsync(fileno(fp)) == 0));
+   if(fclose(fp) != 0)
+      ok = FALSE;
+
+   if(!ok || rename(tmpFile, ckptFile))
+   {
+      remove(tmpFile);
+      return(FALSE);
+   }
+   return(SyncDirectory(ckptFile));
+}
+
+
+/************************************************************************/
+/*>static BOOL SyncDirectory(char *fileName)
+   -----------------------------------------
+*//**
+   \param[in]   fileName   A file
+   \return                 Success
+
+   Syncs the directory containing a file so that a rename is on disk
+
+-  18.10.26 Original   By: ACRM
+*/
+static BOOL SyncDirectory(char *fileName)
+{
+   char dirName[MAXBUFF],
+        *slash;
+   int  fd;
+   BOOL ok;
+
+   strncpy(dirName, fileName, MAXBUFF-1);
+   dirName[MAXBUFF-1] = '\0';
+   if((slash = strrchr(dirName, '/')) == NULL)
+      strcpy(dirName, ".");
+   else if(slash == dirName)
+      slash[1] = '\0';
+   else
+      *slash = '\0';
+
+   if((fd = open(dirName, O_RDONLY)) < 0)
+      return(FALSE);
+   ok = (fsync(fd) == 0);
+   close(fd);
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>int ReadCheckpoint(char *ckptFile, CHECKPOINT *ckpt)
+   ----------------------------------------------------
+*//**
+   \param[in]   ckptFile  Sidecar file
+   \param[out]  ckpt      The checkpoint
+   \return                1 if read, 0 if there is no checkpoint, -1 if
+                          the file is not a valid checkpoint
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Reads the data file and scoring options
+-  18.10.26 Reads the gap penalties and whether there are p-values
+*/
+int ReadCheckpoint(char *ckptFile, CHECKPOINT *ckpt)
+{
+   FILE *fp;
+   char line[MAXBUFF+16],
+        *chp;
+   int  version,
+        fullMatrix, includeX, doProduct, pValues,
+        nFields = 0;
+
+   if((fp = fopen(ckptFile, "r"))==NULL)
+      return(0);
+
+   if(!fgets(line, MAXBUFF+16, fp) ||
+      strncmp(line, CKPTMAGIC, strlen(CKPTMAGIC)) ||
+      (sscanf(line+strlen(CKPTMAGIC), "%d", &version) != 1) ||
+      (version != CKPTVERSION))
+   {
+      fclose(fp);
+      return(-1);
+   }
+   
+   while(fgets(line, MAXBUFF+16, fp))
+   {
+      if((chp = strchr(line, '\n')) != NULL)
+         *chp = '\0';
+
+      if(!strncmp(line, "input ", 6))
+      {
+         strncpy(ckpt->inFile, line+6, MAXBUFF-1);
+         ckpt->inFile[MAXBUFF-1] = '\0';
+         nFields++;
+      }
+      else if(!strncmp(line, "data ", 5))
+      {
+         strncpy(ckpt->dataFile, line+5, MAXBUFF-1);
+         ckpt->dataFile[MAXBUFF-1] = '\0';
+         nFields++;
+      }
+      else if(sscanf(line, "scoring %d %d %d", &fullMatrix, &includeX,
+                     &doProduct) == 3)
+      {
+         ckpt->fullMatrix = (BOOL)fullMatrix;
+         ckpt->includeX   = (BOOL)includeX;
+         ckpt->doProduct  = (BOOL)doProduct;
+         nFields++;
+      }
+      else if(sscanf(line, "gaps %lf %lf", &(ckpt->gapOpen),
+                     &(ckpt->gapExtend)) == 2)
+      {
+         nFields++;
+      }
+      else if(sscanf(line, "pvalues %d", &pValues) == 1)
+      {
+         ckpt->pValues = (BOOL)pValues;
+         nFields++;
+      }
+      else if(sscanf(line, "shard %d/%d", &(ckpt->shard),
+                     &(ckpt->nShards)) == 2)
+      {
+         nFields++;
+      }
+      else if(sscanf(line, "options %d %d %d", &(ckpt->format),
+                     &(ckpt->topK), &(ckpt->verbose)) == 3)
+      {
+         nFields++;
+      }
+      else if(sscanf(line, "position %ld %ld %ld", &(ckpt->inOffset),
+                     &(ckpt->outOffset), &(ckpt->nRecords)) == 3)
+      {
+         nFields++;
+      }
+   }
+   fclose(fp);
+
+   return((nFields == 8) ? 1 : -1);
+}
+
+
+/************************************************************************/
+/*>BOOL SameRun(CHECKPOINT *ckpt1, CHECKPOINT *ckpt2)
+   --------------------------------------------------
+*//**
+   \param[in]   ckpt1    A checkpoint
+   \param[in]   ckpt2    Another checkpoint
+   \return               The checkpoints are for the same input, shard,
+                         data file, scoring and output options
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Compares the data file and scoring options
+-  18.10.26 Compares the gap penalties and whether there are p-values
+*/
+BOOL SameRun(CHECKPOINT *ckpt1, CHECKPOINT *ckpt2)
+{
+   return(!strcmp(ckpt1->inFile,   ckpt2->inFile)   &&
+          !strcmp(ckpt1->dataFile, ckpt2->dataFile) &&
+          (ckpt1->shard      == ckpt2->shard)       &&
+          (ckpt1->nShards    == ckpt2->nShards)     &&
+          (ckpt1->format     == ckpt2->format)      &&
+          (ckpt1->topK       == ckpt2->topK)        &&
+          (ckpt1->verbose    == ckpt2->verbose)     &&
+          (!ckpt1->fullMatrix == !ckpt2->fullMatrix) &&
+          (!ckpt1->includeX   == !ckpt2->includeX)   &&
+          (!ckpt1->doProduct  == !ckpt2->doProduct)  &&
+          (!ckpt1->pValues    == !ckpt2->pValues)    &&
+          (ckpt1->gapOpen    == ckpt2->gapOpen)     &&
+          (ckpt1->gapExtend  == ckpt2->gapExtend));
+}
+
+
+/************************************************************************/
+/*>FILE *ReopenOutput(char *outFile, long outOffset)
+   -------------------------------------------------
+*//**
+   \param[in]   outFile    Output file
+   \param[in]   outOffset  Size of the output at the checkpoint
+   \return                 The file positioned for writing at outOffset
+                           (NULL if it can't be opened or is shorter
+                           than outOffset)
+
+   Opens the output of an interrupted run and truncates anything
+   written after the checkpoint
+
+-  18.10.26 Original   By: ACRM
+*/
+FILE *ReopenOutput(char *outFile, long outOffset)
+{
+   FILE        *fp;
+   struct stat st;
+
+   if((fp = fopen(outFile, "r+b"))==NULL)
+      return(NULL);
+
+   if(fstat(fileno(fp), &st)                ||
+      ((long)st.st_size < outOffset)        ||
+      ftruncate(fileno(fp), (off_t)outOffset) ||
+      fseek(fp, outOffset, SEEK_SET))
+   {
+      fclose(fp);
+      return(NULL);
+   }
+   return(fp);
+}
@@ -0,0 +1,101 @@
+/*************************************************************************
+
+   Program:    hsubgroup
+   File:       checkpoint.h
+
+   Version:    V3.26
+   Date:       18.10.26
+   Function:   Checkpoint and resume for long runs
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   A checkpoint records how far through the input and output a run has
+   got so that it can be restarted with --resume.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V3.9  18.10.26   Original
+   V3.25 18.10.26   Records the data file and scoring options
+   V3.26 18.10.26   Records the gap penalties and --pvalues
+
+*************************************************************************/
+#ifndef _CHECKPOINT_H
+#define _CHECKPOINT_H
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define CKPTSUFFIX        ".ckpt"  /* Added to the output file name     */
+#define CKPTVERSION             4
+#define DEFAULTCKPTINTERVAL  60.0  /* Seconds between checkpoints       */
+
+/* A checkpoint. The offsets and record count are for the point where
+   all output for the entries before inOffset has been written and
+   synced. The other fields identify the run so that a checkpoint is
+   not used with a different input, model, scoring or output format
+*/
+typedef struct
+{
+   char inFile[MAXBUFF],
+        dataFile[MAXBUFF];     /* Empty for the built-in data           */
+   long inOffset,
+        outOffset,
+        nRecords;
+   int  format,
+        topK,
+        verbose,
+        shard,
+        nShards;
+   BOOL fullMatrix,
+        includeX,
+        doProduct,
+        pValues;
+   REAL gapOpen,               /* -ve for ungapped scoring              */
+        gapExtend;
+}  CHECKPOINT;
+
+
+/************************************************************************/
+/* Prototypes
+*/
+BOOL SaveCheckpoint(char *ckptFile, CHECKPOINT *ckpt, OUTWRITER *writer,
+                    SEQREADER *reader);
+BOOL WriteCheckpoint(char *ckptFile, CHECKPOINT *ckpt);
+int  ReadCheckpoint(char *ckptFile, CHECKPOINT *ckpt);
+BOOL SameRun(CHECKPOINT *ckpt1, CHECKPOINT *ckpt2);
+FILE *ReopenOutput(char *outFile, long outOffset);
+
+#endif
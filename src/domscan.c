@@ -0,0 +1,390 @@
+/*************************************************************************
+
+   Program:    hsubgroup
+   File:       domscan.c
+
+   Version:    V3.19
+   Date:       18.10.26
+   Function:   Find several variable domains along a chain
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Normal scoring only looks for the start of a variable domain in the
+   first MAXEXTENSION residues. Here every window of the profile length
+   along the chain is scored against every subgroup, as are the windows
+   at the start of the chain that are N-terminally truncated by up to
+   MAXTRUNCATION-1 residues, so a window score is the same as the score
+   for an offset in normal scoring.
+
+   The windows are scored from the model's table of scores for each
+   residue code exactly as normal scoring does, but with a window start
+   for every residue of the chain.
+
+   Domains are taken greedily: the best window start scoring at least
+   the threshold, then the best that is at least DOMAINLENGTH residues
+   from any start already taken, and so on.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V3.16 18.10.26   Original
+   V3.19 18.10.26   Uses the model's table and profile length
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bioplib/MathType.h"
+#include "bioplib/SysDefs.h"
+#include "subgroup.h"
+#include "domscan.h"
+
+/************************************************************************/
+/* Prototypes
+*/
+static BOOL GrowDomainScan(DOMSCAN *dom, int nAlloc);
+static void ScoreWindows(DOMSCAN *dom, int nStarts);
+static void PickDomains(DOMSCAN *dom, int nStarts);
+static int  DomainChainType(SUBGROUPMODEL *model, int sgNum);
+
+
+/************************************************************************/
+/*>DOMSCAN *OpenDomainScan(SUBGROUPMODEL *model, REAL threshold)
+   -------------------------------------------------------------
+*//**
+   \param[in]   model      The model
+   \param[in]   threshold  Score a domain must reach
+   \return                 The scan (NULL if no memory)
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 The table of scores is now kept with the model
+*/
+DOMSCAN *OpenDomainScan(SUBGROUPMODEL *model, REAL threshold)
+{
+   DOMSCAN *dom;
+
+   if((dom = (DOMSCAN *)malloc(sizeof(DOMSCAN)))==NULL)
+      return(NULL);
+
+   dom->model       = model;
+   dom->threshold   = threshold;
+   dom->nAlloc      = 0;
+   dom->nDomains    = 0;
+   dom->score       = dom->scoreMax = NULL;
+   dom->bestScore   = dom->secondScore = NULL;
+   dom->best        = dom->second = NULL;
+   dom->code        = NULL;
+   return(dom);
+}
+
+
+/************************************************************************/
+/*>void CloseDomainScan(DOMSCAN *dom)
+   ----------------------------------
+*//**
+   \param[in]   dom       The scan
+
+-  18.10.26 Original   By: ACRM
+*/
+void CloseDomainScan(DOMSCAN *dom)
+{
+   if(dom != NULL)
+   {
+      GrowDomainScan(dom, 0);
+      free(dom);
+   }
+}
+
+
+/************************************************************************/
+/*>static BOOL GrowDomainScan(DOMSCAN *dom, int nAlloc)
+   ----------------------------------------------------
+*//**
+   \param[in,out] dom     The scan
+   \param[in]   nAlloc    Window starts needed (0 to free the space)
+   \return                Success
+
+   Makes sure there is working space for a chain
+
+-  18.10.26 Original   By: ACRM
+*/
+static BOOL GrowDomainScan(DOMSCAN *dom, int nAlloc)
+{
+   if((nAlloc > 0) && (nAlloc <= dom->nAlloc))
+      return(TRUE);
+
+   if(dom->score       != NULL) free(dom->score);
+   if(dom->scoreMax    != NULL) free(dom->scoreMax);
+   if(dom->bestScore   != NULL) free(dom->bestScore);
+   if(dom->secondScore != NULL) free(dom->secondScore);
+   if(dom->best        != NULL) free(dom->best);
+   if(dom->second      != NULL) free(dom->second);
+   if(dom->code        != NULL) free(dom->code);
+   dom->score       = dom->scoreMax = NULL;
+   dom->bestScore   = dom->secondScore = NULL;
+   dom->best        = dom->second = NULL;
+   dom->code        = NULL;
+   dom->nAlloc      = 0;
+   if(nAlloc == 0)
+      return(TRUE);
+
+   /* Round up so a run of growing chains doesn't reallocate each time  */
+   nAlloc = (nAlloc + 1023) & ~1023;
+   dom->score       = (REAL *)malloc(nAlloc * sizeof(REAL));
+   dom->scoreMax    = (REAL *)malloc(nAlloc * sizeof(REAL));
+   dom->bestScore   = (REAL *)malloc(nAlloc * sizeof(REAL));
+   dom->secondScore = (REAL *)malloc(nAlloc * sizeof(REAL));
+   dom->best        = (int *)malloc(nAlloc * sizeof(int));
+   dom->second      = (int *)malloc(nAlloc * sizeof(int));
+   dom->code        = (unsigned char *)malloc(nAlloc);
+   if((dom->score == NULL)     || (dom->scoreMax == NULL)    ||
+      (dom->bestScore == NULL) || (dom->secondScore == NULL) ||
+      (dom->best == NULL)      || (dom->second == NULL)      ||
+      (dom->code == NULL))
+   {
+      GrowDomainScan(dom, 0);
+      return(FALSE);
+   }
+   dom->nAlloc = nAlloc;
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>BOOL DomainScan(DOMSCAN *dom, char *sequence)
+   ---------------------------------------------
+*//**
+   \param[in,out] dom     The scan
+   \param[in]   sequence  The chain
+   \return                Success (FALSE if no memory)
+
+   Finds the domains in a chain
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Uses EncodeProfileChain() and the profile length
+*/
+BOOL DomainScan(DOMSCAN *dom, char *sequence)
+{
+   int length = strlen(sequence),
+       nStarts;
+
+   dom->nDomains = 0;
+
+   /* Every window must lie within the chain apart from the padding     */
+   nStarts = PROFPADDING + length - dom->model->refLength + 1;
+   if(nStarts <= 0)
+      return(TRUE);
+   if(!GrowDomainScan(dom, PROFPADDING + length))
+      return(FALSE);
+
+   EncodeProfileChain(sequence, length, dom->code, PROFPADDING + length);
+
+   ScoreWindows(dom, nStarts);
+   PickDomains(dom, nStarts);
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static void ScoreWindows(DOMSCAN *dom, int nStarts)
+   ---------------------------------------------------
+*//**
+   \param[in,out] dom     The scan
+   \param[in]   nStarts   Number of window starts
+
+   Finds the best and second best subgroup for every window start. As
+   in normal scoring, a subgroup must score more than zero and the
+   earlier subgroup wins a tie.
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Windows are summed by ScoreProfileStarts()
+*/
+static void ScoreWindows(DOMSCAN *dom, int nStarts)
+{
+   REAL          *score    = dom->score,
+                 *scoreMax = dom->scoreMax,
+                 value;
+   int           sgNum, start;
+
+   for(start=0; start<nStarts; start++)
+   {
+      dom->bestScore[start] = dom->secondScore[start] = 0.0;
+      dom->best[start]      = dom->second[start]      = -1;
+   }
+
+   for(sgNum=0; sgNum<dom->model->nSubGroups; sgNum++)
+   {
+      ScoreProfileStarts(dom->model, sgNum, dom->code, nStarts,
+                         score, scoreMax);
+
+      for(start=0; start<nStarts; start++)
+      {
+         if(scoreMax[start] <= 0.0)
+            continue;
+         value = (score[start] * 100.0) / scoreMax[start];
+         if(value > dom->bestScore[start])
+         {
+            dom->secondScore[start] = dom->bestScore[start];
+            dom->second[start]      = dom->best[start];
+            dom->bestScore[start]   = value;
+            dom->best[start]        = sgNum;
+         }
+         else if(value > dom->secondScore[start])
+         {
+            dom->secondScore[start] = value;
+            dom->second[start]      = sgNum;
+         }
+      }
+   }
+}
+
+
+/************************************************************************/
+/*>static void PickDomains(DOMSCAN *dom, int nStarts)
+   --------------------------------------------------
+*//**
+   \param[in,out] dom     The scan
+   \param[in]   nStarts   Number of window starts
+
+   Takes the best window starts that reach the threshold and don't
+   overlap a domain already taken. The domains are then put in order
+   along the chain.
+
+-  18.10.26 Original   By: ACRM
+*/
+static void PickDomains(DOMSCAN *dom, int nStarts)
+{
+   DOMAINHIT hit;
+   int       start, pick, i;
+
+   while(dom->nDomains < MAXDOMAINS)
+   {
+      pick = -1;
+      for(start=0; start<nStarts; start++)
+      {
+         if((dom->best[start] < 0) ||
+            (dom->bestScore[start] < dom->threshold) ||
+            ((pick >= 0) &&
+             (dom->bestScore[start] <= dom->bestScore[pick])))
+            continue;
+         for(i=0; i<dom->nDomains; i++)
+         {
+            if(abs(dom->domains[i].start + PROFPADDING - start) <
+               DOMAINLENGTH)
+               break;
+         }
+         if(i == dom->nDomains)
+            pick = start;
+      }
+      if(pick < 0)
+         break;
+
+      hit.start       = pick - PROFPADDING;
+      hit.score       = dom->bestScore[pick];
+      hit.secondScore = dom->secondScore[pick];
+      hit.best        = dom->best[pick];
+      hit.second      = dom->second[pick];
+
+      for(i=dom->nDomains; (i > 0) && (dom->domains[i-1].start >
+                                       hit.start); i--)
+         dom->domains[i] = dom->domains[i-1];
+      dom->domains[i] = hit;
+      dom->nDomains++;
+   }
+}
+
+
+/************************************************************************/
+/*>static int DomainChainType(SUBGROUPMODEL *model, int sgNum)
+   -----------------------------------------------------------
+*//**
+   \param[in]   model     The model
+   \param[in]   sgNum     Subgroup
+   \return                Chain type of the subgroup
+
+-  18.10.26 Original   By: ACRM
+*/
+static int DomainChainType(SUBGROUPMODEL *model, int sgNum)
+{
+   return(model->fullMatrix ? model->fmSubGroupInfo[sgNum].chainType :
+                              model->subGroupInfo[sgNum].chainType);
+}
+
+
+/************************************************************************/
+/*>BOOL WriteDomainScan(FILE *fp, char *id, int chainNum, DOMSCAN *dom,
+                        BOOL header)
+   -------------------------------------------------------------------
+*//**
+   \param[in]   fp        Output file
+   \param[in]   id        Sequence identifier
+   \param[in]   chainNum  Chain number within the entry (from 1)
+   \param[in]   dom       The scan
+   \param[in]   header    Write the column names first
+   \return                Success
+
+   Writes a tab separated row for each domain with its start (from 1;
+   0 or less if the domain is N-terminally truncated), chain type,
+   subgroup, score and margin over the second best subgroup for the
+   same window. If there are no domains there is one row with none.
+
+-  18.10.26 Original   By: ACRM
+*/
+BOOL WriteDomainScan(FILE *fp, char *id, int chainNum, DOMSCAN *dom,
+                     BOOL header)
+{
+   DOMAINHIT *hit;
+   int       i;
+
+   if(header)
+      fprintf(fp, "#id\tchain\tdomain\tstart\ttype\tsubgroup\tscore\t\
+margin\n");
+
+   if(dom->nDomains == 0)
+      fprintf(fp, "%s\t%d\t0\t-\t-\tnone\t-\t-\n", id, chainNum);
+
+   for(i=0; i<dom->nDomains; i++)
+   {
+      hit = &(dom->domains[i]);
+      fprintf(fp, "%s\t%d\t%d\t%d\t%s\t%s\t%f\t%f\n",
+              id, chainNum, i+1, hit->start+1,
+              ChainTypeLabel(DomainChainType(dom->model, hit->best)),
+              ModelSubgroupName(dom->model, hit->best),
+              hit->score, hit->score - hit->secondScore);
+   }
+   return(!ferror(fp));
+}
@@ -0,0 +1,108 @@
+/*************************************************************************
+
+   Program:    hsubgroup
+   File:       domscan.h
+
+   Version:    V3.19
+   Date:       18.10.26
+   Function:   Find several variable domains along a chain
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+
+   Description:
+   ============
+   A domain scan slides the subgroup profiles along the whole of a
+   chain rather than just the N-terminus so that the second variable
+   domain of an scFv, bispecific or fusion protein is also found.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V3.16 18.10.26   Original
+   V3.19 18.10.26   The table of scores moved to the model
+
+*************************************************************************/
+#ifndef _DOMSCAN_H
+#define _DOMSCAN_H
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define DEFAULTDOMAINSCORE 50.0  /* Score a domain start must reach     */
+#define DOMAINLENGTH      100    /* Starts closer than this overlap     */
+#define MAXDOMAINS         16    /* Domains reported for each chain     */
+
+/* A domain found in a chain. start is from 0 and is negative if the
+   domain is N-terminally truncated at the start of the chain
+*/
+typedef struct
+{
+   REAL score,
+        secondScore;
+   int  start,
+        best,
+        second;
+}  DOMAINHIT;
+
+/* A domain scan. The arrays are working space for the chain being
+   scanned, indexed by window start (plus PROFPADDING for the truncated
+   starts)
+*/
+typedef struct
+{
+   SUBGROUPMODEL *model;
+   REAL          *score,
+                 *scoreMax,
+                 *bestScore,
+                 *secondScore,
+                 threshold;
+   int           *best,
+                 *second,
+                 nAlloc,
+                 nDomains;
+   unsigned char *code;
+   DOMAINHIT     domains[MAXDOMAINS];
+}  DOMSCAN;
+
+
+/************************************************************************/
+/* Prototypes
+*/
+DOMSCAN *OpenDomainScan(SUBGROUPMODEL *model, REAL threshold);
+BOOL    DomainScan(DOMSCAN *dom, char *sequence);
+BOOL    WriteDomainScan(FILE *fp, char *id, int chainNum, DOMSCAN *dom,
+                        BOOL header);
+void    CloseDomainScan(DOMSCAN *dom);
+
+#endif
@@ -0,0 +1,860 @@
+/*************************************************************************
+
+   Program:    hsubgroup
+   File:       filepool.c
+
+   Version:    V3.25
+   Date:       18.10.26
+   Function:   Process many input files on a pool of threads
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Many-files mode. Instruments write lots of small files, and starting
+   a process for each one means loading the model each time. Here the
+   model is loaded once and then each worker thread repeatedly takes
+   the next file from a queue, reads it with its own SEQREADER and
+   scores the chains. Files can be queued while the workers are running
+   (as in --watch mode). The model is only read once it has been loaded,
+   so no locking is needed while scoring.
+
+   By default each input gets its own output file named after it (with
+   a suffix for the format) either alongside it or in an output
+   directory. Alternatively all results go to one combined output with
+   each record tagged with its input file name. Workers collect results
+   in batches of RESULTBATCH chains and take a lock to write each batch,
+   so records from different files are interleaved in batches.
+
+   Each worker has its own RUNSTATS which are merged when it finishes.
+   For --summary each worker adds the chains to its own SUMMARY instead
+   of writing them and these are merged in the same way.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V3.10 18.10.26   Original
+   V3.11 18.10.26   Files are taken from a queue that can be added to
+                    while the pool runs. Inputs can be moved to done
+                    and failed directories
+   V3.20 18.10.26   Worker statistics are sized for the model
+   V3.24 18.10.26   Workers can add to a summary instead of writing
+   V3.25 18.10.26   Moved file names are built with snprintf()
+
+*************************************************************************/
+/* Includes
+*/
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "bioplib/MathType.h"
+#include "bioplib/SysDefs.h"
+#include "subgroup.h"
+#include "output.h"
+#include "stats.h"
+#include "summary.h"
+#include "seqio.h"
+#include "filepool.h"
+#include "probes.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXSEQ 8
+
+/* A worker thread with its statistics and a batch of results waiting
+   to be written to a combined output
+*/
+typedef struct
+{
+   FILEPOOL       *pool;
+   pthread_t      thread;
+   RUNSTATS       stats;
+   SUMMARY        summary;
+   int            nBatch,
+                  chainNums[RESULTBATCH];
+   char           ids[RESULTBATCH][MAXSEQID];
+   SUBGROUPRESULT results[RESULTBATCH];
+}  POOLWORKER;
+
+/* State shared between the workers. Files are taken from the queue in
+   order; a worker owns the name once it has taken it
+*/
+struct filepool
+{
+   POOLOPTIONS     *opts;
+   OUTWRITER       *combined;  /* NULL for one output per input         */
+   FILE            *out;
+   POOLWORKER      *workers;
+   FILELIST        queue;
+   pthread_mutex_t lock;       /* Protects queue, next, closed, nFailed
+                                  and combined                          */
+   pthread_cond_t  ready;      /* A file was queued or the queue closed */
+   int             next,
+                   nFailed,
+                   nWorkers,
+                   format,
+                   topK;
+   BOOL            verbose,
+                   doStats,
+                   closed;
+};
+
+/************************************************************************/
+/* Prototypes
+*/
+static void *Worker(void *arg);
+static BOOL ProcessFile(POOLWORKER *worker, char *inFile, int order);
+static BOOL FlushBatch(POOLWORKER *worker, char *tag);
+static BOOL MoveToDirectory(char *file, char *dir);
+
+
+/************************************************************************/
+/*>void InitPoolOptions(POOLOPTIONS *opts)
+   ---------------------------------------
+*//**
+   \param[out]  opts    Many-files options
+
+   Sets the defaults - not active and one thread per CPU
+
+-  18.10.26 Original   By: ACRM
+*/
+void InitPoolOptions(POOLOPTIONS *opts)
+{
+   opts->inputs.names    = NULL;
+   opts->inputs.nNames   = 0;
+   opts->inputs.maxNames = 0;
+   opts->listFile[0]     = '\0';
+   opts->outDir[0]       = '\0';
+   opts->combined[0]     = '\0';
+   opts->watchDir[0]     = '\0';
+   opts->doneDir[0]      = '\0';
+   opts->failedDir[0]    = '\0';
+   opts->summary         = NULL;
+   opts->nThreads        = 0;
+   opts->active          = FALSE;
+}
+
+
+/************************************************************************/
+/*>BOOL AddFileName(FILELIST *list, char *name)
+   --------------------------------------------
+*//**
+   \param[in,out] list    File list
+   \param[in]     name    File name to add (copied)
+   \return                Success (FALSE if no memory)
+
+-  18.10.26 Original   By: ACRM
+*/
+BOOL AddFileName(FILELIST *list, char *name)
+{
+   char *copy;
+   
+   if(list->nNames >= list->maxNames)
+   {
+      char **names;
+      int  maxNames = 2 * list->maxNames + 64;
+
+      if((names = (char **)realloc(list->names,
+                                   maxNames * sizeof(char *)))==NULL)
+         return(FALSE);
+      list->names    = names;
+      list->maxNames = maxNames;
+   }
+   if((copy = (char *)malloc(strlen(name)+1))==NULL)
+      return(FALSE);
+   strcpy(copy, name);
+   list->names[list->nNames++] = copy;
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>BOOL ReadFileList(FILELIST *list, char *listFile)
+   -------------------------------------------------
+*//**
+   \param[in,out] list      File list
+   \param[in]     listFile  File of file names, one per line ("-" for
+                            standard input)
+   \return                  Success
+
+   Adds the file names from a file. Blank lines and lines starting
+   with '#' are skipped, as is white space at the end of a line.
+
+-  18.10.26 Original   By: ACRM
+*/
+BOOL ReadFileList(FILELIST *list, char *listFile)
+{
+   FILE *fp = stdin;
+   char line[MAXBUFF];
+   BOOL ok  = TRUE;
+
+   if(strcmp(listFile, "-") && ((fp = fopen(listFile, "r"))==NULL))
+      return(FALSE);
+
+   while(ok && fgets(line, MAXBUFF, fp))
+   {
+      int len = strlen(line);
+
+      while(len && isspace((int)line[len-1]))
+         line[--len] = '\0';
+      if(len && (line[0] != '#'))
+         ok = AddFileName(list, line);
+   }
+
+   if(fp != stdin)
+      fclose(fp);
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>void FreeFileList(FILELIST *list)
+   ---------------------------------
+*//**
+   \param[in,out] list    File list to empty
+
+-  18.10.26 Original   By: ACRM
+*/
+void FreeFileList(FILELIST *list)
+{
+   int i;
+
+   for(i=0; i<list->nNames; i++)
+      free(list->names[i]);
+   free(list->names);
+   list->names    = NULL;
+   list->nNames   = 0;
+   list->maxNames = 0;
+}
+
+
+/************************************************************************/
+/*>int DefaultThreads(void)
+   ------------------------
+*//**
+   \return    Number of online CPUs (1 if not known)
+
+-  18.10.26 Original   By: ACRM
+*/
+int DefaultThreads(void)
+{
+   long nCPUs = sysconf(_SC_NPROCESSORS_ONLN);
+
+   if(nCPUs < 1)
+      return(1);
+   if(nCPUs > MAXTHREADS)
+      return(MAXTHREADS);
+   return((int)nCPUs);
+}
+
+
+/************************************************************************/
+/*>void OutputFileName(char *inFile, char *outDir, int format,
+                       char *outFile)
+   ----------------------------------------------------------
+*//**
+   \param[in]   inFile    Input file name
+   \param[in]   outDir    Output directory (blank for alongside the
+                          input)
+   \param[in]   format    OUTFORMAT_ value
+   \param[out]  outFile   Output file name (MAXBUFF characters)
+
+   The output is named after the input with .hsg, .tsv, .jsonl or .hsgb
+   added
+
+-  18.10.26 Original   By: ACRM
+*/
+void OutputFileName(char *inFile, char *outDir, int format,
+                    char *outFile)
+{
+   char *suffix,
+        *base;
+
+   switch(format)
+   {
+   case OUTFORMAT_TSV:
+      suffix = ".tsv";
+      break;
+   case OUTFORMAT_JSON:
+      suffix = ".jsonl";
+      break;
+   case OUTFORMAT_BINARY:
+      suffix = ".hsgb";
+      break;
+   default:
+      suffix = ".hsg";
+      break;
+   }
+
+   if(outDir[0])
+   {
+      base = strrchr(inFile, '/');
+      base = (base == NULL) ? inFile : base+1;
+      if(strlen(outDir) + strlen(base) + strlen(suffix) + 2 > MAXBUFF)
+         outFile[0] = '\0';
+      else
+         sprintf(outFile, "%s/%s%s", outDir, base, suffix);
+   }
+   else
+   {
+      if(strlen(inFile) + strlen(suffix) + 1 > MAXBUFF)
+         outFile[0] = '\0';
+      else
+         sprintf(outFile, "%s%s", inFile, suffix);
+   }
+}
+
+
+/************************************************************************/
+/*>int ProcessFiles(POOLOPTIONS *opts, int format, BOOL verbose,
+                    int topK, BOOL doStats, RUNSTATS *stats)
+   -------------------------------------------------------------
+*//**
+   \param[in]     opts      Many-files options with the input files
+   \param[in]     format    OUTFORMAT_ value
+   \param[in]     verbose   Verbose text output
+   \param[in]     topK      Number of subgroups ranked
+   \param[in]     doStats   Collect statistics
+   \param[in,out] stats     Statistics from the workers are added here
+   \return                  Number of files that failed (-1 if the
+                            pool could not be started or the combined
+                            output could not be written)
+
+   Processes all the input files. The model must already be loaded.
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Uses the file queue
+*/
+int ProcessFiles(POOLOPTIONS *opts, int format, BOOL verbose, int topK,
+                 BOOL doStats, RUNSTATS *stats)
+{
+   FILEPOOL *pool;
+   int      nThreads = opts->nThreads,
+            i;
+
+   if(nThreads > opts->inputs.nNames)
+      nThreads = opts->inputs.nNames;
+
+   if((pool = StartFilePool(opts, format, verbose, topK, doStats,
+                            nThreads))==NULL)
+      return(-1);
+   
+   for(i=0; i<opts->inputs.nNames; i++)
+   {
+      if(!QueueFile(pool, opts->inputs.names[i]))
+      {
+         fprintf(stderr, "hsubgroup Error: No memory to queue %s\n",
+                 opts->inputs.names[i]);
+         break;
+      }
+   }
+
+   return(FinishFilePool(pool, stats));
+}
+
+
+/************************************************************************/
+/*>FILEPOOL *StartFilePool(POOLOPTIONS *opts, int format, BOOL verbose,
+                           int topK, BOOL doStats, int nThreads)
+   ---------------------------------------------------------------------
+*//**
+   \param[in]   opts      Many-files options (output directory,
+                          combined output and done/failed directories)
+   \param[in]   format    OUTFORMAT_ value
+   \param[in]   verbose   Verbose text output
+   \param[in]   topK      Number of subgroups ranked
+   \param[in]   doStats   Collect statistics
+   \param[in]   nThreads  Number of worker threads
+   \return                The pool (NULL on failure)
+
+   Opens any combined output and starts the workers. They wait for
+   files to be given with QueueFile().
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Worker statistics are sized for the model
+-  18.10.26 Workers have their own summary
+*/
+FILEPOOL *StartFilePool(POOLOPTIONS *opts, int format, BOOL verbose,
+                        int topK, BOOL doStats, int nThreads)
+{
+   FILEPOOL *pool;
+   int      i;
+
+   if(nThreads < 1)
+      nThreads = 1;
+
+   if((pool = (FILEPOOL *)malloc(sizeof(FILEPOOL)))==NULL)
+   {
+      fprintf(stderr, "hsubgroup Error: No memory for workers\n");
+      return(NULL);
+   }
+   if((pool->workers = (POOLWORKER *)malloc(nThreads *
+                                            sizeof(POOLWORKER)))==NULL)
+   {
+      fprintf(stderr, "hsubgroup Error: No memory for workers\n");
+      free(pool);
+      return(NULL);
+   }
+
+   pool->opts           = opts;
+   pool->combined       = NULL;
+   pool->out            = NULL;
+   pool->queue.names    = NULL;
+   pool->queue.nNames   = 0;
+   pool->queue.maxNames = 0;
+   pool->next           = 0;
+   pool->nFailed        = 0;
+   pool->nWorkers       = 0;
+   pool->format         = format;
+   pool->topK           = topK;
+   pool->verbose        = verbose;
+   pool->doStats        = doStats;
+   pool->closed         = FALSE;
+   
+   if(opts->combined[0])
+   {
+      if(((pool->out = fopen(opts->combined, "w"))==NULL) ||
+         ((pool->combined = OpenOutputWriter(pool->out, format, verbose,
+                                             topK))==NULL))
+      {
+         fprintf(stderr, "hsubgroup Error: Unable to open output file \
+(%s)\n", opts->combined);
+         if(pool->out != NULL)
+            fclose(pool->out);
+         free(pool->workers);
+         free(pool);
+         return(NULL);
+      }
+   }
+
+   pthread_mutex_init(&(pool->lock), NULL);
+   pthread_cond_init(&(pool->ready), NULL);
+   for(i=0; i<nThreads; i++)
+   {
+      POOLWORKER *worker = &(pool->workers[pool->nWorkers]);
+
+      worker->pool   = pool;
+      worker->nBatch = 0;
+      if(!InitRunStats(&(worker->stats), GetSubgroupCount()))
+         break;
+      if((opts->summary != NULL) &&
+         !InitSummary(&(worker->summary), GetSubgroupCount()))
+      {
+         FreeRunStats(&(worker->stats));
+         break;
+      }
+      if(pthread_create(&(worker->thread), NULL, Worker, worker))
+      {
+         FreeRunStats(&(worker->stats));
+         if(opts->summary != NULL)
+            FreeSummary(&(worker->summary));
+         break;
+      }
+      pool->nWorkers++;
+   }
+
+   if(pool->nWorkers == 0)
+   {
+      fprintf(stderr, "hsubgroup Error: Unable to start worker \
+threads\n");
+      if(pool->combined != NULL)
+      {
+         CloseOutputWriter(pool->combined);
+         fclose(pool->out);
+      }
+      pthread_cond_destroy(&(pool->ready));
+      pthread_mutex_destroy(&(pool->lock));
+      free(pool->workers);
+      free(pool);
+      return(NULL);
+   }
+   
+   return(pool);
+}
+
+
+/************************************************************************/
+/*>BOOL QueueFile(FILEPOOL *pool, char *name)
+   ------------------------------------------
+*//**
+   \param[in,out] pool    The pool
+   \param[in]     name    Input file (copied)
+   \return                Success (FALSE if no memory)
+
+   Adds a file to the queue and wakes a worker
+
+-  18.10.26 Original   By: ACRM
+*/
+BOOL QueueFile(FILEPOOL *pool, char *name)
+{
+   BOOL ok;
+   
+   pthread_mutex_lock(&(pool->lock));
+   ok = AddFileName(&(pool->queue), name);
+   pthread_cond_signal(&(pool->ready));
+   pthread_mutex_unlock(&(pool->lock));
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>int FinishFilePool(FILEPOOL *pool, RUNSTATS *stats)
+   ---------------------------------------------------
+*//**
+   \param[in]     pool    The pool (freed)
+   \param[in,out] stats   Statistics from the workers are added here
+   \return                Number of files that failed (-1 if the
+                          combined output could not be written)
+
+   Waits for the workers to finish everything that has been queued,
+   then closes any combined output and frees the pool. Worker summaries
+   are added to the summary in the options.
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Frees the worker statistics
+-  18.10.26 Merges the worker summaries
+*/
+int FinishFilePool(FILEPOOL *pool, RUNSTATS *stats)
+{
+   int i,
+       nFailed;
+   
+   pthread_mutex_lock(&(pool->lock));
+   pool->closed = TRUE;
+   pthread_cond_broadcast(&(pool->ready));
+   pthread_mutex_unlock(&(pool->lock));
+
+   for(i=0; i<pool->nWorkers; i++)
+   {
+      pthread_join(pool->workers[i].thread, NULL);
+      MergeRunStats(stats, &(pool->workers[i].stats));
+      FreeRunStats(&(pool->workers[i].stats));
+   }
+   nFailed = pool->nFailed;
+
+   for(i=0; (pool->opts->summary != NULL) && (i<pool->nWorkers); i++)
+   {
+      if(!MergeSummary(pool->opts->summary, &(pool->workers[i].summary)))
+      {
+         fprintf(stderr, "hsubgroup Error: No memory for summary\n");
+         nFailed = -1;
+      }
+      FreeSummary(&(pool->workers[i].summary));
+   }
+
+   if(pool->combined != NULL)
+   {
+      if(!CloseOutputWriter(pool->combined) || fclose(pool->out))
+      {
+         fprintf(stderr, "hsubgroup Error: Unable to write output \
+file (%s)\n", pool->opts->combined);
+         nFailed = -1;
+      }
+   }
+   
+   pthread_cond_destroy(&(pool->ready));
+   pthread_mutex_destroy(&(pool->lock));
+   FreeFileList(&(pool->queue));
+   free(pool->workers);
+   free(pool);
+   
+   return(nFailed);
+}
+
+
+/************************************************************************/
+/*>static void *Worker(void *arg)
+   ------------------------------
+*//**
+   \param[in]   arg     The POOLWORKER
+   \return              NULL
+
+   Thread function. Takes files from the queue, waiting for more when
+   it is empty, until the queue is closed and empty. If done and
+   failed directories are set, each input is moved to one of them
+   afterwards. A file that has gone (already processed after being
+   seen twice) is skipped.
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Waits on the queue and moves processed files
+*/
+static void *Worker(void *arg)
+{
+   POOLWORKER *worker = (POOLWORKER *)arg;
+   FILEPOOL   *pool   = worker->pool;
+   char       *name;
+   int        order;
+   BOOL       ok,
+              moveFiles = (pool->opts->doneDir[0] != '\0');
+
+   for(;;)
+   {
+      pthread_mutex_lock(&(pool->lock));
+      while((pool->next >= pool->queue.nNames) && !pool->closed)
+         pthread_cond_wait(&(pool->ready), &(pool->lock));
+      if(pool->next >= pool->queue.nNames)
+      {
+         pthread_mutex_unlock(&(pool->lock));
+         break;
+      }
+      order = pool->next;
+      name  = pool->queue.names[pool->next];
+      pool->queue.names[pool->next++] = NULL;
+      pthread_mutex_unlock(&(pool->lock));
+
+      if(moveFiles && access(name, F_OK))
+      {
+         free(name);
+         continue;
+      }
+      
+      ok = ProcessFile(worker, name, order);
+      if(moveFiles &&
+         !MoveToDirectory(name, ok ? pool->opts->doneDir :
+                                     pool->opts->failedDir))
+      {
+         fprintf(stderr, "hsubgroup Error: Unable to move %s\n", name);
+         ok = FALSE;
+      }
+      
+      if(!ok)
+      {
+         pthread_mutex_lock(&(pool->lock));
+         pool->nFailed++;
+         pthread_mutex_unlock(&(pool->lock));
+      }
+      free(name);
+   }
+   return(NULL);
+}
+
+
+/************************************************************************/
+/*>static BOOL MoveToDirectory(char *file, char *dir)
+   --------------------------------------------------
+*//**
+   \param[in]   file    File to move
+   \param[in]   dir     Directory on the same file system
+   \return              Success (FALSE if the new name is too long)
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 snprintf() to catch a name that is too long
+*/
+static BOOL MoveToDirectory(char *file, char *dir)
+{
+   char newName[MAXBUFF],
+        *base;
+   int  length;
+
+   base = strrchr(file, '/');
+   base = (base == NULL) ? file : base+1;
+   length = snprintf(newName, MAXBUFF, "%s/%s", dir, base);
+   if((length < 0) || (length >= MAXBUFF))
+      return(FALSE);
+   return(rename(file, newName) == 0);
+}
+
+
+/************************************************************************/
+/*>static BOOL ProcessFile(POOLWORKER *worker, char *inFile, int order)
+   --------------------------------------------------------------------
+*//**
+   \param[in,out] worker   The worker
+   \param[in]     inFile   Input file
+   \param[in]     order    Position of the file in the queue
+   \return                 Success
+
+   Scores all the chains in one file writing to its own output,
+   adding them to the worker's batch for the combined output or adding
+   them to the worker's summary
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Adds to the summary
+*/
+static BOOL ProcessFile(POOLWORKER *worker, char *inFile, int order)
+{
+   FILEPOOL  *pool   = worker->pool;
+   FILE      *in,
+             *out    = NULL;
+   SEQREADER *reader;
+   OUTWRITER *writer = NULL;
+   char      outFile[MAXBUFF],
+             id[MAXSEQID],
+             *seqs[MAXSEQ];
+   int       nchain, i;
+   REAL      mark    = 0.0;
+   BOOL      ok      = TRUE;
+
+   if((in = fopen(inFile, "r"))==NULL)
+   {
+      fprintf(stderr, "hsubgroup Error: Unable to open input file \
+(%s)\n", inFile);
+      return(FALSE);
+   }
+   if((reader = OpenSeqReader(in, 0, -1))==NULL)
+   {
+      fprintf(stderr, "hsubgroup Error: No memory to read %s\n", inFile);
+      fclose(in);
+      return(FALSE);
+   }
+
+   if(pool->opts->summary != NULL)
+   {
+      if(!StartSummaryFile(&(worker->summary), inFile, order))
+      {
+         fprintf(stderr, "hsubgroup Error: No memory for summary of \
+%s\n", inFile);
+         CloseSeqReader(reader);
+         fclose(in);
+         return(FALSE);
+      }
+   }
+   else if(pool->combined == NULL)
+   {
+      OutputFileName(inFile, pool->opts->outDir, pool->format, outFile);
+      if(!outFile[0]                                          ||
+         ((out = fopen(outFile, "w"))==NULL)                  ||
+         ((writer = OpenOutputWriter(out, pool->format, pool->verbose,
+                                     pool->topK))==NULL))
+      {
+         fprintf(stderr, "hsubgroup Error: Unable to open output file \
+for %s\n", inFile);
+         if(out != NULL)
+            fclose(out);
+         CloseSeqReader(reader);
+         fclose(in);
+         return(FALSE);
+      }
+   }
+
+   if(pool->doStats)
+      mark = StatsTime();
+   
+   while(ok && ((nchain = ReadSeqEntry(reader, seqs, MAXSEQ, id)) >= 0))
+   {
+      if(pool->doStats)
+         worker->stats.parseTime += StatsLap(&mark);
+      PROBE2(batch_start, id, nchain);
+      
+      for(i=0; i<nchain; i++)
+      {
+         SUBGROUPRESULT *result = &(worker->results[worker->nBatch]);
+
+         /* The model is already loaded                                 */
+         FindHumanSubgroupResult(NULL, FALSE, seqs[i], result);
+         free(seqs[i]);
+         if(pool->doStats)
+            AddChainStats(&(worker->stats), result, StatsLap(&mark));
+
+         if(pool->opts->summary != NULL)
+         {
+            AddSummaryChain(&(worker->summary), result);
+         }
+         else if(writer != NULL)
+         {
+            ok = ok && WriteResult(writer, id, i+1, result);
+         }
+         else
+         {
+            strcpy(worker->ids[worker->nBatch], id);
+            worker->chainNums[worker->nBatch] = i+1;
+            if(++(worker->nBatch) == RESULTBATCH)
+            {
+               ok = ok && FlushBatch(worker, inFile);
+               worker->nBatch = 0;
+            }
+         }
+         
+         if(pool->doStats)
+            worker->stats.outputTime += StatsLap(&mark);
+      }
+      PROBE2(batch_end, id, nchain);
+   }
+   CloseSeqReader(reader);
+   fclose(in);
+
+   if(writer != NULL)
+   {
+      if(!CloseOutputWriter(writer))
+         ok = FALSE;
+      if(fclose(out))
+         ok = FALSE;
+   }
+   else if(worker->nBatch)
+   {
+      ok = ok && FlushBatch(worker, inFile);
+      worker->nBatch = 0;
+   }
+   
+   if(!ok)
+      fprintf(stderr, "hsubgroup Error: Unable to write output for %s\n",
+              inFile);
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>static BOOL FlushBatch(POOLWORKER *worker, char *tag)
+   -----------------------------------------------------
+*//**
+   \param[in,out] worker   The worker
+   \param[in]     tag      Input file name to tag the records with
+   \return                 Success
+
+   Writes the worker's batch of results to the combined output
+
+-  18.10.26 Original   By: ACRM
+*/
+static BOOL FlushBatch(POOLWORKER *worker, char *tag)
+{
+   FILEPOOL *pool = worker->pool;
+   BOOL     ok    = TRUE;
+   int      i;
+
+   pthread_mutex_lock(&(pool->lock));
+   SetOutputTag(pool->combined, tag);
+   for(i=0; ok && (i<worker->nBatch); i++)
+   {
+      ok = WriteResult(pool->combined, worker->ids[i],
+                       worker->chainNums[i], &(worker->results[i]));
+   }
+   pthread_mutex_unlock(&(pool->lock));
+
+   worker->nBatch = 0;
+   return(ok);
+}
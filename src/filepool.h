@@ -0,0 +1,112 @@
+/*************************************************************************
+
+   Program:    hsubgroup
+   File:       filepool.h
+
+   Version:    V3.24
+   Date:       18.10.26
+   Function:   Process many input files on a pool of threads
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Many-files mode. The model is loaded once and the input files are
+   shared out between worker threads.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V3.10 18.10.26   Original
+   V3.11 18.10.26   Added the file queue and watch directory
+   V3.24 18.10.26   Added the summary
+
+*************************************************************************/
+#ifndef _FILEPOOL_H
+#define _FILEPOOL_H
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXTHREADS          256
+#define RESULTBATCH         256  /* Chains written to a combined output
+                                    in one go                           */
+
+/* A growable list of file names                                        */
+typedef struct
+{
+   char **names;
+   int  nNames,
+        maxNames;
+}  FILELIST;
+
+/* Many-files mode options. active is set if any of them are used or
+   more than two files are given
+*/
+typedef struct
+{
+   FILELIST inputs;
+   char     listFile[MAXBUFF],
+            outDir[MAXBUFF],
+            combined[MAXBUFF],
+            watchDir[MAXBUFF],
+            doneDir[MAXBUFF],     /* Inputs are moved here and to      */
+            failedDir[MAXBUFF];   /* here if set                       */
+   SUMMARY  *summary;             /* Chains are added to this instead
+                                     of being written (NULL for none)  */
+   int      nThreads;
+   BOOL     active;
+}  POOLOPTIONS;
+
+/* A running pool of workers (defined in filepool.c)                    */
+typedef struct filepool FILEPOOL;
+
+
+/************************************************************************/
+/* Prototypes
+*/
+void InitPoolOptions(POOLOPTIONS *opts);
+BOOL AddFileName(FILELIST *list, char *name);
+BOOL ReadFileList(FILELIST *list, char *listFile);
+void FreeFileList(FILELIST *list);
+int  DefaultThreads(void);
+void OutputFileName(char *inFile, char *outDir, int format,
+                    char *outFile);
+int  ProcessFiles(POOLOPTIONS *opts, int format, BOOL verbose, int topK,
+                  BOOL doStats, RUNSTATS *stats);
+FILEPOOL *StartFilePool(POOLOPTIONS *opts, int format, BOOL verbose,
+                        int topK, BOOL doStats, int nThreads);
+BOOL QueueFile(FILEPOOL *pool, char *name);
+int  FinishFilePool(FILEPOOL *pool, RUNSTATS *stats);
+
+#endif
@@ -53,11 +53,18 @@
    V2.3  05.02.19   Added info to verbose output on the second best match
    V3.0  12.02.19   Added support for full matrices
    V3.2  05.04.19   Zero the counter of the number of subtypes
+   V3.19 18.10.26   Matrices may have any number of positions and are
+                    held in allocated memory
+   V3.20 18.10.26   Any number of entries in an array that grows as they
+                    are read
+   V3.26 18.10.26   Removed CalcFullScore() which the profile table
+                    replaced
 
 *************************************************************************/
 /* Includes
 */
 #include <stdio.h>
+#include <stdlib.h>
 #include <ctype.h>
 #include <math.h>
 #include "bioplib/general.h"
@@ -75,55 +82,71 @@
 /* Prototypes
 */
 static void PopulateTopScores(FMSUBGROUPINFO *subGroupInfo);
+static int  CountValues(char *buffer);
+static void fmDiscardSubgroups(FMSUBGROUPINFO *fullMatrix,
+                               int nSubGroups);
 
 /************************************************************************/
-/*>int ReadFullMatrix(FILE *fp, FMSUBGROUPINFO *fullMatrix)
-   --------------------------------------------------------
+/*>int ReadFullMatrix(FILE *fp, FMSUBGROUPINFO **pFullMatrix)
+   -----------------------------------------------------------
 *//**
-   \param[in]   *fp          File pointer for matrix file
-   \param[out]  *fullMatrix  The populated matrix
-   \return                   The number of matrix entries
-
-   Reads a full-matrix representation of residue frequencies
+   \param[in]   *fp           File pointer for matrix file
+   \param[out]  **pFullMatrix The populated matrix in an array
+                              allocated for the number of entries
+                              (NULL if none)
+   \return                    The number of matrix entries (0 for an
+                              error or no memory)
+
+   Reads a full-matrix representation of residue frequencies. The
+   first row of the first entry gives the number of positions and every
+   row of every entry must have that many. Residues without a row
+   score zero.
 
 -  12.02.19 Original   By: ACRM
 -  05.04.19 Reset entryCount after zeroing the matrix
+-  18.10.26 Any number of positions in allocated memory and lines of
+            any length
+-  18.10.26 Any number of entries
 */
-int ReadFullMatrix(FILE *fp, FMSUBGROUPINFO *fullMatrix)
+int ReadFullMatrix(FILE *fp, FMSUBGROUPINFO **pFullMatrix)
 {
-   char       buffer[MAXBUFF],
-              *chp;
-   int        entryCount = 0;
-   BOOL       inData     = FALSE;
+   char           *buffer,
+                  *chp;
+   int            entryCount = 0,
+                  nAlloc     = 0,
+                  length     = 0;
+   BOOL           inData     = FALSE,
+                  allocated  = FALSE;
+   FMSUBGROUPINFO *fullMatrix = NULL,
+                  *grown;
    
+   *pFullMatrix = NULL;
 
-   for(entryCount=0; entryCount<MAXSUBTYPES; entryCount++)
-   {
-      int i, j;
-      for(i=0; i<MAXREFSEQLEN; i++)
-      {
-         for(j=0; j<26; j++)
-         {
-            fullMatrix[entryCount].scores[i][j] = 0.0;
-         }
-         fullMatrix[entryCount].topScores[i] = 0.0;
-      }
-   }
-
-   entryCount = 0;
-   while(fgets(buffer, MAXBUFF, fp))
+   while((buffer = blFgetsany(fp)) != NULL)
    {
       if(buffer[0] == '#')
       {
-         continue; /* Skip comment lines */
+         /* Skip comment lines */
       }
       else if(buffer[0] == '>')
       {
-         if(entryCount >= MAXSUBTYPES)
+         /* Drop an entry that was never finished                       */
+         if(allocated)
+            fmFreeSubgroupData(&(fullMatrix[entryCount]), 1);
+         allocated = FALSE;
+
+         if(entryCount >= nAlloc)
          {
-            fprintf(stderr,"Error: too many subtypes in data file. \
-Increase MAXSUBTYPES\n");
-            exit(1);
+            nAlloc = (nAlloc ? (2 * nAlloc) : SUBGROUPALLOC);
+            if((grown = (FMSUBGROUPINFO *)
+                realloc(fullMatrix,
+                        nAlloc * sizeof(FMSUBGROUPINFO)))==NULL)
+            {
+               free(buffer);
+               fmDiscardSubgroups(fullMatrix, entryCount);
+               return(0);
+            }
+            fullMatrix = grown;
          }
          
          inData = TRUE;
@@ -144,6 +167,8 @@ Increase MAXSUBTYPES\n");
             fullMatrix[entryCount].chainType = CHAINTYPE_HEAVY;
             break;
          default:
+            free(buffer);
+            fmDiscardSubgroups(fullMatrix, entryCount);
             return(0);
          }
          
@@ -152,34 +177,196 @@ Increase MAXSUBTYPES\n");
       {
          chp = buffer+1;
          TERMAT(chp, '"');
-         strncpy(fullMatrix[entryCount].name, chp, MAXBUFF);
+         strncpy(fullMatrix[entryCount].name, chp, MAXBUFF-1);
+         fullMatrix[entryCount].name[MAXBUFF-1] = '\0';
       }
       else if ((buffer[0] == '/') && (buffer[1] == '/'))
       {
-         PopulateTopScores(&(fullMatrix[entryCount]));
-
-         entryCount++;
-         inData = FALSE;
+         if(allocated)
+         {
+            PopulateTopScores(&(fullMatrix[entryCount]));
+            entryCount++;
+         }
+         inData    = FALSE;
+         allocated = FALSE;
       }
-      else if (inData)
+      else if (inData && isupper(buffer[0]))
       {
          char aa    = buffer[0];
          int  aaidx = ILETTER(aa);
          char word[MAXWORD];
          int  valCount = 0;
          
-         chp        = buffer+2;
-         while((chp = blGetWord(chp, word, MAXWORD))!=NULL)
+         TERMINATE(buffer);
+         TERMAT(buffer, '\r');
+         KILLTRAILSPACES(buffer);
+         chp        = buffer+1;
+
+         /* The first row gives the number of positions                 */
+         if(!allocated)
+         {
+            if(entryCount == 0)
+               length = CountValues(chp);
+            if((length == 0) ||
+               !fmAllocSubgroupInfo(&(fullMatrix[entryCount]), length))
+            {
+               free(buffer);
+               fmDiscardSubgroups(fullMatrix, entryCount);
+               return(0);
+            }
+            allocated = TRUE;
+         }
+
+         do
+         {
+            chp = blGetWord(chp, word, MAXWORD);
+            if(word[0])
+            {
+               if(valCount < length)
+                  fullMatrix[entryCount].scores[valCount][aaidx] =
+                     atof(word);
+               valCount++;
+            }
+         }  while(chp != NULL);
+
+         if(valCount != length)
          {
-            fullMatrix[entryCount].scores[valCount++][aaidx] = atof(word);
+            fprintf(stderr,"Error: %s %d has %d positions for %c \
+instead of %d\n",
+                    fullMatrix[entryCount].type,
+                    fullMatrix[entryCount].index, valCount, aa, length);
+            free(buffer);
+            fmDiscardSubgroups(fullMatrix, entryCount+1);
+            return(0);
          }
       }
+      free(buffer);
    }
 
+   /* Drop an entry that was never finished                             */
+   if(allocated)
+      fmFreeSubgroupData(&(fullMatrix[entryCount]), 1);
+
+   if(entryCount == 0)
+   {
+      fmDiscardSubgroups(fullMatrix, 0);
+      return(0);
+   }
+
+   /* Give back the unused space                                        */
+   if((grown = (FMSUBGROUPINFO *)
+       realloc(fullMatrix, entryCount * sizeof(FMSUBGROUPINFO)))!=NULL)
+      fullMatrix = grown;
+   *pFullMatrix = fullMatrix;
    return(entryCount);
 }
 
 
+/************************************************************************/
+/*>static void fmDiscardSubgroups(FMSUBGROUPINFO *fullMatrix,
+                                  int nSubGroups)
+   ----------------------------------------------------------
+*//**
+   \param[in]   *fullMatrix   Allocated array of entries (may be NULL)
+   \param[in]   nSubGroups    Number of them with allocated data
+
+   Frees the data of each entry and the array
+
+-  18.10.26 Original   By: ACRM
+*/
+static void fmDiscardSubgroups(FMSUBGROUPINFO *fullMatrix,
+                               int nSubGroups)
+{
+   if(fullMatrix != NULL)
+   {
+      fmFreeSubgroupData(fullMatrix, nSubGroups);
+      free(fullMatrix);
+   }
+}
+
+
+/************************************************************************/
+/*>static int CountValues(char *buffer)
+   ------------------------------------
+*//**
+   \param[in]   *buffer   Values separated by white space with no
+                          trailing space
+   \return                Number of values
+
+-  18.10.26 Original   By: ACRM
+*/
+static int CountValues(char *buffer)
+{
+   char word[MAXWORD];
+   int  nValues = 0;
+
+   do
+   {
+      buffer = blGetWord(buffer, word, MAXWORD);
+      if(word[0])
+         nValues++;
+   }  while(buffer != NULL);
+
+   return(nValues);
+}
+
+
+/************************************************************************/
+/*>BOOL fmAllocSubgroupInfo(FMSUBGROUPINFO *subGroupInfo, int length)
+   ------------------------------------------------------------------
+*//**
+   \param[out]  *subGroupInfo  Full matrix information for a subgroup
+   \param[in]   length         Number of positions
+   \return                     Success (FALSE if no memory, when the
+                               arrays are left NULL)
+
+   Allocates the arrays for a subgroup with zero scores
+
+-  18.10.26 Original   By: ACRM
+*/
+BOOL fmAllocSubgroupInfo(FMSUBGROUPINFO *subGroupInfo, int length)
+{
+   subGroupInfo->length    = length;
+   subGroupInfo->scores    = (REAL (*)[26])calloc(length,
+                                                  26 * sizeof(REAL));
+   subGroupInfo->topScores = (REAL *)calloc(length, sizeof(REAL));
+
+   if((subGroupInfo->scores == NULL) || (subGroupInfo->topScores == NULL))
+   {
+      fmFreeSubgroupData(subGroupInfo, 1);
+      return(FALSE);
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void fmFreeSubgroupData(FMSUBGROUPINFO *subGroupInfo, int nSubGroups)
+   ---------------------------------------------------------------------
+*//**
+   \param[in,out] *subGroupInfo  Array of full matrix information
+   \param[in]     nSubGroups     Number of subgroups
+
+   Frees the arrays of each subgroup and sets them to NULL
+
+-  18.10.26 Original   By: ACRM
+*/
+void fmFreeSubgroupData(FMSUBGROUPINFO *subGroupInfo, int nSubGroups)
+{
+   int i;
+
+   for(i=0; i<nSubGroups; i++)
+   {
+      if(subGroupInfo[i].scores != NULL)
+         free(subGroupInfo[i].scores);
+      if(subGroupInfo[i].topScores != NULL)
+         free(subGroupInfo[i].topScores);
+      subGroupInfo[i].scores    = NULL;
+      subGroupInfo[i].topScores = NULL;
+   }
+}
+
+
 /************************************************************************/
 /*>static void PopulateTopScores(FMSUBGROUPINFO *subGroupInfo)
    -----------------------------------------------------------
@@ -196,7 +383,7 @@ static void PopulateTopScores(FMSUBGROUPINFO *subGroupInfo)
    REAL maxScore = 0.0;
    
 
-   for(posNum=0; posNum<MAXREFSEQLEN; posNum++)
+   for(posNum=0; posNum<subGroupInfo->length; posNum++)
    {
       maxScore = 0.0;
       
@@ -216,77 +403,13 @@ static void PopulateTopScores(FMSUBGROUPINFO *subGroupInfo)
 }
 
 
-/************************************************************************/
-/*>REAL CalcFullScore(FMSUBGROUPINFO subGroupInfo, char *sequence, 
-                      int offset, int offsetType, BOOL includeX)
-   ---------------------------------------------------------------
-*//**
-   \param[in]   subGroupInfo   The full matrix information for a subgroup
-   \param[in]   sequence       The sequence to test
-   \param[in]   offset         Offset into the sequence
-   \param[in]   offsetType     Truncation or extension
-   \param[in]   includeX       Include X characters in calculation
-   \return                     The score for this sequence
-
-   Calculates the score for a sequence against a sub group matrix
-
--  12.02.19 Original   By: ACRM
--  13.02.19 Added X checking
-*/
-REAL CalcFullScore(FMSUBGROUPINFO subGroupInfo, char *sequence,
-                   int offset, int offsetType, BOOL includeX)
-{
-   REAL score    = 0.0,
-        scoreMax = 0.0;
-   int i;
-   
-   if(offsetType == OFFSETTRUNCATION)
-   {
-      for(i = 0; i < (MAXREFSEQLEN-offset); i++) 
-      {
-         if((sequence[i] != 'X') || includeX)
-         {
-            score += subGroupInfo.scores[i+offset][ILETTER(sequence[i])];
-                                                
-            /* Calculate the best score we could get against the most 
-               common residues
-            */
-            scoreMax += subGroupInfo.topScores[i+offset];
-         }
-      }
-   }
-   else  /* OFFSETEXTENSION                                             */
-   {
-      /* Return score of zero if we don't have enough residues in the
-         test sequence
-      */
-      if(strlen(sequence) < (MAXREFSEQLEN + offset))
-         return(0.0);
-      
-      for(i = 0; i < MAXREFSEQLEN; i++) 
-      {
-         if((sequence[i+offset] != 'X') || includeX)
-         {
-            score += subGroupInfo.scores[i][ILETTER(sequence[i+offset])];
-         
-            /* Calculate the best score we could get against the most 
-               common residues
-            */
-            scoreMax += subGroupInfo.topScores[i];
-         }
-      }
-   }
-
-   return((score*100.0)/scoreMax);
-}
-
 /************************************************************************/
 void fmTakeLogs(FMSUBGROUPINFO *subGroupInfo, int nSubGroups)
 {
    int sgNum, i, j;
    for(sgNum=0; sgNum<nSubGroups; sgNum++)
    {
-      for(i=0; i<MAXREFSEQLEN; i++)
+      for(i=0; i<subGroupInfo[sgNum].length; i++)
       {
          for(j=0; j<26; j++)
          {
@@ -314,10 +437,10 @@ int main(int argc, char **argv)
    FILE *fp;
    if((fp=fopen("../data/human_full.dat", "r"))!=NULL)
    {
-      FMSUBGROUPINFO fullMatrix[MAXSUBTYPES];
+      FMSUBGROUPINFO *fullMatrix;
       int        nEntries, entryNum;
       
-      nEntries = ReadFullMatrix(fp, fullMatrix);
+      nEntries = ReadFullMatrix(fp, &fullMatrix);
       for(entryNum=0; entryNum<nEntries; entryNum++)
       {
          int aaNum, position;
@@ -333,7 +456,7 @@ int main(int argc, char **argv)
                (aaNum==ILETTER('X')) ||
                (aaNum==ILETTER('Z'))) continue;
                 fprintf(stdout, "%c", LETTER(aaNum));
-            for(position=0; position<MAXREFSEQLEN; position++)
+            for(position=0; position<fullMatrix[entryNum].length; position++)
             {
                fprintf(stdout, "%6.3f",
                        fullMatrix[entryNum].scores[position][aaNum]);
@@ -342,7 +465,7 @@ int main(int argc, char **argv)
          }
 
          fprintf(stdout, "Top Scores:\n ");
-         for(position=0; position<MAXREFSEQLEN; position++)
+         for(position=0; position<fullMatrix[entryNum].length; position++)
          {
             fprintf(stdout, "%6.3f",
                     fullMatrix[entryNum].topScores[position]);
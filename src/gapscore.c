@@ -0,0 +1,239 @@
+/*************************************************************************
+
+   Program:    hsubgroup
+   File:       gapscore.c
+
+   Version:    V3.18
+   Date:       18.10.26
+   Function:   Gapped scoring against the subgroup data
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Normal scoring slides the sequence along the reference positions
+   without gaps so a single insertion or deletion puts every later
+   residue out of register. Here the start of the sequence is aligned
+   to the reference positions allowing gaps with affine penalties: the
+   first residue of a gap costs gapOpen and each further one
+   gapExtend.
+
+   The alignment must run to the last reference position (deleting any
+   that the sequence doesn't reach) but may start anywhere a normal
+   offset does: at sequence position 0 against any truncation offset,
+   or at any extension offset against reference position 0. The
+   dynamic programming is done backwards from the end of the reference
+   so a single pass gives the best alignment from every start. It is
+   banded: only the diagonals the ungapped offsets use, widened by
+   MAXGAPBAND on each side, are filled in.
+
+   The normalized score is the alignment score (including the gap
+   penalties) as a percentage of the maximum for the reference
+   positions from the start, so gaps cost but deletions don't shrink
+   the maximum. An X is scored as a mismatch when it is aligned since
+   its reference position can't simply be dropped from the maximum as
+   it is in ungapped scoring.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V3.18 18.10.26   Original
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include "bioplib/MathType.h"
+#include "bioplib/SysDefs.h"
+#include "subgroup.h"
+
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define ILETTER(x) ((int)(x)-65)
+#define GAPNEG     (-1.0e30)                 /* Outside the band        */
+#define GAPLODIAG  (-(MAXTRUNCATION-1) - MAXGAPBAND)
+#define GAPHIDIAG  (MAXEXTENSION - 1 + MAXGAPBAND)
+#define GAPROWS    (MAXREFSEQLEN + GAPHIDIAG)/* Residues that can align */
+#define MAX3(a, b, c) (((a) > (b)) ? (((a) > (c)) ? (a) : (c)) :         \
+                                     (((b) > (c)) ? (b) : (c)))
+
+/************************************************************************/
+/* Prototypes
+*/
+static REAL ResidueScore(SUBGROUPMODEL *model, int sgNum, int refPos,
+                         char res);
+
+
+/************************************************************************/
+/*>REAL CalcGappedScore(SUBGROUPMODEL *model, int sgNum, char *sequence,
+                        int length, int *offset)
+   ---------------------------------------------------------------------
+*//**
+   \param[in]   model     - the model
+   \param[in]   sgNum     - the subgroup
+   \param[in]   sequence  - the sequence we are looking at
+   \param[in]   length    - length of the sequence
+   \param[out]  offset    - offset at which the best alignment starts
+                            (+ve truncation, -ve extension)
+   \return                - best normalized score of a gapped alignment
+
+   Calculates the score for the test sequence against a subgroup
+   allowing gaps. Returns 0.0 if no alignment scores more than that.
+
+-  18.10.26 Original   By: ACRM
+*/
+REAL CalcGappedScore(SUBGROUPMODEL *model, int sgNum, char *sequence,
+                     int length, int *offset)
+{
+   /* Best score for the rest of the alignment from each cell when the
+      previous column was a match (or the start), an insertion or a
+      deletion
+   */
+   REAL match[GAPROWS+1][MAXREFSEQLEN+1],
+        insert[GAPROWS+1][MAXREFSEQLEN+1],
+        delete[GAPROWS+1][MAXREFSEQLEN+1],
+        topSum[MAXREFSEQLEN+1],
+        here, openI, extendI, openD, extendD, value,
+        best = 0.0;
+   int  nRows = (length < GAPROWS) ? length : GAPROWS,
+        i, j, diagonal;
+
+   /* Maximum score from each reference position to the end            */
+   topSum[MAXREFSEQLEN] = 0.0;
+   for(j=MAXREFSEQLEN-1; j>=0; j--)
+   {
+      topSum[j] = topSum[j+1] +
+                  (model->fullMatrix ?
+                   model->fmSubGroupInfo[sgNum].topScores[j] :
+                   model->subGroupInfo[sgNum].topScores[j]);
+   }
+
+   for(i=nRows; i>=0; i--)
+   {
+      /* Nothing is left to align at the end of the reference           */
+      match[i][MAXREFSEQLEN]  = 0.0;
+      insert[i][MAXREFSEQLEN] = 0.0;
+      delete[i][MAXREFSEQLEN] = 0.0;
+
+      for(j=MAXREFSEQLEN-1; j>=0; j--)
+      {
+         diagonal = i - j;
+         if((diagonal < GAPLODIAG) || (diagonal > GAPHIDIAG))
+         {
+            match[i][j] = insert[i][j] = delete[i][j] = GAPNEG;
+            continue;
+         }
+
+         /* Residue i is matched to position j or inserted. Past the end
+            of the sequence the reference positions can only be deleted
+         */
+         if(i < nRows)
+         {
+            here    = ResidueScore(model, sgNum, j, sequence[i]) +
+                      match[i+1][j+1];
+            openI   = insert[i+1][j] - model->gapOpen;
+            extendI = insert[i+1][j] - model->gapExtend;
+         }
+         else
+         {
+            here = openI = extendI = GAPNEG;
+         }
+         openD   = delete[i][j+1] - model->gapOpen;
+         extendD = delete[i][j+1] - model->gapExtend;
+
+         match[i][j]  = MAX3(here, openI,   openD);
+         insert[i][j] = MAX3(here, extendI, openD);
+         delete[i][j] = MAX3(here, openI,   extendD);
+      }
+   }
+
+   /* Truncation offsets start at the first residue                     */
+   for(j=0; j<MAXTRUNCATION; j++)
+   {
+      if((topSum[j] > 0.0) &&
+         ((value = (match[0][j] * 100.0) / topSum[j]) > best))
+      {
+         best    = value;
+         *offset = j;
+      }
+   }
+
+   /* Extension offsets start at the first reference position           */
+   for(i=1; (i<MAXEXTENSION) && (i<=nRows); i++)
+   {
+      if((topSum[0] > 0.0) &&
+         ((value = (match[i][0] * 100.0) / topSum[0]) > best))
+      {
+         best    = value;
+         *offset = -i;
+      }
+   }
+
+   return(best);
+}
+
+
+/************************************************************************/
+/*>static REAL ResidueScore(SUBGROUPMODEL *model, int sgNum, int refPos,
+                            char res)
+   ---------------------------------------------------------------------
+*//**
+   \param[in]   model     - the model
+   \param[in]   sgNum     - the subgroup
+   \param[in]   refPos    - reference position
+   \param[in]   res       - residue aligned to it
+   \return                - score for the residue
+
+-  18.10.26 Original   By: ACRM
+*/
+static REAL ResidueScore(SUBGROUPMODEL *model, int sgNum, int refPos,
+                         char res)
+{
+   if((res == 'X') && !model->includeX)
+      return(0.0);
+
+   if(model->fullMatrix)
+   {
+      if((res < 'A') || (res > 'Z'))
+         return(0.0);
+      return(model->fmSubGroupInfo[sgNum].scores[refPos][ILETTER(res)]);
+   }
+
+   if(res == model->subGroupInfo[sgNum].topSeq[refPos])
+      return(model->subGroupInfo[sgNum].topScores[refPos]);
+   if(res == model->subGroupInfo[sgNum].secondSeq[refPos])
+      return(model->subGroupInfo[sgNum].secondScores[refPos]);
+   return(0.0);
+}
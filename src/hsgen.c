@@ -0,0 +1,886 @@
+/*************************************************************************
+
+   Program:    hsgen
+   File:       hsgen.c
+
+   Version:    V1.1
+   Date:       18.10.26
+   Function:   Generate synthetic antibody sequences from the subgroup
+               data
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Samples chains from the per-position residue frequencies of the
+   built-in subgroup data or a data file (either format). Each chain is
+   drawn from a randomly chosen subgroup and may be N-terminally
+   truncated or extended, have residues masked as X and be followed by
+   a random tail. A fraction of chains can be exact duplicates of
+   recent ones.
+
+   Residues are drawn in constant time from Walker/Vose alias tables
+   built for each subgroup position. Extensions and tails are drawn
+   from the mean composition of the data.
+
+   The subgroup and offset used for each chain are written in the
+   header so the output can be used to check the accuracy of the
+   assignments. The subgroup is given as its index in the data (as in
+   the bestid column of hsubgroup -F tsv) and the offset is positive
+   for truncation and negative for extension.
+
+**************************************************************************
+
+   Usage:
+   ======
+   hsgen [-d datafile [-f]] [-n count] [-s seed] [-F format]
+         [-t maxtrunc] [-e maxext] [-x xrate] [-u duprate]
+         [-l minlen[:maxlen]] [-w width] [out]
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0  18.10.26   Original
+   V1.1  18.10.26   Checks the number of subgroups
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bioplib/MathType.h"
+#include "bioplib/SysDefs.h"
+#include "subgroup.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define NALPHA            26  /* Residue letters A-Z                    */
+#define ALIASSCALE 165191049UL/* 0xFFFFFFFF / NALPHA                    */
+#define MAXSEQLEN       2048  /* Longest chain generated                */
+#define NRECENT           64  /* Chains remembered for duplication      */
+#define GENBUFFSIZE  1048576  /* Output buffer                          */
+#define MAXRECORD  (2*MAXSEQLEN + 2*MAXBUFF)
+
+#define GENFORMAT_PIR      0
+#define GENFORMAT_FASTA    1
+#define GENFORMAT_AIRR     2
+
+#define AIRRHEADER "sequence_id\tsequence\trev_comp\tproductive\tv_call\t\
+d_call\tj_call\tsequence_alignment\tgermline_alignment\tjunction\t\
+junction_aa\tv_cigar\td_cigar\tj_cigar\tsequence_aa\tlocus\tsubgroup_id\t\
+subgroup\toffset\n"
+
+/* Samples a residue from an alias table. One 32-bit random number
+   gives both the column and the fraction. The comparison is used as an
+   index rather than a branch since it is unpredictable
+*/
+#define SAMPLE(table, r)                                                 \
+   ((table)->letter[(r) % NALPHA]                                        \
+                   [((r) / NALPHA) < (table)->threshold[(r) % NALPHA]])
+
+/* Marsaglia's xorshift128 generator. Sets r to the next 32-bit value   */
+#define NEXTRANDOM(rng, r)                                               \
+   do {                                                                  \
+      unsigned long t_ = ((rng).x ^ ((rng).x << 11)) & 0xFFFFFFFFUL;     \
+      (rng).x = (rng).y;                                                 \
+      (rng).y = (rng).z;                                                 \
+      (rng).z = (rng).w;                                                 \
+      (rng).w = (rng).w ^ ((rng).w >> 19) ^ t_ ^ (t_ >> 8);              \
+      (r)     = (rng).w;                                                 \
+   }  while(0)
+
+/* An alias table for sampling a residue in constant time. Column c
+   gives letter[c][1] if the random fraction is below threshold[c],
+   otherwise its alias, letter[c][0]
+*/
+typedef struct
+{
+   unsigned long threshold[NALPHA];
+   char          letter[NALPHA][2];
+}  ALIASTABLE;
+
+/* Random number generator state                                        */
+typedef struct
+{
+   unsigned long x, y, z, w;
+}  RNGSTATE;
+
+/* Command line options                                                 */
+typedef struct
+{
+   char dataFile[MAXBUFF],
+        outFile[MAXBUFF];
+   long count;
+   unsigned long seed;
+   int  format,
+        maxTrunc,
+        maxExt,
+        minTail,
+        maxTail,
+        width;
+   REAL xRate,
+        dupRate;
+   BOOL fullMatrix;
+}  GENOPTIONS;
+
+/* A generated chain                                                    */
+typedef struct
+{
+   int  subGroup,
+        offset,
+        length;
+   char seq[MAXSEQLEN+1];
+}  GENCHAIN;
+
+/************************************************************************/
+/* Globals
+*/
+static ALIASTABLE    sProfile[MAXSUBTYPES][MAXREFSEQLEN];
+static ALIASTABLE    sBackground;
+static RNGSTATE      sRNG;
+static GENCHAIN      sRecent[NRECENT];
+static char          sBuffer[GENBUFFSIZE];
+static int           sNUsed = 0;
+
+/************************************************************************/
+/* Prototypes
+*/
+int main(int argc, char **argv);
+static BOOL ParseCmdLine(int argc, char **argv, GENOPTIONS *opts);
+static void Usage(void);
+static void SeedRandom(unsigned long seed);
+static unsigned long Random(void);
+static unsigned long ProbThreshold(REAL p);
+static void BuildAliasTable(REAL *freq, ALIASTABLE *table);
+static BOOL BuildTables(int nSubGroups);
+static void GenerateChain(GENOPTIONS *opts, int nSubGroups,
+                          unsigned long xThresh, GENCHAIN *chain);
+static BOOL FlushBuffer(FILE *fp);
+static void AppendString(char *string);
+static void AppendInt(long value);
+static void WriteChain(GENOPTIONS *opts, long chainNum, GENCHAIN *chain);
+
+
+/************************************************************************/
+/*>int main(int argc, char **argv)
+   -------------------------------
+*//**
+   Main program for the sequence generator
+
+-  18.10.26 Original   By: ACRM
+*/
+int main(int argc, char **argv)
+{
+   FILE          *fpData = NULL,
+                 *out    = stdout;
+   GENOPTIONS    opts;
+   GENCHAIN      chain;
+   unsigned long xThresh, dupThresh;
+   long          i, nRecent = 0;
+   int           nSubGroups;
+
+   if(!ParseCmdLine(argc, argv, &opts))
+   {
+      Usage();
+      return(0);
+   }
+
+   if(opts.dataFile[0])
+   {
+      if((fpData=fopen(opts.dataFile, "r"))==NULL)
+      {
+         fprintf(stderr, "hsgen Error: Unable to open data file (%s)\n",
+                 opts.dataFile);
+         return(1);
+      }
+   }
+
+   if(!LoadSubgroupModel(fpData, opts.fullMatrix))
+   {
+      fprintf(stderr, "hsgen Error: Unable to read data from data \
+file (%s)\n", opts.dataFile);
+      return(1);
+   }
+   if((nSubGroups = GetSubgroupCount()) > MAXSUBTYPES)
+   {
+      fprintf(stderr, "hsgen Error: Too many subgroups (%d; max %d)\n",
+              nSubGroups, MAXSUBTYPES);
+      return(1);
+   }
+   if(!BuildTables(nSubGroups))
+   {
+      fprintf(stderr, "hsgen Error: Unable to read data from data \
+file (%s)\n", opts.dataFile);
+      return(1);
+   }
+   if(fpData != NULL)
+      fclose(fpData);
+
+   if(opts.outFile[0])
+   {
+      if((out=fopen(opts.outFile, "w"))==NULL)
+      {
+         fprintf(stderr, "hsgen Error: Unable to open output file \
+(%s)\n", opts.outFile);
+         return(1);
+      }
+   }
+
+   SeedRandom(opts.seed);
+   xThresh   = ProbThreshold(opts.xRate);
+   dupThresh = ProbThreshold(opts.dupRate);
+
+   if(opts.format == GENFORMAT_AIRR)
+      AppendString(AIRRHEADER);
+
+   for(i=0; i<opts.count; i++)
+   {
+      if(sNUsed > GENBUFFSIZE - MAXRECORD)
+      {
+         if(!FlushBuffer(out))
+         {
+            fprintf(stderr, "hsgen Error: Unable to write output\n");
+            return(1);
+         }
+      }
+
+      if(nRecent && (Random() < dupThresh))
+      {
+         int which = (int)(Random() % (nRecent < NRECENT ? nRecent :
+                                                           NRECENT));
+         WriteChain(&opts, i+1, &(sRecent[which]));
+      }
+      else
+      {
+         GenerateChain(&opts, nSubGroups, xThresh, &chain);
+         WriteChain(&opts, i+1, &chain);
+         if(dupThresh)
+            sRecent[(nRecent++) % NRECENT] = chain;
+      }
+   }
+
+   if(!FlushBuffer(out) || (fflush(out) != 0))
+   {
+      fprintf(stderr, "hsgen Error: Unable to write output\n");
+      return(1);
+   }
+   if(out != stdout)
+      fclose(out);
+
+   return(0);
+}
+
+
+/************************************************************************/
+/*>static BOOL ParseCmdLine(int argc, char **argv, GENOPTIONS *opts)
+   -----------------------------------------------------------------
+*//**
+   \param[in]   argc     Argument count
+   \param[in]   argv     Argument array
+   \param[out]  opts     Options
+   \return               Success?
+
+   Parse the command line
+
+-  18.10.26 Original   By: ACRM
+*/
+static BOOL ParseCmdLine(int argc, char **argv, GENOPTIONS *opts)
+{
+   opts->dataFile[0] = opts->outFile[0] = '\0';
+   opts->count       = 1000;
+   opts->seed        = 1;
+   opts->format      = GENFORMAT_PIR;
+   opts->maxTrunc    = 0;
+   opts->maxExt      = 0;
+   opts->minTail     = 90;
+   opts->maxTail     = 100;
+   opts->width       = 60;
+   opts->xRate       = 0.0;
+   opts->dupRate     = 0.0;
+   opts->fullMatrix  = FALSE;
+
+   argc--;
+   argv++;
+
+   while(argc)
+   {
+      if(argv[0][0] == '-')
+      {
+         if(argv[0][1] == 'f')
+         {
+            opts->fullMatrix = TRUE;
+            argc--;
+            argv++;
+            continue;
+         }
+
+         /* All other options take a value                              */
+         if(argc < 2)
+            return(FALSE);
+
+         switch(argv[0][1])
+         {
+         case 'd':
+            strncpy(opts->dataFile, argv[1], MAXBUFF-1);
+            opts->dataFile[MAXBUFF-1] = '\0';
+            break;
+         case 'n':
+            if((sscanf(argv[1], "%ld", &(opts->count)) != 1) ||
+               (opts->count < 0))
+               return(FALSE);
+            break;
+         case 's':
+            if(sscanf(argv[1], "%lu", &(opts->seed)) != 1)
+               return(FALSE);
+            break;
+         case 'F':
+            if(!strcmp(argv[1], "pir"))
+               opts->format = GENFORMAT_PIR;
+            else if(!strcmp(argv[1], "fasta"))
+               opts->format = GENFORMAT_FASTA;
+            else if(!strcmp(argv[1], "airr"))
+               opts->format = GENFORMAT_AIRR;
+            else
+               return(FALSE);
+            break;
+         case 't':
+            if((sscanf(argv[1], "%d", &(opts->maxTrunc)) != 1) ||
+               (opts->maxTrunc < 0) || (opts->maxTrunc >= MAXREFSEQLEN))
+               return(FALSE);
+            break;
+         case 'e':
+            if((sscanf(argv[1], "%d", &(opts->maxExt)) != 1) ||
+               (opts->maxExt < 0) || (opts->maxExt > MAXSEQLEN/4))
+               return(FALSE);
+            break;
+         case 'x':
+            if((sscanf(argv[1], "%lf", &(opts->xRate)) != 1) ||
+               (opts->xRate < 0.0) || (opts->xRate > 1.0))
+               return(FALSE);
+            break;
+         case 'u':
+            if((sscanf(argv[1], "%lf", &(opts->dupRate)) != 1) ||
+               (opts->dupRate < 0.0) || (opts->dupRate > 1.0))
+               return(FALSE);
+            break;
+         case 'l':
+            switch(sscanf(argv[1], "%d:%d", &(opts->minTail),
+                          &(opts->maxTail)))
+            {
+            case 1:
+               opts->maxTail = opts->minTail;
+               break;
+            case 2:
+               break;
+            default:
+               return(FALSE);
+            }
+            if((opts->minTail < 0) || (opts->maxTail < opts->minTail) ||
+               (opts->maxTail > MAXSEQLEN/2))
+               return(FALSE);
+            break;
+         case 'w':
+            if((sscanf(argv[1], "%d", &(opts->width)) != 1) ||
+               (opts->width < 0))
+               return(FALSE);
+            break;
+         default:
+            return(FALSE);
+         }
+         argc -= 2;
+         argv += 2;
+      }
+      else
+      {
+         if(argc > 1)
+            return(FALSE);
+         strncpy(opts->outFile, argv[0], MAXBUFF-1);
+         opts->outFile[MAXBUFF-1] = '\0';
+         return(TRUE);
+      }
+   }
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static void Usage(void)
+   -----------------------
+*//**
+   Prints a usage message
+
+-  18.10.26 Original   By: ACRM
+*/
+static void Usage(void)
+{
+   fprintf(stderr,"\nhsgen V1.0 (c) 2026, Andrew C.R. Martin, UCL\n");
+   fprintf(stderr,"\nUsage: hsgen [-d datafile [-f]] [-n count] \
+[-s seed] [-F format] [-t maxtrunc]\n");
+   fprintf(stderr,"             [-e maxext] [-x xrate] [-u duprate] \
+[-l minlen[:maxlen]] [-w width]\n");
+   fprintf(stderr,"             [out]\n");
+   fprintf(stderr,"       -d Data file (default built-in data)\n");
+   fprintf(stderr,"       -f Data file is a full matrix\n");
+   fprintf(stderr,"       -n Number of chains (default 1000)\n");
+   fprintf(stderr,"       -s Random number seed (default 1)\n");
+   fprintf(stderr,"       -F Output format: pir (default), fasta \
+or airr\n");
+   fprintf(stderr,"       -t Maximum N-terminal truncation \
+(default 0)\n");
+   fprintf(stderr,"       -e Maximum N-terminal extension \
+(default 0)\n");
+   fprintf(stderr,"       -x Fraction of residues masked as X \
+(default 0)\n");
+   fprintf(stderr,"       -u Fraction of chains duplicating a recent \
+chain (default 0)\n");
+   fprintf(stderr,"       -l Length of the random tail after the \
+N-terminus (default 90:100)\n");
+   fprintf(stderr,"       -w Line width for PIR and FASTA, 0 for a \
+single line (default 60)\n");
+   fprintf(stderr,"\nGenerates synthetic antibody sequences from the \
+subgroup data. The subgroup\n");
+   fprintf(stderr,"(index in the data) and offset (+ve truncation, \
+-ve extension) used for each\n");
+   fprintf(stderr,"chain are given in its header.\n\n");
+}
+
+
+/************************************************************************/
+/*>static void SeedRandom(unsigned long seed)
+   ------------------------------------------
+*//**
+   \param[in]   seed    Seed
+
+   Seeds the xorshift128 generator. The state is filled using an LCG
+   so that similar seeds give unrelated sequences
+
+-  18.10.26 Original   By: ACRM
+*/
+static void SeedRandom(unsigned long seed)
+{
+   unsigned long state[4];
+   int           i;
+
+   seed &= 0xFFFFFFFFUL;
+   for(i=0; i<4; i++)
+   {
+      seed     = (1664525UL * seed + 1013904223UL) & 0xFFFFFFFFUL;
+      state[i] = seed ^ (seed >> 16);
+   }
+   if(!(state[0] | state[1] | state[2] | state[3]))
+      state[0] = 1;
+   sRNG.x = state[0];
+   sRNG.y = state[1];
+   sRNG.z = state[2];
+   sRNG.w = state[3];
+}
+
+
+/************************************************************************/
+/*>static unsigned long Random(void)
+   ---------------------------------
+*//**
+   \return      Random 32-bit value
+
+-  18.10.26 Original   By: ACRM
+*/
+static unsigned long Random(void)
+{
+   unsigned long r;
+
+   NEXTRANDOM(sRNG, r);
+   return(r);
+}
+
+
+/************************************************************************/
+/*>static unsigned long ProbThreshold(REAL p)
+   ------------------------------------------
+*//**
+   \param[in]   p     Probability
+   \return            Threshold such that Random() < threshold with
+                      probability p
+
+-  18.10.26 Original   By: ACRM
+*/
+static unsigned long ProbThreshold(REAL p)
+{
+   if(p <= 0.0)
+      return(0);
+   if(p >= 1.0)
+      return(0xFFFFFFFFUL);
+   return((unsigned long)(p * 4294967296.0));
+}
+
+
+/************************************************************************/
+/*>static void BuildAliasTable(REAL *freq, ALIASTABLE *table)
+   ----------------------------------------------------------
+*//**
+   \param[in]   freq     NALPHA frequencies summing to 1
+   \param[out]  table    The alias table
+
+   Builds an alias table using Vose's method
+
+-  18.10.26 Original   By: ACRM
+*/
+static void BuildAliasTable(REAL *freq, ALIASTABLE *table)
+{
+   REAL scaled[NALPHA];
+   int  small[NALPHA],
+        large[NALPHA],
+        nSmall = 0,
+        nLarge = 0,
+        i;
+
+   for(i=0; i<NALPHA; i++)
+   {
+      scaled[i] = freq[i] * NALPHA;
+      table->letter[i][0] = table->letter[i][1] = (char)('A' + i);
+      if(scaled[i] < 1.0)
+         small[nSmall++] = i;
+      else
+         large[nLarge++] = i;
+   }
+
+   while(nSmall && nLarge)
+   {
+      int s = small[--nSmall],
+          l = large[--nLarge];
+
+      table->threshold[s] = (unsigned long)(scaled[s] *
+                                            (REAL)(ALIASSCALE + 1));
+      table->letter[s][0] = (char)('A' + l);
+
+      scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+      if(scaled[l] < 1.0)
+         small[nSmall++] = l;
+      else
+         large[nLarge++] = l;
+   }
+
+   /* Anything left has probability 1 (to within rounding)              */
+   while(nLarge)
+      table->threshold[large[--nLarge]] = ALIASSCALE + 1;
+   while(nSmall)
+      table->threshold[small[--nSmall]] = ALIASSCALE + 1;
+}
+
+
+/************************************************************************/
+/*>static BOOL BuildTables(int nSubGroups)
+   ---------------------------------------
+*//**
+   \param[in]   nSubGroups   Number of subgroups loaded
+   \return                   Success?
+
+   Builds the alias tables for every subgroup position and for the
+   mean composition used for extensions and tails
+
+-  18.10.26 Original   By: ACRM
+*/
+static BOOL BuildTables(int nSubGroups)
+{
+   REAL freq[NALPHA],
+        mean[NALPHA],
+        total = 0.0;
+   int  sg, pos, i;
+
+   if(nSubGroups <= 0)
+      return(FALSE);
+
+   for(i=0; i<NALPHA; i++)
+      mean[i] = 0.0;
+
+   for(sg=0; sg<nSubGroups; sg++)
+   {
+      for(pos=0; pos<MAXREFSEQLEN; pos++)
+      {
+         if(!GetSubgroupProfile(sg, pos, freq))
+            return(FALSE);
+         BuildAliasTable(freq, &(sProfile[sg][pos]));
+         for(i=0; i<NALPHA; i++)
+            mean[i] += freq[i];
+      }
+   }
+
+   /* The background excludes X and other non-standard letters          */
+   mean['B'-'A'] = mean['J'-'A'] = mean['O'-'A'] = 0.0;
+   mean['U'-'A'] = mean['X'-'A'] = mean['Z'-'A'] = 0.0;
+   for(i=0; i<NALPHA; i++)
+      total += mean[i];
+   if(total <= 0.0)
+      return(FALSE);
+   for(i=0; i<NALPHA; i++)
+      mean[i] /= total;
+   BuildAliasTable(mean, &sBackground);
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static void GenerateChain(GENOPTIONS *opts, int nSubGroups,
+                             unsigned long xThresh, GENCHAIN *chain)
+   -----------------------------------------------------------------
+*//**
+   \param[in]   opts         Options
+   \param[in]   nSubGroups   Number of subgroups loaded
+   \param[in]   xThresh      Threshold for masking a residue as X
+   \param[out]  chain        The generated chain
+
+   Generates a chain from a random subgroup with a random offset and
+   tail length
+
+-  18.10.26 Original   By: ACRM
+*/
+static void GenerateChain(GENOPTIONS *opts, int nSubGroups,
+                          unsigned long xThresh, GENCHAIN *chain)
+{
+   ALIASTABLE    *profile;
+   RNGSTATE      rng;
+   unsigned long r;
+   char          *seq = chain->seq;
+   int           len  = 0,
+                 tail, pos, i;
+
+   chain->subGroup = (int)(Random() % (unsigned long)nSubGroups);
+   chain->offset   = (int)(Random() % (unsigned long)(opts->maxTrunc +
+                                                      opts->maxExt + 1))
+                     - opts->maxExt;
+   tail            = opts->minTail +
+                     (int)(Random() % (unsigned long)(opts->maxTail -
+                                                      opts->minTail + 1));
+   profile         = sProfile[chain->subGroup];
+
+   /* Work on a local copy of the generator state since the stores to
+      seq could otherwise alias it
+   */
+   rng = sRNG;
+
+   /* N-terminal extension                                              */
+   for(i=chain->offset; i<0; i++)
+   {
+      NEXTRANDOM(rng, r);
+      seq[len++] = SAMPLE(&sBackground, r);
+   }
+
+   /* The profile positions after any truncation                        */
+   for(pos=(chain->offset > 0 ? chain->offset : 0);
+       pos<MAXREFSEQLEN;
+       pos++)
+   {
+      NEXTRANDOM(rng, r);
+      seq[len++] = SAMPLE(&(profile[pos]), r);
+   }
+
+   /* Random tail                                                       */
+   for(i=0; i<tail; i++)
+   {
+      NEXTRANDOM(rng, r);
+      seq[len++] = SAMPLE(&sBackground, r);
+   }
+
+   if(xThresh)
+   {
+      for(i=0; i<len; i++)
+      {
+         NEXTRANDOM(rng, r);
+         if(r < xThresh)
+            seq[i] = 'X';
+      }
+   }
+
+   sRNG = rng;
+   seq[len]      = '\0';
+   chain->length = len;
+}
+
+
+/************************************************************************/
+/*>static BOOL FlushBuffer(FILE *fp)
+   ---------------------------------
+*//**
+   \param[in]   fp    Output file
+   \return            Success?
+
+-  18.10.26 Original   By: ACRM
+*/
+static BOOL FlushBuffer(FILE *fp)
+{
+   if(sNUsed)
+   {
+      if(fwrite(sBuffer, 1, sNUsed, fp) != (size_t)sNUsed)
+         return(FALSE);
+      sNUsed = 0;
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static void AppendString(char *string)
+   --------------------------------------
+*//**
+   \param[in]   string    String to add to the output buffer
+
+   The caller ensures there is space
+
+-  18.10.26 Original   By: ACRM
+*/
+static void AppendString(char *string)
+{
+   while(*string)
+      sBuffer[sNUsed++] = *(string++);
+}
+
+
+/************************************************************************/
+/*>static void AppendInt(long value)
+   ---------------------------------
+*//**
+   \param[in]   value    Integer to add to the output buffer
+
+-  18.10.26 Original   By: ACRM
+*/
+static void AppendInt(long value)
+{
+   char digits[24];
+   int  n = 0;
+   unsigned long v;
+
+   if(value < 0)
+   {
+      sBuffer[sNUsed++] = '-';
+      v = (unsigned long)(-value);
+   }
+   else
+   {
+      v = (unsigned long)value;
+   }
+
+   do
+   {
+      digits[n++] = (char)('0' + (v % 10));
+      v /= 10;
+   }  while(v);
+
+   while(n)
+      sBuffer[sNUsed++] = digits[--n];
+}
+
+
+/************************************************************************/
+/*>static void WriteChain(GENOPTIONS *opts, long chainNum,
+                          GENCHAIN *chain)
+   ------------------------------------------------------
+*//**
+   \param[in]   opts       Options
+   \param[in]   chainNum   Chain number used to build the ID
+   \param[in]   chain      The chain
+
+   Adds a chain to the output buffer in the requested format. The ID
+   is the chain number as s%07ld
+
+-  18.10.26 Original   By: ACRM
+*/
+static void WriteChain(GENOPTIONS *opts, long chainNum, GENCHAIN *chain)
+{
+   char id[32];
+   int  i;
+
+   sprintf(id, "s%07ld", chainNum);
+
+   if(opts->format == GENFORMAT_AIRR)
+   {
+      int chainType = GetSubgroupChainType(chain->subGroup);
+
+      AppendString(id);
+      AppendString("\t\t\t\t\t\t\t\t\t\t\t\t\t\t");
+      AppendString(chain->seq);
+      AppendString(chainType == CHAINTYPE_HEAVY ? "\tIGH\t" :
+                   (chainType == CHAINTYPE_KAPPA ? "\tIGK\t" :
+                                                   "\tIGL\t"));
+      AppendInt(chain->subGroup);
+      sBuffer[sNUsed++] = '\t';
+      AppendString(GetSubgroupName(chain->subGroup));
+      sBuffer[sNUsed++] = '\t';
+      AppendInt(chain->offset);
+      sBuffer[sNUsed++] = '\n';
+      return;
+   }
+
+   /* Header with the true subgroup and offset                          */
+   if(opts->format == GENFORMAT_PIR)
+   {
+      AppendString(">P1;");
+      AppendString(id);
+      sBuffer[sNUsed++] = '\n';
+   }
+   else
+   {
+      sBuffer[sNUsed++] = '>';
+      AppendString(id);
+      sBuffer[sNUsed++] = ' ';
+   }
+   AppendString("subgroup=");
+   AppendInt(chain->subGroup);
+   AppendString(" offset=");
+   AppendInt(chain->offset);
+   sBuffer[sNUsed++] = ' ';
+   AppendString(GetSubgroupName(chain->subGroup));
+   sBuffer[sNUsed++] = '\n';
+
+   /* Sequence                                                          */
+   if(opts->width == 0)
+   {
+      memcpy(sBuffer+sNUsed, chain->seq, chain->length);
+      sNUsed += chain->length;
+   }
+   else
+   {
+      for(i=0; i<chain->length; i+=opts->width)
+      {
+         int n = chain->length - i;
+         if(n > opts->width)
+            n = opts->width;
+         memcpy(sBuffer+sNUsed, chain->seq+i, n);
+         sNUsed += n;
+         if((i+n < chain->length) || (opts->format == GENFORMAT_FASTA))
+            sBuffer[sNUsed++] = '\n';
+      }
+   }
+
+   if(opts->format == GENFORMAT_PIR)
+      AppendString("*\n");
+   else if((opts->width == 0) || (chain->length == 0))
+      sBuffer[sNUsed++] = '\n';
+}
@@ -0,0 +1,495 @@
+/*************************************************************************
+
+   Program:    hsmerge
+   File:       hsmerge.c
+
+   Version:    V1.0
+   Date:       18.10.26
+   Function:   Merge the outputs of hsubgroup --shard runs
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Joins the outputs from hsubgroup --shard runs in the order given on
+   the command line, which should be shard 1 to N. Each shard must have
+   been run with the same options.
+
+   Binary output (-F binary) is recognised from its magic number. The
+   header of the first file is kept, the headers of the others must
+   match it and are dropped, and the records are renumbered. For the
+   text formats, '#' header lines (as written by -F tsv) are kept from
+   the first file only and everything else is copied unchanged.
+
+   An empty file (from a shard with no entries) is skipped.
+
+**************************************************************************
+
+   Usage:
+   ======
+   hsmerge shard1 shard2 ... [-o out]
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0  18.10.26   Original
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bioplib/MathType.h"
+#include "bioplib/SysDefs.h"
+#include "subgroup.h"
+#include "output.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define BINFIXEDHEADER    20  /* Header up to the subgroup names        */
+#define COPYBUFFSIZE   65536
+
+/************************************************************************/
+/* Prototypes
+*/
+int main(int argc, char **argv);
+static BOOL ParseCmdLine(int argc, char **argv, char *outFile,
+                         int *firstFile);
+static void Usage(void);
+static unsigned long GetUInt32(unsigned char *bytes);
+static void PutUInt32(unsigned char *bytes, unsigned long value);
+static unsigned char *ReadBinaryHeader(FILE *fp, long *headerSize,
+                                       long *recordSize);
+static BOOL MergeBinary(FILE *in, FILE *out, char *fileName,
+                        unsigned char **firstHeader, long *firstSize,
+                        long *nRecords);
+static BOOL MergeText(FILE *in, FILE *out, BOOL *headerDone);
+
+
+/************************************************************************/
+/*>int main(int argc, char **argv)
+   -------------------------------
+*//**
+   Main program for merging shard outputs
+
+-  18.10.26 Original   By: ACRM
+*/
+int main(int argc, char **argv)
+{
+   FILE          *in,
+                 *out         = stdout;
+   char          outFile[MAXBUFF],
+                 magic[4];
+   unsigned char *firstHeader = NULL;
+   long          firstSize    = 0,
+                 nRecords     = 0;
+   int           firstFile, i,
+                 isBinary,
+                 binary       = -1;   /* Not yet known                  */
+   size_t        nRead;
+   BOOL          headerDone   = FALSE,
+                 ok;
+
+   if(!ParseCmdLine(argc, argv, outFile, &firstFile))
+   {
+      Usage();
+      return(0);
+   }
+
+   if(outFile[0])
+   {
+      if((out=fopen(outFile, "wb"))==NULL)
+      {
+         fprintf(stderr, "hsmerge Error: Unable to open output file \
+(%s)\n", outFile);
+         return(1);
+      }
+   }
+
+   for(i=firstFile; i<argc; i++)
+   {
+      if(!strcmp(argv[i], "-o"))
+      {
+         i++;
+         continue;
+      }
+      
+      if((in=fopen(argv[i], "rb"))==NULL)
+      {
+         fprintf(stderr, "hsmerge Error: Unable to open input file \
+(%s)\n", argv[i]);
+         return(1);
+      }
+
+      /* Skip empty files and check all others are the same type        */
+      if((nRead = fread(magic, 1, 4, in)) == 0)
+      {
+         fclose(in);
+         continue;
+      }
+      rewind(in);
+      isBinary = ((nRead == 4) && !memcmp(magic, OUTBINMAGIC, 4));
+      if(binary < 0)
+         binary = isBinary;
+      else if(binary != isBinary)
+      {
+         fprintf(stderr, "hsmerge Error: Binary and text shards can't \
+be merged (%s)\n", argv[i]);
+         return(1);
+      }
+
+      if(binary)
+         ok = MergeBinary(in, out, argv[i], &firstHeader, &firstSize,
+                          &nRecords);
+      else
+         ok = MergeText(in, out, &headerDone);
+      fclose(in);
+
+      if(!ok)
+      {
+         fprintf(stderr, "hsmerge Error: Unable to merge %s\n", argv[i]);
+         return(1);
+      }
+   }
+
+   if(fflush(out) != 0)
+   {
+      fprintf(stderr, "hsmerge Error: Unable to write output\n");
+      return(1);
+   }
+   if(out != stdout)
+      fclose(out);
+   
+   return(0);
+}
+
+
+/************************************************************************/
+/*>static BOOL ParseCmdLine(int argc, char **argv, char *outFile,
+                            int *firstFile)
+   --------------------------------------------------------------
+*//**
+   \param[in]   argc       Argument count
+   \param[in]   argv       Argument array
+   \param[out]  outFile    Output file (or blank string)
+   \param[out]  firstFile  Index in argv of the first shard file
+   \return                 Success?
+
+   Parse the command line. -o may appear anywhere and is skipped by
+   main() when the files are read.
+
+-  18.10.26 Original   By: ACRM
+*/
+static BOOL ParseCmdLine(int argc, char **argv, char *outFile,
+                         int *firstFile)
+{
+   int i,
+       nFiles = 0;
+
+   outFile[0] = '\0';
+   *firstFile = 1;
+
+   for(i=1; i<argc; i++)
+   {
+      if(argv[i][0] == '-')
+      {
+         if(strcmp(argv[i], "-o") || (i+1 >= argc))
+            return(FALSE);
+         i++;
+         strncpy(outFile, argv[i], MAXBUFF-1);
+         outFile[MAXBUFF-1] = '\0';
+      }
+      else
+      {
+         nFiles++;
+      }
+   }
+
+   return(nFiles > 0);
+}
+
+
+/************************************************************************/
+/*>static void Usage(void)
+   -----------------------
+*//**
+   Prints a usage message
+
+-  18.10.26 Original   By: ACRM
+*/
+static void Usage(void)
+{
+   fprintf(stderr,"\nhsmerge V1.0 (c) 2026, Andrew C.R. Martin, UCL\n");
+   fprintf(stderr,"\nUsage: hsmerge shard1 shard2 ... [-o out]\n");
+   fprintf(stderr,"       -o Output file (default standard output)\n");
+   fprintf(stderr,"\nJoins the outputs of hsubgroup --shard i/N in the \
+order given. The shards\n");
+   fprintf(stderr,"must have been run with the same options. Binary \
+records are renumbered\n");
+   fprintf(stderr,"and only the first header is kept.\n\n");
+}
+
+
+/************************************************************************/
+/*>static unsigned long GetUInt32(unsigned char *bytes)
+   ----------------------------------------------------
+*//**
+   \param[in]   bytes    4 bytes
+   \return               Little-endian value
+
+-  18.10.26 Original   By: ACRM
+*/
+static unsigned long GetUInt32(unsigned char *bytes)
+{
+   return((unsigned long)bytes[0]         |
+          ((unsigned long)bytes[1] <<  8) |
+          ((unsigned long)bytes[2] << 16) |
+          ((unsigned long)bytes[3] << 24));
+}
+
+
+/************************************************************************/
+/*>static void PutUInt32(unsigned char *bytes, unsigned long value)
+   ----------------------------------------------------------------
+*//**
+   \param[out]  bytes    4 bytes
+   \param[in]   value    Value to store little-endian
+
+-  18.10.26 Original   By: ACRM
+*/
+static void PutUInt32(unsigned char *bytes, unsigned long value)
+{
+   bytes[0] = (unsigned char)(value         & 0xFF);
+   bytes[1] = (unsigned char)((value >>  8) & 0xFF);
+   bytes[2] = (unsigned char)((value >> 16) & 0xFF);
+   bytes[3] = (unsigned char)((value >> 24) & 0xFF);
+}
+
+
+/************************************************************************/
+/*>static unsigned char *ReadBinaryHeader(FILE *fp, long *headerSize,
+                                          long *recordSize)
+   ------------------------------------------------------------------
+*//**
+   \param[in]   fp          Binary hsubgroup output
+   \param[out]  headerSize  Size of the header in bytes
+   \param[out]  recordSize  Size of each record in bytes
+   \return                  malloc()'d copy of the header (NULL if the
+                            header is not valid or no memory)
+
+   Reads the header including the table of subgroup names
+
+-  18.10.26 Original   By: ACRM
+*/
+static unsigned char *ReadBinaryHeader(FILE *fp, long *headerSize,
+                                       long *recordSize)
+{
+   unsigned char *header,
+                 *newHeader;
+   unsigned long nSubGroups,
+                 i;
+   long          size = BINFIXEDHEADER;
+
+   if((header = (unsigned char *)malloc(size))==NULL)
+      return(NULL);
+   if((fread(header, 1, size, fp) != (size_t)size) ||
+      memcmp(header, OUTBINMAGIC, 4)               ||
+      (GetUInt32(header+4) != OUTBINVERSION))
+   {
+      free(header);
+      return(NULL);
+   }
+   *recordSize = (long)GetUInt32(header+8);
+   nSubGroups  = GetUInt32(header+16);
+
+   for(i=0; i<nSubGroups; i++)
+   {
+      long len;
+      
+      if((newHeader = (unsigned char *)realloc(header, size+2))==NULL)
+      {
+         free(header);
+         return(NULL);
+      }
+      header = newHeader;
+      if(fread(header+size, 1, 2, fp) != 2)
+      {
+         free(header);
+         return(NULL);
+      }
+      len   = (long)header[size] | ((long)header[size+1] << 8);
+      size += 2;
+
+      if((newHeader = (unsigned char *)realloc(header, size+len))==NULL)
+      {
+         free(header);
+         return(NULL);
+      }
+      header = newHeader;
+      if(fread(header+size, 1, len, fp) != (size_t)len)
+      {
+         free(header);
+         return(NULL);
+      }
+      size += len;
+   }
+
+   *headerSize = size;
+   return(header);
+}
+
+
+/************************************************************************/
+/*>static BOOL MergeBinary(FILE *in, FILE *out, char *fileName,
+                           unsigned char **firstHeader, long *firstSize,
+                           long *nRecords)
+   ---------------------------------------------------------------------
+*//**
+   \param[in]     in           Binary shard output
+   \param[in]     out          Merged output
+   \param[in]     fileName     Name of the shard (for messages)
+   \param[in,out] firstHeader  Header of the first shard (NULL until
+                               one has been read)
+   \param[in,out] firstSize    Size of firstHeader
+   \param[in,out] nRecords     Number of records written
+   \return                     Success
+
+   Copies the records from a binary shard giving them consecutive
+   record numbers. The header is written for the first shard; for
+   the others it must be the same.
+
+-  18.10.26 Original   By: ACRM
+*/
+static BOOL MergeBinary(FILE *in, FILE *out, char *fileName,
+                        unsigned char **firstHeader, long *firstSize,
+                        long *nRecords)
+{
+   unsigned char *header,
+                 *record;
+   long          headerSize,
+                 recordSize;
+   size_t        nRead;
+   BOOL          ok = TRUE;
+
+   if((header = ReadBinaryHeader(in, &headerSize, &recordSize))==NULL)
+   {
+      fprintf(stderr, "hsmerge Error: Not a valid binary output \
+file (%s)\n", fileName);
+      return(FALSE);
+   }
+
+   if(*firstHeader == NULL)
+   {
+      if(fwrite(header, 1, headerSize, out) != (size_t)headerSize)
+      {
+         free(header);
+         return(FALSE);
+      }
+      *firstHeader = header;
+      *firstSize   = headerSize;
+   }
+   else
+   {
+      if((headerSize != *firstSize) ||
+         memcmp(header, *firstHeader, headerSize))
+      {
+         fprintf(stderr, "hsmerge Error: Shard was run with different \
+options or data (%s)\n", fileName);
+         free(header);
+         return(FALSE);
+      }
+      free(header);
+   }
+
+   if((record = (unsigned char *)malloc(recordSize))==NULL)
+      return(FALSE);
+
+   while((nRead = fread(record, 1, recordSize, in)) != 0)
+   {
+      if(nRead != (size_t)recordSize)
+      {
+         fprintf(stderr, "hsmerge Error: Truncated record (%s)\n",
+                 fileName);
+         ok = FALSE;
+         break;
+      }
+      PutUInt32(record, (unsigned long)(++(*nRecords)));
+      if(fwrite(record, 1, recordSize, out) != (size_t)recordSize)
+      {
+         ok = FALSE;
+         break;
+      }
+   }
+   
+   free(record);
+   return(ok && !ferror(in));
+}
+
+
+/************************************************************************/
+/*>static BOOL MergeText(FILE *in, FILE *out, BOOL *headerDone)
+   ------------------------------------------------------------
+*//**
+   \param[in]     in          Text, TSV or JSON Lines shard output
+   \param[in]     out         Merged output
+   \param[in,out] headerDone  A '#' header has been written
+   \return                    Success
+
+   Copies a text shard. Header lines starting with '#' are dropped if
+   an earlier shard had them.
+
+-  18.10.26 Original   By: ACRM
+*/
+static BOOL MergeText(FILE *in, FILE *out, BOOL *headerDone)
+{
+   static char buffer[COPYBUFFSIZE];
+   BOOL        lineStart = TRUE,
+               skipping  = FALSE,
+               sawHeader = FALSE;
+
+   while(fgets(buffer, COPYBUFFSIZE, in))
+   {
+      int len = strlen(buffer);
+      
+      if(lineStart)
+      {
+         skipping   = ((buffer[0] == '#') && *headerDone);
+         sawHeader |= (buffer[0] == '#');
+      }
+      lineStart = (buffer[len-1] == '\n');
+      
+      if(!skipping && (fwrite(buffer, 1, len, out) != (size_t)len))
+         return(FALSE);
+   }
+   if(sawHeader)
+      *headerDone = TRUE;
+   
+   return(!ferror(in));
+}
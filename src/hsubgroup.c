@@ -3,11 +3,11 @@
    Program:    hsubgroup
    File:       hsubgroup.c
    
-   Version:    V3.2
-   Date:       05.04.19
+   Version:    V3.26
+   Date:       18.10.26
    Function:   Assign human subgroups from antibody sequences in PIR file
    
-   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2019
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2026
    Author:     Dr. Andrew C. R. Martin
    Address:    Biomolecular Structure & Modelling Unit,
                Department of Biochemistry & Molecular Biology,
@@ -55,21 +55,85 @@
    V3.1  13.02.19   Added better handling of X in the sequence and code
                     to calculate product-based scores
    V3.2  05.04.19   Zero the counter of the number of subtypes
+   V3.3  18.10.26   Added -F to select TSV, JSON Lines or binary output
+                    with sequence IDs. Output now honours the output file
+   V3.4  18.10.26   Added -k to rank the best K subgroups. The second
+                    best is now always a different subgroup from the best
+   V3.5  18.10.26   Added --stats to report counts, stage timing and
+                    per-chain latency
+   V3.6  18.10.26   Added --perf to report hardware performance counters
+                    for each stage
+   V3.7  18.10.26   Added USDT probes at the start and end of each entry
+   V3.8  18.10.26   Reads sequences with a SEQREADER. Added --shard to
+                    process one byte range of the input
+   V3.9  18.10.26   Added --checkpoint and --resume
+   V3.10 18.10.26   Added many-files mode (-L, -O, -C, -j)
+   V3.11 18.10.26   Added --watch
+   V3.12 18.10.26   Added -m and -mf to score against several models
+                    in one pass
+   V3.13 18.10.26   Added --config to run several scoring configurations
+                    in one pass
+   V3.14 18.10.26   Added --mutscan
+   V3.15 18.10.26   Added --humanise
+   V3.16 18.10.26   Added --domains
+   V3.17 18.10.26   Added --dna
+   V3.18 18.10.26   Added --gapped
+   V3.19 18.10.26   Data files may have profiles of any length
+   V3.20 18.10.26   Data files may have any number of subgroups
+   V3.21 18.10.26   Added --split
+   V3.22 18.10.26   Added --pvalues
+   V3.23 18.10.26   Added --cascade
+   V3.24 18.10.26   Added --summary
+   V3.25 18.10.26   Checkpoints record the data file, -f, -x and -p
+   V3.26 18.10.26   No winner between models that mix sums and products.
+                    Removed --cascade
 
 *************************************************************************/
 /* Includes
 */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "bioplib/MathType.h"
 #include "bioplib/seq.h"
 #include "bioplib/general.h"
 #include "subgroup.h"
+#include "output.h"
+#include "stats.h"
+#include "summary.h"
+#include "perfcount.h"
+#include "probes.h"
+#include "seqio.h"
+#include "checkpoint.h"
+#include "filepool.h"
+#include "watch.h"
+#include "mutscan.h"
+#include "humanise.h"
+#include "domscan.h"
+#include "translate.h"
+#include "splitpool.h"
 
 /************************************************************************/
 /* Defines and macros
 */
-#define MAXSEQ 8
+#define MAXSEQ    8
+#define MAXMODELS 16       /* Models that may be given with -m and -mf  */
+#define BUILTINMODEL "builtin"
+
+/* An additional model or scoring configuration from the command line.
+   A blank file for a configuration means the main data file. raw is
+   the unconfigured data if this is the first use of the file
+*/
+typedef struct
+{
+   SUBGROUPMODEL *raw;
+   char file[MAXBUFF],
+        flags[MAXWORD];
+   BOOL fullMatrix,
+        includeX,
+        doProduct,
+        config;
+} MODELSPEC;
 
 
 /************************************************************************/
@@ -78,7 +142,21 @@
 int main(int argc, char **argv);
 BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
                   char *dataFile, BOOL *verbose, BOOL *fullMatrix,
-                  BOOL *includeX, BOOL *doProduct);
+                  BOOL *includeX, BOOL *doProduct, int *format,
+                  int *topK, int *statsFormat, BOOL *perfCounters,
+                  int *shard, int *nShards, REAL *ckptInterval,
+                  BOOL *resume, POOLOPTIONS *poolOpts,
+                  MODELSPEC *modelSpecs, int *nModelSpecs,
+                  BOOL *mutScan, char *humTarget, REAL *humMargin,
+                  int *humMaxMut, REAL *domThreshold, int *dnaFrames,
+                  REAL *gapOpen, REAL *gapExtend, int *nSplit,
+                  BOOL *pValues, int *summaryFormat);
+BOOL ParseShard(char *spec, int *shard, int *nShards);
+BOOL ParseConfig(char *text, MODELSPEC *modelSpec);
+int  LoadExtraModels(MODELSPEC *modelSpecs, int nModelSpecs,
+                     char *dataFile, BOOL fullMatrix,
+                     SUBGROUPMODEL **models);
+char *ModelLabel(char *fileName);
 void Usage(void);
 
 
@@ -92,25 +170,100 @@ void Usage(void);
    16.06.97 Fixed memory leak --- wasn't freeing sequence data
    26.11.18 Added data file and verbose options
    12.02.18 Added full matrix support
+   18.10.26 Results are written through an output writer and the data
+            file is read before any sequences
+   18.10.26 Collects run statistics if --stats is given
+   18.10.26 Reads performance counters for each stage if --perf is given
+   18.10.26 Added batch_start and batch_end probes
+   18.10.26 Reads with a SEQREADER and handles --shard
+   18.10.26 Writes checkpoints and resumes from them
+   18.10.26 Hands many input files to the worker pool
+   18.10.26 Added watch mode
+   18.10.26 Scores against several models if -m or -mf are given
+   18.10.26 Scores with several configurations if --config is given
+   18.10.26 Writes a mutational scan of each chain if --mutscan is given
+   18.10.26 Runs a humanisation search if --humanise is given
+   18.10.26 Writes the domains in each chain if --domains is given
+   18.10.26 Translates each chain and scores the best frame if --dna is
+            given
+   18.10.26 Sets gapped scoring for every model if --gapped is given
+   18.10.26 Statistics are sized for the main model
+   18.10.26 Starts the split pool if --split is given
+   18.10.26 Builds the null scores and writes p-values if --pvalues is
+            given
+   18.10.26 Checkpoints record the data file and scoring options
+   18.10.26 Checkpoints record the gap penalties and --pvalues
 */
 int main(int argc, char **argv)
 {
-   FILE *in     = stdin,
-        *out    = stdout,
-        *fpData = NULL;
-   char infile[MAXBUFF],
-        outfile[MAXBUFF],
-        dataFile[MAXBUFF],
-        *seqs[MAXSEQ];
-   int  nchain, i,
-        class, subGroup;
-   BOOL punct, error, verbose, fullMatrix, includeX, doProduct;
+   FILE      *in     = stdin,
+             *out    = stdout,
+             *fpData = NULL;
+   char      infile[MAXBUFF],
+             outfile[MAXBUFF],
+             dataFile[MAXBUFF],
+             humTarget[MAXBUFF],
+             ckptFile[MAXBUFF+8],
+             id[MAXSEQID],
+             *seqs[MAXSEQ];
+   int       nchain, i,
+             format, topK, statsFormat,
+             summaryFormat,
+             shard, nShards,
+             nModelSpecs,
+             humMaxMut,
+             dnaFrames,
+             nSplit,
+             nModels = 1;
+   long      start   = 0,
+             end     = -1;
+   BOOL      verbose, fullMatrix, includeX, doProduct,
+             perfCounters, resume, mutScan, pValues,
+             resumed = FALSE;
+   OUTWRITER *writer;
+   SEQREADER *reader;
+   CHECKPOINT ckpt, saved;
+   HUMANISE  *hum    = NULL;
+   DOMSCAN   *dom    = NULL;
+   POOLOPTIONS poolOpts;
+   MODELSPEC  modelSpecs[MAXMODELS];
+   SUBGROUPMODEL *models[MAXMODELS+1];
+   REAL      startTime = 0.0,
+             mark      = 0.0,   /* Time the last stage finished         */
+             ckptInterval,
+             humMargin,
+             domThreshold,
+             gapOpen, gapExtend,
+             lastCkpt  = 0.0;
+   static RUNSTATS     stats;
+   static PERFCOUNTERS perf;
+   static MUTSCAN      scan;
+   static SUMMARY      summary;
 
    dataFile[0] = '\0';
    if(ParseCmdLine(argc, argv, infile, outfile, dataFile, &verbose,
-                   &fullMatrix, &includeX, &doProduct))
+                   &fullMatrix, &includeX, &doProduct, &format, &topK,
+                   &statsFormat, &perfCounters, &shard, &nShards,
+                   &ckptInterval, &resume, &poolOpts,
+                   modelSpecs, &nModelSpecs, &mutScan,
+                   humTarget, &humMargin, &humMaxMut, &domThreshold,
+                   &dnaFrames, &gapOpen, &gapExtend, &nSplit,
+                   &pValues, &summaryFormat))
    {
+      if(statsFormat)
+         startTime = mark = StatsTime();
+      if(perfCounters)
+         OpenPerfCounters(&perf);
+      
+
       FindSubgroupSetOptions(verbose, includeX, doProduct);
+      FindSubgroupSetTopK(topK);
+      if((nSplit > 1) && !FindSubgroupSetSplit(nSplit))
+      {
+         fprintf(stderr, "hsubgroup Error: Unable to start threads for \
+--split\n");
+         return(1);
+      }
       
       if(dataFile[0] != '\0')
       {
@@ -121,24 +274,381 @@ file (%s)\n", dataFile);
             return(1);
          }
       }
+
+      if(!LoadSubgroupModel(fpData, fullMatrix))
+      {
+         fprintf(stderr, "hsubgroup Error: Unable to read data \
+from data file (%s)\n", dataFile);
+         return(1);
+      }
+
+      /* The main model is always first                                 */
+      models[0] = GetDefaultModel();
+      strcpy(models[0]->label,
+             (dataFile[0] != '\0') ? ModelLabel(dataFile) : BUILTINMODEL);
+      if(nModelSpecs &&
+         ((nModels = LoadExtraModels(modelSpecs, nModelSpecs,
+                                     dataFile, fullMatrix,
+                                     models+1) + 1) == 1))
+         return(1);
+
+      if(statsFormat && !InitRunStats(&stats, models[0]->nSubGroups))
+      {
+         fprintf(stderr, "hsubgroup Error: No memory for statistics\n");
+         return(1);
+      }
+      if(summaryFormat && !InitSummary(&summary, models[0]->nSubGroups))
+      {
+         fprintf(stderr, "hsubgroup Error: No memory for summary\n");
+         return(1);
+      }
+
+      /* The scans and gapped alignment use the standard window and the
+         scans keep results for at most MAXSUBTYPES subgroups
+      */
+      if((mutScan || humTarget[0]) && (models[0]->nSubGroups > MAXSUBTYPES))
+      {
+         fprintf(stderr, "hsubgroup Error: --mutscan and --humanise need \
+at most %d subgroups\n(%s has %d)\n", MAXSUBTYPES, models[0]->label,
+                 models[0]->nSubGroups);
+         return(1);
+      }
+      if(mutScan || humTarget[0] || (gapOpen >= 0.0))
+      {
+         for(i=0; i<nModels; i++)
+         {
+            if(models[i]->refLength != MAXREFSEQLEN)
+            {
+               fprintf(stderr, "hsubgroup Error: --mutscan, --humanise \
+and --gapped need\nprofiles of %d positions (%s has %d)\n",
+                       MAXREFSEQLEN, models[i]->label,
+                       models[i]->refLength);
+               return(1);
+            }
+         }
+      }
+      if(gapOpen >= 0.0)
+      {
+         for(i=0; i<nModels; i++)
+            SetSubgroupGaps(models[i], TRUE, gapOpen, gapExtend);
+      }
+      if(pValues)
+      {
+         for(i=0; i<nModels; i++)
+         {
+            if(!BuildNullScores(models[i]))
+            {
+               fprintf(stderr, "hsubgroup Error: No memory for null \
+scores\n");
+               return(1);
+            }
+         }
+      }
+
+      if(humTarget[0])
+      {
+         int target;
+         
+         if((target = HumaniseTarget(models[0], humTarget)) < 0)
+         {
+            fprintf(stderr, "hsubgroup Error: No such subgroup (%s)\n",
+                    humTarget);
+            return(1);
+         }
+         if((hum = OpenHumanise(models[0], target, humMargin,
+                                humMaxMut))==NULL)
+         {
+            fprintf(stderr, "hsubgroup Error: No memory for \
+humanisation search\n");
+            return(1);
+         }
+      }
+      if((domThreshold >= 0.0) &&
+         ((dom = OpenDomainScan(models[0], domThreshold))==NULL))
+      {
+         fprintf(stderr, "hsubgroup Error: No memory for domain scan\n");
+         return(1);
+      }
+      
+      if(statsFormat)
+      {
+         stats.loadTime = StatsLap(&mark);
+         PerfLap(&perf, PERFSTAGE_LOAD);
+      }
+      
+      /* Many-files mode                                                */
+      if(poolOpts.active)
+      {
+         int nFailed;
+         
+         if(poolOpts.listFile[0] &&
+            !ReadFileList(&(poolOpts.inputs), poolOpts.listFile))
+         {
+            fprintf(stderr, "hsubgroup Error: Unable to read file list \
+(%s)\n", poolOpts.listFile);
+            return(1);
+         }
+         
+         if(summaryFormat)
+            poolOpts.summary = &summary;
+         if(poolOpts.watchDir[0])
+            nFailed = WatchDirectory(&poolOpts, format, verbose, topK,
+                                     (statsFormat != STATS_NONE), &stats);
+         else
+            nFailed = ProcessFiles(&poolOpts, format, verbose, topK,
+                                   (statsFormat != STATS_NONE), &stats);
+         FreeFileList(&(poolOpts.inputs));
+
+         /* The summary of all the files goes to standard output        */
+         if(summaryFormat)
+         {
+            if((nFailed >= 0) &&
+               (!WriteSummary(stdout, &summary, summaryFormat) ||
+                fflush(stdout)))
+            {
+               fprintf(stderr, "hsubgroup Error: Unable to write \
+summary\n");
+               nFailed = -1;
+            }
+            FreeSummary(&summary);
+         }
+         
+         if(statsFormat)
+         {
+            WriteRunStats(stderr, &stats, statsFormat,
+                          StatsTime() - startTime);
+            FreeRunStats(&stats);
+         }
+         return((nFailed == 0) ? 0 : 1);
+      }
+      
+      /* Look for a checkpoint from an earlier run                      */
+      if(ckptInterval >= 0.0)
+      {
+         sprintf(ckptFile, "%s%s", outfile, CKPTSUFFIX);
+         strcpy(ckpt.inFile, infile);
+         ckpt.format  = format;
+         ckpt.topK    = topK;
+         ckpt.verbose = verbose;
+         ckpt.shard   = shard;
+         ckpt.nShards = nShards;
+         strcpy(ckpt.dataFile, dataFile);
+         ckpt.fullMatrix = fullMatrix;
+         ckpt.includeX   = includeX;
+         ckpt.doProduct  = doProduct;
+         ckpt.gapOpen    = gapOpen;
+         ckpt.gapExtend  = gapExtend;
+         ckpt.pValues    = pValues;
+
+         if(resume)
+         {
+            switch(ReadCheckpoint(ckptFile, &saved))
+            {
+            case 1:
+               if(!SameRun(&ckpt, &saved))
+               {
+                  fprintf(stderr, "hsubgroup Error: Checkpoint (%s) is \
+for a different input, data file or options\n", ckptFile);
+                  return(1);
+               }
+               resumed = TRUE;
+               break;
+            case 0:
+               break;
+            default:
+               fprintf(stderr, "hsubgroup Error: Checkpoint (%s) is not \
+valid\n", ckptFile);
+               return(1);
+            }
+         }
+      }
       
-      if(blOpenStdFiles(infile, outfile, &in, &out))
+      if(blOpenStdFiles(infile, (resumed ? "" : outfile), &in, &out))
       {
-         while((nchain=blReadPIR(in,FALSE,seqs,MAXSEQ,NULL,
-                                 &punct,&error)))
+         if(resumed &&
+            ((out = ReopenOutput(outfile, saved.outOffset))==NULL))
+         {
+            fprintf(stderr, "hsubgroup Error: Unable to resume output \
+file (%s)\n", outfile);
+            return(1);
+         }
+         if((nShards > 1) &&
+            !ShardRange(in, shard-1, nShards, &start, &end))
+         {
+            fprintf(stderr, "hsubgroup Error: --shard needs a regular \
+input file\n");
+            return(1);
+         }
+         if(resumed)
+            start = saved.inOffset;
+         if((reader = OpenSeqReader(in, start, end))==NULL)
+         {
+            fprintf(stderr, "hsubgroup Error: Unable to read input\n");
+            return(1);
+         }
+         if((writer = OpenOutputWriter(out, format, verbose, topK))==NULL)
+         {
+            fprintf(stderr, "hsubgroup Error: No memory for output\n");
+            return(1);
+         }
+         if(resumed)
+            ResumeOutputWriter(writer, saved.nRecords,
+                               (saved.outOffset > 0));
+         if(nModels > 1)
+            SetOutputModels(writer, models, nModels);
+         if(pValues)
+            SetOutputPValues(writer);
+         if(ckptInterval >= 0.0)
+            lastCkpt = StatsTime();
+         if(summaryFormat &&
+            !StartSummaryFile(&summary, (infile[0] ? infile : "stdin"), 0))
+         {
+            fprintf(stderr, "hsubgroup Error: No memory for summary\n");
+            return(1);
+         }
+         
+         while((nchain=ReadSeqEntry(reader, seqs, MAXSEQ, id)) >= 0)
          {
+            /* Time since the last entry was finished is parsing        */
+            if(statsFormat)
+            {
+               stats.parseTime += StatsLap(&mark);
+               PerfLap(&perf, PERFSTAGE_PARSE);
+            }
+            PROBE2(batch_start, id, nchain);
+            
             for(i=0; i<nchain; i++)
             {
-               BOOL ok = FindHumanSubgroup(fpData, fullMatrix, seqs[i],
-                                           &class, &subGroup);
+               SUBGROUPRESULT results[MAXMODELS+1],
+                              work[MAXMODELS+1];
+               BOOL           ok;
+               
+               if(dnaFrames)
+                  SetOutputFrame(writer, BestFrame(models, nModels, seqs[i],
+                                                   dnaFrames, results,
+                                                   work));
+               else if(nModels > 1)
+                  ScoreSubgroupModels(models, nModels, seqs[i], results);
+               else
+                  FindHumanSubgroupResult(fpData, fullMatrix, seqs[i],
+                                          results);
+               if(statsFormat)
+               {
+                  AddChainStats(&stats, results, StatsLap(&mark));
+                  PerfLap(&perf, PERFSTAGE_SCORE);
+               }
+               
+               if(mutScan)
+               {
+                  MutationalScan(models[0], seqs[i], &scan);
+                  ok = WriteMutationalScan(out, id, i+1, models[0],
+                                           &scan,
+                                           ((format == OUTFORMAT_TSV) &&
+                                            !writer->headerDone));
+                  writer->headerDone = TRUE;
+               }
+               else if(hum != NULL)
+               {
+                  Humanise(hum, seqs[i]);
+                  ok = WriteHumanise(out, id, i+1, hum,
+                                     ((format == OUTFORMAT_TSV) &&
+                                      !writer->headerDone));
+                  writer->headerDone = TRUE;
+               }
+               else if(dom != NULL)
+               {
+                  ok = (DomainScan(dom, seqs[i]) &&
+                        WriteDomainScan(out, id, i+1, dom,
+                                        ((format == OUTFORMAT_TSV) &&
+                                         !writer->headerDone)));
+                  writer->headerDone = TRUE;
+               }
+               else if(summaryFormat)
+               {
+                  AddSummaryChain(&summary, results);
+                  ok = TRUE;
+               }
+               else if(nModels > 1)
+               {
+                  ok = WriteModelResults(writer, id, i+1, results);
+               }
+               else
+               {
+                  ok = WriteResult(writer, id, i+1, results);
+               }
                free(seqs[i]);
                if(!ok)
                {
-                  fprintf(stderr, "hsubgroup Error: Unable to read data \
-from data file (%s)\n", dataFile);
+                  fprintf(stderr, "hsubgroup Error: Unable to write \
+output\n");
+                  return(1);
+               }
+               if(statsFormat)
+               {
+                  stats.outputTime += StatsLap(&mark);
+                  PerfLap(&perf, PERFSTAGE_OUTPUT);
+               }
+            }
+            PROBE2(batch_end, id, nchain);
+
+            if((ckptInterval >= 0.0) &&
+               (StatsTime() - lastCkpt >= ckptInterval))
+            {
+               if(!SaveCheckpoint(ckptFile, &ckpt, writer, reader))
+               {
+                  fprintf(stderr, "hsubgroup Error: Unable to write \
+checkpoint (%s)\n", ckptFile);
                   return(1);
                }
+               lastCkpt = StatsTime();
+               if(statsFormat)
+               {
+                  stats.outputTime += StatsLap(&mark);
+                  PerfLap(&perf, PERFSTAGE_OUTPUT);
+               }
+            }
+         }
+         CloseSeqReader(reader);
+
+         if(!CloseOutputWriter(writer))
+         {
+            fprintf(stderr, "hsubgroup Error: Unable to write output\n");
+            return(1);
+         }
+         if(summaryFormat)
+         {
+            if(!WriteSummary(out, &summary, summaryFormat) || fflush(out))
+            {
+               fprintf(stderr, "hsubgroup Error: Unable to write \
+summary\n");
+               return(1);
             }
+            FreeSummary(&summary);
+         }
+
+         /* The run is complete so the checkpoint is no longer needed    */
+         if(ckptInterval >= 0.0)
+            remove(ckptFile);
+
+         for(i=1; i<nModels; i++)
+            FreeSubgroupModel(models[i]);
+         for(i=0; i<nModelSpecs; i++)
+            FreeSubgroupModel(modelSpecs[i].raw);
+         CloseHumanise(hum);
+         CloseDomainScan(dom);
+         FindSubgroupSetSplit(1);
+         
+         if(statsFormat)
+         {
+            stats.outputTime += StatsLap(&mark);
+            PerfLap(&perf, PERFSTAGE_OUTPUT);
+            WriteRunStats(stderr, &stats, statsFormat, mark - startTime);
+            if(perfCounters)
+            {
+               ClosePerfCounters(&perf);
+               WritePerfReport(stderr, &perf, &stats, statsFormat);
+            }
+            FreeRunStats(&stats);
          }
       }
    }
@@ -153,7 +663,15 @@ from data file (%s)\n", dataFile);
 /************************************************************************/
 /*>BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
                      char *dataFile, BOOL *verbose, BOOL *fullMatrix,
-                     BOOL *includeX, BOOL *doProduct)
+                     BOOL *includeX, BOOL *doProduct, int *format,
+                     int *topK, int *statsFormat, BOOL *perfCounters,
+                     int *shard, int *nShards, REAL *ckptInterval,
+                     BOOL *resume, POOLOPTIONS *poolOpts,
+                     MODELSPEC *modelSpecs, int *nModelSpecs,
+                     BOOL *mutScan, char *humTarget, REAL *humMargin,
+                     int *humMaxMut, REAL *domThreshold,
+                     int *dnaFrames, REAL *gapOpen, REAL *gapExtend,
+                     int *nSplit, BOOL *pValues, int *summaryFormat)
    ---------------------------------------------------------------------
    Input:   int    argc         Argument count
             char   **argv       Argument array
@@ -162,6 +680,38 @@ from data file (%s)\n", dataFile);
             char   *dataFile    Optional data file (or blank string)
             BOOL   *verbose     Verbose output from subgroup code
             BOOL   *fullMatrix  Data file is a full scoring matrix
+            BOOL   *includeX    Include X characters in the sequence
+            BOOL   *doProduct   Score as a product rather than a sum
+            int    *format      Output format (OUTFORMAT_*)
+            int    *topK        Number of subgroups to rank
+            int    *statsFormat Run statistics report (STATS_*)
+            BOOL   *perfCounters Report performance counters
+            int    *shard       Shard to process (1..nShards)
+            int    *nShards     Number of shards
+            REAL   *ckptInterval Seconds between checkpoints (-ve for
+                                none)
+            BOOL   *resume      Resume from a checkpoint
+            POOLOPTIONS *poolOpts Many-files options and input files
+            MODELSPEC *modelSpecs Additional models and configurations
+                                (MAXMODELS)
+            int    *nModelSpecs Number of additional models
+            BOOL   *mutScan     Write a mutational scan
+            char   *humTarget   Target subgroup for a humanisation 
+                                search (or blank string)
+            REAL   *humMargin   Margin for the target to win by
+            int    *humMaxMut   Most mutations to try
+            REAL   *domThreshold Score for a domain in a domain scan
+                                (-ve for no scan)
+            int    *dnaFrames   Frames to translate nucleotide input
+                                in (0 for protein input)
+            REAL   *gapOpen     Gap opening penalty (-ve for ungapped
+                                scoring)
+            REAL   *gapExtend   Gap extension penalty
+            int    *nSplit      Threads to share the scoring of each
+                                chain (0 for none)
+            BOOL   *pValues     Write p-values and E-values
+            int    *summaryFormat Summary report in place of the results
+                                (SUMMARY_* or 0 for none)
    Returns: BOOL                Success?
 
    Parse the command line
@@ -170,17 +720,68 @@ from data file (%s)\n", dataFile);
    26.11.18 Added data file and verbose options
    05.02.19 Added -f
    13.02.19 Added -x and -p
+   18.10.26 Added -F
+   18.10.26 Added -k
+   18.10.26 Added --stats
+   18.10.26 Added --perf
+   18.10.26 Added --shard
+   18.10.26 Added --checkpoint and --resume
+   18.10.26 Added -L, -O, -C and -j. Any number of input files may be
+            given in many-files mode
+   18.10.26 Added --watch
+   18.10.26 Added -m and -mf
+   18.10.26 Added --config
+   18.10.26 Added --mutscan
+   18.10.26 Added --humanise, --margin and --maxmut
+   18.10.26 Added --domains
+   18.10.26 Added --dna
+   18.10.26 Added --gapped
+   18.10.26 Added --split
+   18.10.26 Added --pvalues
+   18.10.26 Added --cascade
+   18.10.26 Added --summary
+   18.10.26 Removed --cascade
 */
 BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
                   char *dataFile, BOOL *verbose, BOOL *fullMatrix,
-                  BOOL *includeX, BOOL *doProduct)
+                  BOOL *includeX, BOOL *doProduct, int *format,
+                  int *topK, int *statsFormat, BOOL *perfCounters,
+                  int *shard, int *nShards, REAL *ckptInterval,
+                  BOOL *resume, POOLOPTIONS *poolOpts,
+                  MODELSPEC *modelSpecs, int *nModelSpecs,
+                  BOOL *mutScan, char *humTarget, REAL *humMargin,
+                  int *humMaxMut, REAL *domThreshold, int *dnaFrames,
+                  REAL *gapOpen, REAL *gapExtend, int *nSplit,
+                  BOOL *pValues, int *summaryFormat)
 
 {
+   int i;
+   
    argc--;
    argv++;
 
    infile[0] = outfile[0]  = dataFile[0] = '\0';
    *verbose  = *fullMatrix = *includeX   = *doProduct = FALSE;
+   *format   = OUTFORMAT_TEXT;
+   *topK     = DEFAULTTOPK;
+   *statsFormat = STATS_NONE;
+   *perfCounters = FALSE;
+   *shard    = *nShards = 1;
+   *ckptInterval = -1.0;
+   *resume   = FALSE;
+   *nModelSpecs = 0;
+   *mutScan  = FALSE;
+   humTarget[0] = '\0';
+   *humMargin = 0.0;
+   *humMaxMut = DEFAULTHUMMUT;
+   *domThreshold = -1.0;
+   *dnaFrames = 0;
+   *gapOpen   = -1.0;
+   *gapExtend = DEFAULTGAPEXTEND;
+   *nSplit    = 0;
+   *pValues   = FALSE;
+   *summaryFormat = 0;
+   InitPoolOptions(poolOpts);
    
    while(argc)
    {
@@ -206,6 +807,216 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
          case 'p':
             *doProduct = TRUE;
             break;
+         case 'F':
+            argc--; argv++;
+            if(!argc)
+               return(FALSE);
+            if((*format = ParseOutputFormat(argv[0])) < 0)
+               return(FALSE);
+            break;
+         case 'k':
+            argc--; argv++;
+            if(!argc)
+               return(FALSE);
+            if((sscanf(argv[0], "%d", topK) != 1) ||
+               (*topK < 1) || (*topK > MAXTOPK))
+               return(FALSE);
+            break;
+         case 'm':
+            if((*nModelSpecs >= MAXMODELS) ||
+               (argv[0][2] && strcmp(argv[0]+2, "f")))
+               return(FALSE);
+            modelSpecs[*nModelSpecs].fullMatrix = (argv[0][2] == 'f');
+            modelSpecs[*nModelSpecs].config     = FALSE;
+            argc--; argv++;
+            if(!argc)
+               return(FALSE);
+            strcpy(modelSpecs[(*nModelSpecs)++].file, argv[0]);
+            break;
+         case 'j':
+            argc--; argv++;
+            if(!argc)
+               return(FALSE);
+            if((sscanf(argv[0], "%d", &(poolOpts->nThreads)) != 1) ||
+               (poolOpts->nThreads < 1) ||
+               (poolOpts->nThreads > MAXTHREADS))
+               return(FALSE);
+            break;
+         case 'L':
+            argc--; argv++;
+            if(!argc)
+               return(FALSE);
+            strcpy(poolOpts->listFile, argv[0]);
+            poolOpts->active = TRUE;
+            break;
+         case 'O':
+            argc--; argv++;
+            if(!argc)
+               return(FALSE);
+            strcpy(poolOpts->outDir, argv[0]);
+            poolOpts->active = TRUE;
+            break;
+         case 'C':
+            argc--; argv++;
+            if(!argc)
+               return(FALSE);
+            strcpy(poolOpts->combined, argv[0]);
+            poolOpts->active = TRUE;
+            break;
+         case '-':
+            if(!strcmp(argv[0], "--stats"))
+            {
+               *statsFormat = STATS_TEXT;
+            }
+            else if(!strncmp(argv[0], "--stats=", 8))
+            {
+               if((*statsFormat = ParseStatsFormat(argv[0]+8)) < 0)
+                  return(FALSE);
+            }
+            else if(!strcmp(argv[0], "--perf"))
+            {
+               *perfCounters = TRUE;
+            }
+            else if(!strcmp(argv[0], "--shard"))
+            {
+               argc--; argv++;
+               if(!argc || !ParseShard(argv[0], shard, nShards))
+                  return(FALSE);
+            }
+            else if(!strncmp(argv[0], "--shard=", 8))
+            {
+               if(!ParseShard(argv[0]+8, shard, nShards))
+                  return(FALSE);
+            }
+            else if(!strcmp(argv[0], "--checkpoint"))
+            {
+               *ckptInterval = DEFAULTCKPTINTERVAL;
+            }
+            else if(!strncmp(argv[0], "--checkpoint=", 13))
+            {
+               if((sscanf(argv[0]+13, "%lf", ckptInterval) != 1) ||
+                  (*ckptInterval < 0.0))
+                  return(FALSE);
+            }
+            else if(!strcmp(argv[0], "--resume"))
+            {
+               *resume = TRUE;
+            }
+            else if(!strcmp(argv[0], "--watch"))
+            {
+               argc--; argv++;
+               if(!argc)
+                  return(FALSE);
+               strcpy(poolOpts->watchDir, argv[0]);
+               poolOpts->active = TRUE;
+            }
+            else if(!strncmp(argv[0], "--watch=", 8))
+            {
+               strcpy(poolOpts->watchDir, argv[0]+8);
+               poolOpts->active = TRUE;
+            }
+            else if(!strcmp(argv[0], "--mutscan"))
+            {
+               *mutScan = TRUE;
+            }
+            else if(!strcmp(argv[0], "--humanise"))
+            {
+               argc--; argv++;
+               if(!argc)
+                  return(FALSE);
+               strcpy(humTarget, argv[0]);
+            }
+            else if(!strncmp(argv[0], "--humanise=", 11))
+            {
+               strcpy(humTarget, argv[0]+11);
+            }
+            else if(!strncmp(argv[0], "--margin=", 9))
+            {
+               if((sscanf(argv[0]+9, "%lf", humMargin) != 1) ||
+                  (*humMargin < 0.0))
+                  return(FALSE);
+            }
+            else if(!strncmp(argv[0], "--maxmut=", 9))
+            {
+               if((sscanf(argv[0]+9, "%d", humMaxMut) != 1) ||
+                  (*humMaxMut < 0) || (*humMaxMut > MAXHUMMUT))
+                  return(FALSE);
+            }
+            else if(!strcmp(argv[0], "--domains"))
+            {
+               *domThreshold = DEFAULTDOMAINSCORE;
+            }
+            else if(!strncmp(argv[0], "--domains=", 10))
+            {
+               if((sscanf(argv[0]+10, "%lf", domThreshold) != 1) ||
+                  (*domThreshold < 0.0))
+                  return(FALSE);
+            }
+            else if(!strcmp(argv[0], "--dna"))
+            {
+               *dnaFrames = DNAFRAMES_ALL;
+            }
+            else if(!strncmp(argv[0], "--dna=", 6))
+            {
+               if((sscanf(argv[0]+6, "%d", dnaFrames) != 1) ||
+                  ((*dnaFrames != DNAFRAMES_FORWARD) &&
+                   (*dnaFrames != DNAFRAMES_ALL)))
+                  return(FALSE);
+            }
+            else if(!strcmp(argv[0], "--gapped"))
+            {
+               *gapOpen   = DEFAULTGAPOPEN;
+               *gapExtend = DEFAULTGAPEXTEND;
+            }
+            else if(!strncmp(argv[0], "--gapped=", 9))
+            {
+               if((sscanf(argv[0]+9, "%lf,%lf", gapOpen, gapExtend) != 2) ||
+                  (*gapOpen < 0.0) || (*gapExtend < 0.0))
+                  return(FALSE);
+            }
+            else if(!strcmp(argv[0], "--split"))
+            {
+               *nSplit = DefaultThreads();
+            }
+            else if(!strncmp(argv[0], "--split=", 8))
+            {
+               if((sscanf(argv[0]+8, "%d", nSplit) != 1) ||
+                  (*nSplit < 1) || (*nSplit > MAXSPLIT))
+                  return(FALSE);
+            }
+            else if(!strcmp(argv[0], "--pvalues"))
+            {
+               *pValues = TRUE;
+            }
+            else if(!strcmp(argv[0], "--summary"))
+            {
+               *summaryFormat = SUMMARY_TSV;
+            }
+            else if(!strncmp(argv[0], "--summary=", 10))
+            {
+               if((*summaryFormat = ParseSummaryFormat(argv[0]+10)) < 0)
+                  return(FALSE);
+            }
+            else if(!strcmp(argv[0], "--config"))
+            {
+               argc--; argv++;
+               if(!argc || (*nModelSpecs >= MAXMODELS) ||
+                  !ParseConfig(argv[0], &(modelSpecs[*nModelSpecs])))
+                  return(FALSE);
+               (*nModelSpecs)++;
+            }
+            else if(!strncmp(argv[0], "--config=", 9))
+            {
+               if((*nModelSpecs >= MAXMODELS) ||
+                  !ParseConfig(argv[0]+9, &(modelSpecs[*nModelSpecs])))
+                  return(FALSE);
+               (*nModelSpecs)++;
+            }
+            else
+            {
+               return(FALSE);
+            }
+            break;
          default:
             return(FALSE);
             break;
@@ -213,9 +1024,17 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
       }
       else
       {
-         /* Check that there are only 1 or 2 arguments left             */
-         if(argc > 2)
-            return(FALSE);
+         /* In many-files mode all the remaining arguments are inputs   */
+         if(poolOpts->active || (argc > 2))
+         {
+            poolOpts->active = TRUE;
+            for(; argc; argc--, argv++)
+            {
+               if(!AddFileName(&(poolOpts->inputs), argv[0]))
+                  return(FALSE);
+            }
+            break;
+         }
          
          /* Copy the first to infile                                    */
          strcpy(infile, argv[0]);
@@ -226,16 +1045,302 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
          if(argc)
             strcpy(outfile, argv[0]);
             
-         return(TRUE);
+         break;
       }
       argc--;
       argv++;
    }
+
+   /* The counters are reported with the run statistics                 */
+   if(*perfCounters && (*statsFormat == STATS_NONE))
+      *statsFormat = STATS_TEXT;
+
+   /* Resuming carries on checkpointing. Both need named files          */
+   if(*resume && (*ckptInterval < 0.0))
+      *ckptInterval = DEFAULTCKPTINTERVAL;
+   if((*ckptInterval >= 0.0) && ((infile[0] == '\0') ||
+                                 (outfile[0] == '\0')))
+      return(FALSE);
+
+   /* Many-files mode needs some input and doesn't support the options
+      that work on a single file. Binary records can't be tagged. Watch
+      mode takes its input from the directory and writes one output
+      per input
+   */
+   if(poolOpts->active)
+   {
+      BOOL haveInput = ((poolOpts->inputs.nNames > 0) ||
+                        (poolOpts->listFile[0] != '\0'));
+      
+      if((poolOpts->watchDir[0] ? (haveInput || poolOpts->combined[0])
+                                : !haveInput)                        ||
+         (*nShards > 1) || (*ckptInterval >= 0.0) || *perfCounters ||
+         *nSplit || *pValues ||
+         (poolOpts->combined[0] && (*format == OUTFORMAT_BINARY)))
+         return(FALSE);
+      if(poolOpts->nThreads == 0)
+         poolOpts->nThreads = DefaultThreads();
+   }
+
+   /* Models from -m and -mf are scored in the same way as the main 
+      model
+   */
+   for(i=0; i<*nModelSpecs; i++)
+   {
+      if(!modelSpecs[i].config)
+      {
+         modelSpecs[i].includeX  = *includeX;
+         modelSpecs[i].doProduct = *doProduct;
+      }
+   }
+
+   /* Several models are only scored in a single run. Binary records
+      have no room for the model and the checkpoint does not record
+      the models
+   */
+   if(*nModelSpecs &&
+      (poolOpts->active || (*format == OUTFORMAT_BINARY) ||
+       (*ckptInterval >= 0.0)))
+      return(FALSE);
+
+   /* A mutational scan, humanisation search or domain scan is a table
+      for one model from a single run
+   */
+   if((*mutScan + (humTarget[0] != '\0') + (*domThreshold >= 0.0)) > 1)
+      return(FALSE);
+   if((*mutScan || humTarget[0] || (*domThreshold >= 0.0)) &&
+      (*nModelSpecs || poolOpts->active || (*ckptInterval >= 0.0) ||
+       *pValues ||
+       ((*format != OUTFORMAT_TEXT) && (*format != OUTFORMAT_TSV))))
+      return(FALSE);
+
+   /* Product scores are never gapped and the scans work on ungapped
+      offsets
+   */
+   if((*gapOpen >= 0.0) &&
+      (*doProduct || *mutScan || humTarget[0] || (*domThreshold >= 0.0)))
+      return(FALSE);
+
+   /* Nucleotide input is only translated for normal scoring in a single
+      run. Binary records have no room for the frame and the checkpoint
+      does not record it
+   */
+   if(*dnaFrames &&
+      (*mutScan || humTarget[0] || (*domThreshold >= 0.0) ||
+       poolOpts->active || (*format == OUTFORMAT_BINARY) ||
+       (*ckptInterval >= 0.0)))
+      return(FALSE);
+
+   /* Binary records have no room for p-values                          */
+   if(*pValues && (*format == OUTFORMAT_BINARY))
+      return(FALSE);
+
+   /* The summary replaces the results of normal scoring for one model.
+      In many-files mode it is written to standard output so there are
+      no output files. The checkpoint can't record it
+   */
+   if(*summaryFormat &&
+      (*mutScan || humTarget[0] || (*domThreshold >= 0.0) ||
+       *nModelSpecs || *pValues || (*ckptInterval >= 0.0) ||
+       (*format == OUTFORMAT_BINARY) || poolOpts->watchDir[0] ||
+       poolOpts->outDir[0] || poolOpts->combined[0]))
+      return(FALSE);
+   
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>BOOL ParseShard(char *spec, int *shard, int *nShards)
+   -----------------------------------------------------
+   Input:   char   *spec        Shard as i/N
+   Output:  int    *shard       Shard number (1..N)
+            int    *nShards     Number of shards (N)
+   Returns: BOOL                Valid specification
+
+   18.10.26 Original   By: ACRM
+*/
+BOOL ParseShard(char *spec, int *shard, int *nShards)
+{
+   char junk;
    
+   if((sscanf(spec, "%d/%d%c", shard, nShards, &junk) != 2) ||
+      (*nShards < 1) || (*shard < 1) || (*shard > *nShards))
+      return(FALSE);
    return(TRUE);
 }
 
 
+/************************************************************************/
+/*>BOOL ParseConfig(char *text, MODELSPEC *modelSpec)
+   --------------------------------------------------
+   Input:   char      *text         Configuration as flags[:file]
+   Output:  MODELSPEC *modelSpec    The configuration
+   Returns: BOOL                    Valid specification
+
+   The flags are any of x (include X), p (product) and f (file is a 
+   full matrix) or - for none. Without a file the main data is used.
+
+   18.10.26 Original   By: ACRM
+*/
+BOOL ParseConfig(char *text, MODELSPEC *modelSpec)
+{
+   char *chp;
+   int  nFlags;
+
+   modelSpec->config     = TRUE;
+   modelSpec->includeX   = FALSE;
+   modelSpec->doProduct  = FALSE;
+   modelSpec->fullMatrix = FALSE;
+   modelSpec->file[0]    = '\0';
+   
+   for(chp=text; *chp && (*chp != ':'); chp++)
+   {
+      switch(*chp)
+      {
+      case 'x':
+         modelSpec->includeX = TRUE;
+         break;
+      case 'p':
+         modelSpec->doProduct = TRUE;
+         break;
+      case 'f':
+         modelSpec->fullMatrix = TRUE;
+         break;
+      case '-':
+         break;
+      default:
+         return(FALSE);
+      }
+   }
+
+   if(((nFlags = (int)(chp - text)) == 0) || (nFlags >= MAXWORD))
+      return(FALSE);
+   strncpy(modelSpec->flags, text, nFlags);
+   modelSpec->flags[nFlags] = '\0';
+   
+   if(*chp == ':')
+      strcpy(modelSpec->file, chp+1);
+
+   /* A full matrix must be named                                       */
+   return(modelSpec->file[0] || !modelSpec->fullMatrix);
+}
+
+
+/************************************************************************/
+/*>int LoadExtraModels(MODELSPEC *modelSpecs, int nModelSpecs,
+                       char *dataFile, BOOL fullMatrix,
+                       SUBGROUPMODEL **models)
+   ------------------------------------------------------------
+   Input:   MODELSPEC *modelSpecs    Models from the command line
+            int       nModelSpecs    Number of models
+            char      *dataFile      Main data file (or blank string)
+            BOOL      fullMatrix     Main data file is a full matrix
+   Output:  SUBGROUPMODEL **models   The loaded models
+   Returns: int                      Number of models loaded (0 on 
+                                     error)
+
+   Loads the models given with -m, -mf and --config. The name builtin
+   gives the hardcoded data. Each file is only read once; every model
+   is configured from a copy of the raw data.
+
+   18.10.26 Original   By: ACRM
+   18.10.26 Handles configurations and reads each file once
+*/
+int LoadExtraModels(MODELSPEC *modelSpecs, int nModelSpecs,
+                    char *dataFile, BOOL fullMatrix,
+                    SUBGROUPMODEL **models)
+{
+   int           i, j;
+   FILE          *fp;
+   SUBGROUPMODEL *raw;
+   char          label[MAXBUFF];
+   
+   for(i=0; i<nModelSpecs; i++)
+   {
+      MODELSPEC *spec = &(modelSpecs[i]);
+
+      spec->raw = NULL;
+      if(spec->file[0] == '\0')
+      {
+         strcpy(spec->file, dataFile[0] ? dataFile : BUILTINMODEL);
+         spec->fullMatrix = (dataFile[0] && fullMatrix);
+      }
+      if(!strcmp(spec->file, BUILTINMODEL))
+         spec->fullMatrix = FALSE;
+
+      /* Look for an earlier use of the same data                       */
+      raw = NULL;
+      for(j=0; j<i; j++)
+      {
+         if(!strcmp(modelSpecs[j].file, spec->file) &&
+            (modelSpecs[j].fullMatrix == spec->fullMatrix))
+         {
+            raw = modelSpecs[j].raw;
+            break;
+         }
+      }
+
+      if(raw == NULL)
+      {
+         fp = NULL;
+         if(strcmp(spec->file, BUILTINMODEL) &&
+            ((fp=fopen(spec->file, "r"))==NULL))
+         {
+            fprintf(stderr, "hsubgroup Error: Unable to open model \
+file (%s)\n", spec->file);
+            return(0);
+         }
+         raw = spec->raw = ReadSubgroupModel(fp, spec->fullMatrix, "");
+         if(fp != NULL)
+            fclose(fp);
+         if(raw == NULL)
+         {
+            fprintf(stderr, "hsubgroup Error: Unable to read data from \
+model file (%s)\n", spec->file);
+            return(0);
+         }
+      }
+
+      if(spec->config)
+         sprintf(label, "%s:%s", spec->flags, ModelLabel(spec->file));
+      else
+         strcpy(label, ModelLabel(spec->file));
+      
+      if((models[i] = CopySubgroupModel(raw, label))==NULL)
+      {
+         fprintf(stderr, "hsubgroup Error: No memory for models\n");
+         return(0);
+      }
+      ConfigureSubgroupModel(models[i], spec->includeX, spec->doProduct);
+   }
+   return(nModelSpecs);
+}
+
+
+/************************************************************************/
+/*>char *ModelLabel(char *fileName)
+   --------------------------------
+   Input:   char   *fileName    Model file name
+   Returns: char *              The name without its directory or
+                                extension (static)
+
+   18.10.26 Original   By: ACRM
+*/
+char *ModelLabel(char *fileName)
+{
+   static char label[MAXBUFF];
+   char        *chp;
+
+   if((chp = strrchr(fileName, '/')) != NULL)
+      fileName = chp+1;
+   strcpy(label, fileName);
+   if(((chp = strrchr(label, '.')) != NULL) && (chp != label))
+      *chp = '\0';
+   return(label);
+}
+
+
 /************************************************************************/
 /*>void Usage(void)
    ----------------
@@ -249,25 +1354,233 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
    12.02.19 V3.0
    13.02.19 V3.1
    05.04.19 V3.2
+   18.10.26 V3.3
+   18.10.26 V3.4
+   18.10.26 V3.5
+   18.10.26 V3.6
+   18.10.26 V3.7
+   18.10.26 V3.8
+   18.10.26 V3.9
+   18.10.26 V3.10
+   18.10.26 V3.11
+   18.10.26 V3.12
+   18.10.26 V3.13
+   18.10.26 V3.14
+   18.10.26 V3.15
+   18.10.26 V3.16
+   18.10.26 V3.17
+   18.10.26 V3.18
+   18.10.26 V3.19
+   18.10.26 V3.20
+   18.10.26 V3.21
+   18.10.26 V3.22
+   18.10.26 V3.23
+   18.10.26 V3.24
+   18.10.26 V3.25
+   18.10.26 V3.26
 */
 void Usage(void)
 {
-   fprintf(stderr,"\nhsubgroup V3.2 (c) 1997-2019, Andrew C.R. Martin, \
+   fprintf(stderr,"\nhsubgroup V3.26 (c) 1997-2026, Andrew C.R. Martin, \
 UCL\n");
    fprintf(stderr,"Original subgroup assignment code (c) Sophie Deret, \
 Necker Entants Malade, Paris\n");
    fprintf(stderr,"   Used with permission\n");
    
    fprintf(stderr,"\nUsage: hsubgroup [-x][-p][-d datafile [-f]][-v] \
-[in.pir [out.txt]]\n");
+[-F format]\n");
+   fprintf(stderr,"                 [-k K] [--stats[=json]] [--perf] \
+[--shard i/N]\n");
+   fprintf(stderr,"                 [--checkpoint[=secs]] [--resume] \
+[-m[f] modelfile ...]\n");
+   fprintf(stderr,"                 [--config flags[:modelfile] ...] \
+[--mutscan]\n");
+   fprintf(stderr,"                 [--humanise subgroup [--margin=m] \
+[--maxmut=n]]\n");
+   fprintf(stderr,"                 [--domains[=score]] [--dna[=3]] \
+[--gapped[=open,extend]]\n");
+   fprintf(stderr,"                 [--split[=threads]] [--pvalues] \
+[--summary[=json]]\n");
+   fprintf(stderr,"                 [in.pir [out.txt]]\n");
+   fprintf(stderr,"       hsubgroup [options] [-j threads] [-O outdir | \
+-C combined.out]\n");
+   fprintf(stderr,"                 [-L filelist] [in1.pir in2.pir \
+...]\n");
+   fprintf(stderr,"       hsubgroup [options] [-j threads] [-O outdir] \
+--watch dir\n");
 
    fprintf(stderr,"       -x Include X characters as part of sequence\n");
    fprintf(stderr,"       -p Calculate score as a product rather than \
 a sum\n");
-   fprintf(stderr,"       -d Specify data file\n");
+   fprintf(stderr,"       -d Specify data file. It may have any number of \
+subgroups and\n");
+   fprintf(stderr,"          the profiles any number of positions\n");
    fprintf(stderr,"       -f Data file is a full matrix\n");
    fprintf(stderr,"       -v Verbose - shows best and 2nd best scores\n");
    fprintf(stderr,"          and the second best match\n");
+   fprintf(stderr,"       -F Output format: text (default), tsv, json \
+or binary\n");
+   fprintf(stderr,"          tsv, json and binary include the sequence \
+ID and scores\n");
+   fprintf(stderr,"       -k Rank the best K distinct subgroups (1-%d, \
+default %d)\n", MAXTOPK, DEFAULTTOPK);
+   fprintf(stderr,"          Shown with -v or in tsv, json and binary \
+output\n");
+   fprintf(stderr,"       --stats Report counts, time in each stage, \
+per-chain latency\n");
+   fprintf(stderr,"          and peak memory on standard error as text \
+or JSON\n");
+   fprintf(stderr,"       --perf Add hardware performance counters for \
+each stage to the\n");
+   fprintf(stderr,"          --stats report (Linux only; software \
+counters or timing only\n");
+   fprintf(stderr,"          if they are not available)\n");
+   fprintf(stderr,"       --shard Process shard i of N (1-N). The input \
+file is split into\n");
+   fprintf(stderr,"          N byte ranges and only entries whose headers \
+start in range i\n");
+   fprintf(stderr,"          are processed. Join the outputs in order \
+with hsmerge\n");
+   fprintf(stderr,"       --checkpoint Flush the output and record the \
+position in out.txt%s\n", CKPTSUFFIX);
+   fprintf(stderr,"          every secs seconds (default %.0f). Needs \
+named input and output\n", DEFAULTCKPTINTERVAL);
+   fprintf(stderr,"          files. The record is removed when the run \
+completes\n");
+   fprintf(stderr,"       --resume Truncate the output to the last \
+checkpoint and carry on from\n");
+   fprintf(stderr,"          there. Starts from the beginning if there \
+is no checkpoint. The\n");
+   fprintf(stderr,"          input, data file and scoring and output \
+options must be the same\n");
+   fprintf(stderr,"          as those of the interrupted run\n");
+   fprintf(stderr,"       -m Also score against another model. Use -mf \
+if it is a full\n");
+   fprintf(stderr,"          matrix or '%s' for the hardcoded data. Each \
+chain gets a\n", BUILTINMODEL);
+   fprintf(stderr,"          result for every model (labelled with the \
+file name) and the\n");
+   fprintf(stderr,"          best scoring model is marked as the winner, \
+unless sums and\n");
+   fprintf(stderr,"          products (-p) are mixed as their scores \
+can't be compared. Up\n");
+   fprintf(stderr,"          to %d may be given. Not with binary output, \
+many-files mode or\n", MAXMODELS);
+   fprintf(stderr,"          --checkpoint\n");
+   fprintf(stderr,"       --config Also score with another configuration. \
+flags are any of\n");
+   fprintf(stderr,"          x (as -x), p (as -p) and f (modelfile is a \
+full matrix) or -\n");
+   fprintf(stderr,"          for none. Without modelfile the main data is \
+used. Results are\n");
+   fprintf(stderr,"          labelled flags:modelfile and written as \
+for -m\n");
+   fprintf(stderr,"       --mutscan Write a table of the best subgroup, \
+score and margin over\n");
+   fprintf(stderr,"          the second best for every point mutation \
+in the first %d\n", SCANWINDOW);
+   fprintf(stderr,"          residues of each chain, with whether the \
+best subgroup changed\n");
+   fprintf(stderr,"          and the change in margin. Text or tsv \
+(with a header) only\n");
+   fprintf(stderr,"       --humanise Find the fewest mutations in the \
+first %d residues\n", SCANWINDOW);
+   fprintf(stderr,"          that make subgroup (an ID or exact name) \
+the best match by at\n");
+   fprintf(stderr,"          least --margin (default 0). Up to --maxmut \
+mutations (default\n");
+   fprintf(stderr,"          %d, max %d) are tried. The best %d sets are \
+ranked by margin. Text\n", DEFAULTHUMMUT, MAXHUMMUT, MAXHUMSOLUTIONS);
+   fprintf(stderr,"          or tsv only. Most chains take a few \
+milliseconds; a chain needing\n");
+   fprintf(stderr,"          more than %ld search nodes is given up \
+and written as incomplete\n", MAXHUMNODES);
+   fprintf(stderr,"       --domains Find every variable domain along \
+each chain (for scFvs\n");
+   fprintf(stderr,"          and fusions) scoring at least score \
+(default %.0f). Writes the\n", DEFAULTDOMAINSCORE);
+   fprintf(stderr,"          start, chain type, subgroup, score and \
+margin of each. Domains\n");
+   fprintf(stderr,"          start at least %d residues apart. Text or \
+tsv only\n", DOMAINLENGTH);
+   fprintf(stderr,"       --dna Input is nucleotide. Each chain is \
+translated in all six\n");
+   fprintf(stderr,"          frames (--dna=3 for the three forward \
+frames) and assigned from\n");
+   fprintf(stderr,"          the best scoring frame (1 to 3 forward, -1 \
+to -3 reverse) which\n");
+   fprintf(stderr,"          is written before the result. Only the \
+first %d codons of each\n", MAXFRAMECODONS);
+   fprintf(stderr,"          frame are used (more for longer profiles). \
+Not with binary\n");
+   fprintf(stderr,"          output, many-files mode or --checkpoint\n");
+   fprintf(stderr,"       --gapped Also align the start of each chain to \
+each subgroup allowing\n");
+   fprintf(stderr,"          gaps, so an insertion or deletion doesn't \
+put the rest out of\n");
+   fprintf(stderr,"          register. The better of this and the \
+ungapped score is used.\n");
+   fprintf(stderr,"          Gap penalties (default %.1f to open, %.1f \
+to extend) are in the\n", DEFAULTGAPOPEN, DEFAULTGAPEXTEND);
+   fprintf(stderr,"          units of the data file scores. Not with -p \
+or the scans\n");
+   fprintf(stderr,"       --split Share the subgroups of each chain \
+between threads (default:\n");
+   fprintf(stderr,"          number of CPUs) to cut the time for a \
+single chain. Used for\n");
+   fprintf(stderr,"          --gapped and for models of 256 or \
+more subgroups. Results are\n");
+   fprintf(stderr,"          the same as without it\n");
+   fprintf(stderr,"       --pvalues Add the p-value and E-value of the \
+best match: the chance\n");
+   fprintf(stderr,"          of a random chain scoring as well against \
+the whole profile and\n");
+   fprintf(stderr,"          the number expected from all subgroups and \
+offsets. Written at\n");
+   fprintf(stderr,"          the end of each record. Not with binary \
+output or the scans.\n");
+   fprintf(stderr,"          With --gapped the values are too small as \
+the chance scores are\n");
+   fprintf(stderr,"          ungapped\n");
+   fprintf(stderr,"       --summary Write one report in place of the \
+result for each chain:\n");
+   fprintf(stderr,"          the chains won by each subgroup, of each \
+chain type and in each\n");
+   fprintf(stderr,"          input file with the mean and 10th, 50th \
+and 90th percentile\n");
+   fprintf(stderr,"          scores, mean margin over the second best \
+and a histogram of the\n");
+   fprintf(stderr,"          margins. As tsv (default) or json. In \
+many-files mode the report\n");
+   fprintf(stderr,"          for all the files goes to standard output. \
+Not with -m, --config,\n");
+   fprintf(stderr,"          --pvalues, --checkpoint, binary output, \
+the scans, -O, -C or\n");
+   fprintf(stderr,"          --watch\n");
+   fprintf(stderr,"\n       Many-files mode is used with -L, -O, -C or \
+more than two files.\n");
+   fprintf(stderr,"       The model is loaded once and the files are \
+processed in parallel.\n");
+   fprintf(stderr,"       -L File of input file names, one per line \
+(- for standard input)\n");
+   fprintf(stderr,"       -O Directory for the outputs (default \
+alongside each input). Each\n");
+   fprintf(stderr,"          output is the input name with .hsg, .tsv, \
+.jsonl or .hsgb added\n");
+   fprintf(stderr,"       -C Write all results to one file, tagged with \
+the input file name\n");
+   fprintf(stderr,"          (not binary)\n");
+   fprintf(stderr,"       -j Number of worker threads (default: number \
+of CPUs)\n");
+   fprintf(stderr,"          --shard, --checkpoint, --perf, --split and \
+--pvalues are not\n");
+   fprintf(stderr,"          available\n");
+   fprintf(stderr,"       --watch Keep running and process files as \
+they are renamed into dir.\n");
+   fprintf(stderr,"          Outputs go to dir/%s (or -O) and each input \
+is then moved\n", WATCHDONE);
+   fprintf(stderr,"          to dir/%s or dir/%s. Stop with SIGINT or \
+SIGTERM\n", WATCHDONE, WATCHFAILED);
    fprintf(stderr,"\nAssigns sub-group information for antibody \
 sequences\n\n");
 }
@@ -0,0 +1,1043 @@
+/*************************************************************************
+
+   Program:    hsubgroup
+   File:       humanise.c
+
+   Version:    V3.26
+   Date:       18.10.26
+   Function:   Search for minimal mutations giving a target subgroup
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+
+   Description:
+   ============
+   Finds the smallest sets of point mutations in the first SCANWINDOW
+   residues of a chain that make a target subgroup the best match with
+   its score at least a given margin above the next subgroup. Mutations
+   are only made to residues the target prefers at some offset: the
+   most and second most common residue for the top-2 data or the best
+   scoring residue for a full matrix.
+
+   The search is iterative deepening on the number of mutations so the
+   first sets found are minimal; all sets of that size are ranked by 
+   margin. Within each depth it is a branch-and-bound over positions in
+   increasing order, working on the score sums kept by ScanParent(). As
+   positions after the last one mutated still have the parent residue,
+   the largest gains the target could still make and the largest 
+   losses any other subgroup could suffer can be tabulated once per
+   chain. At each node these give an upper bound on the target's score
+   and a lower bound on the best of the others at every offset. The
+   branch is dropped if the margin can't be reached. Where X is not
+   scored, mutating it adds to the maximum score too. That can only
+   lower the target's score so its bound holds; the others' bounds
+   also add the largest such additions to the maximum score. Scores
+   are never negative so both bounds are safe. The last mutation is
+   checked against the bounds using the candidate's own change before
+   the mutant is scored. A chain that takes more than MAXHUMNODES
+   nodes is given up and reported as incomplete.
+
+   Sums are updated by adding and subtracting terms so candidate sets
+   are confirmed by scoring the mutant sequence normally; the score
+   and margin reported are from that.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V3.15 18.10.26   Original
+   V3.26 18.10.26   Tighter bounds where X is not scored, the last
+                    mutation is checked before scoring and searches that
+                    give up after finding sets are marked
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "bioplib/MathType.h"
+#include "bioplib/SysDefs.h"
+#include "subgroup.h"
+#include "mutscan.h"
+#include "humanise.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define ILETTER(x) ((int)(x)-65)
+#define HUMTOL     1.0e-6   /* Slack before confirming a candidate set  */
+
+/* Index of the sums for the positions after L (-1 for all)             */
+#define SUMINDEX(L, r) ((((L)+1) * (MAXHUMMUT+1)) + (r))
+#define GAINSUM(hum, o, L, r)                                            \
+   ((hum)->gainSum[((o) * (SCANWINDOW+1) * (MAXHUMMUT+1)) + SUMINDEX(L, r)])
+/* Score and maximum score changes for candidate c at an offset        */
+#define DELTA(hum, c, o)                                                 \
+   ((hum)->delta + ((((c) * SCANOFFSETS) + (o)) * 2 *                    \
+                    (hum)->model->nSubGroups))
+#define LOSSSUM(hum, g, o, L, r)                                         \
+   ((hum)->lossSum[((((g) * SCANOFFSETS) + (o)) *                        \
+                    (SCANWINDOW+1) * (MAXHUMMUT+1)) + SUMINDEX(L, r)])
+#define XMAXSUM(hum, g, o, L, r)                                         \
+   ((hum)->xMaxSum[((((g) * SCANOFFSETS) + (o)) *                        \
+                    (SCANWINDOW+1) * (MAXHUMMUT+1)) + SUMINDEX(L, r)])
+
+/* What FillSums() tabulates                                            */
+#define SUMGAIN 0
+#define SUMLOSS 1
+#define SUMXMAX 2
+
+/************************************************************************/
+/* Prototypes
+*/
+static void FillSums(HUMANISE *hum, int sgNum, int offsetNum, int kind,
+                     REAL *sums);
+static void FindCandidates(HUMANISE *hum);
+static BOOL FillDeltas(HUMANISE *hum);
+static void Search(HUMANISE *hum, int last, int depth, int nMut);
+static BOOL Feasible(HUMANISE *hum, int last, int candNum, int nLeft);
+static void TryLeaf(HUMANISE *hum);
+static void TryLastMutation(HUMANISE *hum, int last, int depth);
+static BOOL LastMutationReaches(HUMANISE *hum, int candNum);
+static void ApplyMutation(HUMANISE *hum, int pos, int candNum, int sign);
+static REAL OffsetValue(HUMANISE *hum, int sgNum, int offsetNum);
+static void AddSolution(HUMANISE *hum, REAL score, REAL margin);
+static REAL NeededMargin(HUMANISE *hum);
+
+
+/************************************************************************/
+/*>HUMANISE *OpenHumanise(SUBGROUPMODEL *model, int target, REAL margin,
+                          int maxMut)
+   ---------------------------------------------------------------------
+*//**
+   \param[in]   model     The model
+   \param[in]   target    Target subgroup ID
+   \param[in]   margin    Margin the target must win by
+   \param[in]   maxMut    Largest set of mutations to try (up to 
+                          MAXHUMMUT)
+   \return                The search (NULL if no memory)
+
+-  18.10.26 Original   By: ACRM
+*/
+HUMANISE *OpenHumanise(SUBGROUPMODEL *model, int target, REAL margin,
+                       int maxMut)
+{
+   HUMANISE *hum;
+   long     nSums = (long)SCANOFFSETS * (SCANWINDOW+1) * (MAXHUMMUT+1);
+
+   if((hum = (HUMANISE *)malloc(sizeof(HUMANISE)))==NULL)
+      return(NULL);
+
+   hum->model    = model;
+   hum->target   = target;
+   hum->margin   = margin;
+   hum->maxMut   = (maxMut > MAXHUMMUT) ? MAXHUMMUT : maxMut;
+   hum->sequence = NULL;
+   hum->delta    = NULL;
+   hum->nDelta   = 0;
+   hum->gainSum  = (REAL *)malloc(nSums * sizeof(REAL));
+   hum->lossSum  = (REAL *)malloc(nSums * model->nSubGroups *
+                                  sizeof(REAL));
+   hum->xMaxSum  = (REAL *)malloc(nSums * model->nSubGroups *
+                                  sizeof(REAL));
+   if((hum->gainSum == NULL) || (hum->lossSum == NULL) ||
+      (hum->xMaxSum == NULL))
+   {
+      CloseHumanise(hum);
+      return(NULL);
+   }
+   return(hum);
+}
+
+
+/************************************************************************/
+/*>void CloseHumanise(HUMANISE *hum)
+   ---------------------------------
+*//**
+   \param[in]   hum       The search
+
+-  18.10.26 Original   By: ACRM
+*/
+void CloseHumanise(HUMANISE *hum)
+{
+   if(hum != NULL)
+   {
+      if(hum->gainSum != NULL)
+         free(hum->gainSum);
+      if(hum->lossSum != NULL)
+         free(hum->lossSum);
+      if(hum->xMaxSum != NULL)
+         free(hum->xMaxSum);
+      if(hum->sequence != NULL)
+         free(hum->sequence);
+      if(hum->delta != NULL)
+         free(hum->delta);
+      free(hum);
+   }
+}
+
+
+/************************************************************************/
+/*>int HumaniseTarget(SUBGROUPMODEL *model, char *text)
+   ----------------------------------------------------
+*//**
+   \param[in]   model     The model
+   \param[in]   text      Subgroup ID or exact name
+   \return                Subgroup ID (-1 if not found)
+
+-  18.10.26 Original   By: ACRM
+*/
+int HumaniseTarget(SUBGROUPMODEL *model, char *text)
+{
+   int  sgNum;
+   char *chp;
+
+   for(chp=text; isdigit(*chp); chp++);
+   if((chp != text) && (*chp == '\0'))
+   {
+      sgNum = atoi(text);
+      return((sgNum < model->nSubGroups) ? sgNum : -1);
+   }
+
+   for(sgNum=0; sgNum<model->nSubGroups; sgNum++)
+   {
+      if(!strcmp(ModelSubgroupName(model, sgNum), text))
+         return(sgNum);
+   }
+   return(-1);
+}
+
+
+/************************************************************************/
+/*>BOOL Humanise(HUMANISE *hum, char *sequence)
+   --------------------------------------------
+*//**
+   \param[in,out] hum     The search
+   \param[in]   sequence  The chain
+   \return                The search finished within MAXHUMNODES
+
+   Finds the ranked minimal mutation sets for a chain
+
+-  18.10.26 Original   By: ACRM
+*/
+BOOL Humanise(HUMANISE *hum, char *sequence)
+{
+   MUTSCAN *scan = &(hum->scan);
+   int     sgNum, offsetNum, nMut, i,
+           nOther = 0;
+   REAL    best[MAXSUBTYPES],
+           value,
+           other = 0.0;
+
+   ScanParent(hum->model, sequence, scan);
+   hum->nSolutions = 0;
+   hum->nNodes     = 0;
+   hum->complete   = TRUE;
+
+   if(hum->sequence != NULL)
+      free(hum->sequence);
+   if((hum->sequence = (char *)malloc(scan->length + 1))==NULL)
+      return(FALSE);
+   strcpy(hum->sequence, sequence);
+
+   /* Offsets scored for this chain                                     */
+   for(offsetNum=0; offsetNum<SCANOFFSETS; offsetNum++)
+   {
+      hum->valid[offsetNum] = 
+         ((offsetNum < MAXTRUNCATION) ||
+          (scan->length >= 
+           (MAXREFSEQLEN + offsetNum - MAXTRUNCATION)));
+   }
+   FindCandidates(hum);
+   if(!FillDeltas(hum))
+      return(FALSE);
+
+   /* The parent, and the other subgroups strongest first               */
+   hum->parentScore = 0.0;
+   for(sgNum=0; sgNum<hum->model->nSubGroups; sgNum++)
+   {
+      best[sgNum] = 0.0;
+      for(offsetNum=0; offsetNum<SCANOFFSETS; offsetNum++)
+      {
+         if(hum->valid[offsetNum] &&
+            ((value = OffsetValue(hum, sgNum, offsetNum)) > best[sgNum]))
+            best[sgNum] = value;
+      }
+      if(sgNum == hum->target)
+      {
+         hum->parentScore = best[sgNum];
+         continue;
+      }
+      if(best[sgNum] > other)
+         other = best[sgNum];
+      for(i=nOther; (i > 0) && (best[hum->sgOrder[i-1]] < best[sgNum]);
+          i--)
+         hum->sgOrder[i] = hum->sgOrder[i-1];
+      hum->sgOrder[i] = sgNum;
+      nOther++;
+   }
+   hum->parentMargin = hum->parentScore - other;
+   
+   /* Bounds tables                                                     */
+   for(offsetNum=0; offsetNum<SCANOFFSETS; offsetNum++)
+   {
+      if(!hum->valid[offsetNum])
+         continue;
+      FillSums(hum, hum->target, offsetNum, SUMGAIN,
+               &GAINSUM(hum, offsetNum, -1, 0));
+      for(sgNum=0; sgNum<hum->model->nSubGroups; sgNum++)
+      {
+         if(sgNum == hum->target)
+            continue;
+         FillSums(hum, sgNum, offsetNum, SUMLOSS,
+                  &LOSSSUM(hum, sgNum, offsetNum, -1, 0));
+         FillSums(hum, sgNum, offsetNum, SUMXMAX,
+                  &XMAXSUM(hum, sgNum, offsetNum, -1, 0));
+      }
+   }
+
+   for(nMut=0; nMut<=hum->maxMut; nMut++)
+   {
+      if(++(hum->nNodes) > MAXHUMNODES)
+      {
+         hum->complete = FALSE;
+         break;
+      }
+      hum->current.nMut = nMut;
+      if(nMut == 0)
+         TryLeaf(hum);
+      else if(Feasible(hum, -1, -1, nMut))
+         Search(hum, -1, 0, nMut);
+      if(hum->nSolutions || !hum->complete)
+         break;
+   }
+   return(hum->complete);
+}
+
+
+/************************************************************************/
+/*>static void FillSums(HUMANISE *hum, int sgNum, int offsetNum,
+                        int kind, REAL *sums)
+   -------------------------------------------------------------
+*//**
+   \param[in]   hum        The search
+   \param[in]   sgNum      Subgroup
+   \param[in]   offsetNum  Offset
+   \param[in]   kind       SUMGAIN, SUMLOSS or SUMXMAX
+   \param[out]  sums       Indexed by SUMINDEX(L, r); the sum of the r
+                           largest terms from positions after L
+
+   A gain is the most a candidate residue can add to the subgroup's
+   score at a position; a loss is the most it can take away. Where X
+   is not scored, mutating it adds to the maximum score as well; the
+   X maximum is that addition.
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 kind replaces gain and X maxima are added
+*/
+static void FillSums(HUMANISE *hum, int sgNum, int offsetNum, int kind,
+                     REAL *sums)
+{
+   REAL top[MAXHUMMUT],
+        term, termMax, candTerm, candMax, value, total;
+   int  nTop = 0,
+        pos, refPos, r, i;
+   char *res;
+
+   for(pos=hum->scan.nPositions-1; pos>=-1; pos--)
+   {
+      /* top[] holds the largest terms after pos                        */
+      total = 0.0;
+      sums[SUMINDEX(pos, 0)] = 0.0;
+      for(r=1; r<=hum->maxMut; r++)
+      {
+         if(r <= nTop)
+            total += top[r-1];
+         sums[SUMINDEX(pos, r)] = total;
+      }
+
+      if((pos < 0) ||
+         ((refPos = ScanRefPosition(&(hum->scan), offsetNum, pos)) < 0))
+         continue;
+      
+      ScanContribution(hum->model, sgNum, refPos, hum->scan.wild[pos],
+                       &term, &termMax);
+      value = 0.0;
+      for(res=hum->cand[pos]; *res; res++)
+      {
+         ScanContribution(hum->model, sgNum, refPos, *res,
+                          &candTerm, &candMax);
+         if((kind == SUMGAIN) && (candTerm - term > value))
+            value = candTerm - term;
+         else if((kind == SUMLOSS) && (term - candTerm > value))
+            value = term - candTerm;
+         else if((kind == SUMXMAX) && (candMax - termMax > value))
+            value = candMax - termMax;
+      }
+      if(value <= 0.0)
+         continue;
+
+      /* Insert keeping the largest maxMut in descending order          */
+      for(i=nTop; (i > 0) && (top[i-1] < value); i--)
+      {
+         if(i < hum->maxMut)
+            top[i] = top[i-1];
+      }
+      if(i < hum->maxMut)
+      {
+         top[i] = value;
+         if(nTop < hum->maxMut)
+            nTop++;
+      }
+   }
+}
+
+
+/************************************************************************/
+/*>static void FindCandidates(HUMANISE *hum)
+   -----------------------------------------
+*//**
+   \param[in,out] hum     The search
+
+   Lists the residues each position may be mutated to: those the target
+   prefers at that position for some offset.
+
+-  18.10.26 Original   By: ACRM
+*/
+static void FindCandidates(HUMANISE *hum)
+{
+   SUBGROUPMODEL *model = hum->model;
+   int           pos, offsetNum, refPos, nCand, i, j, best;
+   char          res[2];
+   REAL          score;
+
+   for(pos=0; pos<hum->scan.nPositions; pos++)
+   {
+      nCand = 0;
+      for(offsetNum=0; offsetNum<SCANOFFSETS; offsetNum++)
+      {
+         if(!hum->valid[offsetNum] ||
+            ((refPos=ScanRefPosition(&(hum->scan), offsetNum, pos)) < 0))
+            continue;
+
+         if(model->fullMatrix)
+         {
+            best  = -1;
+            score = 0.0;
+            for(j=0; j<NSCANRESIDUES; j++)
+            {
+               REAL s = model->fmSubGroupInfo[hum->target].
+                        scores[refPos][ILETTER(SCANRESIDUES[j])];
+               if((best < 0) || (s > score))
+               {
+                  best  = j;
+                  score = s;
+               }
+            }
+            res[0] = SCANRESIDUES[best];
+            res[1] = '\0';
+         }
+         else
+         {
+            res[0] = model->subGroupInfo[hum->target].topSeq[refPos];
+            res[1] = model->subGroupInfo[hum->target].secondSeq[refPos];
+         }
+
+         for(i=0; i<2; i++)
+         {
+            if((res[i] == '\0') || (res[i] == hum->scan.wild[pos]) ||
+               (strchr(SCANRESIDUES, res[i]) == NULL))
+               continue;
+            for(j=0; (j<nCand) && (hum->cand[pos][j] != res[i]); j++);
+            if(j == nCand)
+               hum->cand[pos][nCand++] = res[i];
+         }
+      }
+      hum->cand[pos][nCand] = '\0';
+   }
+}
+
+
+/************************************************************************/
+/*>static BOOL FillDeltas(HUMANISE *hum)
+   -------------------------------------
+*//**
+   \param[in,out] hum     The search
+   \return                Success (FALSE if no memory)
+
+   Works out the change each candidate residue makes to the score and
+   maximum score of every subgroup at every offset so the search only
+   has to add them up
+
+-  18.10.26 Original   By: ACRM
+*/
+static BOOL FillDeltas(HUMANISE *hum)
+{
+   MUTSCAN *scan = &(hum->scan);
+   int     nSubGroups = hum->model->nSubGroups,
+           nCand = 0,
+           pos, offsetNum, refPos, sgNum;
+   long    nDelta;
+   char    *res;
+   REAL    *delta,
+           oldScore, oldScoreMax,
+           newScore, newScoreMax;
+
+   for(pos=0; pos<scan->nPositions; pos++)
+   {
+      hum->candBase[pos] = nCand;
+      nCand += strlen(hum->cand[pos]);
+
+      hum->nCover[pos] = 0;
+      for(offsetNum=0; offsetNum<SCANOFFSETS; offsetNum++)
+      {
+         if(hum->valid[offsetNum] &&
+            (ScanRefPosition(scan, offsetNum, pos) >= 0))
+            hum->cover[pos][hum->nCover[pos]++] = offsetNum;
+      }
+   }
+
+   nDelta = (long)nCand * SCANOFFSETS * 2 * nSubGroups;
+   if(nDelta > hum->nDelta)
+   {
+      if(hum->delta != NULL)
+         free(hum->delta);
+      hum->nDelta = 0;
+      if((hum->delta = (REAL *)malloc(nDelta * sizeof(REAL)))==NULL)
+         return(FALSE);
+      hum->nDelta = nDelta;
+   }
+   
+   for(pos=0; pos<scan->nPositions; pos++)
+   {
+      for(res=hum->cand[pos]; *res; res++)
+      {
+         for(offsetNum=0; offsetNum<SCANOFFSETS; offsetNum++)
+         {
+            delta = DELTA(hum, hum->candBase[pos] + (res - hum->cand[pos]),
+                          offsetNum);
+            refPos = (hum->valid[offsetNum] ?
+                      ScanRefPosition(scan, offsetNum, pos) : -1);
+            for(sgNum=0; sgNum<nSubGroups; sgNum++)
+            {
+               delta[2*sgNum] = delta[2*sgNum+1] = 0.0;
+               if(refPos < 0)
+                  continue;
+               ScanContribution(hum->model, sgNum, refPos, scan->wild[pos],
+                                &oldScore, &oldScoreMax);
+               ScanContribution(hum->model, sgNum, refPos, *res,
+                                &newScore, &newScoreMax);
+               delta[2*sgNum]   = newScore - oldScore;
+               delta[2*sgNum+1] = newScoreMax - oldScoreMax;
+            }
+         }
+      }
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static void Search(HUMANISE *hum, int last, int depth, int nMut)
+   ----------------------------------------------------------------
+*//**
+   \param[in,out] hum     The search
+   \param[in]   last      Last position mutated (-1 for none)
+   \param[in]   depth     Number of mutations made (less than nMut)
+   \param[in]   nMut      Number of mutations wanted
+
+   Tries every set of nMut mutations after last that the bounds allow.
+   The node has been counted and found feasible. Each child is counted
+   and checked with the bounds before it is applied to the sums, as
+   most are dropped.
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 The last mutation is tried by TryLastMutation() and children
+            are checked before they are applied
+*/
+static void Search(HUMANISE *hum, int last, int depth, int nMut)
+{
+   int  pos, candNum;
+   char *res;
+
+   if(depth == nMut - 1)
+   {
+      TryLastMutation(hum, last, depth);
+      return;
+   }
+
+   for(pos=last+1; pos <= hum->scan.nPositions - (nMut - depth); pos++)
+   {
+      if((pos > last+1) && !Feasible(hum, pos-1, -1, nMut - depth))
+         return;
+      
+      for(res=hum->cand[pos]; *res; res++)
+      {
+         if(++(hum->nNodes) > MAXHUMNODES)
+         {
+            hum->complete = FALSE;
+            return;
+         }
+
+         candNum = hum->candBase[pos] + (res - hum->cand[pos]);
+         if(!Feasible(hum, pos, candNum, nMut - depth - 1))
+            continue;
+         
+         hum->current.pos[depth] = pos;
+         hum->current.res[depth] = *res;
+         ApplyMutation(hum, pos, res - hum->cand[pos], 1);
+         Search(hum, pos, depth+1, nMut);
+         ApplyMutation(hum, pos, res - hum->cand[pos], -1);
+         if(!hum->complete)
+            return;
+      }
+   }
+}
+
+
+/************************************************************************/
+/*>static BOOL Feasible(HUMANISE *hum, int last, int candNum,
+                        int nLeft)
+   ---------------------------------------------------------
+*//**
+   \param[in]   hum       The search
+   \param[in]   last      Last position mutated
+   \param[in]   candNum   Candidate (from candBase[]) at last that is
+                          not yet applied to the sums (-1 for none)
+   \param[in]   nLeft     Mutations still to make after last
+   \return                The margin might still be reached
+
+   The other subgroups are checked strongest first so most hopeless
+   branches are rejected after only a few
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Adds a candidate that hasn't been applied
+*/
+static BOOL Feasible(HUMANISE *hum, int last, int candNum, int nLeft)
+{
+   MUTSCAN *scan = &(hum->scan);
+   int     sgNum, offsetNum, i;
+   REAL    upper = 0.0,
+           needed, value, score, scoreMax,
+           *delta;
+
+   for(offsetNum=0; offsetNum<SCANOFFSETS; offsetNum++)
+   {
+      if(!hum->valid[offsetNum])
+         continue;
+      
+      score    = scan->score[hum->target][offsetNum];
+      scoreMax = scan->scoreMax[hum->target][offsetNum];
+      if(candNum >= 0)
+      {
+         delta     = DELTA(hum, candNum, offsetNum) + 2 * hum->target;
+         score    += delta[0];
+         scoreMax += delta[1];
+      }
+      
+      if(scoreMax <= 0.0)
+      {
+         upper = 100.0;
+         continue;
+      }
+      
+      value = ((score + GAINSUM(hum, offsetNum, last, nLeft)) * 100.0) /
+              scoreMax;
+      if(value > upper)
+         upper = value;
+   }
+
+   if(upper <= 0.0)
+      return(FALSE);
+   needed = NeededMargin(hum) - HUMTOL;
+
+   for(i=0; i<hum->model->nSubGroups-1; i++)
+   {
+      sgNum = hum->sgOrder[i];
+      for(offsetNum=0; offsetNum<SCANOFFSETS; offsetNum++)
+      {
+         if(!hum->valid[offsetNum])
+            continue;
+         score    = scan->score[sgNum][offsetNum];
+         scoreMax = scan->scoreMax[sgNum][offsetNum];
+         if(candNum >= 0)
+         {
+            delta     = DELTA(hum, candNum, offsetNum) + 2 * sgNum;
+            score    += delta[0];
+            scoreMax += delta[1];
+         }
+         scoreMax += XMAXSUM(hum, sgNum, offsetNum, last, nLeft);
+         if(scoreMax <= 0.0)
+            continue;
+         value = ((score - LOSSSUM(hum, sgNum, offsetNum, last, nLeft)) *
+                  100.0) / scoreMax;
+         if(upper - value < needed)
+            return(FALSE);
+      }
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static void TryLeaf(HUMANISE *hum)
+   ----------------------------------
+*//**
+   \param[in,out] hum     The search
+
+   Checks whether the current set of mutations reaches the margin. If
+   the sums suggest it might, the mutant is scored normally to decide.
+
+-  18.10.26 Original   By: ACRM
+*/
+static void TryLeaf(HUMANISE *hum)
+{
+   SUBGROUPMODEL  *model = hum->model;
+   SUBGROUPRESULT result;
+   int            sgNum, offsetNum;
+   REAL           value,
+                  target = 0.0,
+                  other  = 0.0;
+
+   for(sgNum=0; sgNum<model->nSubGroups; sgNum++)
+   {
+      for(offsetNum=0; offsetNum<SCANOFFSETS; offsetNum++)
+      {
+         if(!hum->valid[offsetNum])
+            continue;
+         value = OffsetValue(hum, sgNum, offsetNum);
+         if(sgNum == hum->target)
+         {
+            if(value > target)
+               target = value;
+         }
+         else if(value > other)
+         {
+            other = value;
+         }
+      }
+   }
+   if((target <= 0.0) || (target - other < NeededMargin(hum) - HUMTOL))
+      return;
+
+   ScoreSubgroupModels(&model, 1, hum->sequence, &result);
+   if((result.best == hum->target) &&
+      (result.score - result.secondScore >= hum->margin))
+      AddSolution(hum, result.score, result.score - result.secondScore);
+}
+
+
+/************************************************************************/
+/*>static void TryLastMutation(HUMANISE *hum, int last, int depth)
+   ---------------------------------------------------------------
+*//**
+   \param[in,out] hum     The search
+   \param[in]   last      Last position mutated (-1 for none)
+   \param[in]   depth     Number of mutations made
+
+   Tries each mutation after last as the final one of the set. These are
+   the leaves of the search and nearly all of them fail, so rather than
+   applying each to the sums and working out every subgroup as
+   TryLeaf() does, they are checked from the sums and the mutation's
+   deltas by LastMutationReaches(). The few that pass are scored
+   normally. Each counts as a node as it would in Search().
+
+-  18.10.26 Original   By: ACRM
+*/
+static void TryLastMutation(HUMANISE *hum, int last, int depth)
+{
+   SUBGROUPMODEL  *model = hum->model;
+   SUBGROUPRESULT result;
+   int            pos, candNum;
+   char           *res;
+
+   for(pos=last+1; pos<hum->scan.nPositions; pos++)
+   {
+      /* The bounds for a mutation at pos or later only get tighter as
+         pos moves on
+      */
+      if((pos > last+1) && !Feasible(hum, pos-1, -1, 1))
+         return;
+      
+      for(res=hum->cand[pos]; *res; res++)
+      {
+         if(++(hum->nNodes) > MAXHUMNODES)
+         {
+            hum->complete = FALSE;
+            return;
+         }
+
+         candNum = hum->candBase[pos] + (res - hum->cand[pos]);
+         if(!LastMutationReaches(hum, candNum))
+            continue;
+
+         hum->current.pos[depth] = pos;
+         hum->current.res[depth] = *res;
+         hum->sequence[pos]      = *res;
+         ScoreSubgroupModels(&model, 1, hum->sequence, &result);
+         hum->sequence[pos]      = hum->scan.wild[pos];
+         if((result.best == hum->target) &&
+            (result.score - result.secondScore >= hum->margin))
+            AddSolution(hum, result.score,
+                        result.score - result.secondScore);
+      }
+   }
+}
+
+
+/************************************************************************/
+/*>static BOOL LastMutationReaches(HUMANISE *hum, int candNum)
+   -----------------------------------------------------------
+*//**
+   \param[in]   hum       The search
+   \param[in]   candNum   Candidate (from candBase[]) to add to the
+                          current mutations
+   \return                The sums suggest the margin might be reached
+
+   The same test as TryLeaf() makes on the sums, but the target is
+   worked out first and the other subgroups are checked strongest
+   first, stopping at the first that is too close
+
+-  18.10.26 Original   By: ACRM
+*/
+static BOOL LastMutationReaches(HUMANISE *hum, int candNum)
+{
+   MUTSCAN *scan = &(hum->scan);
+   int     sgNum, offsetNum, i;
+   REAL    *delta,
+           score, scoreMax, needed,
+           target = 0.0;
+
+   for(offsetNum=0; offsetNum<SCANOFFSETS; offsetNum++)
+   {
+      if(!hum->valid[offsetNum])
+         continue;
+      delta    = DELTA(hum, candNum, offsetNum) + 2 * hum->target;
+      score    = scan->score[hum->target][offsetNum]    + delta[0];
+      scoreMax = scan->scoreMax[hum->target][offsetNum] + delta[1];
+      if((scoreMax > 0.0) && ((score * 100.0) / scoreMax > target))
+         target = (score * 100.0) / scoreMax;
+   }
+   if(target <= 0.0)
+      return(FALSE);
+   needed = NeededMargin(hum) - HUMTOL;
+
+   for(i=0; i<hum->model->nSubGroups-1; i++)
+   {
+      sgNum = hum->sgOrder[i];
+      for(offsetNum=0; offsetNum<SCANOFFSETS; offsetNum++)
+      {
+         if(!hum->valid[offsetNum])
+            continue;
+         delta    = DELTA(hum, candNum, offsetNum) + 2 * sgNum;
+         score    = scan->score[sgNum][offsetNum]    + delta[0];
+         scoreMax = scan->scoreMax[sgNum][offsetNum] + delta[1];
+         if((scoreMax > 0.0) &&
+            (target - (score * 100.0) / scoreMax < needed))
+            return(FALSE);
+      }
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static void ApplyMutation(HUMANISE *hum, int pos, int candNum,
+                           int sign)
+   ----------------------------------------------------------------
+*//**
+   \param[in,out] hum     The search
+   \param[in]   pos       Position
+   \param[in]   candNum   Candidate residue at the position
+   \param[in]   sign      1 to make the mutation, -1 to undo it
+
+   Makes or undoes a mutation from the wild type updating the sums for
+   every subgroup and offset that covers it
+
+-  18.10.26 Original   By: ACRM
+*/
+static void ApplyMutation(HUMANISE *hum, int pos, int candNum, int sign)
+{
+   MUTSCAN *scan = &(hum->scan);
+   int     sgNum, offsetNum, i;
+   REAL    *delta;
+
+   for(i=0; i<hum->nCover[pos]; i++)
+   {
+      offsetNum = hum->cover[pos][i];
+      delta = DELTA(hum, hum->candBase[pos] + candNum, offsetNum);
+      for(sgNum=0; sgNum<hum->model->nSubGroups; sgNum++)
+      {
+         scan->score[sgNum][offsetNum]    += sign * delta[2*sgNum];
+         scan->scoreMax[sgNum][offsetNum] += sign * delta[2*sgNum+1];
+      }
+   }
+   hum->sequence[pos] = ((sign > 0) ? hum->cand[pos][candNum] :
+                         scan->wild[pos]);
+}
+
+
+/************************************************************************/
+/*>static REAL OffsetValue(HUMANISE *hum, int sgNum, int offsetNum)
+   ----------------------------------------------------------------
+*//**
+   \param[in]   hum        The search
+   \param[in]   sgNum      Subgroup
+   \param[in]   offsetNum  Offset
+   \return                 Normalized score from the current sums
+
+-  18.10.26 Original   By: ACRM
+*/
+static REAL OffsetValue(HUMANISE *hum, int sgNum, int offsetNum)
+{
+   if(hum->scan.scoreMax[sgNum][offsetNum] <= 0.0)
+      return(0.0);
+   return((hum->scan.score[sgNum][offsetNum] * 100.0) /
+          hum->scan.scoreMax[sgNum][offsetNum]);
+}
+
+
+/************************************************************************/
+/*>static REAL NeededMargin(HUMANISE *hum)
+   ---------------------------------------
+*//**
+   \param[in]   hum       The search
+   \return                Margin a new set must reach to be kept
+
+   Once the ranked list is full a set must also beat the last one
+   kept
+
+-  18.10.26 Original   By: ACRM
+*/
+static REAL NeededMargin(HUMANISE *hum)
+{
+   REAL last;
+
+   if(hum->nSolutions < MAXHUMSOLUTIONS)
+      return(hum->margin);
+   last = hum->solutions[MAXHUMSOLUTIONS-1].margin;
+   return((last > hum->margin) ? last : hum->margin);
+}
+
+
+/************************************************************************/
+/*>static void AddSolution(HUMANISE *hum, REAL score, REAL margin)
+   ---------------------------------------------------------------
+*//**
+   \param[in,out] hum     The search
+   \param[in]   score     Target score for the current set
+   \param[in]   margin    Margin for the current set
+
+   Adds the current set to the solutions which are kept in descending
+   order of margin. Sets found earlier stay ahead on a tie.
+
+-  18.10.26 Original   By: ACRM
+*/
+static void AddSolution(HUMANISE *hum, REAL score, REAL margin)
+{
+   int i;
+
+   for(i=hum->nSolutions; (i > 0) && (hum->solutions[i-1].margin < margin);
+       i--)
+   {
+      if(i < MAXHUMSOLUTIONS)
+         hum->solutions[i] = hum->solutions[i-1];
+   }
+   if(i < MAXHUMSOLUTIONS)
+   {
+      hum->solutions[i]        = hum->current;
+      hum->solutions[i].score  = score;
+      hum->solutions[i].margin = margin;
+      if(hum->nSolutions < MAXHUMSOLUTIONS)
+         hum->nSolutions++;
+   }
+}
+
+
+/************************************************************************/
+/*>BOOL WriteHumanise(FILE *fp, char *id, int chainNum, HUMANISE *hum,
+                      BOOL header)
+   -------------------------------------------------------------------
+*//**
+   \param[in]   fp        Output file
+   \param[in]   id        Sequence identifier
+   \param[in]   chainNum  Chain number within the entry (from 1)
+   \param[in]   hum       The search
+   \param[in]   header    Write the column names first
+   \return                Success
+
+   Writes the parent (rank 0) then the ranked sets as tab separated
+   rows. Mutations are written as wild type, position (from 1) and new
+   residue separated by commas. If nothing was found there is one row
+   with none. If the search gave up there is a row with incomplete
+   after any sets it had found, as they may not be minimal or complete.
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Marks a search that gave up after finding sets
+*/
+BOOL WriteHumanise(FILE *fp, char *id, int chainNum, HUMANISE *hum,
+                   BOOL header)
+{
+   int         i, j;
+   HUMSOLUTION *sol;
+   
+   if(header)
+      fprintf(fp, "#id\tchain\trank\tnmut\tmutations\tscore\t\
+margin\n");
+
+   fprintf(fp, "%s\t%d\t0\t0\t-\t%f\t%f\n",
+           id, chainNum, hum->parentScore, hum->parentMargin);
+
+   if((hum->nSolutions == 0) && hum->complete)
+      fprintf(fp, "%s\t%d\t-\t-\tnone\t-\t-\n", id, chainNum);
+
+   for(i=0; i<hum->nSolutions; i++)
+   {
+      sol = &(hum->solutions[i]);
+      fprintf(fp, "%s\t%d\t%d\t%d\t", id, chainNum, i+1, sol->nMut);
+      if(sol->nMut == 0)
+         fputc('-', fp);
+      for(j=0; j<sol->nMut; j++)
+      {
+         fprintf(fp, "%s%c%d%c", (j ? "," : ""),
+                 hum->scan.wild[sol->pos[j]], sol->pos[j]+1,
+                 sol->res[j]);
+      }
+      fprintf(fp, "\t%f\t%f\n", sol->score, sol->margin);
+   }
+
+   if(!hum->complete)
+      fprintf(fp, "%s\t%d\t-\t-\tincomplete\t-\t-\n", id, chainNum);
+   return(!ferror(fp));
+}
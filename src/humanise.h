@@ -0,0 +1,130 @@
+/*************************************************************************
+
+   Program:    hsubgroup
+   File:       humanise.h
+
+   Version:    V3.26
+   Date:       18.10.26
+   Function:   Search for minimal mutations giving a target subgroup
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+
+   Description:
+   ============
+   A humanisation search finds the smallest sets of mutations in the
+   scored part of a chain that make a chosen subgroup the best match by
+   a given margin.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V3.15 18.10.26   Original
+   V3.26 18.10.26   Added xMaxSum, removed xAfter
+
+*************************************************************************/
+#ifndef _HUMANISE_H
+#define _HUMANISE_H
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXHUMMUT          8  /* Max mutations in a set                 */
+#define DEFAULTHUMMUT      4
+#define MAXHUMSOLUTIONS   10  /* Ranked sets kept for each chain        */
+#define MAXHUMNODES  2000000L /* Search nodes before giving up          */
+
+/* A set of mutations. pos is from 0 and res is the new residue. The
+   score and margin are for the target subgroup scoring the mutant
+*/
+typedef struct
+{
+   REAL score,
+        margin;
+   int  nMut,
+        pos[MAXHUMMUT];
+   char res[MAXHUMMUT];
+}  HUMSOLUTION;
+
+/* A humanisation search. The tables hold, for each offset and each
+   last mutated position L, sums of the r largest possible gains for
+   the target (gainSum) and losses for every subgroup (lossSum) from
+   the positions after L, with the largest additions to the maximum
+   score from mutating an unscored X (xMaxSum). These are used to
+   bound the margin that can still be reached. delta holds the change
+   each candidate residue makes to the score and maximum score for
+   every offset and subgroup. cover lists the offsets that score each
+   position and sgOrder has the other subgroups, strongest on the
+   parent first
+*/
+typedef struct
+{
+   SUBGROUPMODEL *model;
+   MUTSCAN     scan;
+   HUMSOLUTION solutions[MAXHUMSOLUTIONS],
+               current;
+   REAL        *gainSum,
+               *lossSum,
+               *xMaxSum,
+               *delta,
+               margin,
+               parentScore,
+               parentMargin;
+   long        nNodes,
+               nDelta;
+   int         target,
+               maxMut,
+               nSolutions,
+               candBase[SCANWINDOW],
+               nCover[SCANWINDOW],
+               cover[SCANWINDOW][SCANOFFSETS],
+               sgOrder[MAXSUBTYPES];
+   BOOL        complete,
+               valid[SCANOFFSETS];
+   char        *sequence,
+               cand[SCANWINDOW][NSCANRESIDUES+1];
+}  HUMANISE;
+
+
+/************************************************************************/
+/* Prototypes
+*/
+HUMANISE *OpenHumanise(SUBGROUPMODEL *model, int target, REAL margin,
+                       int maxMut);
+int  HumaniseTarget(SUBGROUPMODEL *model, char *text);
+BOOL Humanise(HUMANISE *hum, char *sequence);
+BOOL WriteHumanise(FILE *fp, char *id, int chainNum, HUMANISE *hum,
+                   BOOL header);
+void CloseHumanise(HUMANISE *hum);
+
+#endif
@@ -0,0 +1,407 @@
+/*************************************************************************
+
+   Program:    hsubgroup
+   File:       mutscan.c
+
+   Version:    V3.15
+   Date:       18.10.26
+   Function:   Saturation mutagenesis scan of the N-terminal window
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+
+   Description:
+   ============
+   Only the first SCANWINDOW residues of a chain are ever compared with
+   the subgroup data (MAXREFSEQLEN residues at up to MAXEXTENSION-1 
+   residues of N-terminal extension), so only these are mutated. Each
+   is changed in turn to each of the 20 standard amino acids.
+
+   Rather than rescoring each mutant, the parent is scored once keeping
+   the score and maximum score sums for each subgroup at each offset.
+   A point mutation only changes the term for one residue in the sums
+   for the offsets whose window covers it, so each mutant just adjusts
+   those sums and re-takes the best offset and subgroups. The sums are
+   adjusted rather than recalculated so the last bits of a mutant's
+   score may differ from scoring the mutant sequence afresh.
+
+   The table has a row for each mutant giving the new best subgroup,
+   its score and the margin over the second best, whether the best
+   subgroup changed and the change in margin. A row for the parent
+   with position 0 comes first.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V3.14 18.10.26   Original
+   V3.15 18.10.26   ScanParent(), ScanContribution() and ScanRefPosition()
+                    made available for the humanisation search
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <string.h>
+#include "bioplib/MathType.h"
+#include "bioplib/SysDefs.h"
+#include "subgroup.h"
+#include "mutscan.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define ILETTER(x) ((int)(x)-65)
+
+/************************************************************************/
+/* Prototypes
+*/
+static void CallSubgroups(SUBGROUPMODEL *model, MUTSCAN *scan, int pos,
+                          char res, SCANCALL *call);
+
+
+/************************************************************************/
+/*>void MutationalScan(SUBGROUPMODEL *model, char *sequence,
+                       MUTSCAN *scan)
+   ---------------------------------------------------------
+*//**
+   \param[in]   model     The model to score against
+   \param[in]   sequence  The parent sequence
+   \param[out]  scan      The assignments for the parent and every
+                          mutant
+
+   Scores the parent then derives each mutant from the sums.
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Parent scoring moved to ScanParent()
+*/
+void MutationalScan(SUBGROUPMODEL *model, char *sequence,
+                    MUTSCAN *scan)
+{
+   int pos, res;
+
+   ScanParent(model, sequence, scan);
+   CallSubgroups(model, scan, -1, '\0', &(scan->parent));
+
+   /* Each mutant                                                       */
+   for(pos=0; pos<scan->nPositions; pos++)
+   {
+      for(res=0; res<NSCANRESIDUES; res++)
+      {
+         if(SCANRESIDUES[res] == scan->wild[pos])
+            scan->mutant[pos][res] = scan->parent;
+         else
+            CallSubgroups(model, scan, pos, SCANRESIDUES[res],
+                          &(scan->mutant[pos][res]));
+      }
+   }
+}
+
+
+/************************************************************************/
+/*>void ScanParent(SUBGROUPMODEL *model, char *sequence, MUTSCAN *scan)
+   --------------------------------------------------------------------
+*//**
+   \param[in]   model     The model to score against
+   \param[in]   sequence  The parent sequence
+   \param[out]  scan      The parent sums and normalized scores for
+                          each subgroup and offset
+
+   Scores the parent at every subgroup and offset keeping the sums.
+   The sums are built in reference position order, as in
+   ScoreTableStarts(), so the parent gets the same scores as a normal
+   run.
+   Extension offsets that the chain is too short for score 0.0.
+
+-  18.10.26 Split out from MutationalScan()   By: ACRM
+*/
+void ScanParent(SUBGROUPMODEL *model, char *sequence, MUTSCAN *scan)
+{
+   int  sgNum, offsetNum, pos, refPos,
+        nRef;
+   REAL score, scoreMax;
+
+   scan->length     = (int)strlen(sequence);
+   scan->nPositions = (scan->length < SCANWINDOW) ? scan->length :
+                                                    SCANWINDOW;
+   for(pos=0; pos<scan->nPositions; pos++)
+      scan->wild[pos] = sequence[pos];
+
+   /* Score the parent keeping the sums                                 */
+   for(sgNum=0; sgNum<model->nSubGroups; sgNum++)
+   {
+      for(offsetNum=0; offsetNum<SCANOFFSETS; offsetNum++)
+      {
+         scan->score[sgNum][offsetNum]    = 0.0;
+         scan->scoreMax[sgNum][offsetNum] = 0.0;
+         scan->value[sgNum][offsetNum]    = 0.0;
+
+         if(offsetNum < MAXTRUNCATION)
+         {
+            /* Truncation - the sequence starts offsetNum residues 
+               into the reference
+            */
+            nRef = MAXREFSEQLEN - offsetNum;
+            for(pos=0; pos<nRef; pos++)
+            {
+               ScanContribution(model, sgNum, pos+offsetNum,
+                                sequence[pos], &score, &scoreMax);
+               scan->score[sgNum][offsetNum]    += score;
+               scan->scoreMax[sgNum][offsetNum] += scoreMax;
+            }
+         }
+         else
+         {
+            /* Extension - the chain must be long enough                */
+            int offset = offsetNum - MAXTRUNCATION;
+            
+            if(scan->length < (MAXREFSEQLEN + offset))
+               continue;
+            for(refPos=0; refPos<MAXREFSEQLEN; refPos++)
+            {
+               ScanContribution(model, sgNum, refPos,
+                                sequence[refPos+offset],
+                                &score, &scoreMax);
+               scan->score[sgNum][offsetNum]    += score;
+               scan->scoreMax[sgNum][offsetNum] += scoreMax;
+            }
+         }
+
+         scan->value[sgNum][offsetNum] = 
+            (scan->score[sgNum][offsetNum] * 100.0) /
+            scan->scoreMax[sgNum][offsetNum];
+      }
+   }
+}
+
+
+/************************************************************************/
+/*>static void CallSubgroups(SUBGROUPMODEL *model, MUTSCAN *scan,
+                             int pos, char res, SCANCALL *call)
+   ---------------------------------------------------------------
+*//**
+   \param[in]   model     The model
+   \param[in]   scan      Scan with the parent sums
+   \param[in]   pos       Position mutated (-1 for the parent)
+   \param[in]   res       Residue at that position
+   \param[out]  call      Best and second best subgroups
+
+   Finds the best offset for each subgroup and then the best two
+   subgroups in the same way as the normal scoring, so on a tie the
+   earlier offset and the earlier subgroup win.
+
+-  18.10.26 Original   By: ACRM
+*/
+static void CallSubgroups(SUBGROUPMODEL *model, MUTSCAN *scan, int pos,
+                          char res, SCANCALL *call)
+{
+   int  sgNum, offsetNum, refPos;
+   REAL value, subGroupMax,
+        oldScore, oldScoreMax,
+        newScore, newScoreMax;
+
+   call->best        = call->second      = -1;
+   call->score       = call->secondScore = 0.0;
+   
+   for(sgNum=0; sgNum<model->nSubGroups; sgNum++)
+   {
+      subGroupMax = 0.0;
+      for(offsetNum=0; offsetNum<SCANOFFSETS; offsetNum++)
+      {
+         value = scan->value[sgNum][offsetNum];
+
+         /* Adjust the sums if this offset covers the mutation          */
+         if((pos >= 0) &&
+            ((refPos = ScanRefPosition(scan, offsetNum, pos)) >= 0))
+         {
+            ScanContribution(model, sgNum, refPos, scan->wild[pos],
+                             &oldScore, &oldScoreMax);
+            ScanContribution(model, sgNum, refPos, res,
+                             &newScore, &newScoreMax);
+            value = ((scan->score[sgNum][offsetNum] - oldScore + 
+                      newScore) * 100.0) /
+                    (scan->scoreMax[sgNum][offsetNum] - oldScoreMax +
+                     newScoreMax);
+         }
+
+         if(value > subGroupMax)
+            subGroupMax = value;
+      }
+
+      /* Only subgroups that matched something are ranked               */
+      if(subGroupMax > 0.0)
+      {
+         if((call->best < 0) || (subGroupMax > call->score))
+         {
+            call->second      = call->best;
+            call->secondScore = call->score;
+            call->best        = sgNum;
+            call->score       = subGroupMax;
+         }
+         else if((call->second < 0) || (subGroupMax > call->secondScore))
+         {
+            call->second      = sgNum;
+            call->secondScore = subGroupMax;
+         }
+      }
+   }
+}
+
+
+/************************************************************************/
+/*>int ScanRefPosition(MUTSCAN *scan, int offsetNum, int pos)
+   -----------------------------------------------------------
+*//**
+   \param[in]   scan       The scan
+   \param[in]   offsetNum  Offset (truncation offsets first)
+   \param[in]   pos        Position in the chain
+   \return                 Position in the reference sequence compared
+                           with pos at this offset (-1 if none)
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 No longer static
+*/
+int ScanRefPosition(MUTSCAN *scan, int offsetNum, int pos)
+{
+   int offset;
+   
+   if(offsetNum < MAXTRUNCATION)
+      return((pos < (MAXREFSEQLEN - offsetNum)) ? pos + offsetNum : -1);
+
+   offset = offsetNum - MAXTRUNCATION;
+   if((scan->length < (MAXREFSEQLEN + offset)) ||
+      (pos < offset) || (pos >= (offset + MAXREFSEQLEN)))
+      return(-1);
+   return(pos - offset);
+}
+
+
+/************************************************************************/
+/*>void ScanContribution(SUBGROUPMODEL *model, int sgNum, 
+                         int refPos, char res, REAL *score,
+                         REAL *scoreMax)
+   --------------------------------------------------------
+*//**
+   \param[in]   model     The model
+   \param[in]   sgNum     Subgroup
+   \param[in]   refPos    Position in the reference sequence
+   \param[in]   res       Residue in the chain at that position
+   \param[out]  score     Its term in the score
+   \param[out]  scoreMax  Its term in the maximum score
+
+   The term for one residue, as held in the profile table
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 No longer static
+*/
+void ScanContribution(SUBGROUPMODEL *model, int sgNum, int refPos,
+                      char res, REAL *score, REAL *scoreMax)
+{
+   *score = *scoreMax = 0.0;
+   
+   if((res == 'X') && !model->includeX)
+      return;
+
+   if(model->fullMatrix)
+   {
+      *score    = model->fmSubGroupInfo[sgNum].scores[refPos][ILETTER(res)];
+      *scoreMax = model->fmSubGroupInfo[sgNum].topScores[refPos];
+   }
+   else
+   {
+      SUBGROUPINFO *info = &(model->subGroupInfo[sgNum]);
+
+      if(res == info->topSeq[refPos])
+         *score = info->topScores[refPos];
+      else if(res == info->secondSeq[refPos])
+         *score = info->secondScores[refPos];
+      *scoreMax = info->topScores[refPos];
+   }
+}
+
+
+/************************************************************************/
+/*>BOOL WriteMutationalScan(FILE *fp, char *id, int chainNum,
+                            SUBGROUPMODEL *model, MUTSCAN *scan,
+                            BOOL header)
+   -----------------------------------------------------------
+*//**
+   \param[in]   fp        Output file
+   \param[in]   id        Sequence identifier
+   \param[in]   chainNum  Chain number within the entry (from 1)
+   \param[in]   model     The model (for subgroup names)
+   \param[in]   scan      The scan
+   \param[in]   header    Write the column names first
+   \return                Success
+
+   Writes the scan as tab separated rows. The parent comes first with
+   position 0
+
+-  18.10.26 Original   By: ACRM
+*/
+BOOL WriteMutationalScan(FILE *fp, char *id, int chainNum,
+                         SUBGROUPMODEL *model, MUTSCAN *scan,
+                         BOOL header)
+{
+   int      pos, res;
+   REAL     margin,
+            parentMargin;
+   SCANCALL *call;
+
+   if(header)
+      fprintf(fp, "#id\tchain\tpos\twt\tmut\tbest\tscore\tmargin\t\
+changed\tdmargin\n");
+
+   parentMargin = scan->parent.score - scan->parent.secondScore;
+   fprintf(fp, "%s\t%d\t0\t-\t-\t%s\t%f\t%f\t0\t%f\n",
+           id, chainNum, ModelSubgroupName(model, scan->parent.best),
+           scan->parent.score, parentMargin, 0.0);
+
+   for(pos=0; pos<scan->nPositions; pos++)
+   {
+      for(res=0; res<NSCANRESIDUES; res++)
+      {
+         if(SCANRESIDUES[res] == scan->wild[pos])
+            continue;
+         
+         call   = &(scan->mutant[pos][res]);
+         margin = call->score - call->secondScore;
+         fprintf(fp, "%s\t%d\t%d\t%c\t%c\t%s\t%f\t%f\t%d\t%f\n",
+                 id, chainNum, pos+1, scan->wild[pos], SCANRESIDUES[res],
+                 ModelSubgroupName(model, call->best),
+                 call->score, margin,
+                 (call->best != scan->parent.best),
+                 margin - parentMargin);
+      }
+   }
+   return(!ferror(fp));
+}
@@ -0,0 +1,109 @@
+/*************************************************************************
+
+   Program:    hsubgroup
+   File:       mutscan.h
+
+   Version:    V3.15
+   Date:       18.10.26
+   Function:   Saturation mutagenesis scan of the N-terminal window
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+
+   Description:
+   ============
+   A mutational scan gives the subgroup assignment for every single
+   point mutation in the part of a chain that is scored.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V3.14 18.10.26   Original
+   V3.15 18.10.26   Added ScanParent(), ScanContribution() and 
+                    ScanRefPosition()
+
+*************************************************************************/
+#ifndef _MUTSCAN_H
+#define _MUTSCAN_H
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define SCANWINDOW   (MAXREFSEQLEN + MAXEXTENSION - 1) /* Positions that
+                                                         affect scores */
+#define SCANOFFSETS  (MAXTRUNCATION + MAXEXTENSION)
+#define SCANRESIDUES "ACDEFGHIKLMNPQRSTVWY"
+#define NSCANRESIDUES 20
+
+/* The assignment for one sequence: best and second best subgroup       */
+typedef struct
+{
+   REAL score,
+        secondScore;
+   int  best,
+        second;
+}  SCANCALL;
+
+/* A mutational scan of one chain. mutant[pos][res] is the assignment
+   with position pos (from 0) mutated to SCANRESIDUES[res]; where that
+   is the wild type residue it is the same as parent. The sums are the
+   unnormalized score and maximum score for each subgroup at each
+   offset (truncation offsets first, then extension) for the parent
+*/
+typedef struct
+{
+   SCANCALL parent,
+            mutant[SCANWINDOW][NSCANRESIDUES];
+   REAL     score[MAXSUBTYPES][SCANOFFSETS],
+            scoreMax[MAXSUBTYPES][SCANOFFSETS],
+            value[MAXSUBTYPES][SCANOFFSETS];
+   int      nPositions,
+            length;
+   char     wild[SCANWINDOW];
+}  MUTSCAN;
+
+
+/************************************************************************/
+/* Prototypes
+*/
+void MutationalScan(SUBGROUPMODEL *model, char *sequence,
+                    MUTSCAN *scan);
+void ScanParent(SUBGROUPMODEL *model, char *sequence, MUTSCAN *scan);
+void ScanContribution(SUBGROUPMODEL *model, int sgNum, int refPos,
+                      char res, REAL *score, REAL *scoreMax);
+int  ScanRefPosition(MUTSCAN *scan, int offsetNum, int pos);
+BOOL WriteMutationalScan(FILE *fp, char *id, int chainNum,
+                         SUBGROUPMODEL *model, MUTSCAN *scan,
+                         BOOL header);
+
+#endif
@@ -0,0 +1,313 @@
+/*************************************************************************
+
+   Program:    hsubgroup
+   File:       nullscore.c
+
+   Version:    V3.22
+   Date:       18.10.26
+   Function:   Scores of chance matches to the subgroups
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   The normalized score of a chain says how well it matches a subgroup
+   but not how likely that match is by chance. For each subgroup the
+   distribution of scores of a random chain matched to the whole
+   profile is worked out once, so a result's p-value is a lookup.
+
+   The residues of a random chain are drawn independently with the
+   background frequencies of Robinson & Robinson (1991) PNAS 88:8880,
+   so its score is a sum of independent terms, one for each reference
+   position. Each term is rounded to a whole number of bins, where the
+   bin width is the range of possible scores divided by NULLBINS, and
+   the distribution of the sum is found exactly by convolving the
+   distributions of the terms one position at a time. The chance of
+   scoring at least each bin is then kept in the model. The rounding
+   adds up to half a bin for each position so there are extra bins
+   beyond NULLBINS to hold the sums.
+
+   The p-value is for one subgroup at one offset and is for ungapped
+   scoring; a gapped score can only be higher so its p-value is too
+   small. The E-value allows for every subgroup and offset tried.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V3.22 18.10.26   Original
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include "bioplib/MathType.h"
+#include "bioplib/SysDefs.h"
+#include "subgroup.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define NBACKGROUND 20
+
+/************************************************************************/
+/* Globals
+*/
+static char sBgResidues[NBACKGROUND+1] = "ARNDCQEGHILKMFPSTWYV";
+static REAL sBgFrequency[NBACKGROUND] =
+{
+   0.07805, 0.05129, 0.04487, 0.05364, 0.01925,
+   0.04264, 0.06295, 0.07377, 0.02199, 0.05142,
+   0.09019, 0.05744, 0.02243, 0.03856, 0.05203,
+   0.07120, 0.05841, 0.01330, 0.03216, 0.06441
+};
+
+/************************************************************************/
+/* Prototypes
+*/
+static void NullDistribution(SUBGROUPMODEL *model, int sgNum,
+                             REAL *dist, REAL *next, REAL *row);
+
+
+/************************************************************************/
+/*>BOOL BuildNullScores(SUBGROUPMODEL *model)
+   ------------------------------------------
+*//**
+   \param[in,out] model   The model with its table built
+   \return                Success (FALSE if no memory)
+
+   (Re)builds the distribution of the scores of a chance match to each
+   subgroup. Once built, the distributions are rebuilt whenever the
+   model's table is.
+
+-  18.10.26 Original   By: ACRM
+*/
+BOOL BuildNullScores(SUBGROUPMODEL *model)
+{
+   REAL *dist, *next;
+   int  sgNum;
+
+   FreeNullScores(model);
+   model->nNullBins = NULLBINS + model->refLength + 1;
+
+   if((model->nullTable = (REAL *)malloc(model->nSubGroups *
+                                         (model->nNullBins + 2) *
+                                         sizeof(REAL)))==NULL)
+      return(FALSE);
+   dist = (REAL *)malloc(model->nNullBins * sizeof(REAL));
+   next = (REAL *)malloc(model->nNullBins * sizeof(REAL));
+   if((dist == NULL) || (next == NULL))
+   {
+      if(dist != NULL) free(dist);
+      if(next != NULL) free(next);
+      FreeNullScores(model);
+      return(FALSE);
+   }
+
+   for(sgNum=0; sgNum<model->nSubGroups; sgNum++)
+      NullDistribution(model, sgNum, dist, next, PROFNULL(model, sgNum));
+
+   free(dist);
+   free(next);
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void FreeNullScores(SUBGROUPMODEL *model)
+   -----------------------------------------
+*//**
+   \param[in,out] model   The model
+
+-  18.10.26 Original   By: ACRM
+*/
+void FreeNullScores(SUBGROUPMODEL *model)
+{
+   if(model->nullTable != NULL)
+      free(model->nullTable);
+   model->nullTable = NULL;
+   model->nNullBins = 0;
+}
+
+
+/************************************************************************/
+/*>REAL NullPValue(SUBGROUPMODEL *model, int sgNum, REAL score)
+   ------------------------------------------------------------
+*//**
+   \param[in]   model     The model with its null scores built
+   \param[in]   sgNum     The subgroup
+   \param[in]   score     A normalized score
+   \return                Chance of a random chain scoring at least
+                          as much against the whole profile
+
+-  18.10.26 Original   By: ACRM
+*/
+REAL NullPValue(SUBGROUPMODEL *model, int sgNum, REAL score)
+{
+   REAL *row = PROFNULL(model, sgNum);
+   int  bin;
+
+   /* Every random chain scores the same                                */
+   if(row[1] <= 0.0)
+      return((score <= row[0] + NULLTOLERANCE) ? 1.0 : 0.0);
+
+   bin = (int)ceil(((score - row[0]) / row[1]) - NULLTOLERANCE);
+   if(bin <= 0)
+      return(1.0);
+   if(bin >= model->nNullBins)
+      return(0.0);
+   return(row[2 + bin]);
+}
+
+
+/************************************************************************/
+/*>static void NullDistribution(SUBGROUPMODEL *model, int sgNum,
+                                REAL *dist, REAL *next, REAL *row)
+   ---------------------------------------------------------------
+*//**
+   \param[in]   model     The model with its table built
+   \param[in]   sgNum     The subgroup
+   \param       dist      Space for model->nNullBins values
+   \param       next      Space for model->nNullBins values
+   \param[out]  row       The subgroup's row of the null table (see
+                          PROFNULL())
+
+   Finds the distribution of the scores of a random chain against the
+   whole profile of a subgroup
+
+-  18.10.26 Original   By: ACRM
+*/
+static void NullDistribution(SUBGROUPMODEL *model, int sgNum,
+                             REAL *dist, REAL *next, REAL *row)
+{
+   REAL *scores, *swap,
+        low      = 0.0,
+        range    = 0.0,
+        scoreMax = 0.0,
+        binWidth, lowest, highest, total,
+        prob[NBACKGROUND];
+   int  bins[NBACKGROUND],
+        refPos, res, i, bin, nTerms, maxBin,
+        top = 0;
+
+   for(refPos=0; refPos<model->refLength; refPos++)
+   {
+      scores   = PROFTABLE(model, sgNum, refPos);
+      scoreMax += scores[PROFCODES + sBgResidues[0] - 'A'];
+      lowest   = highest = scores[sBgResidues[0] - 'A'];
+      for(res=1; res<NBACKGROUND; res++)
+      {
+         if(scores[sBgResidues[res] - 'A'] < lowest)
+            lowest = scores[sBgResidues[res] - 'A'];
+         if(scores[sBgResidues[res] - 'A'] > highest)
+            highest = scores[sBgResidues[res] - 'A'];
+      }
+      low   += lowest;
+      range += highest - lowest;
+   }
+
+   /* Nothing can score so every score is as likely as any other        */
+   if(scoreMax <= 0.0)
+   {
+      row[0] = 100.0;
+      row[1] = 0.0;
+      return;
+   }
+
+   row[0] = (low * 100.0) / scoreMax;
+   row[1] = (range * 100.0) / (scoreMax * NULLBINS);
+   if(range <= 0.0)
+      return;
+   binWidth = range / NULLBINS;
+
+   dist[0] = 1.0;
+   for(refPos=0; refPos<model->refLength; refPos++)
+   {
+      /* The chance of each number of bins this position adds           */
+      scores = PROFTABLE(model, sgNum, refPos);
+      lowest = scores[sBgResidues[0] - 'A'];
+      for(res=1; res<NBACKGROUND; res++)
+      {
+         if(scores[sBgResidues[res] - 'A'] < lowest)
+            lowest = scores[sBgResidues[res] - 'A'];
+      }
+
+      nTerms = 0;
+      maxBin = 0;
+      for(res=0; res<NBACKGROUND; res++)
+      {
+         bin = (int)(((scores[sBgResidues[res] - 'A'] - lowest) /
+                      binWidth) + 0.5);
+         for(i=0; (i<nTerms) && (bins[i] != bin); i++);
+         if(i == nTerms)
+         {
+            bins[nTerms]   = bin;
+            prob[nTerms++] = 0.0;
+         }
+         prob[i] += sBgFrequency[res];
+         if(bin > maxBin)
+            maxBin = bin;
+      }
+
+      /* Convolve with the distribution so far                          */
+      for(bin=0; bin<=top+maxBin; bin++)
+         next[bin] = 0.0;
+      for(bin=0; bin<=top; bin++)
+      {
+         if(dist[bin] > 0.0)
+         {
+            for(i=0; i<nTerms; i++)
+               next[bin + bins[i]] += dist[bin] * prob[i];
+         }
+      }
+      top += maxBin;
+
+      swap = dist;
+      dist = next;
+      next = swap;
+   }
+
+   /* The chance of scoring at least each bin. The frequencies don't
+      sum to exactly 1 so the total is scaled to 1
+   */
+   total = 0.0;
+   for(bin=model->nNullBins-1; bin>=0; bin--)
+   {
+      if(bin <= top)
+         total += dist[bin];
+      row[2 + bin] = total;
+   }
+   for(bin=0; bin<model->nNullBins; bin++)
+      row[2 + bin] /= total;
+}
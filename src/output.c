@@ -0,0 +1,1182 @@
+/*************************************************************************
+
+   Program:    hsubgroup
+   File:       output.c
+
+   Version:    V3.4
+   Date:       18.10.26
+   Function:   Output writers for subgroup assignments
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Writes subgroup assignments in one of several formats:
+
+   text    The original output - the name of the best subgroup with
+           the scores and second best subgroup if verbose is set. Any
+           further ranked subgroups follow as name,score pairs
+   tsv     Tab separated columns including the sequence ID. Each
+           ranked subgroup has ID, name, score and offset columns
+   json    JSON Lines - one object per chain. If more than two
+           subgroups are ranked, all appear in a "ranked" array
+   binary  Fixed size little-endian records. The file starts with a
+           header containing the subgroup names so that the records
+           need only store subgroup IDs
+
+   If a tag is set with SetOutputTag() (for several input files written
+   to one output) it is written first in each record: as a leading
+   "file" column in TSV, a "file" member in JSON and a tab-terminated
+   prefix in text output. Binary records are not tagged.
+
+   If several models are set with SetOutputModels(), 
+   WriteModelResults() writes one record per model for each chain.
+   The model label follows the ID and chain number as "model" and 
+   "winner" columns in TSV and members in JSON (winner is 1 for the
+   model with the best score). Text output has a tab-terminated label
+   prefix and " *" after the name for the winning model. If the models
+   mix sums and products (-p) their scores can't be compared, so there
+   is no winner column or member and no model is marked. Binary output
+   does not support several models.
+
+   For nucleotide input the translation frame is set with 
+   SetOutputFrame() before each record. It follows the ID and chain
+   number (and any model columns) as a "frame" column in TSV and
+   member in JSON, and is a tab-terminated prefix after any label in
+   text output. Binary output does not support frames.
+
+   If SetOutputPValues() is used, the p-value and E-value of the best
+   match end each record, in scientific notation: as two more 
+   comma-separated fields in text, "pvalue" and "evalue" columns in TSV
+   and members in JSON. Binary output does not support them.
+
+   Records are formatted directly into a large buffer rather than going
+   through printf() so that output is not the bottleneck when scoring
+   is fast.
+
+   Binary file layout (all integers little-endian):
+      char[4]  magic "HSGB"
+      uint32   version
+      uint32   record size
+      uint32   number of ranked subgroups per record (K, at least 2)
+      uint32   number of subgroups
+      then for each subgroup: uint16 name length, name (no terminator)
+   Each record:
+      uint32   record number (from 1)
+      uint32   chain number within the entry (from 1)
+      char[16] sequence ID (NUL padded)
+      then K times, best first:
+         int32    subgroup ID (-1 if none)
+         float32  score
+         int32    offset (+ve truncation, -ve extension)
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V3.3  18.10.26   Original
+   V3.4  18.10.26   Writes the top-K ranking and offsets
+   V3.9  18.10.26   Added ResumeOutputWriter()
+   V3.10 18.10.26   Records may be tagged with the source file name
+   V3.12 18.10.26   Added SetOutputModels() and WriteModelResults()
+   V3.17 18.10.26   Added SetOutputFrame()
+   V3.22 18.10.26   Added SetOutputPValues()
+   V3.26 18.10.26   There is no winner if the models' scores are on
+                    different scales
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bioplib/MathType.h"
+#include "bioplib/SysDefs.h"
+#include "subgroup.h"
+#include "output.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define BINRECORDSIZE(k) (4 + 4 + OUTIDLEN + ((k) * 12))
+#define FORMATTIE  1.0e-6   /* Distance from a tie in the sixth decimal
+                               place that FormatReal() can't resolve */
+
+/************************************************************************/
+/* Prototypes
+*/
+static BOOL AppendBytes(OUTWRITER *writer, char *bytes, int nBytes);
+static BOOL AppendString(OUTWRITER *writer, char *string);
+static BOOL AppendJSONString(OUTWRITER *writer, char *string);
+static BOOL AppendInt(OUTWRITER *writer, long value);
+static BOOL AppendReal(OUTWRITER *writer, REAL value);
+static BOOL AppendUInt32(OUTWRITER *writer, unsigned long value);
+static BOOL AppendFloat32(OUTWRITER *writer, REAL value);
+static BOOL AppendProbability(OUTWRITER *writer, REAL value);
+static BOOL WriteBinaryHeader(OUTWRITER *writer);
+static char *SubgroupName(OUTWRITER *writer, int id);
+static BOOL WriteTSVHeader(OUTWRITER *writer);
+static BOOL WriteText(OUTWRITER *writer, SUBGROUPRESULT *result);
+static BOOL WriteTSV(OUTWRITER *writer, char *id, int chainNum,
+                     SUBGROUPRESULT *result);
+static BOOL WriteJSON(OUTWRITER *writer, char *id, int chainNum,
+                      SUBGROUPRESULT *result);
+static BOOL WriteBinary(OUTWRITER *writer, char *id, int chainNum,
+                        SUBGROUPRESULT *result);
+
+
+/************************************************************************/
+/*>int ParseOutputFormat(char *name)
+   ---------------------------------
+*//**
+   \param[in]   name    Format name (text, tsv, json or binary)
+   \return              OUTFORMAT_ value or -1 if not recognized
+
+-  18.10.26 Original   By: ACRM
+*/
+int ParseOutputFormat(char *name)
+{
+   if(!strcmp(name, "text"))
+      return(OUTFORMAT_TEXT);
+   if(!strcmp(name, "tsv"))
+      return(OUTFORMAT_TSV);
+   if(!strcmp(name, "json") || !strcmp(name, "jsonl"))
+      return(OUTFORMAT_JSON);
+   if(!strcmp(name, "binary") || !strcmp(name, "bin"))
+      return(OUTFORMAT_BINARY);
+   return(-1);
+}
+
+
+/************************************************************************/
+/*>OUTWRITER *OpenOutputWriter(FILE *fp, int format, BOOL verbose,
+                               int nTop)
+   ---------------------------------------------------------------
+*//**
+   \param[in]   fp        File to write to
+   \param[in]   format    OUTFORMAT_ value
+   \param[in]   verbose   Include scores and second best in text output
+   \param[in]   nTop      Number of ranked subgroups to write (the best
+                          and second best are always written)
+   \return                The writer (NULL if no memory)
+
+   Creates an output writer. Any header is written with the first
+   record so the subgroup data need not be loaded yet.
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Added nTop
+-  18.10.26 Initializes models
+-  18.10.26 Initializes the frame
+-  18.10.26 Initializes pValues
+*/
+OUTWRITER *OpenOutputWriter(FILE *fp, int format, BOOL verbose,
+                            int nTop)
+{
+   OUTWRITER *writer;
+
+   if((writer = (OUTWRITER *)malloc(sizeof(OUTWRITER)))==NULL)
+      return(NULL);
+
+   writer->fp         = fp;
+   writer->tag        = NULL;
+   writer->models     = NULL;
+   writer->nModels    = 0;
+   writer->model      = 0;
+   writer->winner     = FALSE;
+   writer->compareModels = FALSE;
+   writer->dna        = FALSE;
+   writer->frame      = 0;
+   writer->pValues    = FALSE;
+   writer->format     = format;
+   writer->verbose    = verbose;
+   writer->nUsed      = 0;
+   writer->nRecords   = 0;
+   writer->headerDone = FALSE;
+   writer->nTop       = (nTop < 2) ? 2 : nTop;
+
+   return(writer);
+}
+
+
+/************************************************************************/
+/*>BOOL WriteResult(OUTWRITER *writer, char *id, int chainNum,
+                    SUBGROUPRESULT *result)
+   -----------------------------------------------------------
+*//**
+   \param[in]   writer    The output writer
+   \param[in]   id        Sequence identifier (may be NULL)
+   \param[in]   chainNum  Chain number within the entry (from 1)
+   \param[in]   result    The subgroup assignment
+   \return                Success
+
+   Formats a result into the output buffer
+
+-  18.10.26 Original   By: ACRM
+*/
+BOOL WriteResult(OUTWRITER *writer, char *id, int chainNum,
+                 SUBGROUPRESULT *result)
+{
+   if(id == NULL)
+      id = "";
+
+   if(!writer->headerDone)
+   {
+      writer->headerDone = TRUE;
+      if(writer->format == OUTFORMAT_TSV)
+      {
+         if(!WriteTSVHeader(writer))
+            return(FALSE);
+      }
+      else if(writer->format == OUTFORMAT_BINARY)
+      {
+         if(!WriteBinaryHeader(writer))
+            return(FALSE);
+      }
+   }
+
+   writer->nRecords++;
+
+   switch(writer->format)
+   {
+   case OUTFORMAT_TSV:
+      return(WriteTSV(writer, id, chainNum, result));
+   case OUTFORMAT_JSON:
+      return(WriteJSON(writer, id, chainNum, result));
+   case OUTFORMAT_BINARY:
+      return(WriteBinary(writer, id, chainNum, result));
+   default:
+      break;
+   }
+   return(WriteText(writer, result));
+}
+
+
+/************************************************************************/
+/*>BOOL WriteModelResults(OUTWRITER *writer, char *id, int chainNum,
+                          SUBGROUPRESULT *results)
+   -----------------------------------------------------------------
+*//**
+   \param[in]   writer    The output writer
+   \param[in]   id        Sequence identifier (may be NULL)
+   \param[in]   chainNum  Chain number within the entry (from 1)
+   \param[in]   results   One subgroup assignment for each model set 
+                          with SetOutputModels()
+   \return                Success
+
+   Writes a record for each model marking the one with the best score
+   if the scores can be compared
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Only marks a winner if the scores are on the same scale
+*/
+BOOL WriteModelResults(OUTWRITER *writer, char *id, int chainNum,
+                       SUBGROUPRESULT *results)
+{
+   int  m,
+        best;
+   BOOL ok = TRUE;
+
+   best = writer->compareModels ? BestModel(results, writer->nModels)
+                                : -1;
+   for(m=0; ok && (m<writer->nModels); m++)
+   {
+      writer->model  = m;
+      writer->winner = (m == best);
+      ok = WriteResult(writer, id, chainNum, &(results[m]));
+   }
+   writer->model  = 0;
+   writer->winner = FALSE;
+   
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>void SetOutputModels(OUTWRITER *writer, SUBGROUPMODEL **models,
+                        int nModels)
+   ---------------------------------------------------------------
+*//**
+   \param[in]   writer    The output writer
+   \param[in]   models    The models results will be given for. Not 
+                          copied.
+   \param[in]   nModels   Number of models
+
+   Sets the models used by WriteModelResults(). Subgroup names are then
+   taken from these models. Must be called before the first record for
+   the TSV header to include the model columns.
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Notes whether the models' scores can be compared
+*/
+void SetOutputModels(OUTWRITER *writer, SUBGROUPMODEL **models,
+                     int nModels)
+{
+   writer->models        = models;
+   writer->nModels       = nModels;
+   writer->compareModels = SameScoreScale(models, nModels);
+}
+
+
+/************************************************************************/
+/*>void SetOutputTag(OUTWRITER *writer, char *tag)
+   -----------------------------------------------
+*//**
+   \param[in]   writer    The output writer
+   \param[in]   tag       Tag for the following records (normally the
+                          input file name). Not copied.
+
+   Sets the tag written with each record. Must be called before the
+   first record for the TSV header to include the tag column.
+
+-  18.10.26 Original   By: ACRM
+*/
+void SetOutputTag(OUTWRITER *writer, char *tag)
+{
+   writer->tag = tag;
+}
+
+
+/************************************************************************/
+/*>void SetOutputFrame(OUTWRITER *writer, int frame)
+   -------------------------------------------------
+*//**
+   \param[in]   writer    The output writer
+   \param[in]   frame     Translation frame for the following records
+                          (1 to 3 or -1 to -3)
+
+   Sets the frame written with each record. Must be called before the
+   first record for the TSV header to include the frame column.
+
+-  18.10.26 Original   By: ACRM
+*/
+void SetOutputFrame(OUTWRITER *writer, int frame)
+{
+   writer->dna   = TRUE;
+   writer->frame = frame;
+}
+
+
+/************************************************************************/
+/*>void SetOutputPValues(OUTWRITER *writer)
+   -----------------------------------------
+*//**
+   \param[in]   writer    The output writer
+
+   Adds the p-value and E-value of each result to its record. Must be
+   called before the first record for the TSV header to include the
+   columns.
+
+-  18.10.26 Original   By: ACRM
+*/
+void SetOutputPValues(OUTWRITER *writer)
+{
+   writer->pValues = TRUE;
+}
+
+
+/************************************************************************/
+/*>void ResumeOutputWriter(OUTWRITER *writer, long nRecords,
+                           BOOL headerDone)
+   ---------------------------------------------------------
+*//**
+   \param[in]   writer      The output writer
+   \param[in]   nRecords    Records already in the file
+   \param[in]   headerDone  The file already has its header
+
+   Sets up a new writer to continue a file written by an earlier run
+   so that record numbers carry on and the header is not repeated
+
+-  18.10.26 Original   By: ACRM
+*/
+void ResumeOutputWriter(OUTWRITER *writer, long nRecords,
+                        BOOL headerDone)
+{
+   writer->nRecords   = nRecords;
+   writer->headerDone = headerDone;
+}
+
+
+/************************************************************************/
+/*>BOOL FlushOutputWriter(OUTWRITER *writer)
+   -----------------------------------------
+*//**
+   \param[in]   writer    The output writer
+   \return                Success
+
+   Writes out anything in the buffer
+
+-  18.10.26 Original   By: ACRM
+*/
+BOOL FlushOutputWriter(OUTWRITER *writer)
+{
+   if(writer->nUsed)
+   {
+      if(fwrite(writer->buffer, 1, writer->nUsed, writer->fp) !=
+         (size_t)writer->nUsed)
+         return(FALSE);
+      writer->nUsed = 0;
+   }
+   return(fflush(writer->fp) == 0);
+}
+
+
+/************************************************************************/
+/*>BOOL CloseOutputWriter(OUTWRITER *writer)
+   -----------------------------------------
+*//**
+   \param[in]   writer    The output writer
+   \return                Success
+
+   Flushes and frees the writer. The file itself is not closed.
+
+-  18.10.26 Original   By: ACRM
+*/
+BOOL CloseOutputWriter(OUTWRITER *writer)
+{
+   BOOL ok = TRUE;
+
+   /* A binary file always gets its header                              */
+   if((writer->format == OUTFORMAT_BINARY) && !writer->headerDone)
+   {
+      writer->headerDone = TRUE;
+      ok = WriteBinaryHeader(writer);
+   }
+
+   if(!FlushOutputWriter(writer))
+      ok = FALSE;
+   free(writer);
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>int FormatReal(char *buffer, REAL value)
+   ----------------------------------------
+*//**
+   \param[out]  buffer    Buffer for the text (at least 32 characters)
+   \param[in]   value     Value to format
+   \return                Number of characters written (not including
+                          the terminator)
+
+   Formats a number in the same way as printf("%f") but very much
+   faster. Values that are too large to be handled, zero and values
+   within FORMATTIE of a rounding tie are passed to sprintf()
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Rounds ties and negative zero as printf() does
+*/
+int FormatReal(char *buffer, REAL value)
+{
+   char          digits[16];
+   unsigned long whole, frac;
+   REAL          scaled, rem;
+   int           nChar  = 0,
+                 nDigit = 0,
+                 i;
+   BOOL          negative = FALSE;
+
+   /* This also catches NaN. Zero may be negative zero                  */
+   if(!((value > -1.0e9) && (value < 1.0e9)) || (value == 0.0))
+      return(sprintf(buffer, "%f", value));
+
+   if(value < 0.0)
+   {
+      buffer[nChar++] = '-';
+      value    = -value;
+      negative = TRUE;
+   }
+
+   /* The fraction is exact but scaling it may round. printf() rounds
+      the exact value so anything that could be a tie after scaling is
+      passed to sprintf()
+   */
+   whole  = (unsigned long)value;
+   scaled = (value - (REAL)whole) * 1000000.0;
+   frac   = (unsigned long)scaled;
+   rem    = scaled - (REAL)frac;
+   if((rem > 0.5 - FORMATTIE) && (rem < 0.5 + FORMATTIE))
+      return(sprintf(buffer, "%f", (negative ? -value : value)));
+   if(rem > 0.5)
+      frac++;
+   if(frac >= 1000000)
+   {
+      whole++;
+      frac -= 1000000;
+   }
+
+   do
+   {
+      digits[nDigit++] = (char)('0' + (whole % 10));
+      whole /= 10;
+   }  while(whole);
+
+   while(nDigit)
+      buffer[nChar++] = digits[--nDigit];
+
+   buffer[nChar++] = '.';
+   for(i=5; i>=0; i--)
+   {
+      buffer[nChar+i] = (char)('0' + (frac % 10));
+      frac /= 10;
+   }
+   nChar += 6;
+   buffer[nChar] = '\0';
+
+   return(nChar);
+}
+
+
+/************************************************************************/
+/*>static BOOL AppendBytes(OUTWRITER *writer, char *bytes, int nBytes)
+   -------------------------------------------------------------------
+*//**
+   \param[in]   writer    The output writer
+   \param[in]   bytes     Data to add to the buffer
+   \param[in]   nBytes    Number of bytes
+   \return                Success
+
+   Adds data to the output buffer, writing the buffer out if it is full
+
+-  18.10.26 Original   By: ACRM
+*/
+static BOOL AppendBytes(OUTWRITER *writer, char *bytes, int nBytes)
+{
+   if(writer->nUsed + nBytes > OUTBUFFSIZE)
+   {
+      if(fwrite(writer->buffer, 1, writer->nUsed, writer->fp) !=
+         (size_t)writer->nUsed)
+         return(FALSE);
+      writer->nUsed = 0;
+
+      if(nBytes > OUTBUFFSIZE)
+         return(fwrite(bytes, 1, nBytes, writer->fp) == (size_t)nBytes);
+   }
+
+   memcpy(writer->buffer + writer->nUsed, bytes, nBytes);
+   writer->nUsed += nBytes;
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL AppendString(OUTWRITER *writer, char *string)
+   ---------------------------------------------------------
+*//**
+   \param[in]   writer    The output writer
+   \param[in]   string    String to add to the buffer
+   \return                Success
+
+-  18.10.26 Original   By: ACRM
+*/
+static BOOL AppendString(OUTWRITER *writer, char *string)
+{
+   return(AppendBytes(writer, string, strlen(string)));
+}
+
+
+/************************************************************************/
+/*>static BOOL AppendJSONString(OUTWRITER *writer, char *string)
+   -------------------------------------------------------------
+*//**
+   \param[in]   writer    The output writer
+   \param[in]   string    String to add to the buffer
+   \return                Success
+
+   Adds a quoted string to the buffer, escaping as required by JSON
+
+-  18.10.26 Original   By: ACRM
+*/
+static BOOL AppendJSONString(OUTWRITER *writer, char *string)
+{
+   char escaped[8];
+
+   if(!AppendBytes(writer, "\"", 1))
+      return(FALSE);
+
+   for(; *string; string++)
+   {
+      unsigned char c = (unsigned char)*string;
+
+      if((c == '"') || (c == '\\'))
+      {
+         escaped[0] = '\\';
+         escaped[1] = (char)c;
+         if(!AppendBytes(writer, escaped, 2))
+            return(FALSE);
+      }
+      else if(c < 0x20)
+      {
+         sprintf(escaped, "\\u%04x", c);
+         if(!AppendBytes(writer, escaped, 6))
+            return(FALSE);
+      }
+      else if(!AppendBytes(writer, string, 1))
+      {
+         return(FALSE);
+      }
+   }
+
+   return(AppendBytes(writer, "\"", 1));
+}
+
+
+/************************************************************************/
+/*>static BOOL AppendInt(OUTWRITER *writer, long value)
+   ----------------------------------------------------
+*//**
+   \param[in]   writer    The output writer
+   \param[in]   value     Integer to add to the buffer as text
+   \return                Success
+
+-  18.10.26 Original   By: ACRM
+*/
+static BOOL AppendInt(OUTWRITER *writer, long value)
+{
+   char          text[24];
+   int           start = sizeof(text);
+   unsigned long uValue;
+
+   /* Digits are built backwards from the end of the buffer             */
+   uValue = (value < 0) ? (unsigned long)(-value) : (unsigned long)value;
+   do
+   {
+      text[--start] = (char)('0' + (uValue % 10));
+      uValue /= 10;
+   }  while(uValue);
+
+   if(value < 0)
+      text[--start] = '-';
+
+   return(AppendBytes(writer, text+start, sizeof(text) - start));
+}
+
+
+/************************************************************************/
+/*>static BOOL AppendReal(OUTWRITER *writer, REAL value)
+   -----------------------------------------------------
+*//**
+   \param[in]   writer    The output writer
+   \param[in]   value     Number to add to the buffer as text
+   \return                Success
+
+-  18.10.26 Original   By: ACRM
+*/
+static BOOL AppendReal(OUTWRITER *writer, REAL value)
+{
+   char text[64];
+   int  nChar = FormatReal(text, value);
+
+   return(AppendBytes(writer, text, nChar));
+}
+
+
+/************************************************************************/
+/*>static BOOL AppendUInt32(OUTWRITER *writer, unsigned long value)
+   ----------------------------------------------------------------
+*//**
+   \param[in]   writer    The output writer
+   \param[in]   value     Value to add to the buffer as 4 bytes
+   \return                Success
+
+   Adds a little-endian 32-bit integer to the buffer
+
+-  18.10.26 Original   By: ACRM
+*/
+static BOOL AppendUInt32(OUTWRITER *writer, unsigned long value)
+{
+   char bytes[4];
+
+   bytes[0] = (char)(value         & 0xFF);
+   bytes[1] = (char)((value >>  8) & 0xFF);
+   bytes[2] = (char)((value >> 16) & 0xFF);
+   bytes[3] = (char)((value >> 24) & 0xFF);
+
+   return(AppendBytes(writer, bytes, 4));
+}
+
+
+/************************************************************************/
+/*>static BOOL AppendFloat32(OUTWRITER *writer, REAL value)
+   --------------------------------------------------------
+*//**
+   \param[in]   writer    The output writer
+   \param[in]   value     Value to add to the buffer as an IEEE float
+   \return                Success
+
+-  18.10.26 Original   By: ACRM
+*/
+static BOOL AppendFloat32(OUTWRITER *writer, REAL value)
+{
+   float        fValue = (float)value;
+   unsigned int bits;
+
+   memcpy(&bits, &fValue, 4);
+   return(AppendUInt32(writer, (unsigned long)bits));
+}
+
+
+/************************************************************************/
+/*>static BOOL AppendProbability(OUTWRITER *writer, REAL value)
+   ------------------------------------------------------------
+*//**
+   \param[in]   writer    The output writer
+   \param[in]   value     p-value or E-value to add to the buffer as
+                          text
+   \return                Success
+
+   These may be far too small for FormatReal() so are written in
+   scientific notation
+
+-  18.10.26 Original   By: ACRM
+*/
+static BOOL AppendProbability(OUTWRITER *writer, REAL value)
+{
+   char text[64];
+   int  nChar = sprintf(text, "%.3e", value);
+
+   return(AppendBytes(writer, text, nChar));
+}
+
+
+/************************************************************************/
+/*>static char *SubgroupName(OUTWRITER *writer, int id)
+   ----------------------------------------------------
+*//**
+   \param[in]   writer    The output writer
+   \param[in]   id        Subgroup ID
+   \return                The subgroup name from the current model
+
+-  18.10.26 Original   By: ACRM
+*/
+static char *SubgroupName(OUTWRITER *writer, int id)
+{
+   if(writer->models != NULL)
+      return(ModelSubgroupName(writer->models[writer->model], id));
+   return(GetSubgroupName(id));
+}
+
+
+/************************************************************************/
+/*>static BOOL WriteBinaryHeader(OUTWRITER *writer)
+   ------------------------------------------------
+*//**
+   \param[in]   writer    The output writer
+   \return                Success
+
+   Writes the header for binary output including the table of
+   subgroup names used to decode subgroup IDs
+
+-  18.10.26 Original   By: ACRM
+*/
+static BOOL WriteBinaryHeader(OUTWRITER *writer)
+{
+   int nSubGroups = GetSubgroupCount(),
+       i;
+
+   if(!AppendBytes(writer, OUTBINMAGIC, 4)                     ||
+      !AppendUInt32(writer, OUTBINVERSION)                     ||
+      !AppendUInt32(writer, BINRECORDSIZE(writer->nTop))       ||
+      !AppendUInt32(writer, (unsigned long)writer->nTop)       ||
+      !AppendUInt32(writer, (unsigned long)nSubGroups))
+      return(FALSE);
+
+   for(i=0; i<nSubGroups; i++)
+   {
+      char *name = GetSubgroupName(i);
+      int  len   = strlen(name);
+      char lenBytes[2];
+
+      lenBytes[0] = (char)(len & 0xFF);
+      lenBytes[1] = (char)((len >> 8) & 0xFF);
+      if(!AppendBytes(writer, lenBytes, 2) ||
+         !AppendBytes(writer, name, len))
+         return(FALSE);
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL WriteText(OUTWRITER *writer, SUBGROUPRESULT *result)
+   ----------------------------------------------------------------
+*//**
+   \param[in]   writer    The output writer
+   \param[in]   result    The subgroup assignment
+   \return                Success
+
+   The original output format
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Writes any further ranked subgroups
+-  18.10.26 Writes the tag
+-  18.10.26 Writes the model label and marks the winner
+-  18.10.26 Writes the frame
+-  18.10.26 Writes the p-value and E-value
+*/
+static BOOL WriteText(OUTWRITER *writer, SUBGROUPRESULT *result)
+{
+   int rank;
+   
+   if((writer->tag != NULL) &&
+      (!AppendString(writer, writer->tag) ||
+       !AppendBytes(writer, "\t", 1)))
+      return(FALSE);
+
+   if((writer->models != NULL) &&
+      (!AppendString(writer, writer->models[writer->model]->label) ||
+       !AppendBytes(writer, "\t", 1)))
+      return(FALSE);
+
+   if(writer->dna &&
+      (!AppendInt(writer, writer->frame) ||
+       !AppendBytes(writer, "\t", 1)))
+      return(FALSE);
+
+   if(!AppendString(writer, SubgroupName(writer, result->best)))
+      return(FALSE);
+
+   if(writer->winner && !AppendString(writer, " *"))
+      return(FALSE);
+
+   if(writer->verbose)
+   {
+      if(!AppendBytes(writer, ",", 1)                              ||
+         !AppendReal(writer, result->score)                        ||
+         !AppendBytes(writer, ",", 1)                              ||
+         !AppendString(writer, SubgroupName(writer, result->second)) ||
+         !AppendBytes(writer, ",", 1)                              ||
+         !AppendReal(writer, result->secondScore))
+         return(FALSE);
+
+      for(rank=2; rank<result->nTop; rank++)
+      {
+         if(!AppendBytes(writer, ",", 1)                           ||
+            !AppendString(writer,
+                          SubgroupName(writer, result->topId[rank])) ||
+            !AppendBytes(writer, ",", 1)                           ||
+            !AppendReal(writer, result->topScore[rank]))
+            return(FALSE);
+      }
+   }
+
+   if(writer->pValues &&
+      (!AppendBytes(writer, ",", 1)                                ||
+       !AppendProbability(writer, result->pValue)                  ||
+       !AppendBytes(writer, ",", 1)                                ||
+       !AppendProbability(writer, result->eValue)))
+      return(FALSE);
+
+   return(AppendBytes(writer, "\n", 1));
+}
+
+
+/************************************************************************/
+/*>static BOOL WriteTSVHeader(OUTWRITER *writer)
+   ---------------------------------------------
+*//**
+   \param[in]   writer    The output writer
+   \return                Success
+
+   Writes the column names as a comment line
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Added the file column for tagged output
+-  18.10.26 Added the model columns
+-  18.10.26 Added the frame column
+-  18.10.26 Added the p-value and E-value columns
+-  18.10.26 No winner column if the models can't be compared
+*/
+static BOOL WriteTSVHeader(OUTWRITER *writer)
+{
+   int rank;
+
+   if(!AppendString(writer, (writer->tag != NULL) ? "#file\t" : "#") ||
+      !AppendString(writer, "id\tchain\t")                            ||
+      ((writer->models != NULL) && !AppendString(writer, "model\t"))  ||
+      ((writer->models != NULL) && writer->compareModels &&
+       !AppendString(writer, "winner\t"))                             ||
+      (writer->dna && !AppendString(writer, "frame\t"))               ||
+      !AppendString(writer, "chaintype\tsubgroup\t\
+bestid\tbest\tscore\toffset\t\
+secondid\tsecond\tsecondscore\tsecondoffset"))
+      return(FALSE);
+
+   for(rank=3; rank<=writer->nTop; rank++)
+   {
+      char text[80];
+      sprintf(text, "\tid%d\tname%d\tscore%d\toffset%d",
+              rank, rank, rank, rank);
+      if(!AppendString(writer, text))
+         return(FALSE);
+   }
+   if(writer->pValues && !AppendString(writer, "\tpvalue\tevalue"))
+      return(FALSE);
+   return(AppendBytes(writer, "\n", 1));
+}
+
+
+/************************************************************************/
+/*>static BOOL WriteTSV(OUTWRITER *writer, char *id, int chainNum,
+                        SUBGROUPRESULT *result)
+   ---------------------------------------------------------------
+*//**
+   \param[in]   writer    The output writer
+   \param[in]   id        Sequence identifier
+   \param[in]   chainNum  Chain number within the entry
+   \param[in]   result    The subgroup assignment
+   \return                Success
+
+   Unused ranks are written with an ID of -1 and a blank name
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Writes all ranked subgroups with offsets
+-  18.10.26 Writes the tag
+-  18.10.26 Writes the model columns
+-  18.10.26 Writes the frame
+-  18.10.26 Writes the p-value and E-value
+-  18.10.26 No winner column if the models can't be compared
+*/
+static BOOL WriteTSV(OUTWRITER *writer, char *id, int chainNum,
+                     SUBGROUPRESULT *result)
+{
+   int rank;
+   
+   if((writer->tag != NULL) &&
+      (!AppendString(writer, writer->tag) ||
+       !AppendBytes(writer, "\t", 1)))
+      return(FALSE);
+
+   if(!AppendString(writer, id)                                    ||
+      !AppendBytes(writer, "\t", 1)                                ||
+      !AppendInt(writer, chainNum)                                 ||
+      !AppendBytes(writer, "\t", 1))
+      return(FALSE);
+
+   if((writer->models != NULL) &&
+      (!AppendString(writer, writer->models[writer->model]->label) ||
+       !AppendBytes(writer, "\t", 1)))
+      return(FALSE);
+
+   if((writer->models != NULL) && writer->compareModels &&
+      (!AppendInt(writer, writer->winner ? 1 : 0) ||
+       !AppendBytes(writer, "\t", 1)))
+      return(FALSE);
+
+   if(writer->dna &&
+      (!AppendInt(writer, writer->frame) ||
+       !AppendBytes(writer, "\t", 1)))
+      return(FALSE);
+
+   if(      !AppendString(writer, ChainTypeLabel(result->chainType))     ||
+      !AppendBytes(writer, "\t", 1)                                ||
+      !AppendInt(writer, result->subGroup))
+      return(FALSE);
+
+   for(rank=0; rank<writer->nTop; rank++)
+   {
+      BOOL used   = (rank < result->nTop);
+      int  sgId   = used ? result->topId[rank] : -1;
+      
+      if(!AppendBytes(writer, "\t", 1)                             ||
+         !AppendInt(writer, sgId)                                  ||
+         !AppendBytes(writer, "\t", 1)                             ||
+         !AppendString(writer, SubgroupName(writer, sgId))         ||
+         !AppendBytes(writer, "\t", 1)                             ||
+         !AppendReal(writer, used ? result->topScore[rank] : 0.0)  ||
+         !AppendBytes(writer, "\t", 1)                             ||
+         !AppendInt(writer, used ? result->topOffset[rank] : 0))
+         return(FALSE);
+   }
+
+   if(writer->pValues &&
+      (!AppendBytes(writer, "\t", 1)                               ||
+       !AppendProbability(writer, result->pValue)                  ||
+       !AppendBytes(writer, "\t", 1)                               ||
+       !AppendProbability(writer, result->eValue)))
+      return(FALSE);
+
+   return(AppendBytes(writer, "\n", 1));
+}
+
+
+/************************************************************************/
+/*>static BOOL WriteJSON(OUTWRITER *writer, char *id, int chainNum,
+                         SUBGROUPRESULT *result)
+   ----------------------------------------------------------------
+*//**
+   \param[in]   writer    The output writer
+   \param[in]   id        Sequence identifier
+   \param[in]   chainNum  Chain number within the entry
+   \param[in]   result    The subgroup assignment
+   \return                Success
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Added offsets and the ranked array
+-  18.10.26 Writes the tag
+-  18.10.26 Writes the model and winner
+-  18.10.26 Writes the frame
+-  18.10.26 Writes the p-value and E-value
+-  18.10.26 No winner member if the models can't be compared
+*/
+static BOOL WriteJSON(OUTWRITER *writer, char *id, int chainNum,
+                      SUBGROUPRESULT *result)
+{
+   int rank;
+   
+   if((writer->tag != NULL) &&
+      (!AppendString(writer, "{\"file\":")                          ||
+       !AppendJSONString(writer, writer->tag)                      ||
+       !AppendString(writer, ",")))
+      return(FALSE);
+
+   if(!(AppendString(writer, (writer->tag != NULL) ? "\"id\":" :
+                                                      "{\"id\":")   &&
+        AppendJSONString(writer, id)                               &&
+        AppendString(writer, ",\"chain\":")                        &&
+        AppendInt(writer, chainNum)))
+      return(FALSE);
+
+   if((writer->models != NULL) &&
+      !(AppendString(writer, ",\"model\":")                       &&
+        AppendJSONString(writer, 
+                         writer->models[writer->model]->label)))
+      return(FALSE);
+
+   if((writer->models != NULL) && writer->compareModels &&
+      !(AppendString(writer, ",\"winner\":")                      &&
+        AppendInt(writer, writer->winner ? 1 : 0)))
+      return(FALSE);
+
+   if(writer->dna &&
+      !(AppendString(writer, ",\"frame\":") &&
+        AppendInt(writer, writer->frame)))
+      return(FALSE);
+
+   if(!(AppendString(writer, ",\"chaintype\":")                    &&
+        AppendJSONString(writer, ChainTypeLabel(result->chainType)) &&
+        AppendString(writer, ",\"subgroup\":")                     &&
+        AppendInt(writer, result->subGroup)                        &&
+        AppendString(writer, ",\"bestid\":")                       &&
+        AppendInt(writer, result->best)                            &&
+        AppendString(writer, ",\"best\":")                         &&
+        AppendJSONString(writer, SubgroupName(writer, result->best)) &&
+        AppendString(writer, ",\"score\":")                        &&
+        AppendReal(writer, result->score)                          &&
+        AppendString(writer, ",\"offset\":")                       &&
+        AppendInt(writer, result->nTop ? result->topOffset[0] : 0)  &&
+        AppendString(writer, ",\"secondid\":")                     &&
+        AppendInt(writer, result->second)                          &&
+        AppendString(writer, ",\"second\":")                       &&
+        AppendJSONString(writer,
+                         SubgroupName(writer, result->second))     &&
+        AppendString(writer, ",\"secondscore\":")                  &&
+        AppendReal(writer, result->secondScore)                    &&
+        AppendString(writer, ",\"secondoffset\":")                 &&
+        AppendInt(writer, (result->nTop > 1) ?
+                  result->topOffset[1] : 0)))
+      return(FALSE);
+
+   if(writer->nTop > 2)
+   {
+      if(!AppendString(writer, ",\"ranked\":["))
+         return(FALSE);
+      for(rank=0; rank<result->nTop; rank++)
+      {
+         if(!(AppendString(writer, rank ? ",{\"id\":" : "{\"id\":")   &&
+              AppendInt(writer, result->topId[rank])               &&
+              AppendString(writer, ",\"name\":")                   &&
+              AppendJSONString(writer,
+                               SubgroupName(writer,
+                                            result->topId[rank]))  &&
+              AppendString(writer, ",\"score\":")                  &&
+              AppendReal(writer, result->topScore[rank])           &&
+              AppendString(writer, ",\"offset\":")                 &&
+              AppendInt(writer, result->topOffset[rank])           &&
+              AppendString(writer, "}")))
+            return(FALSE);
+      }
+      if(!AppendString(writer, "]"))
+         return(FALSE);
+   }
+
+   if(writer->pValues &&
+      !(AppendString(writer, ",\"pvalue\":")                      &&
+        AppendProbability(writer, result->pValue)                  &&
+        AppendString(writer, ",\"evalue\":")                      &&
+        AppendProbability(writer, result->eValue)))
+      return(FALSE);
+   
+   return(AppendString(writer, "}\n"));
+}
+
+
+/************************************************************************/
+/*>static BOOL WriteBinary(OUTWRITER *writer, char *id, int chainNum,
+                           SUBGROUPRESULT *result)
+   ------------------------------------------------------------------
+*//**
+   \param[in]   writer    The output writer
+   \param[in]   id        Sequence identifier (truncated to OUTIDLEN)
+   \param[in]   chainNum  Chain number within the entry
+   \param[in]   result    The subgroup assignment
+   \return                Success
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Writes K ranked subgroups with offsets
+*/
+static BOOL WriteBinary(OUTWRITER *writer, char *id, int chainNum,
+                        SUBGROUPRESULT *result)
+{
+   char idField[OUTIDLEN];
+   int  rank;
+
+   memset(idField, 0, OUTIDLEN);
+   strncpy(idField, id, OUTIDLEN);
+
+   if(!AppendUInt32(writer, (unsigned long)writer->nRecords)         ||
+      !AppendUInt32(writer, (unsigned long)chainNum)                 ||
+      !AppendBytes(writer, idField, OUTIDLEN))
+      return(FALSE);
+
+   for(rank=0; rank<writer->nTop; rank++)
+   {
+      BOOL used = (rank < result->nTop);
+      
+      if(!AppendUInt32(writer,
+                       (unsigned long)(used ? result->topId[rank] : -1)) ||
+         !AppendFloat32(writer, used ? result->topScore[rank] : 0.0)    ||
+         !AppendUInt32(writer,
+                       (unsigned long)(used ? result->topOffset[rank] : 0)))
+         return(FALSE);
+   }
+   return(TRUE);
+}
@@ -0,0 +1,121 @@
+/*************************************************************************
+
+   Program:    hsubgroup
+   File:       output.h
+
+   Version:    V3.4
+   Date:       18.10.26
+   Function:   Output writers for subgroup assignments
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V3.3  18.10.26   Original
+   V3.4  18.10.26   Writes the top-K ranking and offsets
+   V3.9  18.10.26   Added ResumeOutputWriter()
+   V3.10 18.10.26   Added SetOutputTag()
+   V3.12 18.10.26   Added SetOutputModels() and WriteModelResults()
+   V3.17 18.10.26   Added SetOutputFrame()
+   V3.22 18.10.26   Added SetOutputPValues()
+   V3.26 18.10.26   There is no winner if the models' scores are on
+                    different scales
+
+*************************************************************************/
+#ifndef _OUTPUT_H
+#define _OUTPUT_H
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define OUTFORMAT_TEXT      0  /* Original comma-separated names        */
+#define OUTFORMAT_TSV       1  /* Tab separated with sequence IDs       */
+#define OUTFORMAT_JSON      2  /* JSON Lines                            */
+#define OUTFORMAT_BINARY    3  /* Fixed size binary records             */
+
+#define OUTBUFFSIZE   1048576  /* Size of the output buffer             */
+#define OUTIDLEN           16  /* Sequence ID field in binary records   */
+#define OUTBINMAGIC    "HSGB"  /* Magic number for binary files         */
+#define OUTBINVERSION       1
+
+/* An output writer. Records are formatted into the buffer which is
+   only written when full or when the writer is closed
+*/
+typedef struct
+{
+   FILE *fp;
+   char *tag;               /* Source file name for tagged output       */
+   SUBGROUPMODEL **models;  /* Models for WriteModelResults()           */
+   long nRecords;
+   int  format,
+        nUsed,
+        nTop,
+        nModels,
+        model,              /* Model of the record being written        */
+        frame;              /* Translation frame of the record          */
+   BOOL verbose,
+        headerDone,
+        winner,             /* This model has the best score            */
+        compareModels,      /* Models have a winner (same score scale)  */
+        dna,                /* Records have a translation frame         */
+        pValues;            /* Records end with the p- and E-value      */
+   char buffer[OUTBUFFSIZE];
+} OUTWRITER;
+
+
+/************************************************************************/
+/* Prototypes
+*/
+int       ParseOutputFormat(char *name);
+OUTWRITER *OpenOutputWriter(FILE *fp, int format, BOOL verbose,
+                            int nTop);
+BOOL      WriteResult(OUTWRITER *writer, char *id, int chainNum,
+                      SUBGROUPRESULT *result);
+BOOL      WriteModelResults(OUTWRITER *writer, char *id, int chainNum,
+                            SUBGROUPRESULT *results);
+void      SetOutputModels(OUTWRITER *writer, SUBGROUPMODEL **models,
+                          int nModels);
+void      SetOutputTag(OUTWRITER *writer, char *tag);
+void      SetOutputFrame(OUTWRITER *writer, int frame);
+void      SetOutputPValues(OUTWRITER *writer);
+void      ResumeOutputWriter(OUTWRITER *writer, long nRecords,
+                             BOOL headerDone);
+BOOL      FlushOutputWriter(OUTWRITER *writer);
+BOOL      CloseOutputWriter(OUTWRITER *writer);
+int       FormatReal(char *buffer, REAL value);
+
+#endif
@@ -0,0 +1,405 @@
+/*************************************************************************
+
+   Program:    hsubgroup
+   File:       perfcount.c
+
+   Version:    V3.6
+   Date:       18.10.26
+   Function:   Hardware performance counters for each stage
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Reads Linux perf_event_open() counters around the model load,
+   parsing, scoring and output stages of hsubgroup. Cycles,
+   instructions, branches, branch misses, L1 data cache read misses and
+   last level cache read misses are counted along with the task clock,
+   page faults and context switches. The generic events have no L2
+   cache event so the last level cache is used instead.
+
+   Each event that cannot be opened is skipped. In containers the
+   hardware events are often unavailable, leaving the software events;
+   if nothing can be opened, only the software timing from --stats is
+   reported. On other systems the counters are never available.
+
+   Counts for the parse, score and output stages are reported per chain
+   and the score counts are also reported per (subgroup, offset)
+   evaluation.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V3.6  18.10.26   Original
+
+*************************************************************************/
+/* Includes
+*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include "bioplib/MathType.h"
+#include "bioplib/SysDefs.h"
+#include "subgroup.h"
+#include "stats.h"
+#include "perfcount.h"
+
+#ifdef __linux__
+#  include <unistd.h>
+#  include <sys/ioctl.h>
+#  include <sys/syscall.h>
+#  include <linux/perf_event.h>
+#endif
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define CACHEMISS(cache) ((cache) |                                      \
+                          (PERF_COUNT_HW_CACHE_OP_READ << 8) |           \
+                          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+/************************************************************************/
+/* Globals
+*/
+static char *sEventNames[NPERFEVENTS] =
+{
+   "cycles", "instructions", "branches", "branch_misses", "l1d_misses",
+   "llc_misses", "task_clock_ns", "page_faults", "context_switches"
+};
+static char *sStageNames[NPERFSTAGES] =
+{
+   "load", "parse", "score", "output"
+};
+
+/************************************************************************/
+/* Prototypes
+*/
+static void WriteEventsJSON(FILE *fp, PERFCOUNTERS *perf, int stage,
+                            REAL divisor);
+
+
+/************************************************************************/
+/*>BOOL OpenPerfCounters(PERFCOUNTERS *perf)
+   -----------------------------------------
+*//**
+   \param[out]  perf    Counters
+   \return              Were any counters opened?
+
+   Opens as many of the events as possible for this process in one
+   group. If none can be opened, perf->error says why and PerfLap()
+   does nothing.
+
+-  18.10.26 Original   By: ACRM
+*/
+BOOL OpenPerfCounters(PERFCOUNTERS *perf)
+{
+#ifdef __linux__
+   static unsigned int types[NPERFEVENTS] =
+   {
+      PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE,
+      PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE, PERF_TYPE_HW_CACHE,
+      PERF_TYPE_SOFTWARE, PERF_TYPE_SOFTWARE, PERF_TYPE_SOFTWARE
+   };
+   static unsigned long configs[NPERFEVENTS] =
+   {
+      PERF_COUNT_HW_CPU_CYCLES,       PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_BRANCH_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES,
+      CACHEMISS(PERF_COUNT_HW_CACHE_L1D), CACHEMISS(PERF_COUNT_HW_CACHE_LL),
+      PERF_COUNT_SW_TASK_CLOCK,       PERF_COUNT_SW_PAGE_FAULTS,
+      PERF_COUNT_SW_CONTEXT_SWITCHES
+   };
+   int  event,
+        lastErrno = 0;
+#endif
+
+   memset(perf, 0, sizeof(PERFCOUNTERS));
+   perf->leader = -1;
+   
+#ifdef __linux__
+   for(event=0; event<NPERFEVENTS; event++)
+   {
+      struct perf_event_attr attr;
+      int                    fd;
+
+      perf->slot[event] = -1;
+      
+      memset(&attr, 0, sizeof(attr));
+      attr.size           = sizeof(attr);
+      attr.type           = types[event];
+      attr.config         = configs[event];
+      attr.exclude_kernel = 1;
+      attr.exclude_hv     = 1;
+      attr.read_format    = PERF_FORMAT_GROUP |
+                            PERF_FORMAT_TOTAL_TIME_ENABLED |
+                            PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+      if((fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1,
+                            perf->leader, 0)) < 0)
+      {
+         lastErrno = errno;
+         continue;
+      }
+
+      if(perf->leader < 0)
+         perf->leader = fd;
+      perf->slot[event] = perf->nOpen++;
+   }
+
+   if(perf->nOpen)
+   {
+      perf->enabled = TRUE;
+      PerfLap(perf, PERFSTAGE_NONE);
+   }
+   else
+   {
+      sprintf(perf->error, "perf_event_open: %s", strerror(lastErrno));
+   }
+#else
+   strcpy(perf->error, "not supported on this system");
+#endif
+   
+   return(perf->enabled);
+}
+
+
+/************************************************************************/
+/*>void PerfLap(PERFCOUNTERS *perf, int stage)
+   -------------------------------------------
+*//**
+   \param[in,out] perf    Counters
+   \param[in]     stage   PERFSTAGE_* to be charged with the counts
+                          since the last call
+
+-  18.10.26 Original   By: ACRM
+*/
+void PerfLap(PERFCOUNTERS *perf, int stage)
+{
+#ifdef __linux__
+   __u64 values[3+NPERFEVENTS];
+   int   event;
+
+   if(!perf->enabled)
+      return;
+   
+   if(read(perf->leader, values, sizeof(values)) <
+      (ssize_t)((3 + perf->nOpen) * sizeof(__u64)))
+      return;
+
+   perf->timeEnabled = (REAL)values[1];
+   perf->timeRunning = (REAL)values[2];
+
+   for(event=0; event<NPERFEVENTS; event++)
+   {
+      if(perf->slot[event] >= 0)
+      {
+         REAL value = (REAL)values[3 + perf->slot[event]];
+         if(stage >= 0)
+            perf->counts[stage][event] += value - perf->last[event];
+         perf->last[event] = value;
+      }
+   }
+#endif
+}
+
+
+/************************************************************************/
+/*>void ClosePerfCounters(PERFCOUNTERS *perf)
+   ------------------------------------------
+*//**
+   \param[in,out] perf    Counters
+
+   Closes the counters. The counts are kept for the report
+
+-  18.10.26 Original   By: ACRM
+*/
+void ClosePerfCounters(PERFCOUNTERS *perf)
+{
+#ifdef __linux__
+   if(perf->leader >= 0)
+   {
+      ioctl(perf->leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+      close(perf->leader);
+      perf->leader = -1;
+   }
+#endif
+   perf->enabled = FALSE;
+}
+
+
+/************************************************************************/
+/*>static void WriteEventsJSON(FILE *fp, PERFCOUNTERS *perf, int stage,
+                               REAL divisor)
+   --------------------------------------------------------------------
+*//**
+   \param[in]   fp        Output file
+   \param[in]   perf      Counters
+   \param[in]   stage     PERFSTAGE_*
+   \param[in]   divisor   Divide counts by this
+
+   Writes the available counts for a stage as a JSON object, with the
+   IPC if cycles and instructions are both available
+
+-  18.10.26 Original   By: ACRM
+*/
+static void WriteEventsJSON(FILE *fp, PERFCOUNTERS *perf, int stage,
+                            REAL divisor)
+{
+   int  event;
+   BOOL first = TRUE;
+
+   putc('{', fp);
+   for(event=0; event<NPERFEVENTS; event++)
+   {
+      if(perf->slot[event] >= 0)
+      {
+         fprintf(fp, "%s\"%s\":%.3f", (first ? "" : ","),
+                 sEventNames[event],
+                 perf->counts[stage][event] / divisor);
+         first = FALSE;
+      }
+   }
+   if((perf->slot[PERFEVENT_CYCLES] >= 0) &&
+      (perf->slot[PERFEVENT_INSTRUCTIONS] >= 0) &&
+      (perf->counts[stage][PERFEVENT_CYCLES] > 0.0))
+   {
+      fprintf(fp, ",\"ipc\":%.3f",
+              perf->counts[stage][PERFEVENT_INSTRUCTIONS] /
+              perf->counts[stage][PERFEVENT_CYCLES]);
+   }
+   putc('}', fp);
+}
+
+
+/************************************************************************/
+/*>void WritePerfReport(FILE *fp, PERFCOUNTERS *perf, RUNSTATS *stats,
+                        int format)
+   -------------------------------------------------------------------
+*//**
+   \param[in]   fp        Output file
+   \param[in]   perf      Counters
+   \param[in]   stats     Run statistics giving the numbers of chains
+                          and evaluations
+   \param[in]   format    STATS_TEXT or STATS_JSON
+
+   Writes the counter report. Model load is given as a total, parse,
+   score and output per chain, and score also per evaluation. The JSON
+   version is a single line following the --stats object.
+
+-  18.10.26 Original   By: ACRM
+*/
+void WritePerfReport(FILE *fp, PERFCOUNTERS *perf, RUNSTATS *stats,
+                     int format)
+{
+   REAL chains      = (stats->chains    > 0) ? (REAL)stats->chains    : 1.0,
+        evaluations = (stats->evaluated > 0) ? (REAL)stats->evaluated : 1.0;
+   BOOL multiplexed = (perf->timeRunning < perf->timeEnabled);
+   int  event, stage;
+
+   if(format == STATS_JSON)
+   {
+      if(!perf->nOpen)
+      {
+         fprintf(fp, "{\"counters\":{\"available\":false,\
+\"error\":\"%s\"}}\n", perf->error);
+         return;
+      }
+      
+      fprintf(fp, "{\"counters\":{\"available\":true,\
+\"multiplexed\":%s,\"total\":{", (multiplexed ? "true" : "false"));
+      for(stage=0; stage<NPERFSTAGES; stage++)
+      {
+         fprintf(fp, "%s\"%s\":", (stage ? "," : ""), sStageNames[stage]);
+         WriteEventsJSON(fp, perf, stage, 1.0);
+      }
+      fprintf(fp, "},\"per_chain\":{");
+      for(stage=PERFSTAGE_PARSE; stage<NPERFSTAGES; stage++)
+      {
+         fprintf(fp, "%s\"%s\":", ((stage!=PERFSTAGE_PARSE) ? "," : ""),
+                 sStageNames[stage]);
+         WriteEventsJSON(fp, perf, stage, chains);
+      }
+      fprintf(fp, "},\"per_evaluation\":{\"score\":");
+      WriteEventsJSON(fp, perf, PERFSTAGE_SCORE, evaluations);
+      fprintf(fp, "}}}\n");
+      return;
+   }
+
+   if(!perf->nOpen)
+   {
+      fprintf(fp, "Performance counters unavailable (%s)\n", perf->error);
+      fprintf(fp, "   Software timing only\n");
+      return;
+   }
+
+   fprintf(fp, "Performance counters%s\n",
+           (multiplexed ? " (multiplexed - counts are underestimates)" :
+                          ""));
+   fprintf(fp, "   %-17s %12s %12s %12s %12s %12s\n", "", "load",
+           "parse/chain", "score/chain", "output/chain", "score/eval");
+   for(event=0; event<=NPERFEVENTS; event++)
+   {
+      REAL div[NPERFSTAGES+1];
+
+      div[0] = 1.0;
+      div[1] = div[2] = div[3] = chains;
+      div[4] = evaluations;
+      
+      if(event == NPERFEVENTS)
+      {
+         /* Instructions per cycle                                      */
+         if((perf->slot[PERFEVENT_CYCLES] < 0) ||
+            (perf->slot[PERFEVENT_INSTRUCTIONS] < 0))
+            break;
+         fprintf(fp, "   %-17s", "ipc");
+         for(stage=0; stage<=NPERFSTAGES; stage++)
+         {
+            int  s   = (stage < NPERFSTAGES) ? stage : PERFSTAGE_SCORE;
+            REAL cyc = perf->counts[s][PERFEVENT_CYCLES];
+            fprintf(fp, " %12.3f", (cyc > 0.0) ?
+                    perf->counts[s][PERFEVENT_INSTRUCTIONS] / cyc : 0.0);
+         }
+         fprintf(fp, "\n");
+      }
+      else if(perf->slot[event] >= 0)
+      {
+         fprintf(fp, "   %-17s", sEventNames[event]);
+         for(stage=0; stage<=NPERFSTAGES; stage++)
+         {
+            int s = (stage < NPERFSTAGES) ? stage : PERFSTAGE_SCORE;
+            fprintf(fp, " %12.3f", perf->counts[s][event] / div[stage]);
+         }
+         fprintf(fp, "\n");
+      }
+   }
+}
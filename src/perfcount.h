@@ -0,0 +1,102 @@
+/*************************************************************************
+
+   Program:    hsubgroup
+   File:       perfcount.h
+
+   Version:    V3.6
+   Date:       18.10.26
+   Function:   Hardware performance counters for each stage
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V3.6  18.10.26   Original
+
+*************************************************************************/
+#ifndef _PERFCOUNT_H
+#define _PERFCOUNT_H
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define PERFSTAGE_NONE        -1  /* Resynchronize without recording    */
+#define PERFSTAGE_LOAD         0
+#define PERFSTAGE_PARSE        1
+#define PERFSTAGE_SCORE        2
+#define PERFSTAGE_OUTPUT       3
+#define NPERFSTAGES            4
+
+#define PERFEVENT_CYCLES       0
+#define PERFEVENT_INSTRUCTIONS 1
+#define PERFEVENT_BRANCHES     2
+#define PERFEVENT_BRANCHMISSES 3
+#define PERFEVENT_L1DMISSES    4
+#define PERFEVENT_LLCMISSES    5
+#define PERFEVENT_TASKCLOCK    6
+#define PERFEVENT_PAGEFAULTS   7
+#define PERFEVENT_CTXSWITCHES  8
+#define NPERFEVENTS            9
+
+/* Counters opened as a single group so one read() gives them all.
+   slot[] is the position of each event in the group (-1 if it could
+   not be opened)
+*/
+typedef struct
+{
+   int  leader,
+        nOpen,
+        slot[NPERFEVENTS];
+   REAL last[NPERFEVENTS],
+        counts[NPERFSTAGES][NPERFEVENTS],
+        timeEnabled,
+        timeRunning;
+   BOOL enabled;
+   char error[MAXBUFF];
+} PERFCOUNTERS;
+
+
+/************************************************************************/
+/* Prototypes
+*/
+BOOL OpenPerfCounters(PERFCOUNTERS *perf);
+void PerfLap(PERFCOUNTERS *perf, int stage);
+void ClosePerfCounters(PERFCOUNTERS *perf);
+void WritePerfReport(FILE *fp, PERFCOUNTERS *perf, RUNSTATS *stats,
+                     int format);
+
+#endif
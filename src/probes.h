@@ -0,0 +1,111 @@
+/*************************************************************************
+
+   Program:    hsubgroup
+   File:       probes.h
+
+   Version:    V3.7
+   Date:       18.10.26
+   Function:   USDT static tracepoints
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Static tracepoints for attaching bpftrace or SystemTap to a running
+   hsubgroup. If <sys/sdt.h> is available (from systemtap-sdt-dev or
+   systemtap-sdt-devel) each probe compiles to a single no-op
+   instruction plus a note in the ELF file, so costs nothing when
+   nothing is attached. Otherwise the probes compile to nothing.
+   Define NO_PROBES to leave them out, or HAVE_SYS_SDT_H if the
+   compiler cannot check for the header itself.
+
+   Probes (provider hsubgroup):
+   model_load_start(int format)
+   model_load_end(int format, int nSubGroups)
+         format is 0 for built-in data, 1 for a data file and 2 for a
+         full matrix
+   chain_start(char *sequence, int length)
+   chain_end(int length, int best, int chainType, long scoreMilli)
+         best is the subgroup index (-1 for no match) and scoreMilli
+         is the score * 1000
+   batch_start(char *id, int nChains)
+   batch_end(char *id, int nChains)
+         a batch is one entry in the input file
+
+   For example, a histogram of per-chain latency and counts of each
+   winning subgroup:
+      bpftrace -p PID -e '
+         usdt:./hsubgroup:hsubgroup:chain_start { @t[tid] = nsecs; }
+         usdt:./hsubgroup:hsubgroup:chain_end /@t[tid]/ {
+            @ns = hist(nsecs - @t[tid]); @best[arg1] = count();
+            delete(@t[tid]); }'
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V3.7  18.10.26   Original
+
+*************************************************************************/
+#ifndef _PROBES_H
+#define _PROBES_H
+
+#ifndef NO_PROBES
+#  if defined(HAVE_SYS_SDT_H)
+#     define USE_SDT_PROBES
+#  elif defined(__has_include)
+#     if __has_include(<sys/sdt.h>)
+#        define USE_SDT_PROBES
+#     endif
+#  endif
+#endif
+
+#ifdef USE_SDT_PROBES
+#  include <sys/sdt.h>
+#  define PROBE1(name, a)          DTRACE_PROBE1(hsubgroup, name, a)
+#  define PROBE2(name, a, b)       DTRACE_PROBE2(hsubgroup, name, a, b)
+#  define PROBE4(name, a, b, c, d) DTRACE_PROBE4(hsubgroup, name, a, b, \
+                                                 c, d)
+#else
+#  define PROBE1(name, a)
+#  define PROBE2(name, a, b)
+#  define PROBE4(name, a, b, c, d)
+#endif
+
+#define PROBEMODEL_BUILTIN    0
+#define PROBEMODEL_FILE       1
+#define PROBEMODEL_FULLMATRIX 2
+#define PROBEMODEL(fp, fullMatrix)                                       \
+   (((fp) == NULL) ? PROBEMODEL_BUILTIN :                                \
+    ((fullMatrix) ? PROBEMODEL_FULLMATRIX : PROBEMODEL_FILE))
+
+#endif
@@ -0,0 +1,330 @@
+/*************************************************************************
+
+   Program:    hsubgroup
+   File:       profile.c
+
+   Version:    V3.22
+   Date:       18.10.26
+   Function:   Table-driven scoring against the subgroup profiles
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   A profile may have any number of reference positions so the cost of
+   scoring must grow no faster than the profile. Each residue of a
+   chain is turned into a code once and the score and maximum score
+   that each code adds at each reference position of each subgroup are
+   looked up in a table kept with the model. An X that isn't included
+   adds nothing to either.
+
+   The chain codes follow PROFPADDING pad codes which add nothing, so
+   the window of reference positions starting at code s is the same as
+   truncation offset PROFPADDING-s when s is before the chain and
+   extension offset s-PROFPADDING otherwise. All the window starts are
+   summed one reference position at a time, an inner loop with no
+   branches that the compiler can vectorize. The terms are added in
+   reference position order, as the scoring of one offset at a time
+   that this replaced did, so the scores are unchanged.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V3.19 18.10.26   Original
+   V3.20 18.10.26   Added ScoreTableStarts() so the index's cluster
+                    table can be scored the same way and
+                    ScoreProfileStart() for a single start
+   V3.21 18.10.26   Added ScoreTableStart()
+   V3.22 18.10.26   Rebuilds any null scores with the table
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include "bioplib/MathType.h"
+#include "bioplib/SysDefs.h"
+#include "subgroup.h"
+
+
+/************************************************************************/
+/*>BOOL BuildProfileTable(SUBGROUPMODEL *model)
+   --------------------------------------------
+*//**
+   \param[in,out] model   The model
+   \return                Success (FALSE if no memory)
+
+   Makes the table of scores for each residue code using the model's
+   current scores and includeX setting, then the index and any null
+   scores which depend on it
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Builds the index
+-  18.10.26 Rebuilds the null scores if the model has them
+*/
+BOOL BuildProfileTable(SUBGROUPMODEL *model)
+{
+   REAL *scores, topScore;
+   int  sgNum, refPos, code;
+
+   if(model->table != NULL)
+      free(model->table);
+   if((model->table = (REAL *)malloc(model->nSubGroups *
+                                     model->refLength * 2 * PROFCODES *
+                                     sizeof(REAL)))==NULL)
+      return(FALSE);
+
+   for(sgNum=0; sgNum<model->nSubGroups; sgNum++)
+   {
+      for(refPos=0; refPos<model->refLength; refPos++)
+      {
+         scores = PROFTABLE(model, sgNum, refPos);
+
+         if(model->fullMatrix)
+         {
+            FMSUBGROUPINFO *info = &(model->fmSubGroupInfo[sgNum]);
+
+            topScore = info->topScores[refPos];
+            for(code=0; code<26; code++)
+               scores[code] = info->scores[refPos][code];
+         }
+         else
+         {
+            SUBGROUPINFO *info = &(model->subGroupInfo[sgNum]);
+
+            topScore = info->topScores[refPos];
+            for(code=0; code<26; code++)
+            {
+               if((char)('A'+code) == info->topSeq[refPos])
+                  scores[code] = info->topScores[refPos];
+               else if((char)('A'+code) == info->secondSeq[refPos])
+                  scores[code] = info->secondScores[refPos];
+               else
+                  scores[code] = 0.0;
+            }
+         }
+
+         for(code=0; code<26; code++)
+            scores[PROFCODES + code] = topScore;
+
+         if(!model->includeX)
+            scores['X'-'A'] = scores[PROFCODES + 'X'-'A'] = 0.0;
+
+         /* Anything else never matches but counts towards the maximum.
+            Padding counts for nothing
+         */
+         scores[PROFOTHER]             = 0.0;
+         scores[PROFCODES + PROFOTHER] = topScore;
+         scores[PROFPAD]               = 0.0;
+         scores[PROFCODES + PROFPAD]   = 0.0;
+      }
+   }
+   return(BuildProfileIndex(model) &&
+          ((model->nullTable == NULL) || BuildNullScores(model)));
+}
+
+
+/************************************************************************/
+/*>void EncodeProfileChain(char *sequence, int length,
+                           unsigned char *code, int nCodes)
+   --------------------------------------------------------
+*//**
+   \param[in]   sequence  The chain
+   \param[in]   length    Length of the chain
+   \param[out]  code      The codes
+   \param[in]   nCodes    Number of codes to fill in (at least
+                          PROFPADDING)
+
+   Turns a chain into residue codes after PROFPADDING pad codes. Codes
+   after the end of the chain are PROFOTHER so, as for any residue that
+   doesn't match, they count towards the maximum score.
+
+-  18.10.26 Original   By: ACRM
+*/
+void EncodeProfileChain(char *sequence, int length, unsigned char *code,
+                        int nCodes)
+{
+   int i;
+
+   for(i=0; i<PROFPADDING; i++)
+      code[i] = PROFPAD;
+   for(i=0; (i<length) && (PROFPADDING+i<nCodes); i++)
+   {
+      code[PROFPADDING+i] =
+         (((sequence[i] >= 'A') && (sequence[i] <= 'Z')) ?
+          (unsigned char)(sequence[i] - 'A') : PROFOTHER);
+   }
+   for(i+=PROFPADDING; i<nCodes; i++)
+      code[i] = PROFOTHER;
+}
+
+
+/************************************************************************/
+/*>void ScoreProfileStarts(SUBGROUPMODEL *model, int sgNum,
+                           unsigned char *code, int nStarts,
+                           REAL *score, REAL *scoreMax)
+   --------------------------------------------------------
+*//**
+   \param[in]   model     The model
+   \param[in]   sgNum     The subgroup
+   \param[in]   code      Codes from EncodeProfileChain(). There must
+                          be nStarts+model->refLength-1 of them
+   \param[in]   nStarts   Number of window starts
+   \param[out]  score     Score for each window start
+   \param[out]  scoreMax  Maximum score for each window start
+
+   Sums the score and maximum score of the window of reference positions
+   at each start
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Summing moved to ScoreTableStarts()
+*/
+void ScoreProfileStarts(SUBGROUPMODEL *model, int sgNum,
+                        unsigned char *code, int nStarts, REAL *score,
+                        REAL *scoreMax)
+{
+   ScoreTableStarts(PROFTABLE(model, sgNum, 0), model->refLength, code,
+                    nStarts, score, scoreMax);
+}
+
+
+/************************************************************************/
+/*>void ScoreProfileStart(SUBGROUPMODEL *model, int sgNum,
+                          unsigned char *code, int start, REAL *score,
+                          REAL *scoreMax)
+   ----------------------------------------------------------------------
+*//**
+   \param[in]   model     The model
+   \param[in]   sgNum     The subgroup
+   \param[in]   code      Codes from EncodeProfileChain(). There must
+                          be start+model->refLength of them
+   \param[in]   start     The window start
+   \param[out]  score     Score for the window start
+   \param[out]  scoreMax  Maximum score for the window start
+
+   Sums the score and maximum score of the window of reference positions
+   at a single start
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Summing moved to ScoreTableStart()
+*/
+void ScoreProfileStart(SUBGROUPMODEL *model, int sgNum,
+                       unsigned char *code, int start, REAL *score,
+                       REAL *scoreMax)
+{
+   ScoreTableStart(PROFTABLE(model, sgNum, 0), model->refLength, code,
+                   start, score, scoreMax);
+}
+
+
+/************************************************************************/
+/*>void ScoreTableStart(REAL *table, int refLength, unsigned char *code,
+                        int start, REAL *score, REAL *scoreMax)
+   ---------------------------------------------------------------------
+*//**
+   \param[in]   table     Scores and maximum scores for each code at
+                          each reference position, laid out as for
+                          PROFTABLE()
+   \param[in]   refLength Number of reference positions
+   \param[in]   code      Codes from EncodeProfileChain(). There must
+                          be start+refLength of them
+   \param[in]   start     The window start
+   \param[out]  score     Score for the window start
+   \param[out]  scoreMax  Maximum score for the window start
+
+   Sums the score and maximum score of the window of reference positions
+   at a single start for one subgroup or node of the index. The terms
+   are added in the same order as ScoreTableStarts() so the sums are
+   identical.
+
+-  18.10.26 Split out from ScoreProfileStart()   By: ACRM
+*/
+void ScoreTableStart(REAL *table, int refLength, unsigned char *code,
+                     int start, REAL *score, REAL *scoreMax)
+{
+   REAL          *scores;
+   unsigned char *window = code + start;
+   int           refPos;
+
+   *score = *scoreMax = 0.0;
+   for(refPos=0; refPos<refLength; refPos++)
+   {
+      scores     = table + (refPos * 2 * PROFCODES);
+      *score    += scores[window[refPos]];
+      *scoreMax += scores[PROFCODES + window[refPos]];
+   }
+}
+
+
+/************************************************************************/
+/*>void ScoreTableStarts(REAL *table, int refLength, unsigned char *code,
+                         int nStarts, REAL *score, REAL *scoreMax)
+   ----------------------------------------------------------------------
+*//**
+   \param[in]   table     Scores and maximum scores for each code at
+                          each reference position, laid out as for
+                          PROFTABLE()
+   \param[in]   refLength Number of reference positions
+   \param[in]   code      Codes from EncodeProfileChain(). There must
+                          be nStarts+refLength-1 of them
+   \param[in]   nStarts   Number of window starts
+   \param[out]  score     Score for each window start
+   \param[out]  scoreMax  Maximum score for each window start
+
+   Sums the score and maximum score of the window of reference positions
+   at each start for one subgroup or node of the index
+
+-  18.10.26 Split out from ScoreProfileStarts()   By: ACRM
+*/
+void ScoreTableStarts(REAL *table, int refLength, unsigned char *code,
+                      int nStarts, REAL *score, REAL *scoreMax)
+{
+   REAL          *scores, *maxScores;
+   unsigned char *window;
+   int           refPos, start;
+
+   for(start=0; start<nStarts; start++)
+      score[start] = scoreMax[start] = 0.0;
+
+   for(refPos=0; refPos<refLength; refPos++)
+   {
+      scores    = table + (refPos * 2 * PROFCODES);
+      maxScores = scores + PROFCODES;
+      window    = code + refPos;
+      for(start=0; start<nStarts; start++)
+      {
+         score[start]    += scores[window[start]];
+         scoreMax[start] += maxScores[window[start]];
+      }
+   }
+}
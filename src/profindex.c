@@ -0,0 +1,490 @@
+/*************************************************************************
+
+   Program:    hsubgroup
+   File:       profindex.c
+
+   Version:    V3.21
+   Date:       18.10.26
+   Function:   Tree index of similar subgroup profiles
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+
+   Description:
+   ============
+   A model with germline-level subgroups may have thousands of them and
+   most are nowhere near a given chain. The index is a tree: subgroups
+   with similar consensus sequences are grouped into leaves and similar
+   nodes are grouped into parents up to a single root, so a whole
+   branch can be skipped if none of the subgroups below it could be
+   ranked.
+
+   A subgroup's normalized score at a window start is S/(S+Q) where S
+   is its score and Q is the shortfall from the maximum score. Each
+   node has a table in the same form as the model's where each residue
+   code scores the highest score of any subgroup below the node and,
+   in place of the maximum, the smallest shortfall of any of them.
+   Summing these gives S' >= S and Q' <= Q for every subgroup below so
+   S'/(S'+Q') bounds their normalized scores, and a node's bound is
+   never below a child's. This is much tighter than dividing the
+   highest score by the lowest maximum when the frequencies differ.
+   The bound needs every score to lie between 0 and the maximum at its
+   position, as frequencies do; models with any other scores are not
+   indexed. All the terms are then positive, so the rounding of the
+   sums is tiny and the bound is raised by INDEXSLACK to cover it. The
+   ranking is therefore exactly the same as scoring every subgroup.
+
+   Each level is made greedily in order: an item joins the group whose
+   first item's consensus is most identical to its own if that is at
+   least the level's identity and the group isn't full, otherwise it
+   starts a new group. Leaves hold up to INDEXLEAFSIZE subgroups that
+   are INDEXIDENTITY percent identical. Each level above holds up to
+   INDEXFANOUT nodes and needs INDEXIDENTITYSTEP percent less identity
+   than the one below, dropping further until the level has at most
+   half as many nodes, so there are fewer than twice as many nodes as
+   leaves. A subgroup's consensus is the highest scoring residue at
+   each position and a node's is that of its first subgroup.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V3.20 18.10.26   Original
+   V3.21 18.10.26   The clusters are the leaves of a tree
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include "bioplib/MathType.h"
+#include "bioplib/SysDefs.h"
+#include "subgroup.h"
+
+
+/************************************************************************/
+/* Prototypes
+*/
+static void Consensus(SUBGROUPMODEL *model, int sgNum,
+                      unsigned char *consensus);
+static int  Identity(unsigned char *seq1, unsigned char *seq2,
+                     int length);
+static int  GroupItems(unsigned char *consensus, int refLength,
+                       int *rep, int nItems, int maxSize,
+                       int minIdentity, int *group, int *leader,
+                       int *size);
+static int  AddLevel(SUBGROUPMODEL *model, int nNodes, int firstItem,
+                     int nItems, int nGroups, int *group, int *leader,
+                     int *rep);
+static void BuildNodeTable(SUBGROUPMODEL *model, int node);
+static BOOL ScoresInRange(SUBGROUPMODEL *model);
+
+
+/************************************************************************/
+/*>BOOL BuildProfileIndex(SUBGROUPMODEL *model)
+   --------------------------------------------
+*//**
+   \param[in,out] model   The model with its table built
+   \return                Success (FALSE if no memory)
+
+   (Re)builds the index of a model with at least INDEXMINSUBGROUPS
+   subgroups. Smaller models, and those with scores outside the range
+   the bound needs, are not indexed.
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Builds a tree
+*/
+BOOL BuildProfileIndex(SUBGROUPMODEL *model)
+{
+   unsigned char *consensus;
+   int           *rep,
+                 *group,
+                 *leader,
+                 *size,
+                 nSubGroups  = model->nSubGroups,
+                 refLength   = model->refLength,
+                 maxNodes    = 2 * model->nSubGroups,
+                 minIdentity = INDEXIDENTITY,
+                 nNodes, nLeaves, nItems, nGroups, levelStart,
+                 sgNum, node;
+
+   FreeProfileIndex(model);
+   if((nSubGroups < INDEXMINSUBGROUPS) || !ScoresInRange(model))
+      return(TRUE);
+
+   consensus = (unsigned char *)malloc(nSubGroups * refLength);
+   rep       = (int *)malloc(maxNodes * sizeof(int));
+   group     = (int *)malloc(nSubGroups * sizeof(int));
+   leader    = (int *)malloc(nSubGroups * sizeof(int));
+   size      = (int *)malloc(nSubGroups * sizeof(int));
+   model->nodeStart = (int *)malloc((maxNodes+1) * sizeof(int));
+   model->nodeItem  = (int *)malloc((nSubGroups+maxNodes) *
+                                    sizeof(int));
+   if((consensus == NULL) || (rep == NULL) || (group == NULL) ||
+      (leader == NULL) || (size == NULL) ||
+      (model->nodeStart == NULL) || (model->nodeItem == NULL))
+   {
+      if(consensus != NULL) free(consensus);
+      if(rep       != NULL) free(rep);
+      if(group     != NULL) free(group);
+      if(leader    != NULL) free(leader);
+      if(size      != NULL) free(size);
+      FreeProfileIndex(model);
+      return(FALSE);
+   }
+
+   /* Each subgroup is its own representative to start with            */
+   for(sgNum=0; sgNum<nSubGroups; sgNum++)
+   {
+      Consensus(model, sgNum, consensus + (sgNum * refLength));
+      rep[sgNum] = sgNum;
+   }
+
+   model->nodeStart[0] = 0;
+   nGroups = GroupItems(consensus, refLength, rep, nSubGroups,
+                        INDEXLEAFSIZE, minIdentity, group, leader, size);
+   nNodes  = nLeaves = AddLevel(model, 0, 0, nSubGroups, nGroups, group,
+                                leader, rep);
+
+   /* Add levels until there is a single root                           */
+   for(levelStart=0; (nItems = nNodes - levelStart) > 1; levelStart+=nItems)
+   {
+      do
+      {
+         minIdentity -= INDEXIDENTITYSTEP;
+         nGroups = GroupItems(consensus, refLength, rep + levelStart,
+                              nItems, INDEXFANOUT, minIdentity, group,
+                              leader, size);
+      }  while(nGroups > nItems / 2);
+      nNodes = AddLevel(model, nNodes, levelStart, nItems, nGroups,
+                        group, leader, rep);
+   }
+
+   free(consensus);
+   free(rep);
+   free(group);
+   free(leader);
+   free(size);
+
+   if((model->nodeTable = (REAL *)malloc(nNodes * refLength *
+                                         2 * PROFCODES *
+                                         sizeof(REAL)))==NULL)
+   {
+      FreeProfileIndex(model);
+      return(FALSE);
+   }
+   model->nNodes  = nNodes;
+   model->nLeaves = nLeaves;
+
+   /* Children come before their parents                                */
+   for(node=0; node<nNodes; node++)
+      BuildNodeTable(model, node);
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void FreeProfileIndex(SUBGROUPMODEL *model)
+   -------------------------------------------
+*//**
+   \param[in,out] model   The model
+
+   Frees a model's index, leaving it unindexed
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Frees the tree
+*/
+void FreeProfileIndex(SUBGROUPMODEL *model)
+{
+   if(model->nodeStart != NULL)
+      free(model->nodeStart);
+   if(model->nodeItem != NULL)
+      free(model->nodeItem);
+   if(model->nodeTable != NULL)
+      free(model->nodeTable);
+   model->nodeStart = NULL;
+   model->nodeItem  = NULL;
+   model->nodeTable = NULL;
+   model->nNodes    = 0;
+   model->nLeaves   = 0;
+}
+
+
+/************************************************************************/
+/*>static void Consensus(SUBGROUPMODEL *model, int sgNum,
+                         unsigned char *consensus)
+   ------------------------------------------------------
+*//**
+   \param[in]   model      The model with its table built
+   \param[in]   sgNum      The subgroup
+   \param[out]  consensus  Code of the highest scoring residue at each
+                           position (PROFOTHER if none scores)
+
+-  18.10.26 Original   By: ACRM
+*/
+static void Consensus(SUBGROUPMODEL *model, int sgNum,
+                      unsigned char *consensus)
+{
+   REAL *scores;
+   int  refPos, code;
+
+   for(refPos=0; refPos<model->refLength; refPos++)
+   {
+      scores            = PROFTABLE(model, sgNum, refPos);
+      consensus[refPos] = PROFOTHER;
+      for(code=0; code<26; code++)
+      {
+         if((scores[code] > 0.0) &&
+            ((consensus[refPos] == PROFOTHER) ||
+             (scores[code] > scores[consensus[refPos]])))
+            consensus[refPos] = (unsigned char)code;
+      }
+   }
+}
+
+
+/************************************************************************/
+/*>static int Identity(unsigned char *seq1, unsigned char *seq2,
+                       int length)
+   -------------------------------------------------------------
+*//**
+   \param[in]   seq1     A consensus
+   \param[in]   seq2     Another consensus
+   \param[in]   length   Their length
+   \return               Number of identical positions
+
+-  18.10.26 Original   By: ACRM
+*/
+static int Identity(unsigned char *seq1, unsigned char *seq2,
+                    int length)
+{
+   int i,
+       nSame = 0;
+
+   for(i=0; i<length; i++)
+   {
+      if(seq1[i] == seq2[i])
+         nSame++;
+   }
+   return(nSame);
+}
+
+
+/************************************************************************/
+/*>static int GroupItems(unsigned char *consensus, int refLength,
+                         int *rep, int nItems, int maxSize,
+                         int minIdentity, int *group, int *leader,
+                         int *size)
+   --------------------------------------------------------------------
+*//**
+   \param[in]   consensus    Consensus of every subgroup
+   \param[in]   refLength    Length of a consensus
+   \param[in]   rep          Subgroup whose consensus stands for each
+                             item
+   \param[in]   nItems       Number of items
+   \param[in]   maxSize      Most items in a group
+   \param[in]   minIdentity  % identity needed to join a group
+   \param[out]  group        Group of each item
+   \param[out]  leader       Subgroup standing for each group
+   \param[out]  size         Number of items in each group
+   \return                   Number of groups
+
+   Groups items greedily in order
+
+-  18.10.26 Original   By: ACRM
+*/
+static int GroupItems(unsigned char *consensus, int refLength,
+                      int *rep, int nItems, int maxSize,
+                      int minIdentity, int *group, int *leader,
+                      int *size)
+{
+   int nGroups = 0,
+       i, g, best, identity, bestIdentity;
+
+   for(i=0; i<nItems; i++)
+   {
+      best         = -1;
+      bestIdentity = -1;
+      for(g=0; g<nGroups; g++)
+      {
+         if((size[g] < maxSize) &&
+            ((identity = Identity(consensus + (rep[i] * refLength),
+                                  consensus + (leader[g] * refLength),
+                                  refLength)) > bestIdentity))
+         {
+            best         = g;
+            bestIdentity = identity;
+         }
+      }
+
+      if((best < 0) || ((bestIdentity * 100) < (minIdentity * refLength)))
+      {
+         best         = nGroups++;
+         leader[best] = rep[i];
+         size[best]   = 0;
+      }
+      group[i] = best;
+      size[best]++;
+   }
+   return(nGroups);
+}
+
+
+/************************************************************************/
+/*>static int AddLevel(SUBGROUPMODEL *model, int nNodes, int firstItem,
+                       int nItems, int nGroups, int *group,
+                       int *leader, int *rep)
+   --------------------------------------------------------------------
+*//**
+   \param[in,out] model      The model with the tree so far
+   \param[in]     nNodes     Number of nodes so far
+   \param[in]     firstItem  Number of the first item (0 for the
+                             subgroups of the leaves, otherwise the
+                             first node of the level below)
+   \param[in]     nItems     Number of items
+   \param[in]     nGroups    Number of groups
+   \param[in]     group      Group of each item
+   \param[in,out] leader     Subgroup standing for each group (used
+                             as workspace)
+   \param[out]    rep        The new nodes' representatives are set
+   \return                   Number of nodes
+
+   Adds a node to the tree for each group of items
+
+-  18.10.26 Original   By: ACRM
+*/
+static int AddLevel(SUBGROUPMODEL *model, int nNodes, int firstItem,
+                    int nItems, int nGroups, int *group, int *leader,
+                    int *rep)
+{
+   int *nodeStart = model->nodeStart + nNodes,
+       i, g;
+
+   /* Count the items of each node, turn the counts into where each
+      node's items start and fill them in, using leader[] for the next
+      free place
+   */
+   for(g=0; g<nGroups; g++)
+   {
+      rep[nNodes+g]  = leader[g];
+      nodeStart[g+1] = 0;
+   }
+   for(i=0; i<nItems; i++)
+      nodeStart[group[i]+1]++;
+   for(g=0; g<nGroups; g++)
+   {
+      leader[g]       = nodeStart[g];
+      nodeStart[g+1] += nodeStart[g];
+   }
+   for(i=0; i<nItems; i++)
+      model->nodeItem[leader[group[i]]++] = firstItem + i;
+
+   return(nNodes + nGroups);
+}
+
+
+/************************************************************************/
+/*>static void BuildNodeTable(SUBGROUPMODEL *model, int node)
+   ----------------------------------------------------------
+*//**
+   \param[in,out] model    The model with its table and tree
+   \param[in]     node     The node, whose children's tables must be
+                           built
+
+   Fills in the node's table with the highest score and smallest
+   shortfall from the maximum of the subgroups below it for each code
+
+-  18.10.26 Original   By: ACRM
+*/
+static void BuildNodeTable(SUBGROUPMODEL *model, int node)
+{
+   REAL *bound, *scores, high, shortfall;
+   int  refPos, code, item;
+   BOOL leaf  = (node < model->nLeaves),
+        first;
+
+   for(refPos=0; refPos<model->refLength; refPos++)
+   {
+      bound = PROFNODE(model, node, refPos);
+      for(item=model->nodeStart[node];
+          item<model->nodeStart[node+1];
+          item++)
+      {
+         first  = (item == model->nodeStart[node]);
+         scores = leaf ?
+                  PROFTABLE(model, model->nodeItem[item], refPos) :
+                  PROFNODE(model, model->nodeItem[item], refPos);
+         for(code=0; code<PROFCODES; code++)
+         {
+            high      = scores[code];
+            shortfall = leaf ? (scores[PROFCODES+code] - scores[code]) :
+                               scores[PROFCODES+code];
+            if(first || (high > bound[code]))
+               bound[code] = high;
+            if(first || (shortfall < bound[PROFCODES+code]))
+               bound[PROFCODES+code] = shortfall;
+         }
+      }
+   }
+}
+
+
+/************************************************************************/
+/*>static BOOL ScoresInRange(SUBGROUPMODEL *model)
+   -----------------------------------------------
+*//**
+   \param[in]   model    The model with its table built
+   \return               Every score is between 0 and the maximum
+
+-  18.10.26 Original   By: ACRM
+*/
+static BOOL ScoresInRange(SUBGROUPMODEL *model)
+{
+   REAL *scores;
+   int  sgNum, refPos, code;
+
+   for(sgNum=0; sgNum<model->nSubGroups; sgNum++)
+   {
+      for(refPos=0; refPos<model->refLength; refPos++)
+      {
+         scores = PROFTABLE(model, sgNum, refPos);
+         for(code=0; code<PROFCODES; code++)
+         {
+            if((scores[code] < 0.0) ||
+               (scores[code] > scores[PROFCODES+code]))
+               return(FALSE);
+         }
+      }
+   }
+   return(TRUE);
+}
@@ -0,0 +1,420 @@
+/*************************************************************************
+
+   Program:    hsubgroup
+   File:       seqio.c
+
+   Version:    V3.8
+   Date:       18.10.26
+   Function:   Sequence file reader with byte offsets
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Reads PIR or FASTA entries while keeping track of the byte offset of
+   each entry in the file. This allows a file to be split between
+   processes (--shard) and a run to be restarted part way through.
+   Unlike blReadPIR() all the state is in the SEQREADER so any number
+   of files may be read at the same time.
+
+   The sequence is handled as in blReadPIR(). An entry may contain
+   several chains, each terminated by '*'. Letters are converted to
+   upper case and everything else is ignored. The ID is the first word
+   after the '>' (or after the ';' in a PIR header such as '>P1;'),
+   truncated to MAXSEQID-1 characters. A PIR header is followed by a
+   title line.
+
+   A reader may be given a byte range. Reading starts at the first
+   header at or after the start of the range and continues until it
+   reaches a header at or after the end. So if a file is split into
+   ranges, each entry is read by exactly one reader.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V3.8  18.10.26   Original
+
+*************************************************************************/
+/* Includes
+*/
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "bioplib/MathType.h"
+#include "bioplib/SysDefs.h"
+#include "seqio.h"
+
+/************************************************************************/
+/* Prototypes
+*/
+static BOOL ReadLine(SEQREADER *reader, BOOL *lineStart);
+static BOOL NextHeader(SEQREADER *reader);
+static BOOL AddChain(char **seqs, int maxChain, int *nChains,
+                     char *buffer, int length);
+
+
+/************************************************************************/
+/*>SEQREADER *OpenSeqReader(FILE *fp, long start, long end)
+   --------------------------------------------------------
+*//**
+   \param[in]   fp      File to read (must be seekable if start > 0)
+   \param[in]   start   Byte offset at which to start looking for an
+                        entry
+   \param[in]   end     Entries with headers at or after this offset
+                        are not read (-1 to read to the end)
+   \return              The reader (NULL if no memory or the seek
+                        failed)
+
+   Creates a reader. If start is part way through a line, the rest of
+   the line is skipped.
+
+-  18.10.26 Original   By: ACRM
+*/
+SEQREADER *OpenSeqReader(FILE *fp, long start, long end)
+{
+   SEQREADER *reader;
+
+   if((reader = (SEQREADER *)malloc(sizeof(SEQREADER)))==NULL)
+      return(NULL);
+
+   reader->fp         = fp;
+   reader->offset     = start;
+   reader->end        = end;
+   reader->entryStart = start;
+   reader->entryEnd   = start;
+   reader->headerStart = start;
+   reader->nEntries   = 0;
+   reader->pending    = FALSE;
+   reader->atEnd      = FALSE;
+   reader->midLine    = FALSE;
+   reader->line[0]    = '\0';
+
+   if(start > 0)
+   {
+      int ch;
+      
+      if(fseek(fp, start-1, SEEK_SET))
+      {
+         free(reader);
+         return(NULL);
+      }
+      
+      /* If the previous byte was not a newline we are part way through
+         a line
+      */
+      if(((ch = getc(fp)) != '\n') && (ch != EOF))
+         reader->midLine = TRUE;
+   }
+
+   return(reader);
+}
+
+
+/************************************************************************/
+/*>static BOOL ReadLine(SEQREADER *reader, BOOL *lineStart)
+   --------------------------------------------------------
+*//**
+   \param[in,out] reader     The reader
+   \param[out]    lineStart  The text read starts a line (lines
+                             longer than MAXSEQLINE are read in pieces)
+   \return                   Something was read
+
+-  18.10.26 Original   By: ACRM
+*/
+static BOOL ReadLine(SEQREADER *reader, BOOL *lineStart)
+{
+   int length;
+
+   if(reader->atEnd || !fgets(reader->line, MAXSEQLINE, reader->fp))
+   {
+      reader->atEnd = TRUE;
+      return(FALSE);
+   }
+
+   length          = strlen(reader->line);
+   reader->offset += length;
+   *lineStart      = !reader->midLine;
+   reader->midLine = (reader->line[length-1] != '\n');
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL NextHeader(SEQREADER *reader)
+   -----------------------------------------
+*//**
+   \param[in,out] reader   The reader
+   \return                 A header is available in reader->line
+
+   Skips to the next header unless one is already waiting.
+   reader->headerStart is set to its offset.
+
+-  18.10.26 Original   By: ACRM
+*/
+static BOOL NextHeader(SEQREADER *reader)
+{
+   BOOL lineStart;
+
+   while(!reader->pending)
+   {
+      long start = reader->offset;
+      
+      if(!ReadLine(reader, &lineStart))
+         return(FALSE);
+      if(lineStart && (reader->line[0] == '>'))
+      {
+         reader->pending     = TRUE;
+         reader->headerStart = start;
+      }
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL AddChain(char **seqs, int maxChain, int *nChains,
+                        char *buffer, int length)
+   -------------------------------------------------------------
+*//**
+   \param[out]    seqs      Chain array
+   \param[in]     maxChain  Size of chain array
+   \param[in,out] nChains   Number of chains stored
+   \param[in]     buffer    Chain sequence (not terminated)
+   \param[in]     length    Length of the chain
+   \return                  Success (FALSE if no memory)
+
+   Stores a copy of a chain. Chains beyond maxChain are dropped.
+
+-  18.10.26 Original   By: ACRM
+*/
+static BOOL AddChain(char **seqs, int maxChain, int *nChains,
+                     char *buffer, int length)
+{
+   char *seq;
+
+   if(*nChains >= maxChain)
+      return(TRUE);
+   if((seq = (char *)malloc(length+1))==NULL)
+      return(FALSE);
+   memcpy(seq, buffer, length);
+   seq[length] = '\0';
+   seqs[(*nChains)++] = seq;
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>int ReadSeqEntry(SEQREADER *reader, char **seqs, int maxChain,
+                    char *id)
+   --------------------------------------------------------------
+*//**
+   \param[in,out] reader     The reader
+   \param[out]    seqs       Chains read (malloc()'d - caller frees)
+   \param[in]     maxChain   Size of seqs array
+   \param[out]    id         Entry ID (at least MAXSEQID characters)
+   \return                   Number of chains (-1 at the end of the file
+                             or byte range, or if there is no memory)
+
+   Reads the next entry. An entry with no sequence returns 0 chains.
+   reader->entryStart and reader->entryEnd give the byte range of the
+   entry.
+
+-  18.10.26 Original   By: ACRM
+*/
+int ReadSeqEntry(SEQREADER *reader, char **seqs, int maxChain,
+                 char *id)
+{
+   char *buffer = NULL,
+        *chp;
+   int  nChains = 0,
+        length  = 0,
+        size    = 0,
+        i;
+   BOOL lineStart,
+        pir,
+        ok      = TRUE;
+
+   if(!NextHeader(reader))
+   {
+      reader->entryStart = reader->entryEnd = reader->offset;
+      return(-1);
+   }
+   if((reader->end >= 0) && (reader->headerStart >= reader->end))
+   {
+      reader->entryStart = reader->entryEnd = reader->headerStart;
+      return(-1);
+   }
+   reader->pending    = FALSE;
+   reader->entryStart = reader->headerStart;
+
+   /* ID follows '>' or, for PIR, the ';' in '>P1;'                     */
+   pir = ((strlen(reader->line) > 3) && (reader->line[3] == ';'));
+   chp = reader->line + (pir ? 4 : 1);
+   for(i=0; (i < MAXSEQID-1) && *chp && !isspace((int)*chp); i++)
+      id[i] = *(chp++);
+   id[i] = '\0';
+
+   /* PIR has a title line                                              */
+   if(pir)
+      ReadLine(reader, &lineStart);
+
+   for(;;)
+   {
+      long start = reader->offset;
+
+      if(!ReadLine(reader, &lineStart))
+         break;
+      if(lineStart && (reader->line[0] == '>'))
+      {
+         reader->pending     = TRUE;
+         reader->headerStart = start;
+         reader->entryEnd    = start;
+         break;
+      }
+
+      for(chp=reader->line; *chp; chp++)
+      {
+         if(*chp == '*')
+         {
+            ok &= AddChain(seqs, maxChain, &nChains, buffer, length);
+            length = 0;
+         }
+         else if(isalpha((int)*chp))
+         {
+            if(length >= size)
+            {
+               char *newBuffer;
+               size = 2*size + MAXSEQLINE;
+               if((newBuffer = (char *)realloc(buffer, size))==NULL)
+               {
+                  free(buffer);
+                  return(-1);
+               }
+               buffer = newBuffer;
+            }
+            buffer[length++] = (char)toupper((int)*chp);
+         }
+      }
+   }
+
+   /* Final chain with no terminating '*'                               */
+   if(length)
+      ok &= AddChain(seqs, maxChain, &nChains, buffer, length);
+   free(buffer);
+
+   if(!reader->pending)
+      reader->entryEnd = reader->offset;
+   reader->nEntries++;
+   
+   if(!ok)
+   {
+      for(i=0; i<nChains; i++)
+         free(seqs[i]);
+      return(-1);
+   }
+   return(nChains);
+}
+
+
+/************************************************************************/
+/*>long SeqReaderOffset(SEQREADER *reader)
+   ---------------------------------------
+*//**
+   \param[in]   reader   The reader
+   \return               Byte offset just after the last entry read,
+                         where reading would resume
+
+-  18.10.26 Original   By: ACRM
+*/
+long SeqReaderOffset(SEQREADER *reader)
+{
+   return(reader->entryEnd);
+}
+
+
+/************************************************************************/
+/*>void CloseSeqReader(SEQREADER *reader)
+   --------------------------------------
+*//**
+   \param[in]   reader   The reader
+
+   Frees the reader. The file is not closed
+
+-  18.10.26 Original   By: ACRM
+*/
+void CloseSeqReader(SEQREADER *reader)
+{
+   if(reader != NULL)
+      free(reader);
+}
+
+
+/************************************************************************/
+/*>BOOL ShardRange(FILE *fp, int shard, int nShards, long *start,
+                   long *end)
+   --------------------------------------------------------------
+*//**
+   \param[in]   fp        A regular file
+   \param[in]   shard     Shard number (0..nShards-1)
+   \param[in]   nShards   Number of shards
+   \param[out]  start     Start of the byte range
+   \param[out]  end       End of the byte range (-1 for the last shard)
+   \return                Success (FALSE if fp is not a regular file)
+
+   Splits the file into nShards equal byte ranges
+
+-  18.10.26 Original   By: ACRM
+*/
+BOOL ShardRange(FILE *fp, int shard, int nShards, long *start,
+                long *end)
+{
+   struct stat st;
+   long        size;
+
+   if((nShards < 1) || (shard < 0) || (shard >= nShards))
+      return(FALSE);
+   if(fstat(fileno(fp), &st) || !S_ISREG(st.st_mode))
+      return(FALSE);
+
+   size   = (long)st.st_size;
+   *start = (size / nShards) * shard + ((size % nShards) * shard) / nShards;
+   *end   = (shard == nShards-1) ? -1 :
+            (size / nShards) * (shard+1) +
+            ((size % nShards) * (shard+1)) / nShards;
+   return(TRUE);
+}
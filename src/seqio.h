@@ -0,0 +1,94 @@
+/*************************************************************************
+
+   Program:    hsubgroup
+   File:       seqio.h
+
+   Version:    V3.8
+   Date:       18.10.26
+   Function:   Sequence file reader with byte offsets
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Reader for PIR and FASTA files which tracks byte offsets so that a
+   file can be split into shards or a run restarted.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V3.8  18.10.26   Original
+
+*************************************************************************/
+#ifndef _SEQIO_H
+#define _SEQIO_H
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXSEQID           16  /* Sequence ID as stored (as SEQINFO)    */
+#define MAXSEQLINE       4096  /* Longest line read in one go           */
+
+/* A reader for PIR or FASTA files which knows the byte offset of every
+   entry. All state is kept here so several readers may be used at
+   once from different threads
+*/
+typedef struct
+{
+   FILE *fp;
+   long offset,          /* Offset of the next byte to be read          */
+        end,             /* Entries starting here or later are not read
+                            (-1 to read to the end of the file)         */
+        entryStart,      /* Offset of the header of the last entry read */
+        entryEnd,        /* Offset just after the last entry read       */
+        headerStart,     /* Offset of the header in line[]              */
+        nEntries;        /* Number of entries read                      */
+   BOOL pending,         /* line[] holds the next header                */
+        atEnd,
+        midLine;         /* The next read continues a long line         */
+   char line[MAXSEQLINE];
+} SEQREADER;
+
+
+/************************************************************************/
+/* Prototypes
+*/
+SEQREADER *OpenSeqReader(FILE *fp, long start, long end);
+int  ReadSeqEntry(SEQREADER *reader, char **seqs, int maxChain,
+                  char *id);
+long SeqReaderOffset(SEQREADER *reader);
+void CloseSeqReader(SEQREADER *reader);
+BOOL ShardRange(FILE *fp, int shard, int nShards, long *start,
+                long *end);
+
+#endif
@@ -3,8 +3,8 @@
    Program:    hsubgroup
    File:       sophie.c
    
-   Version:    V3.0
-   Date:       12.02.19
+   Version:    V3.7
+   Date:       18.10.26
    Function:   Assign human subgroups from antibody sequences in PIR file
    
    Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2019
@@ -69,6 +69,38 @@
                     subtypes!
    V2.3  05.02.19   Added info to verbose output on the second best match
    V3.0  12.02.19   Added support for full matrices
+   V3.3  18.10.26   Scoring split from printing so results can be
+                    passed to the output writers
+   V3.4  18.10.26   Keeps the best K distinct subgroups. This fixes the
+                    second best which could be the same subgroup as the
+                    best or be missed altogether
+   V3.5  18.10.26   Added GetSubgroupProfile() for the sequence generator
+   V3.6  18.10.26   Results include the counts used for run statistics
+   V3.7  18.10.26   Added USDT probes for model loading and each chain
+   V3.12 18.10.26   Subgroup data held in a SUBGROUPMODEL. Several
+                    models can be loaded and a chain scored against all
+                    of them at once
+   V3.13 18.10.26   Each model has its own includeX and doProduct 
+                    settings so several scoring configurations can be
+                    run together
+   V3.18 18.10.26   Optional gapped alignment of each subgroup
+   V3.19 18.10.26   Profiles of any length are held in allocated memory.
+                    Chains are scored through the model's table of
+                    scores for each residue code
+   V3.20 18.10.26   Models hold any number of subgroups. Large models
+                    are searched through an index of clusters
+   V3.21 18.10.26   The index is searched as a tree, best bound first
+   V3.22 18.10.26   The subgroups of a chain can be scored on a pool of
+                    threads
+   V3.23 18.10.26   Results have a p-value and E-value if the model has
+                    null scores
+   V3.24 18.10.26   Added TopTwoSubgroupModel()
+   V3.26 18.10.26   Added SameScoreScale(). Removed CalcScore() which
+                    the profile table replaced
+                    The index sums node bounds over runs of starts
+                    and counts them as evaluated. The index is
+                    searched on the split pool. Removed
+                    TopTwoSubgroupModel()
 
 *************************************************************************/
 /* Includes
@@ -82,10 +114,72 @@
 #include "bioplib/macros.h"
 #include "bioplib/general.h"
 #include "subgroup.h"
+#include "splitpool.h"
+#include "probes.h"
 
 /************************************************************************/
 /* Defines and macros
 */
+/* True if a subgroup with score1 and id1 ranks ahead of one with
+   score2 and id2
+*/
+#define RANKSAHEAD(score1, id1, score2, id2)                             \
+   (((score1) > (score2)) || (((score1) == (score2)) && ((id1) < (id2))))
+
+/* The bound on the scores of the subgroups below a node of the index
+   and at each start
+*/
+typedef struct
+{
+   REAL bound,
+        *startBound;
+   int  node;
+} NODEBOUND;
+
+/* True if node bound b1 is searched before b2                          */
+#define NODEAHEAD(b1, b2)                                                \
+   (((b1).bound > (b2).bound) ||                                         \
+    (((b1).bound == (b2).bound) && ((b1).node < (b2).node)))
+
+/* Ungapped scoring of a subgroup is too quick to be worth sharing
+   between threads unless there are at least this many
+*/
+#define SPLITMINSUBGROUPS 256
+
+/* A piece of the work on a batch of nodes taken from an index's heap:
+   the bounds of a child of an internal node (startBound is its row),
+   the exact bounds of a leaf (item is -1 and startBound the leaf's
+   row) or a subgroup of a leaf (startBound is NULL). item indexes the
+   node's nodeItem and batch is the node's place in the batch
+*/
+typedef struct
+{
+   REAL *startBound,
+        bound;
+   int  batch,
+        item;
+} SPLITUNIT;
+
+/* A chain being scored on the split pool. Each part ranks its own
+   share of the subgroups in results[part]. When an index is searched
+   the share is of the units of a batch of nodes, and each part starts
+   from the ranking so far
+*/
+typedef struct
+{
+   SUBGROUPMODEL  *model;
+   char           *sequence;
+   unsigned char  *code;
+   SUBGROUPRESULT *results,
+                  *ranking;
+   NODEBOUND      *batch;
+   SPLITUNIT      *units;
+   int            *orders;
+   int            length,
+                  nStarts,
+                  nExtension,
+                  nUnits;
+} SPLITJOB;
 
 /************************************************************************/
 /* Globals
@@ -93,13 +187,22 @@
 static BOOL sVerbose   = FALSE;
 static BOOL sIncludeX  = FALSE;
 static BOOL sDoProduct = FALSE;
+static int  sTopK      = DEFAULTTOPK;
+
+/* Threads sharing the scoring of each chain and a ranking for each part
+   (NULL unless FindSubgroupSetSplit() was used)
+*/
+static SPLITPOOL      *sSplitPool    = NULL;
+static SUBGROUPRESULT *sSplitResults = NULL;
+
+/* The default model used by FindHumanSubgroup() and friends           */
+static SUBGROUPMODEL  sModel;
+static int            sInitialized = 0;
 
 /************************************************************************/
 /* Prototypes
 */
 #include "sophie.h"
-static REAL CalcScore(SUBGROUPINFO subGroupInfo, char *sequence, 
-                      int offset, int offsetType, BOOL includeX);
 static void InitSubgroupInfo(SUBGROUPINFO *subGroupInfo, int chainType, 
                              int subGroup,
                              char *name, 
@@ -117,9 +220,49 @@ static void InitSubgroupInfo(SUBGROUPINFO *subGroupInfo, int chainType,
                              REAL sv12, REAL sv13, REAL sv14, REAL sv15,
                              REAL sv16, REAL sv17, REAL sv18, REAL sv19,
                              REAL sv20);
-static int InitializeAllSubgroups(SUBGROUPINFO *subGroupInfo);
-static int ReadSubgroupData(FILE *fp, SUBGROUPINFO *subGroupInfo);
 static void takeLogs(SUBGROUPINFO *subGroupInfo, int nSubGroups);
+static void InsertTopK(SUBGROUPRESULT *result, int topK, int id,
+                       REAL score, int offset);
+static void LoadModelData(SUBGROUPMODEL *model, FILE *fp,
+                          BOOL fullMatrix, BOOL includeX, BOOL doProduct);
+static void FreeModelData(SUBGROUPMODEL *model);
+static void DiscardSubgroups(SUBGROUPINFO *subGroupInfo, int nSubGroups);
+static BOOL SameScoring(SUBGROUPMODEL *model1, SUBGROUPMODEL *model2,
+                        int nX);
+static void ScoreModel(SUBGROUPMODEL *model, char *sequence,
+                       unsigned char *code, SUBGROUPRESULT *result);
+static void ScoreSubgroup(SUBGROUPMODEL *model, int sgNum,
+                          char *sequence, unsigned char *code,
+                          int nStarts, int nExtension,
+                          SUBGROUPRESULT *result);
+static void ScoreSplit(SUBGROUPMODEL *model, char *sequence,
+                       unsigned char *code, int nStarts, int nExtension,
+                       SUBGROUPRESULT *result);
+static void ScorePart(void *arg, int part, int nParts);
+static int  SearchBatchSplit(SUBGROUPMODEL *model, unsigned char *code,
+                             int nStarts, int nExtension,
+                             NODEBOUND *batch, int *orders, int nBatch,
+                             SPLITUNIT *units, REAL **next,
+                             NODEBOUND *heap, int *nHeap,
+                             SUBGROUPRESULT *result);
+static void SearchBatchPart(void *arg, int part, int nParts);
+static void OrderStarts(REAL *startBound, int nStarts, int *order);
+static int  ScoreMember(SUBGROUPMODEL *model, int sgNum,
+                        unsigned char *code, int nStarts, int nExtension,
+                        REAL *startBound, int *order,
+                        SUBGROUPRESULT *result);
+static REAL BestStart(REAL *score, REAL *scoreMax, int nExtension,
+                      int *offset);
+static int  SearchIndex(SUBGROUPMODEL *model, unsigned char *code,
+                        int nStarts, int nExtension,
+                        SUBGROUPRESULT *result);
+static REAL NodeBounds(SUBGROUPMODEL *model, int node,
+                       unsigned char *code, int nStarts,
+                       REAL *parentBound, REAL minBound,
+                       REAL *startBound, int *nSummed);
+static void PushNode(NODEBOUND *heap, int *nHeap, REAL bound,
+                     REAL *startBound, int node);
+static NODEBOUND PopNode(NODEBOUND *heap, int *nHeap);
 
 
 /************************************************************************/
@@ -156,9 +299,12 @@ static void takeLogs(SUBGROUPINFO *subGroupInfo, int nSubGroups);
    \param[in]    sv0-sv20       The scores for the 21 positions in 
                                 secondSeq
 
-   Initialize a subGroupInfo structure
+   Initialize a subGroupInfo structure. The arrays are left NULL if
+   there is no memory
 
 -  01.08.18  Original   By: ACRM
+-  18.10.26  Allocates the arrays
+-  18.10.26  Copies the sequences with memcpy() and terminates them
 */
 static void InitSubgroupInfo(SUBGROUPINFO *subGroupInfo, int chainType, 
                              int subGroup,
@@ -178,9 +324,22 @@ static void InitSubgroupInfo(SUBGROUPINFO *subGroupInfo, int chainType,
                              REAL sv16, REAL sv17, REAL sv18, REAL sv19,
                              REAL sv20)
 {
-   strncpy(subGroupInfo->name,      name,      MAXBUFF);
-   strncpy(subGroupInfo->topSeq,    topSeq,    MAXBUFF);
-   strncpy(subGroupInfo->secondSeq, secondSeq, MAXBUFF);
+   int length;
+   
+   if(!AllocSubgroupInfo(subGroupInfo, MAXREFSEQLEN))
+      return;
+
+   strncpy(subGroupInfo->name, name, MAXBUFF-1);
+   subGroupInfo->name[MAXBUFF-1] = '\0';
+
+   if((length = strlen(topSeq)) > MAXREFSEQLEN)
+      length = MAXREFSEQLEN;
+   memcpy(subGroupInfo->topSeq, topSeq, length);
+   subGroupInfo->topSeq[length] = '\0';
+   if((length = strlen(secondSeq)) > MAXREFSEQLEN)
+      length = MAXREFSEQLEN;
+   memcpy(subGroupInfo->secondSeq, secondSeq, length);
+   subGroupInfo->secondSeq[length] = '\0';
 
    subGroupInfo->chainType        = chainType;
    subGroupInfo->subGroup         = subGroup;
@@ -232,8 +391,8 @@ static void InitSubgroupInfo(SUBGROUPINFO *subGroupInfo, int chainType,
 
 
 /************************************************************************/
-/*>static int InitializeAllSubgroups(SUBGROUPINFO *subGroupInfo)
-   -------------------------------------------------------------
+/*>int InitializeAllSubgroups(SUBGROUPINFO *subGroupInfo)
+   ------------------------------------------------------
 *//**
    \param[out]  *subGroupInfo   Array of SUBGROUPINFO structures to
                                 be initialized
@@ -242,10 +401,13 @@ static void InitSubgroupInfo(SUBGROUPINFO *subGroupInfo, int chainType,
 
 -  01.08.18  Original   By: ACRM
 -  08.01.19  Now returns the number of subgroups done
+-  18.10.26  No longer static so it can be benchmarked
+-  18.10.26  Returns 0 if there is no memory
 */
-static int InitializeAllSubgroups(SUBGROUPINFO *subGroupInfo)
+int InitializeAllSubgroups(SUBGROUPINFO *subGroupInfo)
 {
-   int nSubGroups = 0;
+   int nSubGroups = 0,
+       i;
    
    InitSubgroupInfo(&subGroupInfo[0],  CHAINTYPE_KAPPA,  1, 
                     "Human Kappa Light chain subgroup I",    
@@ -403,114 +565,93 @@ static int InitializeAllSubgroups(SUBGROUPINFO *subGroupInfo)
                     0.009,0.009,0.106,0.009,0.004,0.069,0.046);
    nSubGroups++;
 
+   for(i=0; i<nSubGroups; i++)
+   {
+      if(subGroupInfo[i].topScores == NULL)
+      {
+         FreeSubgroupData(subGroupInfo, nSubGroups);
+         return(0);
+      }
+   }
+
    return(nSubGroups);
 }
 
 
 /************************************************************************/
-/*static REAL CalcScore(SUBGROUPINFO subGroupInfo, char *sequence, 
-                        int offset, int offsetType, BOOL includeX)
-  ----------------------------------------------------------------
+/*>BOOL AllocSubgroupInfo(SUBGROUPINFO *subGroupInfo, int length)
+   --------------------------------------------------------------
 *//**
-   \param[in]  subGroupInfo - Information for the subgroup we are 
-                              looking at
-   \param[in]  sequence     - The sequence we are looking at
-   \param[in]  offset       - Offset into the reference sequence or
-                              sequence
-   \param[in]  offsetType   - OFFSETTRUNCATION - account for the sequence
-                                                 being Nter truncated
-                              OFFSETEXTENSION  - account for the sequence
-                                                 being Nter extended
-   \param[in]  includeX     - include X characters in calculations
+   \param[out]  *subGroupInfo   Subgroup information
+   \param[in]   length          Number of reference positions
+   \return                      Success (FALSE if no memory, when the
+                                arrays are left NULL)
 
-   Calculates the score for the test sequence against a specified
-   subgroup
+   Allocates the arrays for a subgroup with blank sequences and zero
+   scores
 
--  16.06.97 Original from Sophie's code
--  01.08.18 Complete rewrite
--  13.02.19 Added checking for X in sequence
+-  18.10.26  Original   By: ACRM
 */
-static REAL CalcScore(SUBGROUPINFO subGroupInfo, char *sequence, 
-                      int offset, int offsetType, BOOL includeX)
+BOOL AllocSubgroupInfo(SUBGROUPINFO *subGroupInfo, int length)
 {
-   REAL score    = 0.0,
-        scoreMax = 0.0;
-   int i;
-   
-   if(offsetType == OFFSETTRUNCATION)
+   subGroupInfo->length       = length;
+   subGroupInfo->topScores    = (REAL *)calloc(length, sizeof(REAL));
+   subGroupInfo->secondScores = (REAL *)calloc(length, sizeof(REAL));
+   subGroupInfo->topSeq       = (char *)calloc(length+1, sizeof(char));
+   subGroupInfo->secondSeq    = (char *)calloc(length+1, sizeof(char));
+
+   if((subGroupInfo->topScores == NULL) ||
+      (subGroupInfo->secondScores == NULL) ||
+      (subGroupInfo->topSeq == NULL) ||
+      (subGroupInfo->secondSeq == NULL))
    {
-      for(i = 0; i < (MAXREFSEQLEN-offset); i++) 
-      {
-         if((sequence[i] != 'X') || includeX)
-         {
-            /* Test if the residue matches the most common one at this 
-               position 
-            */
-            if(sequence[i] == subGroupInfo.topSeq[i+offset])
-            {
-               score += subGroupInfo.topScores[i+offset];
-            }
-            else /* If not, test if it matches the next most common     */
-            {
-               if(sequence[i] == subGroupInfo.secondSeq[i+offset])
-               {
-                  score += subGroupInfo.secondScores[i+offset];
-               }
-            }
-            
-            /* Calculate the best score we could get against the most 
-               common residues
-            */
-            scoreMax += subGroupInfo.topScores[i+offset];
-         }
-      }
+      FreeSubgroupData(subGroupInfo, 1);
+      return(FALSE);
    }
-   else  /* OFFSETEXTENSION                                             */
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void FreeSubgroupData(SUBGROUPINFO *subGroupInfo, int nSubGroups)
+   -----------------------------------------------------------------
+*//**
+   \param[in,out] *subGroupInfo  Array of subgroup information
+   \param[in]     nSubGroups     Number of subgroups
+
+   Frees the arrays of each subgroup and sets them to NULL
+
+-  18.10.26  Original   By: ACRM
+*/
+void FreeSubgroupData(SUBGROUPINFO *subGroupInfo, int nSubGroups)
+{
+   int i;
+
+   for(i=0; i<nSubGroups; i++)
    {
-      /* Return score of zero if we don't have enough residues in the
-         test sequence
-      */
-      if(strlen(sequence) < (MAXREFSEQLEN + offset))
-         return(0.0);
-      
-      for(i = 0; i < MAXREFSEQLEN; i++) 
-      {
-         if((sequence[i+offset] != 'X') || includeX)
-         {
-            /* Test if the residue matches the most common one at this 
-               position 
-            */
-            if(sequence[i+offset] == subGroupInfo.topSeq[i])
-            {
-               score += subGroupInfo.topScores[i];
-            }
-            else /* If not, test if it matches the next most common     */
-            {
-               if(sequence[i+offset] == subGroupInfo.secondSeq[i])
-               {
-                  score += subGroupInfo.secondScores[i];
-               }
-            }
-            
-            /* Calculate the best score we could get against the most 
-               common residues
-            */
-            scoreMax += subGroupInfo.topScores[i];
-         }
-      }
+      if(subGroupInfo[i].topScores != NULL)
+         free(subGroupInfo[i].topScores);
+      if(subGroupInfo[i].secondScores != NULL)
+         free(subGroupInfo[i].secondScores);
+      if(subGroupInfo[i].topSeq != NULL)
+         free(subGroupInfo[i].topSeq);
+      if(subGroupInfo[i].secondSeq != NULL)
+         free(subGroupInfo[i].secondSeq);
+      subGroupInfo[i].topScores = subGroupInfo[i].secondScores = NULL;
+      subGroupInfo[i].topSeq    = subGroupInfo[i].secondSeq    = NULL;
    }
-
-   return((score*100.0)/scoreMax);
 }
 
 
 /************************************************************************/
-/*>static int ReadSubgroupData(FILE *fp, SUBGROUPINFO *subGroupInfo)
-   -----------------------------------------------------------------
+/*>int ReadSubgroupData(FILE *fp, SUBGROUPINFO **pSubGroupInfo)
+   -----------------------------------------------------------
 *//**
-   \param[in]    *fp            File pointer
-   \param[out]   *subGroupInfo  The sub group information
-   \return                      Number of subgroups (0 for error)
+   \param[in]    *fp             File pointer
+   \param[out]   **pSubGroupInfo The sub group information in an array
+                                 allocated for the number read (NULL
+                                 if none)
+   \return                       Number of subgroups (0 for error)
 
    Reads the subgroup information file which contains records of the
    form
@@ -523,25 +664,36 @@ ZBVZLMZAATTVPLTPRESAI,
 0.005,0.022,0.016,0.022,0.087,0.005,0.038,0.005,0.005,0.011,0.289,0.033,0.022,0.093,0.022,0.120,0.005,0.109,0.027,0.114,0.032
 
 - 27.11.18 Original   By: ACRM
+- 18.10.26 No longer static so it can be benchmarked
+- 18.10.26 The sequences may have any length (the same for every
+           record) and lines may be any length. Returns 0 if there
+           is no memory
+- 18.10.26 Any number of subgroups in an array that grows as they are
+           read
 //
 
 */
-static int ReadSubgroupData(FILE *fp, SUBGROUPINFO *subGroupInfo)
+int ReadSubgroupData(FILE *fp, SUBGROUPINFO **pSubGroupInfo)
 {
    int  subGroupCount = 0,
+        nAlloc        = 0,
         dataNum       = 0,
         chainType     = 0,
         chainTypeNum  = 0,
-        nSubGroups    = 0;
-   char buffer[MAXBUFF],
+        length        = 0,
+        wordSize;
+   BOOL inEntry       = FALSE;
+   char *buffer,
+        *word,
         label[MAXBUFF],
-        seq1[MAXBUFF],
-        seq2[MAXBUFF],
         *chp;
-   REAL freq1[MAXREFSEQLEN],
-        freq2[MAXREFSEQLEN];
+   SUBGROUPINFO *subGroupInfo = NULL,
+                *info         = NULL,
+                *grown;
+
+   *pSubGroupInfo = NULL;
    
-   while(fgets(buffer, MAXBUFF, fp))
+   while((buffer = blFgetsany(fp)) != NULL)
    {
       TERMINATE(buffer);            /* Terminate normally               */
       TERMAT(buffer, '\r');         /* Terminate at DOS cursor return   */
@@ -552,68 +704,47 @@ static int ReadSubgroupData(FILE *fp, SUBGROUPINFO *subGroupInfo)
       {
          if(chp[0] == '>')          /* Start of new entry               */
          {
+            /* Drop an entry that was never finished                    */
+            if(inEntry)
+               FreeSubgroupData(info, 1);
+            inEntry = FALSE;
             dataNum = 0;
             chp++;
             KILLLEADSPACES(chp, chp);
          }
+
+         /* A word may be as long as the line                           */
+         wordSize = strlen(chp) + 1;
+         if((word = (char *)malloc(wordSize))==NULL)
+         {
+            free(buffer);
+            DiscardSubgroups(subGroupInfo, subGroupCount + inEntry);
+            return(0);
+         }
          
          do
          {
-            char word[MAXBUFF];
-            chp=blGetWord(chp, word, MAXBUFF);
+            chp=blGetWord(chp, word, wordSize);
 
             /* Test for the end of a block */
             if((word[0] == '/') && (word[1] == '/'))
             {
-               if(dataNum != 47)
+               if(!inEntry || (dataNum != (2*length + 5)))
                {
-                  char chainTypeLabel[16];
-                  switch(chainType)
-                  {
-                  case CHAINTYPE_HEAVY:
-                     strcpy(chainTypeLabel, "HEAVY");
-                     break;
-                  case CHAINTYPE_KAPPA:
-                     strcpy(chainTypeLabel, "KAPPA");
-                     break;
-                  case CHAINTYPE_LAMBDA:
-                     strcpy(chainTypeLabel, "LAMBDA");
-                     break;
-                  default:
-                     strcpy(chainTypeLabel, "????");
-                     break;
-                  }
-                  
                   fprintf(stderr,"Datafile invalid at %s %d. \
-Got %d fields instead of 46\n",
-                          chainTypeLabel, chainTypeNum, dataNum);
+Got %d fields instead of %d\n",
+                          ChainTypeLabel(chainType), chainTypeNum,
+                          dataNum, 2*length + 4);
+                  free(word);
+                  free(buffer);
+                  DiscardSubgroups(subGroupInfo, subGroupCount + inEntry);
                   return(0);
                }
-               InitSubgroupInfo(&subGroupInfo[subGroupCount++],
-                                chainType, chainTypeNum,
-                                label,
-                                seq1,
-                                freq1[0],  freq1[1],  freq1[2],
-                                freq1[3],  freq1[4],  freq1[5],
-                                freq1[6],  freq1[7],  freq1[8],
-                                freq1[9],  freq1[10], freq1[11], 
-                                freq1[12], freq1[13], freq1[14],
-                                freq1[15], freq1[16], freq1[17],
-                                freq1[18], freq1[19], freq1[20],
-                                seq2,
-                                freq2[0],  freq2[1],  freq2[2],
-                                freq2[3],  freq2[4],  freq2[5],
-                                freq2[6],  freq2[7],  freq2[8],
-                                freq2[9],  freq2[10], freq2[11], 
-                                freq2[12], freq2[13], freq2[14],
-                                freq2[15], freq2[16], freq2[17],
-                                freq2[18], freq2[19], freq2[20]);
-               if(++nSubGroups > MAXSUBTYPES)
-               {
-                  fprintf(stderr, "Data file contains too many types. \
-Increase MAXSUBTYPES.\n");
-                  exit(1);
-               }
+               strncpy(info->name, label, MAXBUFF);
+               info->chainType = chainType;
+               info->subGroup  = chainTypeNum;
+               inEntry         = FALSE;
+               subGroupCount++;
             }
             
             if(dataNum == 0)
@@ -630,6 +761,9 @@ Increase MAXSUBTYPES.\n");
                   chainType = CHAINTYPE_HEAVY;
                   break;
                default:
+                  free(word);
+                  free(buffer);
+                  DiscardSubgroups(subGroupInfo, subGroupCount);
                   return(0);
                }
             }
@@ -639,30 +773,119 @@ Increase MAXSUBTYPES.\n");
             }
             else if(dataNum == 2)
             {
-               strncpy(label, word, MAXBUFF);
+               strncpy(label, word, MAXBUFF-1);
+               label[MAXBUFF-1] = '\0';
             }
             else if(dataNum == 3)
             {
-               strncpy(seq1, word, MAXBUFF);
+               /* The consensus sequence gives the number of positions
+                  which must be the same for every subgroup
+               */
+               length = strlen(word);
+               if((length == 0) ||
+                  ((subGroupCount > 0) &&
+                   (length != subGroupInfo[0].length)))
+               {
+                  fprintf(stderr,"Datafile invalid at %s %d. \
+Got %d positions instead of %d\n",
+                          ChainTypeLabel(chainType), chainTypeNum,
+                          length, subGroupInfo[0].length);
+                  free(word);
+                  free(buffer);
+                  DiscardSubgroups(subGroupInfo, subGroupCount);
+                  return(0);
+               }
+               if(subGroupCount >= nAlloc)
+               {
+                  nAlloc = (nAlloc ? (2 * nAlloc) : SUBGROUPALLOC);
+                  if((grown = (SUBGROUPINFO *)
+                      realloc(subGroupInfo,
+                              nAlloc * sizeof(SUBGROUPINFO)))==NULL)
+                  {
+                     free(word);
+                     free(buffer);
+                     DiscardSubgroups(subGroupInfo, subGroupCount);
+                     return(0);
+                  }
+                  subGroupInfo = grown;
+               }
+               info = &(subGroupInfo[subGroupCount]);
+               if(!AllocSubgroupInfo(info, length))
+               {
+                  free(word);
+                  free(buffer);
+                  DiscardSubgroups(subGroupInfo, subGroupCount);
+                  return(0);
+               }
+               strcpy(info->topSeq, word);
+               inEntry = TRUE;
+            }
+            else if(!inEntry)
+            {
+               /* Skip the rest of an entry that couldn't be started    */
             }
-            else if((dataNum >= 4) && (dataNum <= 24))
+            else if(dataNum <= (length + 3))
             {
-               sscanf(word, "%lf", &(freq1[dataNum-4]));
+               sscanf(word, "%lf", &(info->topScores[dataNum-4]));
             }
-            else if(dataNum == 25)
+            else if(dataNum == (length + 4))
             {
-               strncpy(seq2, word, MAXBUFF);
+               strncpy(info->secondSeq, word, length);
             }
-            else if((dataNum >= 26) && (dataNum <= 46))
+            else if(dataNum <= (2*length + 4))
             {
-               sscanf(word, "%lf", &(freq2[dataNum-26]));
+               sscanf(word, "%lf",
+                      &(info->secondScores[dataNum-length-5]));
             }
             
             dataNum++;
          } while(chp!=NULL);
+
+         free(word);
       }
+      free(buffer);
+   }
+
+   /* Drop an entry that was never finished                             */
+   if(inEntry)
+      FreeSubgroupData(info, 1);
+
+   if(subGroupCount == 0)
+   {
+      DiscardSubgroups(subGroupInfo, 0);
+      return(0);
+   }
+
+   /* Give back the unused space                                        */
+   if((grown = (SUBGROUPINFO *)
+       realloc(subGroupInfo,
+               subGroupCount * sizeof(SUBGROUPINFO)))!=NULL)
+      subGroupInfo = grown;
+   *pSubGroupInfo = subGroupInfo;
+   return(subGroupCount);
+}
+
+
+/************************************************************************/
+/*>static void DiscardSubgroups(SUBGROUPINFO *subGroupInfo,
+                                int nSubGroups)
+   ----------------------------------------------------------
+*//**
+   \param[in]   *subGroupInfo  Allocated array of subgroups (may be
+                               NULL)
+   \param[in]   nSubGroups     Number of them with allocated data
+
+   Frees the data of each subgroup and the array
+
+-  18.10.26 Original   By: ACRM
+*/
+static void DiscardSubgroups(SUBGROUPINFO *subGroupInfo, int nSubGroups)
+{
+   if(subGroupInfo != NULL)
+   {
+      FreeSubgroupData(subGroupInfo, nSubGroups);
+      free(subGroupInfo);
    }
-   return(nSubGroups);
 }
 
 
@@ -688,162 +911,1901 @@ void FindSubgroupSetOptions(BOOL verbose, BOOL includeX,
 
 
 /************************************************************************/
-/*>BOOL FindHumanSubgroup(FILE *fp, BOOL fullMatrix, char *sequence, 
-                          int *chainType, int *subGroup)
-   ----------------------------------------------------------------
+/*>BOOL FindSubgroupSetTopK(int topK)
+   ----------------------------------
+*//**
+   \param[in]    topK       Number of distinct subgroups to rank
+   \return                  Valid value (1..MAXTOPK)?
+
+   Sets how many subgroups are kept in the ranking returned by
+   FindHumanSubgroupResult(). The default is 2 (best and second best)
+
+-  18.10.26  Original   By: ACRM
+*/
+BOOL FindSubgroupSetTopK(int topK)
+{
+   if((topK < 1) || (topK > MAXTOPK))
+      return(FALSE);
+   sTopK = topK;
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>BOOL FindSubgroupSetSplit(int nParts)
+   -------------------------------------
+*//**
+   \param[in]    nParts     Number of threads to share the scoring of
+                            each chain (1 to MAXSPLIT; 1 scores in the
+                            calling thread)
+   \return                  Success
+
+   Starts a pool of threads that share out the subgroups of each chain
+   (stopping any earlier pool). This cuts the time taken for one chain
+   rather than the time for many, so the pool must only be used by one
+   thread at a time. The ranking is the same as scoring in one thread.
+
+-  18.10.26  Original   By: ACRM
+*/
+BOOL FindSubgroupSetSplit(int nParts)
+{
+   if(sSplitPool != NULL)
+   {
+      StopSplitPool(sSplitPool);
+      free(sSplitResults);
+      sSplitPool    = NULL;
+      sSplitResults = NULL;
+   }
+   if((nParts < 1) || (nParts > MAXSPLIT))
+      return(FALSE);
+   if(nParts == 1)
+      return(TRUE);
+   
+   if((sSplitResults = (SUBGROUPRESULT *)malloc(nParts *
+                                          sizeof(SUBGROUPRESULT)))==NULL)
+      return(FALSE);
+   if((sSplitPool = StartSplitPool(nParts))==NULL)
+   {
+      free(sSplitResults);
+      sSplitResults = NULL;
+      return(FALSE);
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>BOOL LoadSubgroupModel(FILE *fp, BOOL fullMatrix)
+   -------------------------------------------------
 *//**
    \param[in]   fp           - file of residue subgroup specifications
                                (NULL - use default hardcoded values)
    \param[in]   fullMatrix   - datafile is a full scoring matrix
-   \param[in]   sequence     - the sequence of interest
-   \param[out]  chainType    - chain type: CHAINTYPE_HEAVY
-                                           CHAINTYPE_KAPPA
-                                           CHAINTYPE_LAMBDA
-   \param[out]  subGroup     - subgroup
    \return                   - Success in reading data file
 
-   Assigns the subgroup information for a sequence
+   Loads the subgroup data. This is done automatically by the first
+   call to FindHumanSubgroup(), but may be called in advance so that
+   the subgroup names are available before any sequence is scored.
+   Subsequent calls do nothing.
 
--  16.06.97 Original from Sophie's code
--  01.08.18 Complete rewrite
--  27.11.18 Now returns BOOL and can read file of residue frequencies
-            Also deals with verbose printing
--  05.02.19 Added fullMatrix handling
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Added model_load_start and model_load_end probes
 */
-BOOL FindHumanSubgroup(FILE *fp, BOOL fullMatrix, char *sequence,
-                       int *chainType, int *subGroup)
+BOOL LoadSubgroupModel(FILE *fp, BOOL fullMatrix)
 {
-   static SUBGROUPINFO subGroupInfo[MAXSUBTYPES];
-   static FMSUBGROUPINFO   fmSubGroupInfo[MAXSUBTYPES];
-   static int          sInitialized            = 0,
-                       sNSubGroups             = 0;
-   int                 bestSubGroupCount       = -1,
-                       secondBestSubGroupCount = -1;
-   REAL                val                     = 0.0,
-                       maxVal                  = 0.0,
-                       secondMaxVal            = 0.0;
-   int                 subGroupCount,
-                       offset;
-#ifdef DEBUG
-   int                 bestOffset              = 0;
-#endif
-   
    if(!sInitialized)
    {
       sInitialized = 1;
-      if(fp != NULL)
+      LoadModelData(&sModel, fp, fullMatrix, sIncludeX, sDoProduct);
+   }
+
+   return(sModel.nSubGroups != 0);
+}
+
+
+/************************************************************************/
+/*>static void LoadModelData(SUBGROUPMODEL *model, FILE *fp,
+                             BOOL fullMatrix, BOOL includeX,
+                             BOOL doProduct)
+   ---------------------------------------------------------
+*//**
+   \param[out]  model        - model to fill in
+   \param[in]   fp           - file of residue subgroup specifications
+                               (NULL - use default hardcoded values)
+   \param[in]   fullMatrix   - datafile is a full scoring matrix
+   \param[in]   includeX     - include X characters in scoring
+   \param[in]   doProduct    - score as a product
+
+   Reads the subgroup data into a model taking logs if scores are to
+   be a product. model->nSubGroups is 0 on failure.
+
+-  18.10.26 Split out from LoadSubgroupModel()   By: ACRM
+-  18.10.26 Added includeX and doProduct
+-  18.10.26 Initializes the gap settings
+-  18.10.26 Sets the profile length and builds the table of scores
+-  18.10.26 The subgroups are allocated for the number loaded
+*/
+static void LoadModelData(SUBGROUPMODEL *model, FILE *fp,
+                          BOOL fullMatrix, BOOL includeX, BOOL doProduct)
+{
+   PROBE1(model_load_start, PROBEMODEL(fp, fullMatrix));
+      
+   model->fullMatrix     = fullMatrix;
+   model->includeX       = FALSE;
+   model->doProduct      = FALSE;
+   model->gapped         = FALSE;
+   model->gapOpen        = DEFAULTGAPOPEN;
+   model->gapExtend      = DEFAULTGAPEXTEND;
+   model->table          = NULL;
+   model->refLength      = 0;
+   model->nSubGroups     = 0;
+   model->subGroupInfo   = NULL;
+   model->fmSubGroupInfo = NULL;
+   model->nNodes         = 0;
+   model->nLeaves        = 0;
+   model->nodeStart      = NULL;
+   model->nodeItem       = NULL;
+   model->nodeTable      = NULL;
+   model->nNullBins      = 0;
+   model->nullTable      = NULL;
+   model->source         = model;
+   if(fp != NULL)
+   {
+      if(fullMatrix)
+         model->nSubGroups = ReadFullMatrix(fp, &(model->fmSubGroupInfo));
+      else
+         model->nSubGroups = ReadSubgroupData(fp, &(model->subGroupInfo));
+   }
+   else
+   {
+      /* The built-in subgroups fit in SUBGROUPALLOC                    */
+      model->fullMatrix = FALSE;
+      if((model->subGroupInfo = (SUBGROUPINFO *)
+          malloc(SUBGROUPALLOC * sizeof(SUBGROUPINFO)))!=NULL)
       {
-         if(fullMatrix)
-         {
-            sNSubGroups = ReadFullMatrix(fp, fmSubGroupInfo);
-            if(sDoProduct)
-               fmTakeLogs(fmSubGroupInfo, sNSubGroups);
-         }
-         else
+         if((model->nSubGroups =
+             InitializeAllSubgroups(model->subGroupInfo)) == 0)
          {
-            sNSubGroups = ReadSubgroupData(fp, subGroupInfo);
-            if(sDoProduct)
-               takeLogs(subGroupInfo, sNSubGroups);
+            free(model->subGroupInfo);
+            model->subGroupInfo = NULL;
          }
-         if(!sNSubGroups)
-            return(FALSE);
       }
-      else
+   }
+
+   if(model->nSubGroups)
+   {
+      model->refLength = model->fullMatrix ?
+                         model->fmSubGroupInfo[0].length :
+                         model->subGroupInfo[0].length;
+      if(!ConfigureSubgroupModel(model, includeX, doProduct))
       {
-         sNSubGroups = InitializeAllSubgroups(subGroupInfo);
-         if(sDoProduct)
-            takeLogs(subGroupInfo, sNSubGroups);
+         FreeModelData(model);
+         model->nSubGroups = 0;
       }
    }
-   
-   /* For each sub-group                                                */
-   for(subGroupCount = 0; subGroupCount < sNSubGroups; subGroupCount++) 
-   { 
-      /* Shift along the reference sequence to account for N-terminal
-         truncation of the test sequence
-      */
-      for(offset = 0; offset < MAXTRUNCATION; offset++)
+      
+   PROBE2(model_load_end, PROBEMODEL(fp, fullMatrix), model->nSubGroups);
+}
+
+
+/************************************************************************/
+/*>BOOL ConfigureSubgroupModel(SUBGROUPMODEL *model, BOOL includeX,
+                               BOOL doProduct)
+   ----------------------------------------------------------------
+*//**
+   \param[in,out] model      - the model
+   \param[in]   includeX     - include X characters in scoring
+   \param[in]   doProduct    - score as a product
+   \return                   - FALSE if the model is already set up for
+                               a product and doProduct is not set or
+                               if there is no memory for the table
+
+   Sets how a model is scored. Logs of the scores are taken the first
+   time a product is asked for; this can't be undone so use 
+   CopySubgroupModel() first to keep the raw scores as well.
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Rebuilds the table of scores
+*/
+BOOL ConfigureSubgroupModel(SUBGROUPMODEL *model, BOOL includeX,
+                            BOOL doProduct)
+{
+   if(model->doProduct && !doProduct)
+      return(FALSE);
+
+   model->includeX = includeX;
+   if(doProduct && !model->doProduct)
+   {
+      if(model->fullMatrix)
+         fmTakeLogs(model->fmSubGroupInfo, model->nSubGroups);
+      else
+         takeLogs(model->subGroupInfo, model->nSubGroups);
+      model->doProduct = TRUE;
+   }
+   return(BuildProfileTable(model));
+}
+
+
+/************************************************************************/
+/*>void SetSubgroupGaps(SUBGROUPMODEL *model, BOOL gapped, REAL gapOpen,
+                        REAL gapExtend)
+   ---------------------------------------------------------------------
+*//**
+   \param[in,out] model      - the model
+   \param[in]   gapped       - also try a gapped alignment
+   \param[in]   gapOpen      - penalty for the first residue of a gap
+   \param[in]   gapExtend    - penalty for each further residue
+
+   Sets whether a model is scored with gapped alignment as well as the
+   normal ungapped offsets. The best of the two is used. Product
+   scores are never gapped.
+
+-  18.10.26 Original   By: ACRM
+*/
+void SetSubgroupGaps(SUBGROUPMODEL *model, BOOL gapped, REAL gapOpen,
+                     REAL gapExtend)
+{
+   model->gapped    = gapped;
+   model->gapOpen   = gapOpen;
+   model->gapExtend = gapExtend;
+}
+
+
+/************************************************************************/
+/*>SUBGROUPMODEL *CopySubgroupModel(SUBGROUPMODEL *model, char *label)
+   ------------------------------------------------------------------
+*//**
+   \param[in]   model        - the model to copy
+   \param[in]   label        - name for the copy in output
+   \return                   - the copy (NULL if no memory)
+
+   Copies a model so that it can be given a different configuration.
+   The copy remembers where its data came from so that 
+   ScoreSubgroupModels() can share results between copies that are
+   bound to score the same.
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Copies the profiles and table
+-  18.10.26 Allocates the subgroups and rebuilds the index
+-  18.10.26 The copy has no null scores
+*/
+SUBGROUPMODEL *CopySubgroupModel(SUBGROUPMODEL *model, char *label)
+{
+   SUBGROUPMODEL *copy;
+   int           sgNum;
+   BOOL          ok = TRUE;
+
+   if((copy = (SUBGROUPMODEL *)malloc(sizeof(SUBGROUPMODEL)))==NULL)
+      return(NULL);
+
+   memcpy(copy, model, sizeof(SUBGROUPMODEL));
+   copy->table          = NULL;
+   copy->nNodes         = 0;
+   copy->nLeaves        = 0;
+   copy->nodeStart      = NULL;
+   copy->nodeItem       = NULL;
+   copy->nodeTable      = NULL;
+   copy->nNullBins      = 0;
+   copy->nullTable      = NULL;
+   copy->subGroupInfo   = NULL;
+   copy->fmSubGroupInfo = NULL;
+   if(model->fullMatrix)
+      ok = ((copy->fmSubGroupInfo = (FMSUBGROUPINFO *)
+             calloc(model->nSubGroups, sizeof(FMSUBGROUPINFO)))!=NULL);
+   else
+      ok = ((copy->subGroupInfo = (SUBGROUPINFO *)
+             calloc(model->nSubGroups, sizeof(SUBGROUPINFO)))!=NULL);
+   if(!ok)
+   {
+      free(copy);
+      return(NULL);
+   }
+
+   for(sgNum=0; sgNum<model->nSubGroups; sgNum++)
+   {
+      if(model->fullMatrix)
       {
-         if(fullMatrix)
+         FMSUBGROUPINFO *from = &(model->fmSubGroupInfo[sgNum]),
+                        *to   = &(copy->fmSubGroupInfo[sgNum]);
+
+         *to = *from;
+         if(ok && (ok = fmAllocSubgroupInfo(to, from->length)))
          {
-            val = CalcFullScore(fmSubGroupInfo[subGroupCount], sequence, 
-                                offset, OFFSETTRUNCATION, sIncludeX);
+            memcpy(to->scores, from->scores,
+                   from->length * sizeof(from->scores[0]));
+            memcpy(to->topScores, from->topScores,
+                   from->length * sizeof(REAL));
          }
          else
          {
-            val = CalcScore(subGroupInfo[subGroupCount], sequence, 
-                            offset, OFFSETTRUNCATION, sIncludeX);
-         }
-         
-         if(val > maxVal) 
-         {
-            maxVal            = val;
-            bestSubGroupCount = subGroupCount;
-#ifdef DEBUG
-            bestOffset        = offset;
-#endif
-         }
-         else if((val < maxVal) && (val > secondMaxVal))
-         {
-            secondMaxVal            = val;
-            secondBestSubGroupCount = subGroupCount;
+            to->scores    = NULL;
+            to->topScores = NULL;
          }
-         
       }
-
-      /* Shift along the test sequence to account for N-terminal 
-         extension of the test sequence
-      */
-      for(offset = 0; offset < MAXEXTENSION; offset++)
+      else
       {
-         if(fullMatrix)
+         SUBGROUPINFO *from = &(model->subGroupInfo[sgNum]),
+                      *to   = &(copy->subGroupInfo[sgNum]);
+
+         *to = *from;
+         if(ok && (ok = AllocSubgroupInfo(to, from->length)))
          {
-            val = CalcFullScore(fmSubGroupInfo[subGroupCount], sequence, 
-                                offset, OFFSETEXTENSION, sIncludeX);
+            memcpy(to->topScores, from->topScores,
+                   from->length * sizeof(REAL));
+            memcpy(to->secondScores, from->secondScores,
+                   from->length * sizeof(REAL));
+            strcpy(to->topSeq,    from->topSeq);
+            strcpy(to->secondSeq, from->secondSeq);
          }
          else
          {
-            val = CalcScore(subGroupInfo[subGroupCount], sequence, 
-                            offset, OFFSETEXTENSION, sIncludeX);
-         }
-         
-         if(val > maxVal) 
-         {
-            maxVal            = val;
-            bestSubGroupCount = subGroupCount;
-#ifdef DEBUG
-            bestOffset        = -offset;
-#endif
-         }
-         else if((val < maxVal) && (val > secondMaxVal))
-         {
-            secondMaxVal            = val;
-            secondBestSubGroupCount = subGroupCount;
+            to->topScores = to->secondScores = NULL;
+            to->topSeq    = to->secondSeq    = NULL;
          }
       }
    }
 
-   /* Print the winning name                                            */
-   printf("%s",fullMatrix ? fmSubGroupInfo[bestSubGroupCount].name :
-          subGroupInfo[bestSubGroupCount].name);
+   if(!ok || !BuildProfileTable(copy))
+   {
+      FreeModelData(copy);
+      free(copy);
+      return(NULL);
+   }
 
-   if(sVerbose)
+   strncpy(copy->label, label, MAXBUFF-1);
+   copy->label[MAXBUFF-1] = '\0';
+   return(copy);
+}
+
+
+/************************************************************************/
+/*>SUBGROUPMODEL *GetDefaultModel(void)
+   ------------------------------------
+*//**
+   \return      The model loaded by LoadSubgroupModel() (NULL if it has
+                not been loaded)
+
+-  18.10.26 Original   By: ACRM
+*/
+SUBGROUPMODEL *GetDefaultModel(void)
+{
+   return((sInitialized && sModel.nSubGroups) ? &sModel : NULL);
+}
+
+
+/************************************************************************/
+/*>SUBGROUPMODEL *ReadSubgroupModel(FILE *fp, BOOL fullMatrix,
+                                    char *label)
+   -----------------------------------------------------------
+*//**
+   \param[in]   fp           - file of residue subgroup specifications
+                               (NULL - use default hardcoded values)
+   \param[in]   fullMatrix   - datafile is a full scoring matrix
+   \param[in]   label        - name for the model in output
+   \return                   - The model (NULL if no memory or the data
+                               could not be read)
+
+   Loads an additional model to be used with ScoreSubgroupModels().
+   The model has the raw scores and doesn't include X; use 
+   ConfigureSubgroupModel() to change this.
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 No longer uses the options from FindSubgroupSetOptions()
+*/
+SUBGROUPMODEL *ReadSubgroupModel(FILE *fp, BOOL fullMatrix, char *label)
+{
+   SUBGROUPMODEL *model;
+
+   if((model = (SUBGROUPMODEL *)malloc(sizeof(SUBGROUPMODEL)))==NULL)
+      return(NULL);
+
+   LoadModelData(model, fp, fullMatrix, FALSE, FALSE);
+   if(model->nSubGroups == 0)
    {
-      printf(",%f,", maxVal);
-      printf("%s,",  fullMatrix ?
-             fmSubGroupInfo[secondBestSubGroupCount].name :
-             subGroupInfo[secondBestSubGroupCount].name);
-      printf("%f",secondMaxVal);
+      free(model);
+      return(NULL);
    }
-   printf("\n");
+   strncpy(model->label, label, MAXBUFF-1);
+   model->label[MAXBUFF-1] = '\0';
+   return(model);
+}
+
+
+/************************************************************************/
+/*>void FreeSubgroupModel(SUBGROUPMODEL *model)
+   --------------------------------------------
+*//**
+   \param[in]   model   Model from ReadSubgroupModel()
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Frees the profiles and table
+*/
+void FreeSubgroupModel(SUBGROUPMODEL *model)
+{
+   if((model != NULL) && (model != &sModel))
+   {
+      FreeModelData(model);
+      free(model);
+   }
+}
+
+
+/************************************************************************/
+/*>static void FreeModelData(SUBGROUPMODEL *model)
+   -----------------------------------------------
+*//**
+   \param[in,out] model   The model
+
+   Frees the profiles, table, index and null scores of a model
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Frees the arrays of subgroups and the index
+-  18.10.26 Frees the null scores
+*/
+static void FreeModelData(SUBGROUPMODEL *model)
+{
+   if(model->fmSubGroupInfo != NULL)
+   {
+      fmFreeSubgroupData(model->fmSubGroupInfo, model->nSubGroups);
+      free(model->fmSubGroupInfo);
+   }
+   if(model->subGroupInfo != NULL)
+      DiscardSubgroups(model->subGroupInfo, model->nSubGroups);
+   model->fmSubGroupInfo = NULL;
+   model->subGroupInfo   = NULL;
+
+   if(model->table != NULL)
+      free(model->table);
+   model->table = NULL;
+   FreeProfileIndex(model);
+   FreeNullScores(model);
+}
+
+
+/************************************************************************/
+/*>char *ModelSubgroupName(SUBGROUPMODEL *model, int id)
+   -----------------------------------------------------
+*//**
+   \param[in]   model  The model
+   \param[in]   id     Subgroup ID as returned in a SUBGROUPRESULT
+   \return             The subgroup name (blank string if id is invalid)
+
+-  18.10.26 Original   By: ACRM
+*/
+char *ModelSubgroupName(SUBGROUPMODEL *model, int id)
+{
+   if((id < 0) || (id >= model->nSubGroups))
+      return("");
+   
+   return(model->fullMatrix ? model->fmSubGroupInfo[id].name :
+                              model->subGroupInfo[id].name);
+}
+
+
+/************************************************************************/
+/*>int GetSubgroupCount(void)
+   --------------------------
+*//**
+   \return      Number of subgroups in the loaded data
+
+-  18.10.26 Original   By: ACRM
+*/
+int GetSubgroupCount(void)
+{
+   return(sModel.nSubGroups);
+}
+
+
+/************************************************************************/
+/*>char *GetSubgroupName(int id)
+   -----------------------------
+*//**
+   \param[in]   id     Subgroup ID as returned in a SUBGROUPRESULT
+   \return             The subgroup name (blank string if id is invalid)
+
+   Subgroup IDs are simply the index into the loaded data so can be
+   stored or written in place of the name.
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Uses ModelSubgroupName()
+*/
+char *GetSubgroupName(int id)
+{
+   return(ModelSubgroupName(&sModel, id));
+}
+
+
+/************************************************************************/
+/*>char *ChainTypeLabel(int chainType)
+   -----------------------------------
+*//**
+   \param[in]   chainType   CHAINTYPE_HEAVY, CHAINTYPE_KAPPA or
+                            CHAINTYPE_LAMBDA
+   \return                  Text label for the chain type
+
+-  18.10.26 Original   By: ACRM
+*/
+char *ChainTypeLabel(int chainType)
+{
+   switch(chainType)
+   {
+   case CHAINTYPE_HEAVY:
+      return("HEAVY");
+   case CHAINTYPE_KAPPA:
+      return("KAPPA");
+   case CHAINTYPE_LAMBDA:
+      return("LAMBDA");
+   default:
+      break;
+   }
+   return("????");
+}
+
+
+/************************************************************************/
+/*>int GetSubgroupChainType(int id)
+   --------------------------------
+*//**
+   \param[in]   id     Subgroup ID as returned in a SUBGROUPRESULT
+   \return             CHAINTYPE_HEAVY, CHAINTYPE_KAPPA or
+                       CHAINTYPE_LAMBDA (-1 if id is invalid)
+
+-  18.10.26 Original   By: ACRM
+*/
+int GetSubgroupChainType(int id)
+{
+   if((id < 0) || (id >= sModel.nSubGroups))
+      return(-1);
+   
+   return(sModel.fullMatrix ? sModel.fmSubGroupInfo[id].chainType :
+                        sModel.subGroupInfo[id].chainType);
+}
+
+
+/************************************************************************/
+/*>BOOL GetSubgroupProfile(int id, int pos, REAL *freq)
+   ----------------------------------------------------
+*//**
+   \param[in]   id     Subgroup ID as returned in a SUBGROUPRESULT
+   \param[in]   pos    Position in the reference (from 0)
+   \param[out]  freq   26 residue frequencies indexed by letter (A=0)
+                       which sum to 1
+   \return             Valid id and position?
+
+   Returns the residue frequencies at a position of the loaded data.
+   For a full matrix these are the matrix values. For the standard
+   data file only the top two residues are known so the remainder
+   is spread evenly over the other standard amino acids. The values
+   are only frequencies if the model was loaded without -p.
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Checks against the length of the profiles
+*/
+BOOL GetSubgroupProfile(int id, int pos, REAL *freq)
+{
+   static char *stdAA = "ACDEFGHIKLMNPQRSTVWY";
+   REAL        total  = 0.0;
+   int         i;
+
+   if((id < 0) || (id >= sModel.nSubGroups) ||
+      (pos < 0) || (pos >= sModel.refLength))
+      return(FALSE);
+
+   for(i=0; i<26; i++)
+      freq[i] = 0.0;
+   
+   if(sModel.fullMatrix)
+   {
+      for(i=0; i<26; i++)
+         freq[i] = sModel.fmSubGroupInfo[id].scores[pos][i];
+   }
+   else
+   {
+      SUBGROUPINFO *info = &(sModel.subGroupInfo[id]);
+      REAL         rest;
+      int          nOther = 0;
+      
+      if(isupper(info->topSeq[pos]))
+         freq[info->topSeq[pos] - 'A']    += info->topScores[pos];
+      if(isupper(info->secondSeq[pos]))
+         freq[info->secondSeq[pos] - 'A'] += info->secondScores[pos];
+
+      rest = 1.0 - info->topScores[pos] - info->secondScores[pos];
+      if(rest > 0.0)
+      {
+         for(i=0; stdAA[i]; i++)
+         {
+            if((stdAA[i] != info->topSeq[pos]) &&
+               (stdAA[i] != info->secondSeq[pos]))
+               nOther++;
+         }
+         for(i=0; stdAA[i]; i++)
+         {
+            if((stdAA[i] != info->topSeq[pos]) &&
+               (stdAA[i] != info->secondSeq[pos]))
+               freq[stdAA[i] - 'A'] += rest / nOther;
+         }
+      }
+   }
+
+   for(i=0; i<26; i++)
+   {
+      if(freq[i] < 0.0)
+         freq[i] = 0.0;
+      total += freq[i];
+   }
+
+   /* Nothing known at this position so use all the standard residues  */
+   if(total <= 0.0)
+   {
+      for(i=0; stdAA[i]; i++)
+         freq[stdAA[i] - 'A'] = 1.0;
+      total = 20.0;
+   }
+   
+   for(i=0; i<26; i++)
+      freq[i] /= total;
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>BOOL FindHumanSubgroupResult(FILE *fp, BOOL fullMatrix, 
+                                char *sequence, SUBGROUPRESULT *result)
+   ---------------------------------------------------------------------
+*//**
+   \param[in]   fp           - file of residue subgroup specifications
+                               (NULL - use default hardcoded values)
+   \param[in]   fullMatrix   - datafile is a full scoring matrix
+   \param[in]   sequence     - the sequence of interest
+   \param[out]  result       - the best K distinct subgroups with
+                               their scores and offsets
+   \return                   - Success in reading data file
+
+   Assigns the subgroup information for a sequence without printing
+   anything. Subgroups are identified by their index in the loaded
+   data (-1 if there was no match); use GetSubgroupName() for the name.
+
+-  16.06.97 Original from Sophie's code
+-  01.08.18 Complete rewrite
+-  27.11.18 Now returns BOOL and can read file of residue frequencies
+-  05.02.19 Added fullMatrix handling
+-  18.10.26 Split out from FindHumanSubgroup(). Chain type is now
+            taken from the full matrix data when that is in use
+-  18.10.26 Ranks the best K distinct subgroups using the best offset
+            for each
+-  18.10.26 Records the chain length, X count and the number of
+            offsets evaluated and pruned
+-  18.10.26 Added chain_start and chain_end probes
+-  18.10.26 Scoring moved to ScoreSubgroupModels()
+*/
+BOOL FindHumanSubgroupResult(FILE *fp, BOOL fullMatrix, char *sequence,
+                             SUBGROUPRESULT *result)
+{
+   SUBGROUPMODEL *model = &sModel;
+   
+   if(!LoadSubgroupModel(fp, fullMatrix))
+      return(FALSE);
+
+   return(ScoreSubgroupModels(&model, 1, sequence, result));
+}
+
+
+/************************************************************************/
+/*>BOOL ScoreSubgroupModels(SUBGROUPMODEL **models, int nModels,
+                            char *sequence, SUBGROUPRESULT *results)
+   -----------------------------------------------------------------
+*//**
+   \param[in]   models       - the models to score against
+   \param[in]   nModels      - number of models
+   \param[in]   sequence     - the sequence of interest
+   \param[out]  results      - array of nModels results, one for each
+                               model
+   \return                   - Success
+
+   Scores a sequence against several loaded models. The sequence is
+   only scanned once for its length and X count and turned into
+   residue codes once for the longest profile; the probes see a 
+   single chain and report the first model's result. A model that is
+   bound to score the same as an earlier one just copies its result.
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Shares results between models with the same scoring
+-  18.10.26 Encodes the sequence for the table-driven scoring. Returns
+            FALSE if there is no memory
+*/
+BOOL ScoreSubgroupModels(SUBGROUPMODEL **models, int nModels,
+                         char *sequence, SUBGROUPRESULT *results)
+{
+   int           m, k,
+                 nX        = 0,
+                 refLength = 0,
+                 nCodes;
+   char          *chp;
+   unsigned char *code;
+   
+   if(nModels < 1)
+      return(FALSE);
+   
+   for(chp=sequence; *chp; chp++)
+   {
+      if(*chp == 'X')
+         nX++;
+   }
+   for(m=0; m<nModels; m++)
+   {
+      if(models[m]->refLength > refLength)
+         refLength = models[m]->refLength;
+   }
+
+   nCodes = PROFSTARTS + refLength - 1;
+   if((code = (unsigned char *)malloc(nCodes))==NULL)
+      return(FALSE);
+   EncodeProfileChain(sequence, (int)(chp - sequence), code, nCodes);
+
+   PROBE2(chain_start, sequence, (int)(chp - sequence));
+
+   for(m=0; m<nModels; m++)
+   {
+      for(k=0; k<m; k++)
+      {
+         if(SameScoring(models[k], models[m], nX))
+            break;
+      }
+
+      if(k < m)
+      {
+         results[m] = results[k];
+      }
+      else
+      {
+         results[m].nX     = nX;
+         results[m].length = (int)(chp - sequence);
+         ScoreModel(models[m], sequence, code, &(results[m]));
+      }
+   }
+   free(code);
+
+   PROBE4(chain_end, results[0].length, results[0].best,
+          results[0].chainType, (long)(results[0].score * 1000.0));
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static BOOL SameScoring(SUBGROUPMODEL *model1, SUBGROUPMODEL *model2,
+                           int nX)
+   ---------------------------------------------------------------------
+*//**
+   \param[in]   model1       - a model
+   \param[in]   model2       - another model
+   \param[in]   nX           - number of X characters in the chain
+   \return                   - The models must give the same result
+
+   Models copied from the same data with the same scores give the same
+   result if they treat X the same way or if there is no X to treat.
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Checks the gap settings
+*/
+static BOOL SameScoring(SUBGROUPMODEL *model1, SUBGROUPMODEL *model2,
+                        int nX)
+{
+   return((model1->source    == model2->source)    &&
+          (model1->doProduct == model2->doProduct) &&
+          (model1->gapped    == model2->gapped)    &&
+          (!model1->gapped ||
+           ((model1->gapOpen   == model2->gapOpen) &&
+            (model1->gapExtend == model2->gapExtend))) &&
+          ((model1->includeX == model2->includeX) || (nX == 0)));
+}
+
+
+/************************************************************************/
+/*>int BestModel(SUBGROUPRESULT *results, int nModels)
+   ---------------------------------------------------
+*//**
+   \param[in]   results      - results from ScoreSubgroupModels()
+   \param[in]   nModels      - number of models
+   \return                   - index of the model with the highest
+                               score (-1 if none matched). On a tie
+                               the earlier model wins
+
+-  18.10.26 Original   By: ACRM
+*/
+int BestModel(SUBGROUPRESULT *results, int nModels)
+{
+   int m,
+       best = -1;
+   
+   for(m=0; m<nModels; m++)
+   {
+      if((results[m].best >= 0) &&
+         ((best < 0) || (results[m].score > results[best].score)))
+         best = m;
+   }
+   return(best);
+}
+
+
+/************************************************************************/
+/*>BOOL SameScoreScale(SUBGROUPMODEL **models, int nModels)
+   --------------------------------------------------------
+*//**
+   \param[in]   models       - the models
+   \param[in]   nModels      - number of models
+   \return                   - the scores of all the models can be
+                               compared. Sums of similarities can't be
+                               compared with the logs of products (-p)
+
+-  18.10.26 Original   By: ACRM
+*/
+BOOL SameScoreScale(SUBGROUPMODEL **models, int nModels)
+{
+   int m;
+   
+   for(m=1; m<nModels; m++)
+   {
+      if(!models[m]->doProduct != !models[0]->doProduct)
+         return(FALSE);
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>static void ScoreModel(SUBGROUPMODEL *model, char *sequence,
+                          unsigned char *code, SUBGROUPRESULT *result)
+   ---------------------------------------------------------------------
+*//**
+   \param[in]   model        - the model to score against
+   \param[in]   sequence     - the sequence of interest
+   \param[in]   code         - the sequence from EncodeProfileChain()
+                               with enough codes for the model
+   \param[in,out] result     - length and nX must be set on entry. The
+                               rest is filled in
+
+   Scores a sequence against each subgroup of a model at every offset.
+   The offsets are tried in the order they always have been, 
+   truncations and then extensions, so the first best offset wins a
+   tie. If the model has an index, only the subgroups and offsets that
+   could be ranked are scored. The index isn't used with a gapped
+   alignment as that can score more than the bound. Either way the
+   work is shared out on the split pool if there is one and there are
+   enough subgroups to be worth sharing.
+
+-  18.10.26 Split out from FindHumanSubgroupResult()   By: ACRM
+-  18.10.26 Uses the model's includeX setting
+-  18.10.26 Tries a gapped alignment if the model is gapped
+-  18.10.26 Scores every offset at once from the model's table
+-  18.10.26 Uses the model's index. Scoring a subgroup moved to
+            ScoreSubgroup()
+-  18.10.26 Counts the offsets the index scored
+-  18.10.26 Uses the split pool
+-  18.10.26 Sets the p-value and E-value
+-  18.10.26 nPruned is never below 0
+-  18.10.26 The index uses the split pool
+*/
+static void ScoreModel(SUBGROUPMODEL *model, char *sequence,
+                       unsigned char *code, SUBGROUPRESULT *result)
+{
+   int subGroupCount,
+       nExtension,
+       nStarts,
+       nEvaluated;
+
+   result->nTop = 0;
+   
+   /* Extension offsets are only scored if the chain is long enough     */
+   nExtension = result->length - model->refLength + 1;
+   if(nExtension < 0)
+      nExtension = 0;
+   if(nExtension > MAXEXTENSION)
+      nExtension = MAXEXTENSION;
+   nStarts = PROFPADDING + ((nExtension > 0) ? nExtension : 1);
+
+   if((model->nNodes > 0) && !(model->gapped && !model->doProduct) &&
+      ((nEvaluated = SearchIndex(model, code, nStarts, nExtension,
+                                 result)) >= 0))
+   {
+      /* Only the offsets the index couldn't rule out were scored       */
+   }
+   else if((sSplitPool != NULL) &&
+           ((model->gapped && !model->doProduct) ||
+            (model->nSubGroups >= SPLITMINSUBGROUPS)))
+   {
+      ScoreSplit(model, sequence, code, nStarts, nExtension, result);
+      nEvaluated = model->nSubGroups * (MAXTRUNCATION + nExtension);
+   }
+   else
+   {
+      for(subGroupCount = 0;
+          subGroupCount < model->nSubGroups;
+          subGroupCount++) 
+      {
+         ScoreSubgroup(model, subGroupCount, sequence, code, nStarts,
+                       nExtension, result);
+      }
+      nEvaluated = model->nSubGroups * (MAXTRUNCATION + nExtension);
+   }
+   /* The sums for an index's node bounds are counted too, so a search
+      that prunes little can make more sums than an exhaustive one
+   */
+   result->nEvaluated = nEvaluated;
+   result->nPruned    = (model->nSubGroups *
+                         (MAXTRUNCATION + MAXEXTENSION)) - nEvaluated;
+   if(result->nPruned < 0)
+      result->nPruned = 0;
+   result->shortChain = (nExtension < MAXEXTENSION);
+
 #ifdef DEBUG
-   printf("Offset: %d (%s)\n", bestOffset, 
-          ((bestOffset<0)?"extension":"truncation"));
+   if(result->nTop)
+      fprintf(stderr, "Offset: %d (%s)\n", result->topOffset[0], 
+              ((result->topOffset[0]<0)?"extension":"truncation"));
 #endif
 
+   result->best        = (result->nTop > 0) ? result->topId[0]    : -1;
+   result->score       = (result->nTop > 0) ? result->topScore[0] : 0.0;
+   result->second      = (result->nTop > 1) ? result->topId[1]    : -1;
+   result->secondScore = (result->nTop > 1) ? result->topScore[1] : 0.0;
+   result->chainType   = -1;
+   result->subGroup    = 0;
+   result->pValue      = -1.0;
+   result->eValue      = -1.0;
+
+   /* A p-value for one subgroup at one offset. Every subgroup could
+      have matched by chance at any of the offsets tried
+   */
+   if(model->nullTable != NULL)
+   {
+      result->pValue = (result->best >= 0) ?
+         NullPValue(model, result->best, result->score) : 1.0;
+      result->eValue = result->pValue * model->nSubGroups *
+                       (MAXTRUNCATION + nExtension);
+   }
+
+   /* Set the chain type and sub group                                  */
+   if(result->best >= 0)
+   {
+      if(model->fullMatrix)
+      {
+         result->chainType = model->fmSubGroupInfo[result->best].chainType;
+         result->subGroup  = model->fmSubGroupInfo[result->best].index;
+      }
+      else
+      {
+         result->chainType = model->subGroupInfo[result->best].chainType;
+         result->subGroup  = model->subGroupInfo[result->best].subGroup;
+      }
+   }
+}
+
+
+/************************************************************************/
+/*>static void ScoreSubgroup(SUBGROUPMODEL *model, int sgNum,
+                             char *sequence, unsigned char *code,
+                             int nStarts, int nExtension,
+                             SUBGROUPRESULT *result)
+   ------------------------------------------------------------
+*//**
+   \param[in]   model        - the model
+   \param[in]   sgNum        - the subgroup
+   \param[in]   sequence     - the sequence of interest
+   \param[in]   code         - the sequence from EncodeProfileChain()
+   \param[in]   nStarts      - window starts to score
+   \param[in]   nExtension   - extension offsets to try
+   \param[in,out] result     - ranking so far. length must be set
+
+   Finds the best offset for a subgroup and ranks the subgroup if it
+   matched anything
+
+-  18.10.26 Split out from ScoreModel()   By: ACRM
+*/
+static void ScoreSubgroup(SUBGROUPMODEL *model, int sgNum,
+                          char *sequence, unsigned char *code,
+                          int nStarts, int nExtension,
+                          SUBGROUPRESULT *result)
+{
+   REAL val,
+        subGroupMax,
+        score[PROFSTARTS],
+        scoreMax[PROFSTARTS];
+   int  offset,
+        subGroupOffset;
+
+   ScoreProfileStarts(model, sgNum, code, nStarts, score, scoreMax);
+   subGroupMax = BestStart(score, scoreMax, nExtension, &subGroupOffset);
+
+   /* An insertion or deletion may give a better gapped alignment       */
+   if(model->gapped && !model->doProduct &&
+      ((val = CalcGappedScore(model, sgNum, sequence, result->length,
+                              &offset)) > subGroupMax))
+   {
+      subGroupMax    = val;
+      subGroupOffset = offset;
+   }
+
+   /* Only subgroups that matched something are ranked                  */
+   if(subGroupMax > 0.0)
+      InsertTopK(result, sTopK, sgNum, subGroupMax, subGroupOffset);
+}
+
+
+/************************************************************************/
+/*>static void ScoreSplit(SUBGROUPMODEL *model, char *sequence,
+                          unsigned char *code, int nStarts,
+                          int nExtension, SUBGROUPRESULT *result)
+   ---------------------------------------------------------------
+*//**
+   \param[in]   model        - the model
+   \param[in]   sequence     - the sequence of interest
+   \param[in]   code         - the sequence from EncodeProfileChain()
+   \param[in]   nStarts      - window starts to score
+   \param[in]   nExtension   - extension offsets to try
+   \param[in,out] result     - length must be set. The ranking (empty
+                               on entry) is filled in
+
+   Scores every subgroup on the split pool. Each part ranks its own
+   share of the subgroups and the parts' rankings are merged. As the
+   ranking is ordered on score and then ID, the best K of the merged
+   rankings are the best K that scoring in one thread would keep.
+
+-  18.10.26 Original   By: ACRM
+*/
+static void ScoreSplit(SUBGROUPMODEL *model, char *sequence,
+                       unsigned char *code, int nStarts, int nExtension,
+                       SUBGROUPRESULT *result)
+{
+   SPLITJOB       job;
+   SUBGROUPRESULT *partResult;
+   int            part, i,
+                  nParts = SplitPoolParts(sSplitPool);
+
+   job.model      = model;
+   job.sequence   = sequence;
+   job.code       = code;
+   job.results    = sSplitResults;
+   job.length     = result->length;
+   job.nStarts    = nStarts;
+   job.nExtension = nExtension;
+   RunSplitPool(sSplitPool, ScorePart, &job);
+
+   for(part=0; part<nParts; part++)
+   {
+      partResult = &(sSplitResults[part]);
+      for(i=0; i<partResult->nTop; i++)
+      {
+         InsertTopK(result, sTopK, partResult->topId[i],
+                    partResult->topScore[i], partResult->topOffset[i]);
+      }
+   }
+}
+
+
+/************************************************************************/
+/*>static void ScorePart(void *arg, int part, int nParts)
+   ------------------------------------------------------
+*//**
+   \param[in]   arg          - the SPLITJOB
+   \param[in]   part         - this part
+   \param[in]   nParts       - number of parts
+
+   Ranks the part's share of the subgroups of a SPLITJOB. Each part
+   has a run of subgroups so that they are next to each other in the
+   model's table.
+
+-  18.10.26 Original   By: ACRM
+*/
+static void ScorePart(void *arg, int part, int nParts)
+{
+   SPLITJOB       *job    = (SPLITJOB *)arg;
+   SUBGROUPRESULT *result = &(job->results[part]);
+   int            sgNum,
+                  first   = (int)(((long)job->model->nSubGroups * part) /
+                                  nParts),
+                  last    = (int)(((long)job->model->nSubGroups *
+                                   (part+1)) / nParts);
+
+   result->nTop   = 0;
+   result->length = job->length;
+   for(sgNum=first; sgNum<last; sgNum++)
+   {
+      ScoreSubgroup(job->model, sgNum, job->sequence, job->code,
+                    job->nStarts, job->nExtension, result);
+   }
+}
+
+
+/************************************************************************/
+/*>static REAL BestStart(REAL *score, REAL *scoreMax, int nExtension,
+                         int *offset)
+   ------------------------------------------------------------------
+*//**
+   \param[in]   score        - score for each window start
+   \param[in]   scoreMax     - maximum score for each window start
+   \param[in]   nExtension   - extension offsets to try
+   \param[out]  offset       - offset giving the best score (0 if
+                               nothing scores)
+   \return                   - best normalized score (0.0 if nothing
+                               scores more)
+
+-  18.10.26 Split out from ScoreModel()   By: ACRM
+*/
+static REAL BestStart(REAL *score, REAL *scoreMax, int nExtension,
+                      int *offset)
+{
+   REAL val,
+        best = 0.0;
+   int  off,
+        start;
+
+   *offset = 0;
+
+   /* Shift along the reference sequence to account for N-terminal
+      truncation of the test sequence
+   */
+   for(off = 0; off < MAXTRUNCATION; off++)
+   {
+      start = PROFPADDING - off;
+      if((scoreMax[start] > 0.0) &&
+         ((val = (score[start] * 100.0) / scoreMax[start]) > best))
+      {
+         best    = val;
+         *offset = off;
+      }
+   }
+
+   /* Shift along the test sequence to account for N-terminal 
+      extension of the test sequence
+   */
+   for(off = 0; off < nExtension; off++)
+   {
+      start = PROFPADDING + off;
+      if((scoreMax[start] > 0.0) &&
+         ((val = (score[start] * 100.0) / scoreMax[start]) > best))
+      {
+         best    = val;
+         *offset = -off;
+      }
+   }
+   return(best);
+}
+
+
+/************************************************************************/
+/*>static int SearchIndex(SUBGROUPMODEL *model, unsigned char *code,
+                          int nStarts, int nExtension,
+                          SUBGROUPRESULT *result)
+   -----------------------------------------------------------------
+*//**
+   \param[in]   model        - the model with an index
+   \param[in]   code         - the sequence from EncodeProfileChain()
+   \param[in]   nStarts      - window starts to score
+   \param[in]   nExtension   - extension offsets to try
+   \param[in,out] result     - the ranking, which must be empty
+   \return                   - number of window sums made for the
+                               subgroups and the nodes of the tree (-1
+                               if no memory, when nothing is done)
+
+   Ranks the subgroups of an indexed model. The tree is searched best
+   bound first: the node with the highest bound is taken from a heap
+   and either its subgroups are scored or its children's bounds are
+   found (see NodeBounds()) and those that could be ranked are added.
+   Once the ranking is full, the search stops when the best bound left
+   is below the lowest score ranked. A subgroup whose bound equals
+   that score could still tie and, being earlier in the data, be
+   ranked ahead, so such nodes are searched too. The subgroups of a
+   leaf are scored with ScoreMember(). The ranking is the same as
+   scoring every subgroup at every start.
+
+   With the split pool, nodes are taken from the heap in batches and
+   searched on the pool by SearchBatchSplit(). A batch is searched with
+   the lowest score ranked before it, so it may make a few more sums
+   than searching one node at a time, but the ranking is the same.
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Searches the tree
+-  18.10.26 Counts the sums for the node bounds as well as the
+            subgroups. Starts are only ordered for leaves
+-  18.10.26 Uses the split pool
+*/
+static int SearchIndex(SUBGROUPMODEL *model, unsigned char *code,
+                       int nStarts, int nExtension,
+                       SUBGROUPRESULT *result)
+{
+   NODEBOUND *heap,
+             *batch  = NULL,
+             top;
+   SPLITUNIT *units  = NULL;
+   REAL      *startBounds,
+             *next,
+             bound;
+   int       order[PROFSTARTS],
+             *orders = NULL,
+             nHeap      = 0,
+             nEvaluated = 0,
+             nBatch     = 0,
+             nUnits     = 0,
+             nSummed,
+             root       = model->nNodes - 1,
+             i;
+   BOOL      split      = ((sSplitPool != NULL) &&
+                           (model->nSubGroups >= SPLITMINSUBGROUPS));
+
+   /* A node is only added to the heap once so each can have a row of
+      bounds at each start. A batch never has more units than the
+      nodes have items and leaves
+   */
+   heap        = (NODEBOUND *)malloc(model->nNodes * sizeof(NODEBOUND));
+   startBounds = (REAL *)malloc(model->nNodes * nStarts * sizeof(REAL));
+   if(split)
+   {
+      batch  = (NODEBOUND *)malloc(model->nNodes * sizeof(NODEBOUND));
+      orders = (int *)malloc(model->nNodes * nStarts * sizeof(int));
+      units  = (SPLITUNIT *)malloc((model->nodeStart[model->nNodes] +
+                                    model->nLeaves) * sizeof(SPLITUNIT));
+   }
+   if((heap == NULL) || (startBounds == NULL) ||
+      (split && ((batch == NULL) || (orders == NULL) ||
+                 (units == NULL))))
+   {
+      if(heap != NULL)        free(heap);
+      if(startBounds != NULL) free(startBounds);
+      if(batch != NULL)       free(batch);
+      if(orders != NULL)      free(orders);
+      if(units != NULL)       free(units);
+      return(-1);
+   }
+
+   next = startBounds;
+   PushNode(heap, &nHeap,
+            NodeBounds(model, root, code, nStarts, NULL, 0.0, next,
+                       &nSummed),
+            next, root);
+   nEvaluated += nSummed;
+   next       += nStarts;
+
+   while((nHeap > 0) || (nBatch > 0))
+   {
+      /* Nothing left can be ranked once the batch is done. The node
+         taken can be dropped as the lowest score ranked can only rise
+      */
+      if((nHeap == 0) ||
+         ((top = PopNode(heap, &nHeap)).bound <= 0.0) ||
+         ((result->nTop == sTopK) &&
+          (top.bound < result->topScore[sTopK-1])))
+      {
+         if(nBatch == 0)
+            break;
+         nEvaluated += SearchBatchSplit(model, code, nStarts, nExtension,
+                                        batch, orders, nBatch, units,
+                                        &next, heap, &nHeap, result);
+         nBatch = nUnits = 0;
+         continue;
+      }
+
+      /* A search that has made as many sums as scoring enough
+         subgroups to be worth sharing at every start goes on on the
+         split pool, in batches of nodes with that many units
+      */
+      if(split && (nEvaluated >= (SPLITMINSUBGROUPS * nStarts)))
+      {
+         batch[nBatch++] = top;
+         nUnits         += model->nodeStart[top.node+1] -
+                           model->nodeStart[top.node];
+         if(nUnits >= SPLITMINSUBGROUPS)
+         {
+            nEvaluated += SearchBatchSplit(model, code, nStarts,
+                                           nExtension, batch, orders,
+                                           nBatch, units, &next, heap,
+                                           &nHeap, result);
+            nBatch = nUnits = 0;
+         }
+         continue;
+      }
+
+      if(top.node >= model->nLeaves)
+      {
+         for(i=model->nodeStart[top.node];
+             i<model->nodeStart[top.node+1];
+             i++)
+         {
+            bound = NodeBounds(model, model->nodeItem[i], code, nStarts,
+                               top.startBound,
+                               ((result->nTop == sTopK) ?
+                                result->topScore[sTopK-1] : 0.0),
+                               next, &nSummed);
+            nEvaluated += nSummed;
+            if((bound > 0.0) &&
+               ((result->nTop < sTopK) ||
+                (bound >= result->topScore[sTopK-1])))
+            {
+               PushNode(heap, &nHeap, bound, next, model->nodeItem[i]);
+               next += nStarts;
+            }
+         }
+         continue;
+      }
+
+      /* A leaf's bounds are made exact at the starts that could be
+         ranked before its subgroups are scored
+      */
+      NodeBounds(model, top.node, code, nStarts, top.startBound,
+                 ((result->nTop == sTopK) ?
+                  result->topScore[sTopK-1] : 0.0),
+                 top.startBound, &nSummed);
+      nEvaluated += nSummed;
+      OrderStarts(top.startBound, nStarts, order);
+      for(i=model->nodeStart[top.node];
+          i<model->nodeStart[top.node+1];
+          i++)
+      {
+         nEvaluated += ScoreMember(model, model->nodeItem[i], code,
+                                   nStarts, nExtension, top.startBound,
+                                   order, result);
+      }
+   }
+
+   free(heap);
+   free(startBounds);
+   if(batch != NULL)  free(batch);
+   if(orders != NULL) free(orders);
+   if(units != NULL)  free(units);
+   return(nEvaluated);
+}
+
+
+/************************************************************************/
+/*>static int SearchBatchSplit(SUBGROUPMODEL *model, unsigned char *code,
+                               int nStarts, int nExtension,
+                               NODEBOUND *batch, int *orders,
+                               int nBatch, SPLITUNIT *units,
+                               REAL **next, NODEBOUND *heap, int *nHeap,
+                               SUBGROUPRESULT *result)
+   ---------------------------------------------------------------------
+*//**
+   \param[in]   model        - the model with an index
+   \param[in]   code         - the sequence from EncodeProfileChain()
+   \param[in]   nStarts      - window starts to score
+   \param[in]   nExtension   - extension offsets to try
+   \param[in]   batch        - nodes taken from the heap
+   \param[out]  orders       - space for the starts of each leaf of the
+                               batch in descending order of bound
+                               (nStarts for each node of the batch)
+   \param[in]   nBatch       - number of nodes in the batch
+   \param[out]  units        - space for the units of the batch
+   \param[in,out] next       - the next free row of start bounds
+   \param[in,out] heap       - the heap of nodes
+   \param[in,out] nHeap      - number of nodes on the heap
+   \param[in,out] result     - ranking so far
+   \return                   - number of window sums made
+
+   Does the work of SearchIndex() for a batch of nodes on the split
+   pool. The bounds of the children of internal nodes and the exact
+   bounds of leaves are found first, the children being given their
+   rows of bounds so that the parts can fill them in. Then the
+   subgroups of the leaves are scored. Each part starts from a copy
+   of the ranking so far, so it skips the same sums as the search in
+   one thread would or fewer. The subgroups each part ranks are
+   merged into the ranking as ScoreSplit() does, and then the children
+   that could still be ranked are added to the heap.
+
+-  18.10.26 Original   By: ACRM
+*/
+static int SearchBatchSplit(SUBGROUPMODEL *model, unsigned char *code,
+                            int nStarts, int nExtension,
+                            NODEBOUND *batch, int *orders, int nBatch,
+                            SPLITUNIT *units, REAL **next,
+                            NODEBOUND *heap, int *nHeap,
+                            SUBGROUPRESULT *result)
+{
+   SPLITJOB       job;
+   SUBGROUPRESULT ranking,
+                  *partResult;
+   int            b, i, j, part,
+                  nBounds    = 0,
+                  nUnits     = 0,
+                  nEvaluated = 0,
+                  nParts     = SplitPoolParts(sSplitPool);
+
+   for(b=0; b<nBatch; b++)
+   {
+      units[nUnits].batch = b;
+      if(batch[b].node < model->nLeaves)
+      {
+         units[nUnits].item       = -1;
+         units[nUnits].startBound = batch[b].startBound;
+         nUnits++;
+         continue;
+      }
+      for(i=model->nodeStart[batch[b].node];
+          i<model->nodeStart[batch[b].node+1];
+          i++)
+      {
+         units[nUnits].batch      = b;
+         units[nUnits].item       = i;
+         units[nUnits].startBound = *next;
+         *next += nStarts;
+         nUnits++;
+      }
+   }
+   nBounds = nUnits;
+
+   ranking        = *result;
+   job.model      = model;
+   job.sequence   = NULL;
+   job.code       = code;
+   job.results    = sSplitResults;
+   job.ranking    = &ranking;
+   job.batch      = batch;
+   job.units      = units;
+   job.orders     = orders;
+   job.length     = result->length;
+   job.nStarts    = nStarts;
+   job.nExtension = nExtension;
+   job.nUnits     = nBounds;
+   RunSplitPool(sSplitPool, SearchBatchPart, &job);
+   for(part=0; part<nParts; part++)
+      nEvaluated += sSplitResults[part].nEvaluated;
+
+   /* The subgroups of the leaves follow the bounds                     */
+   for(b=0; b<nBatch; b++)
+   {
+      if(batch[b].node < model->nLeaves)
+      {
+         for(i=model->nodeStart[batch[b].node];
+             i<model->nodeStart[batch[b].node+1];
+             i++)
+         {
+            units[nUnits].batch      = b;
+            units[nUnits].item       = i;
+            units[nUnits].startBound = NULL;
+            nUnits++;
+         }
+      }
+   }
+
+   if(nUnits > nBounds)
+   {
+      job.units  = units + nBounds;
+      job.nUnits = nUnits - nBounds;
+      RunSplitPool(sSplitPool, SearchBatchPart, &job);
+
+      /* Only the subgroups of the batch are new to the ranking         */
+      for(part=0; part<nParts; part++)
+      {
+         partResult  = &(sSplitResults[part]);
+         nEvaluated += partResult->nEvaluated;
+         for(i=0; i<partResult->nTop; i++)
+         {
+            for(j=0; j<ranking.nTop; j++)
+            {
+               if(ranking.topId[j] == partResult->topId[i])
+                  break;
+            }
+            if(j == ranking.nTop)
+            {
+               InsertTopK(result, sTopK, partResult->topId[i],
+                          partResult->topScore[i],
+                          partResult->topOffset[i]);
+            }
+         }
+      }
+   }
+
+   for(i=0; i<nBounds; i++)
+   {
+      if((units[i].item >= 0) && (units[i].bound > 0.0) &&
+         ((result->nTop < sTopK) ||
+          (units[i].bound >= result->topScore[sTopK-1])))
+      {
+         PushNode(heap, nHeap, units[i].bound, units[i].startBound,
+                  model->nodeItem[units[i].item]);
+      }
+   }
+   return(nEvaluated);
+}
+
+
+/************************************************************************/
+/*>static void SearchBatchPart(void *arg, int part, int nParts)
+   ------------------------------------------------------------
+*//**
+   \param[in]   arg          - the SPLITJOB
+   \param[in]   part         - this part
+   \param[in]   nParts       - number of parts
+
+   Does the part's share of the units of a batch of nodes, taking a
+   run of them in the order of the batch. The number of window sums
+   made is left in the part's nEvaluated.
+
+-  18.10.26 Original   By: ACRM
+*/
+static void SearchBatchPart(void *arg, int part, int nParts)
+{
+   SPLITJOB       *job    = (SPLITJOB *)arg;
+   SUBGROUPMODEL  *model  = job->model;
+   SUBGROUPRESULT *result = &(job->results[part]);
+   SPLITUNIT      *unit;
+   NODEBOUND      *node;
+   int            u, nSummed,
+                  first   = (int)(((long)job->nUnits * part) / nParts),
+                  last    = (int)(((long)job->nUnits * (part+1)) /
+                                  nParts);
+
+   *result            = *(job->ranking);
+   result->nEvaluated = 0;
+   for(u=first; u<last; u++)
+   {
+      unit = &(job->units[u]);
+      node = &(job->batch[unit->batch]);
+      if(unit->startBound == NULL)
+      {
+         result->nEvaluated +=
+            ScoreMember(model, model->nodeItem[unit->item], job->code,
+                        job->nStarts, job->nExtension, node->startBound,
+                        job->orders + (unit->batch * job->nStarts),
+                        result);
+         continue;
+      }
+
+      unit->bound = NodeBounds(model,
+                               ((unit->item < 0) ? node->node :
+                                model->nodeItem[unit->item]),
+                               job->code, job->nStarts,
+                               node->startBound,
+                               ((result->nTop == sTopK) ?
+                                result->topScore[sTopK-1] : 0.0),
+                               unit->startBound, &nSummed);
+      result->nEvaluated += nSummed;
+      if(unit->item < 0)
+      {
+         OrderStarts(node->startBound, job->nStarts,
+                     job->orders + (unit->batch * job->nStarts));
+      }
+   }
+}
+
+
+/************************************************************************/
+/*>static void OrderStarts(REAL *startBound, int nStarts, int *order)
+   ------------------------------------------------------------------
+*//**
+   \param[in]   startBound   - a leaf's bound at each start
+   \param[in]   nStarts      - window starts to score
+   \param[out]  order        - the starts in descending order of bound,
+                               the earlier start first on a tie
+
+-  18.10.26 Split out from SearchIndex()   By: ACRM
+*/
+static void OrderStarts(REAL *startBound, int nStarts, int *order)
+{
+   int i, start;
+
+   for(start=0; start<nStarts; start++)
+   {
+      for(i=start;
+          (i > 0) && (startBound[order[i-1]] < startBound[start]);
+          i--)
+         order[i] = order[i-1];
+      order[i] = start;
+   }
+}
+
+
+/************************************************************************/
+/*>static int ScoreMember(SUBGROUPMODEL *model, int sgNum,
+                          unsigned char *code, int nStarts,
+                          int nExtension, REAL *startBound, int *order,
+                          SUBGROUPRESULT *result)
+   --------------------------------------------------------------------
+*//**
+   \param[in]   model        - the model with an index
+   \param[in]   sgNum        - a subgroup of a leaf
+   \param[in]   code         - the sequence from EncodeProfileChain()
+   \param[in]   nStarts      - window starts to score
+   \param[in]   nExtension   - extension offsets to try
+   \param[in]   startBound   - the leaf's bound at each start
+   \param[in]   order        - the starts in descending order of bound
+   \param[in,out] result     - ranking so far
+   \return                   - number of starts scored
+
+   Does the same as ScoreSubgroup() without a gapped alignment but
+   only scores the starts that could matter. They are scored in
+   descending order of the leaf's bound, stopping at a start whose
+   bound is below the subgroup's best score so far or below the lowest
+   score in a full ranking. Those starts can't be the subgroup's best
+   offset (or tie with it) or else the subgroup couldn't be ranked.
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Returns the number of starts scored
+*/
+static int ScoreMember(SUBGROUPMODEL *model, int sgNum,
+                       unsigned char *code, int nStarts, int nExtension,
+                       REAL *startBound, int *order,
+                       SUBGROUPRESULT *result)
+{
+   REAL val,
+        best = 0.0,
+        score[PROFSTARTS],
+        scoreMax[PROFSTARTS];
+   int  i, start,
+        offset;
+
+   for(start=0; start<nStarts; start++)
+      score[start] = scoreMax[start] = 0.0;
+
+   for(i=0; i<nStarts; i++)
+   {
+      start = order[i];
+      if((startBound[start] <= 0.0) || (startBound[start] < best) ||
+         ((result->nTop == sTopK) &&
+          (startBound[start] < result->topScore[sTopK-1])))
+         break;
+
+      ScoreProfileStart(model, sgNum, code, start, &(score[start]),
+                        &(scoreMax[start]));
+      if((scoreMax[start] > 0.0) &&
+         ((val = (score[start] * 100.0) / scoreMax[start]) > best))
+         best = val;
+   }
+
+   /* The best offset is chosen from the starts in the usual order      */
+   if((best = BestStart(score, scoreMax, nExtension, &offset)) > 0.0)
+      InsertTopK(result, sTopK, sgNum, best, offset);
+
+   return(i);
+}
+
+
+/************************************************************************/
+/*>static REAL NodeBounds(SUBGROUPMODEL *model, int node,
+                          unsigned char *code, int nStarts,
+                          REAL *parentBound, REAL minBound,
+                          REAL *startBound, int *nSummed)
+   ----------------------------------------------------------------
+*//**
+   \param[in]   model        - the model with an index
+   \param[in]   node         - the node
+   \param[in]   code         - the sequence from EncodeProfileChain()
+   \param[in]   nStarts      - window starts to score
+   \param[in]   parentBound  - the parent's bound at each start (NULL
+                               for the root)
+   \param[in]   minBound     - the lowest bound that could be ranked
+   \param[out]  startBound   - bound on the normalized score of any
+                               subgroup below the node at each start
+                               (0.0 if none can be ranked). May be
+                               parentBound
+   \param[out]  nSummed      - number of starts summed
+   \return                   - the highest of the bounds
+
+   The node's table gives the highest score and smallest shortfall
+   from the maximum that any subgroup below it could have (see
+   profindex.c).
+
+   A child's bound at a start is never above its parent's, so only the
+   starts where the parent's bound reaches minBound need to be summed.
+   The run of starts from the first to the last of those is summed at
+   once with ScoreTableStarts(), which is cheaper than summing them one
+   at a time even when some in between are not needed. Every start of
+   the root is summed.
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 For any node of the tree, using the parent's bound to
+            skip starts
+-  18.10.26 Sums the run of starts that could be ranked in one call
+            to ScoreTableStarts()
+*/
+static REAL NodeBounds(SUBGROUPMODEL *model, int node,
+                       unsigned char *code, int nStarts,
+                       REAL *parentBound, REAL minBound,
+                       REAL *startBound, int *nSummed)
+{
+   REAL score[PROFSTARTS],
+        shortfall[PROFSTARTS],
+        best  = 0.0;
+   BOOL live[PROFSTARTS];
+   int  first = -1,
+        last  = -1,
+        start;
+
+   for(start=0; start<nStarts; start++)
+   {
+      live[start] = ((parentBound == NULL) ||
+                     ((parentBound[start] > 0.0) &&
+                      (parentBound[start] >= minBound)));
+      if(live[start])
+      {
+         if(first < 0)
+            first = start;
+         last = start;
+      }
+   }
+
+   *nSummed = 0;
+   if(first >= 0)
+   {
+      *nSummed = last - first + 1;
+      ScoreTableStarts(PROFNODE(model, node, 0), model->refLength,
+                       code + first, *nSummed, score + first,
+                       shortfall + first);
+   }
+
+   for(start=0; start<nStarts; start++)
+   {
+      if(live[start] && (score[start] > 0.0))
+         startBound[start] = ((score[start] * 100.0) /
+                              (score[start] + shortfall[start])) *
+                             (1.0 + INDEXSLACK);
+      else
+         startBound[start] = 0.0;
+
+      if(startBound[start] > best)
+         best = startBound[start];
+   }
+   return(best);
+}
+
+
+/************************************************************************/
+/*>static void PushNode(NODEBOUND *heap, int *nHeap, REAL bound,
+                        REAL *startBound, int node)
+   -------------------------------------------------------------
+*//**
+   \param[in,out] heap       - heap of nodes to search, best first
+   \param[in,out] nHeap      - number of nodes on the heap
+   \param[in]     bound      - the node's bound
+   \param[in]     startBound - the node's bound at each start (kept)
+   \param[in]     node       - the node
+
+-  18.10.26 Original   By: ACRM
+*/
+static void PushNode(NODEBOUND *heap, int *nHeap, REAL bound,
+                     REAL *startBound, int node)
+{
+   NODEBOUND item;
+   int       pos = (*nHeap)++;
+
+   item.bound      = bound;
+   item.startBound = startBound;
+   item.node       = node;
+   for(; (pos > 0) && NODEAHEAD(item, heap[(pos-1)/2]); pos = (pos-1)/2)
+      heap[pos] = heap[(pos-1)/2];
+   heap[pos] = item;
+}
+
+
+/************************************************************************/
+/*>static NODEBOUND PopNode(NODEBOUND *heap, int *nHeap)
+   -----------------------------------------------------
+*//**
+   \param[in,out] heap       - heap of nodes to search, best first
+   \param[in,out] nHeap      - number of nodes on the heap (at least 1)
+   \return                   - the best node, removed from the heap
+
+-  18.10.26 Original   By: ACRM
+*/
+static NODEBOUND PopNode(NODEBOUND *heap, int *nHeap)
+{
+   NODEBOUND top  = heap[0],
+             last = heap[--(*nHeap)];
+   int       pos  = 0,
+             child;
+
+   while((child = (2 * pos) + 1) < *nHeap)
+   {
+      if((child+1 < *nHeap) && NODEAHEAD(heap[child+1], heap[child]))
+         child++;
+      if(!NODEAHEAD(heap[child], last))
+         break;
+      heap[pos] = heap[child];
+      pos       = child;
+   }
+   heap[pos] = last;
+   return(top);
+}
+
+
+/************************************************************************/
+/*>static void InsertTopK(SUBGROUPRESULT *result, int topK, int id,
+                          REAL score, int offset)
+   ----------------------------------------------------------------
+*//**
+   \param[in,out] result    Result containing the ranking so far
+   \param[in]     topK      Max number of entries to keep
+   \param[in]     id        Subgroup ID
+   \param[in]     score     Best score for this subgroup
+   \param[in]     offset    Offset giving the best score
+
+   Inserts a subgroup into the ranking which is kept sorted with the
+   best first. With K at most MAXTOPK a simple insertion is cheaper
+   than a heap. On a tie the earliest subgroup in the data wins, as it
+   always has, even when the index scores them out of order.
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Ties are broken on the ID
+*/
+static void InsertTopK(SUBGROUPRESULT *result, int topK, int id,
+                       REAL score, int offset)
+{
+   int pos = result->nTop;
+
+   if(pos < topK)
+   {
+      result->nTop++;
+   }
+   else
+   {
+      if(!RANKSAHEAD(score, id, result->topScore[topK-1],
+                         result->topId[topK-1]))
+         return;
+      pos = topK-1;
+   }
+
+   while((pos > 0) &&
+         RANKSAHEAD(score, id, result->topScore[pos-1],
+                        result->topId[pos-1]))
+   {
+      result->topId[pos]     = result->topId[pos-1];
+      result->topScore[pos]  = result->topScore[pos-1];
+      result->topOffset[pos] = result->topOffset[pos-1];
+      pos--;
+   }
+
+   result->topId[pos]     = id;
+   result->topScore[pos]  = score;
+   result->topOffset[pos] = offset;
+}
+
+
+/************************************************************************/
+/*>BOOL FindHumanSubgroup(FILE *fp, BOOL fullMatrix, char *sequence, 
+                          int *chainType, int *subGroup)
+   ----------------------------------------------------------------
+*//**
+   \param[in]   fp           - file of residue subgroup specifications
+                               (NULL - use default hardcoded values)
+   \param[in]   fullMatrix   - datafile is a full scoring matrix
+   \param[in]   sequence     - the sequence of interest
+   \param[out]  chainType    - chain type: CHAINTYPE_HEAVY
+                                           CHAINTYPE_KAPPA
+                                           CHAINTYPE_LAMBDA
+   \param[out]  subGroup     - subgroup
+   \return                   - Success in reading data file
+
+   Assigns the subgroup information for a sequence and prints the
+   winning name to stdout
+
+-  16.06.97 Original from Sophie's code
+-  01.08.18 Complete rewrite
+-  27.11.18 Now returns BOOL and can read file of residue frequencies
+            Also deals with verbose printing
+-  05.02.19 Added fullMatrix handling
+-  18.10.26 Scoring moved to FindHumanSubgroupResult()
+*/
+BOOL FindHumanSubgroup(FILE *fp, BOOL fullMatrix, char *sequence,
+                       int *chainType, int *subGroup)
+{
+   SUBGROUPRESULT result;
+   
+   if(!FindHumanSubgroupResult(fp, fullMatrix, sequence, &result))
+      return(FALSE);
+
+   /* Print the winning name                                            */
+   printf("%s", GetSubgroupName(result.best));
+
+   if(sVerbose)
+   {
+      printf(",%f,", result.score);
+      printf("%s,",  GetSubgroupName(result.second));
+      printf("%f",   result.secondScore);
+   }
+   printf("\n");
+
    /* Set the chain type and sub group                                  */
-   *chainType = subGroupInfo[bestSubGroupCount].chainType;
-   *subGroup  = subGroupInfo[bestSubGroupCount].subGroup;
+   *chainType = result.chainType;
+   *subGroup  = result.subGroup;
 
    return(TRUE);
 }
@@ -854,7 +2816,7 @@ static void takeLogs(SUBGROUPINFO *subGroupInfo, int nSubGroups)
    int sgNum, i;
    for(sgNum=0; sgNum<nSubGroups; sgNum++)
    {
-      for(i=0; i<MAXREFSEQLEN; i++)
+      for(i=0; i<subGroupInfo[sgNum].length; i++)
       {
          subGroupInfo[sgNum].topScores[i] = 
             log(subGroupInfo[sgNum].topScores[i] + 1);
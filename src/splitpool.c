@@ -0,0 +1,279 @@
+/*************************************************************************
+
+   Program:    hsubgroup
+   File:       splitpool.c
+
+   Version:    V3.22
+   Date:       18.10.26
+   Function:   Share the scoring of one chain between threads
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   The threads are started once by StartSplitPool() and wait on a
+   condition variable between jobs, so splitting the scoring of a
+   single chain costs a wake-up rather than a thread start. The thread
+   that calls RunSplitPool() does the first part itself and then waits
+   for the others. Each part has a fixed number so the work done by a
+   part, and anything that depends on how it was split, is the same
+   from run to run.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V3.22 18.10.26   Original
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include "bioplib/SysDefs.h"
+#include "splitpool.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+/* A waiting thread and the part of each job it does                    */
+typedef struct
+{
+   SPLITPOOL     *pool;
+   pthread_t     thread;
+   unsigned long generation;   /* Last job started                      */
+   int           part;
+}  SPLITWORKER;
+
+/* State shared between the threads                                     */
+struct splitpool
+{
+   SPLITWORKER     *workers;
+   SPLITFUNC       func;
+   void            *job;
+   pthread_mutex_t lock;       /* Protects everything below             */
+   pthread_cond_t  start,      /* A job was started or the pool stopped */
+                   done;       /* The last worker finished its part     */
+   unsigned long   generation; /* Count of jobs started                 */
+   int             nWorkers,
+                   nRunning;
+   BOOL            stopping;
+};
+
+/************************************************************************/
+/* Prototypes
+*/
+static void *SplitWorker(void *arg);
+
+
+/************************************************************************/
+/*>SPLITPOOL *StartSplitPool(int nParts)
+   -------------------------------------
+*//**
+   \param[in]   nParts   Number of parts to split each job into (2 to
+                         MAXSPLIT)
+   \return               The pool (NULL on failure)
+
+   Starts nParts-1 threads to wait for jobs. If fewer can be started
+   the pool splits jobs into fewer parts.
+
+-  18.10.26 Original   By: ACRM
+*/
+SPLITPOOL *StartSplitPool(int nParts)
+{
+   SPLITPOOL *pool;
+   int       i;
+
+   if((nParts < 2) || (nParts > MAXSPLIT))
+      return(NULL);
+   if((pool = (SPLITPOOL *)malloc(sizeof(SPLITPOOL)))==NULL)
+      return(NULL);
+   if((pool->workers = (SPLITWORKER *)malloc((nParts-1) *
+                                             sizeof(SPLITWORKER)))==NULL)
+   {
+      free(pool);
+      return(NULL);
+   }
+
+   pool->func       = NULL;
+   pool->job        = NULL;
+   pool->generation = 0;
+   pool->nWorkers   = 0;
+   pool->nRunning   = 0;
+   pool->stopping   = FALSE;
+   pthread_mutex_init(&(pool->lock), NULL);
+   pthread_cond_init(&(pool->start), NULL);
+   pthread_cond_init(&(pool->done), NULL);
+
+   for(i=0; i<nParts-1; i++)
+   {
+      SPLITWORKER *worker = &(pool->workers[pool->nWorkers]);
+
+      worker->pool       = pool;
+      worker->generation = 0;
+      worker->part       = pool->nWorkers + 1;
+      if(pthread_create(&(worker->thread), NULL, SplitWorker, worker))
+         break;
+      pool->nWorkers++;
+   }
+
+   if(pool->nWorkers == 0)
+   {
+      StopSplitPool(pool);
+      return(NULL);
+   }
+   return(pool);
+}
+
+
+/************************************************************************/
+/*>int SplitPoolParts(SPLITPOOL *pool)
+   -----------------------------------
+*//**
+   \param[in]   pool     The pool
+   \return               Number of parts each job is split into
+
+-  18.10.26 Original   By: ACRM
+*/
+int SplitPoolParts(SPLITPOOL *pool)
+{
+   return(pool->nWorkers + 1);
+}
+
+
+/************************************************************************/
+/*>void RunSplitPool(SPLITPOOL *pool, SPLITFUNC func, void *job)
+   --------------------------------------------------------------
+*//**
+   \param[in]   pool     The pool
+   \param[in]   func     Does one part of the job
+   \param[in]   job      Passed to func
+
+   Calls func(job, part, nParts) for each part from 0 to nParts-1 at
+   the same time and returns when they have all finished. Part 0 runs
+   in the calling thread. Only one thread may run jobs on a pool.
+
+-  18.10.26 Original   By: ACRM
+*/
+void RunSplitPool(SPLITPOOL *pool, SPLITFUNC func, void *job)
+{
+   pthread_mutex_lock(&(pool->lock));
+   pool->func     = func;
+   pool->job      = job;
+   pool->nRunning = pool->nWorkers;
+   pool->generation++;
+   pthread_cond_broadcast(&(pool->start));
+   pthread_mutex_unlock(&(pool->lock));
+
+   (*func)(job, 0, pool->nWorkers + 1);
+
+   pthread_mutex_lock(&(pool->lock));
+   while(pool->nRunning > 0)
+      pthread_cond_wait(&(pool->done), &(pool->lock));
+   pthread_mutex_unlock(&(pool->lock));
+}
+
+
+/************************************************************************/
+/*>void StopSplitPool(SPLITPOOL *pool)
+   -----------------------------------
+*//**
+   \param[in]   pool     The pool (freed)
+
+   Stops the threads and frees the pool
+
+-  18.10.26 Original   By: ACRM
+*/
+void StopSplitPool(SPLITPOOL *pool)
+{
+   int i;
+
+   pthread_mutex_lock(&(pool->lock));
+   pool->stopping = TRUE;
+   pthread_cond_broadcast(&(pool->start));
+   pthread_mutex_unlock(&(pool->lock));
+
+   for(i=0; i<pool->nWorkers; i++)
+      pthread_join(pool->workers[i].thread, NULL);
+
+   pthread_cond_destroy(&(pool->done));
+   pthread_cond_destroy(&(pool->start));
+   pthread_mutex_destroy(&(pool->lock));
+   free(pool->workers);
+   free(pool);
+}
+
+
+/************************************************************************/
+/*>static void *SplitWorker(void *arg)
+   -----------------------------------
+*//**
+   \param[in]   arg     The SPLITWORKER
+   \return              NULL
+
+   Waits for each job to start, does its part and tells the caller
+   when the last part is finished
+
+-  18.10.26 Original   By: ACRM
+*/
+static void *SplitWorker(void *arg)
+{
+   SPLITWORKER *worker = (SPLITWORKER *)arg;
+   SPLITPOOL   *pool   = worker->pool;
+   SPLITFUNC   func;
+   void        *job;
+   int         nParts;
+
+   pthread_mutex_lock(&(pool->lock));
+   for(;;)
+   {
+      while((pool->generation == worker->generation) && !pool->stopping)
+         pthread_cond_wait(&(pool->start), &(pool->lock));
+      if(pool->stopping)
+         break;
+
+      worker->generation = pool->generation;
+      func   = pool->func;
+      job    = pool->job;
+      nParts = pool->nWorkers + 1;
+      pthread_mutex_unlock(&(pool->lock));
+
+      (*func)(job, worker->part, nParts);
+
+      pthread_mutex_lock(&(pool->lock));
+      if(--(pool->nRunning) == 0)
+         pthread_cond_signal(&(pool->done));
+   }
+   pthread_mutex_unlock(&(pool->lock));
+   return(NULL);
+}
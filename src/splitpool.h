@@ -0,0 +1,77 @@
+/*************************************************************************
+
+   Program:    hsubgroup
+   File:       splitpool.h
+
+   Version:    V3.22
+   Date:       18.10.26
+   Function:   Share the scoring of one chain between threads
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   A pool of threads started once and kept waiting so that a job can
+   be split into parts without the cost of starting threads for each
+   chain.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V3.22 18.10.26   Original
+
+*************************************************************************/
+#ifndef _SPLITPOOL_H
+#define _SPLITPOOL_H
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXSPLIT 256               /* Max parts a job is split into     */
+
+/* Does one part of a job                                               */
+typedef void (*SPLITFUNC)(void *job, int part, int nParts);
+
+/* A running pool of threads (defined in splitpool.c)                   */
+typedef struct splitpool SPLITPOOL;
+
+
+/************************************************************************/
+/* Prototypes
+*/
+SPLITPOOL *StartSplitPool(int nParts);
+int  SplitPoolParts(SPLITPOOL *pool);
+void RunSplitPool(SPLITPOOL *pool, SPLITFUNC func, void *job);
+void StopSplitPool(SPLITPOOL *pool);
+
+#endif
@@ -0,0 +1,472 @@
+/*************************************************************************
+
+   Program:    hsubgroup
+   File:       stats.c
+
+   Version:    V3.20
+   Date:       18.10.26
+   Function:   Run statistics and stage timing
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Collects the statistics reported by hsubgroup --stats: counts of
+   chains, residues and X residues, chains too short for all the
+   N-terminal extensions, offsets evaluated and pruned, the winning
+   subgroups, time spent in each stage, per-chain latency percentiles
+   and peak RSS.
+
+   Per-chain latencies are kept in a histogram with 2^STATS_SUBBITS
+   buckets per power of 2 nanoseconds so percentiles are accurate to
+   about 3% and two RUNSTATS can be merged by adding the counts.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V3.5  18.10.26   Original
+   V3.20 18.10.26   Winners are counted for any number of subgroups
+
+*************************************************************************/
+/* Includes
+*/
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include "bioplib/MathType.h"
+#include "bioplib/SysDefs.h"
+#include "subgroup.h"
+#include "stats.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define SUBBUCKETS (1 << STATS_SUBBITS)
+
+/************************************************************************/
+/* Prototypes
+*/
+static int  LatencyBucket(unsigned long ns);
+static REAL BucketValue(int bucket);
+static void WriteJSONName(FILE *fp, char *name);
+
+
+/************************************************************************/
+/*>int ParseStatsFormat(char *name)
+   --------------------------------
+*//**
+   \param[in]   name    Format name (text or json)
+   \return              STATS_TEXT or STATS_JSON (-1 if not known)
+
+-  18.10.26 Original   By: ACRM
+*/
+int ParseStatsFormat(char *name)
+{
+   if(!strcmp(name, "text"))
+      return(STATS_TEXT);
+   if(!strcmp(name, "json"))
+      return(STATS_JSON);
+   return(-1);
+}
+
+
+/************************************************************************/
+/*>BOOL InitRunStats(RUNSTATS *stats, int nSubGroups)
+   ---------------------------------------------------
+*//**
+   \param[out]  stats        Statistics to clear
+   \param[in]   nSubGroups   Number of subgroups that can win
+   \return                   Success (FALSE if no memory)
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Allocates the winner counts
+*/
+BOOL InitRunStats(RUNSTATS *stats, int nSubGroups)
+{
+   memset(stats, 0, sizeof(RUNSTATS));
+   if((stats->winners = (long *)calloc(nSubGroups+1, sizeof(long)))==NULL)
+      return(FALSE);
+   stats->nWinners = nSubGroups;
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void FreeRunStats(RUNSTATS *stats)
+   ----------------------------------
+*//**
+   \param[in,out] stats   Statistics whose winner counts are freed
+
+-  18.10.26 Original   By: ACRM
+*/
+void FreeRunStats(RUNSTATS *stats)
+{
+   if(stats->winners != NULL)
+      free(stats->winners);
+   stats->winners  = NULL;
+   stats->nWinners = 0;
+}
+
+
+/************************************************************************/
+/*>void MergeRunStats(RUNSTATS *dest, RUNSTATS *src)
+   -------------------------------------------------
+*//**
+   \param[in,out] dest   Statistics to add to
+   \param[in]     src    Statistics to be added
+
+   Adds the statistics collected by one thread into the totals. Stage
+   times are summed so are CPU time rather than wall time if several
+   threads were working. Winners are only added if both have counts
+   for the same subgroups.
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Checks the winner counts
+*/
+void MergeRunStats(RUNSTATS *dest, RUNSTATS *src)
+{
+   int i;
+
+   dest->chains      += src->chains;
+   dest->residues    += src->residues;
+   dest->xResidues   += src->xResidues;
+   dest->shortChains += src->shortChains;
+   dest->evaluated   += src->evaluated;
+   dest->pruned      += src->pruned;
+   dest->loadTime    += src->loadTime;
+   dest->parseTime   += src->parseTime;
+   dest->scoreTime   += src->scoreTime;
+   dest->outputTime  += src->outputTime;
+
+   if((dest->winners != NULL) && (src->winners != NULL) &&
+      (dest->nWinners == src->nWinners))
+   {
+      for(i=0; i<=src->nWinners; i++)
+         dest->winners[i] += src->winners[i];
+   }
+   for(i=0; i<STATS_NLATENCY; i++)
+      dest->latency[i] += src->latency[i];
+}
+
+
+/************************************************************************/
+/*>REAL StatsTime(void)
+   --------------------
+*//**
+   \return      Monotonic time in seconds
+
+-  18.10.26 Original   By: ACRM
+*/
+REAL StatsTime(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return((REAL)ts.tv_sec + ((REAL)ts.tv_nsec * 1.0e-9));
+}
+
+
+/************************************************************************/
+/*>REAL StatsLap(REAL *mark)
+   -------------------------
+*//**
+   \param[in,out] mark   Time from StatsTime(), updated to now
+   \return               Seconds since the mark
+
+-  18.10.26 Original   By: ACRM
+*/
+REAL StatsLap(REAL *mark)
+{
+   REAL now     = StatsTime(),
+        elapsed = now - *mark;
+
+   *mark = now;
+   return(elapsed);
+}
+
+
+/************************************************************************/
+/*>static int LatencyBucket(unsigned long ns)
+   ------------------------------------------
+*//**
+   \param[in]   ns    Latency in nanoseconds
+   \return            Histogram bucket
+
+   Values below 2*SUBBUCKETS have a bucket each. Above that, each power
+   of 2 is split into SUBBUCKETS buckets
+
+-  18.10.26 Original   By: ACRM
+*/
+static int LatencyBucket(unsigned long ns)
+{
+   int shift = 0,
+       bucket;
+
+   if(ns < 2*SUBBUCKETS)
+      return((int)ns);
+
+   while((ns >> shift) >= 2*SUBBUCKETS)
+      shift++;
+   bucket = shift*SUBBUCKETS + (int)(ns >> shift);
+
+   return((bucket < STATS_NLATENCY) ? bucket : STATS_NLATENCY-1);
+}
+
+
+/************************************************************************/
+/*>static REAL BucketValue(int bucket)
+   -----------------------------------
+*//**
+   \param[in]   bucket    Histogram bucket
+   \return                Latency at the middle of the bucket (ns)
+
+-  18.10.26 Original   By: ACRM
+*/
+static REAL BucketValue(int bucket)
+{
+   int shift, mantissa;
+
+   if(bucket < 2*SUBBUCKETS)
+      return((REAL)bucket);
+
+   shift    = bucket/SUBBUCKETS - 1;
+   mantissa = bucket - shift*SUBBUCKETS;
+   return(ldexp((REAL)mantissa + 0.5, shift));
+}
+
+
+/************************************************************************/
+/*>void AddChainStats(RUNSTATS *stats, SUBGROUPRESULT *result,
+                      REAL seconds)
+   -----------------------------------------------------------
+*//**
+   \param[in,out] stats    Statistics
+   \param[in]     result   Result for a chain
+   \param[in]     seconds  Time taken to score the chain
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Any number of winners. Short chains are flagged in the
+            result as the index also prunes
+*/
+void AddChainStats(RUNSTATS *stats, SUBGROUPRESULT *result,
+                   REAL seconds)
+{
+   stats->chains++;
+   stats->residues  += result->length;
+   stats->xResidues += result->nX;
+   stats->evaluated += result->nEvaluated;
+   stats->pruned    += result->nPruned;
+   if(result->shortChain)
+      stats->shortChains++;
+
+   if(stats->winners != NULL)
+   {
+      if((result->best >= 0) && (result->best < stats->nWinners))
+         stats->winners[result->best]++;
+      else
+         stats->winners[stats->nWinners]++;
+   }
+
+   stats->scoreTime += seconds;
+   stats->latency[LatencyBucket((seconds > 0.0) ?
+                                (unsigned long)(seconds * 1.0e9) : 0)]++;
+}
+
+
+/************************************************************************/
+/*>REAL LatencyPercentile(RUNSTATS *stats, REAL percentile)
+   --------------------------------------------------------
+*//**
+   \param[in]   stats        Statistics
+   \param[in]   percentile   Percentile (0-100)
+   \return                   Per-chain latency (ns)
+
+-  18.10.26 Original   By: ACRM
+*/
+REAL LatencyPercentile(RUNSTATS *stats, REAL percentile)
+{
+   long target,
+        count = 0;
+   int  i;
+
+   if(stats->chains == 0)
+      return(0.0);
+
+   target = (long)((percentile * stats->chains) / 100.0 + 0.999999);
+   if(target < 1)
+      target = 1;
+
+   for(i=0; i<STATS_NLATENCY; i++)
+   {
+      count += stats->latency[i];
+      if(count >= target)
+         return(BucketValue(i));
+   }
+   return(BucketValue(STATS_NLATENCY-1));
+}
+
+
+/************************************************************************/
+/*>long PeakRSS(void)
+   ------------------
+*//**
+   \return      Peak resident set size of this process (KB)
+
+-  18.10.26 Original   By: ACRM
+*/
+long PeakRSS(void)
+{
+   struct rusage usage;
+
+   if(getrusage(RUSAGE_SELF, &usage))
+      return(0);
+   return((long)usage.ru_maxrss);
+}
+
+
+/************************************************************************/
+/*>static void WriteJSONName(FILE *fp, char *name)
+   -----------------------------------------------
+*//**
+   \param[in]   fp      Output file
+   \param[in]   name    String to write as a quoted JSON string
+
+-  18.10.26 Original   By: ACRM
+*/
+static void WriteJSONName(FILE *fp, char *name)
+{
+   putc('"', fp);
+   for(; *name; name++)
+   {
+      if((*name == '"') || (*name == '\\'))
+         putc('\\', fp);
+      if((unsigned char)*name >= ' ')
+         putc(*name, fp);
+   }
+   putc('"', fp);
+}
+
+
+/************************************************************************/
+/*>void WriteRunStats(FILE *fp, RUNSTATS *stats, int format,
+                      REAL totalTime)
+   ---------------------------------------------------------
+*//**
+   \param[in]   fp          Output file
+   \param[in]   stats       Statistics
+   \param[in]   format      STATS_TEXT or STATS_JSON
+   \param[in]   totalTime   Wall time for the whole run (s)
+
+   Writes the statistics report. Subgroups that never won are omitted
+   from the histogram.
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Any number of winners
+*/
+void WriteRunStats(FILE *fp, RUNSTATS *stats, int format,
+                   REAL totalTime)
+{
+   int  nSubGroups = stats->nWinners,
+        i;
+   BOOL first      = TRUE;
+   REAL p50        = LatencyPercentile(stats, 50.0)  / 1000.0,
+        p99        = LatencyPercentile(stats, 99.0)  / 1000.0,
+        p999       = LatencyPercentile(stats, 99.9)  / 1000.0;
+
+   if(format == STATS_JSON)
+   {
+      fprintf(fp, "{\"chains\":%ld,\"residues\":%ld,\"x_residues\":%ld,\
+\"short_chains\":%ld,\"offsets_evaluated\":%ld,\"offsets_pruned\":%ld,",
+              stats->chains, stats->residues, stats->xResidues,
+              stats->shortChains, stats->evaluated, stats->pruned);
+      fprintf(fp, "\"time_s\":{\"load\":%.6f,\"parse\":%.6f,\
+\"score\":%.6f,\"output\":%.6f,\"total\":%.6f},",
+              stats->loadTime, stats->parseTime, stats->scoreTime,
+              stats->outputTime, totalTime);
+      fprintf(fp, "\"latency_us\":{\"p50\":%.3f,\"p99\":%.3f,\
+\"p999\":%.3f},\"peak_rss_kb\":%ld,\"winners\":[",
+              p50, p99, p999, PeakRSS());
+      for(i=0; (stats->winners != NULL) && (i<=nSubGroups); i++)
+      {
+         if(stats->winners[i] == 0)
+            continue;
+         fprintf(fp, "%s{\"id\":%d,\"name\":", (first ? "" : ","),
+                 (i < nSubGroups) ? i : -1);
+         WriteJSONName(fp, GetSubgroupName(i));
+         fprintf(fp, ",\"count\":%ld}", stats->winners[i]);
+         first = FALSE;
+      }
+      fprintf(fp, "]}\n");
+   }
+   else
+   {
+      fprintf(fp, "Run statistics\n");
+      fprintf(fp, "   Chains                  %12ld\n", stats->chains);
+      fprintf(fp, "   Residues                %12ld\n", stats->residues);
+      fprintf(fp, "   X residues              %12ld\n",
+              stats->xResidues);
+      fprintf(fp, "   Short chains            %12ld\n",
+              stats->shortChains);
+      fprintf(fp, "   Offsets evaluated       %12ld\n",
+              stats->evaluated);
+      fprintf(fp, "   Offsets pruned          %12ld\n", stats->pruned);
+      fprintf(fp, "   Time (s)\n");
+      fprintf(fp, "      Model load           %12.6f\n",
+              stats->loadTime);
+      fprintf(fp, "      Parsing              %12.6f\n",
+              stats->parseTime);
+      fprintf(fp, "      Scoring              %12.6f\n",
+              stats->scoreTime);
+      fprintf(fp, "      Output               %12.6f\n",
+              stats->outputTime);
+      fprintf(fp, "      Total                %12.6f\n", totalTime);
+      fprintf(fp, "   Chain latency (us)\n");
+      fprintf(fp, "      p50                  %12.3f\n", p50);
+      fprintf(fp, "      p99                  %12.3f\n", p99);
+      fprintf(fp, "      p99.9                %12.3f\n", p999);
+      fprintf(fp, "   Peak RSS (KB)           %12ld\n", PeakRSS());
+      fprintf(fp, "   Winning subgroups\n");
+      for(i=0; (stats->winners != NULL) && (i<=nSubGroups); i++)
+      {
+         if(stats->winners[i] == 0)
+            continue;
+         fprintf(fp, "      %-40s %8ld\n",
+                 (i < nSubGroups) ? GetSubgroupName(i) : "(no match)",
+                 stats->winners[i]);
+      }
+   }
+}
@@ -0,0 +1,104 @@
+/*************************************************************************
+
+   Program:    hsubgroup
+   File:       stats.h
+
+   Version:    V3.20
+   Date:       18.10.26
+   Function:   Run statistics and stage timing
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V3.5  18.10.26   Original
+   V3.20 18.10.26   Winners are counted for any number of subgroups
+
+*************************************************************************/
+#ifndef _STATS_H
+#define _STATS_H
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define STATS_NONE          0
+#define STATS_TEXT          1
+#define STATS_JSON          2
+
+#define STATS_SUBBITS       5  /* Latency buckets per power of 2 are
+                                  2^STATS_SUBBITS                       */
+#define STATS_NLATENCY   1280  /* Latency buckets (covers > 2^38 ns)    */
+
+/* Statistics for a run. Each thread should collect into its own copy
+   which is merged into the main one with MergeRunStats() when the
+   thread finishes, so no locking is needed while scoring
+*/
+typedef struct
+{
+   long chains,
+        residues,
+        xResidues,
+        shortChains,
+        evaluated,
+        pruned,
+        *winners,                /* nWinners+1; last is for no match   */
+        latency[STATS_NLATENCY];
+   int  nWinners;
+   REAL loadTime,
+        parseTime,
+        scoreTime,
+        outputTime;
+} RUNSTATS;
+
+
+/************************************************************************/
+/* Prototypes
+*/
+int  ParseStatsFormat(char *name);
+BOOL InitRunStats(RUNSTATS *stats, int nSubGroups);
+void FreeRunStats(RUNSTATS *stats);
+void MergeRunStats(RUNSTATS *dest, RUNSTATS *src);
+REAL StatsTime(void);
+REAL StatsLap(REAL *mark);
+void AddChainStats(RUNSTATS *stats, SUBGROUPRESULT *result,
+                   REAL seconds);
+REAL LatencyPercentile(RUNSTATS *stats, REAL percentile);
+long PeakRSS(void);
+void WriteRunStats(FILE *fp, RUNSTATS *stats, int format,
+                   REAL totalTime);
+
+#endif
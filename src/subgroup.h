@@ -3,8 +3,8 @@
    Program:    
    File:       subgroup.h
    
-   Version:    V3.0
-   Date:       12.02.19
+   Version:    V3.6
+   Date:       18.10.26
    Function:   Assign human subgroups from antibody sequences in PIR file
    
    Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2019
@@ -52,6 +52,25 @@
    V2.2  08.01.19   Fixes problem with DOS files
    V2.3  05.02.19   Added info to verbose output on the second best match
    V3.0  12.02.19   Added support for full matrices
+   V3.3  18.10.26   Added SUBGROUPRESULT
+   V3.4  18.10.26   Added top-K ranking to SUBGROUPRESULT
+   V3.5  18.10.26   Added GetSubgroupProfile()
+   V3.6  18.10.26   Added chain counts to SUBGROUPRESULT
+   V3.12 18.10.26   Added SUBGROUPMODEL so several models can be loaded
+   V3.13 18.10.26   Models carry their own scoring configuration
+   V3.18 18.10.26   Models may be scored with gapped alignment
+   V3.19 18.10.26   Profiles may have any number of reference positions
+                    and are held in allocated memory. Models carry a
+                    table of scores for each residue code
+   V3.20 18.10.26   Models hold any number of subgroups and large ones
+                    have an index of clusters of similar subgroups
+   V3.21 18.10.26   The index is a tree
+   V3.22 18.10.26   Added FindSubgroupSetSplit()
+   V3.23 18.10.26   Models may have the scores of chance matches and
+                    results a p-value and E-value
+   V3.24 18.10.26   Added TopTwoSubgroupModel()
+   V3.26 18.10.26   Added SameScoreScale(). Removed CalcScore(),
+                    CalcFullScore() and TopTwoSubgroupModel()
 
 *************************************************************************/
 /* Includes
@@ -60,8 +79,10 @@
 /************************************************************************/
 /* Defines and macros
 */
-#define MAXSUBTYPES     100  /* The max number of subtypes              */
-#define MAXREFSEQLEN     21  /* The length of the reference sequences   */
+#define MAXSUBTYPES     100  /* Max subtypes for the scans and hsgen    */
+#define SUBGROUPALLOC    16  /* Subgroups first allocated by readers    */
+#define MAXREFSEQLEN     21  /* The length of the standard reference
+                                sequences                               */
 #define MAXTRUNCATION     6  /* Amount we can Nter truncate a sequence  */
 #define MAXEXTENSION     20  /* Amount we can Nter extend a sequence    */
 #define MAXBUFF         320  /* General purpose buffer                  */
@@ -71,38 +92,213 @@
 #define CHAINTYPE_HEAVY   0
 #define CHAINTYPE_KAPPA   1
 #define CHAINTYPE_LAMBDA  2
+#define MAXTOPK          16  /* Max number of ranked subgroups kept     */
+#define DEFAULTTOPK       2  /* Best and second best                    */
+#define DEFAULTGAPOPEN  0.6  /* Penalty for the first residue of a gap  */
+#define DEFAULTGAPEXTEND 0.2 /* Penalty for each further residue        */
+#define MAXGAPBAND        3  /* Diagonals either side of the offsets    */
+#define PROFCODES        28  /* Residue codes: A-Z, other and pad       */
+#define PROFOTHER        26  /* Code for anything other than A-Z        */
+#define PROFPAD          27  /* Code before the start of a chain        */
+#define PROFPADDING      (MAXTRUNCATION-1) /* Pad codes before a chain  */
+#define PROFSTARTS       (MAXTRUNCATION + MAXEXTENSION - 1) /* Starts of
+                                the window for the truncation and
+                                extension offsets                       */
+#define INDEXMINSUBGROUPS 64 /* Smallest model that is indexed          */
+#define INDEXLEAFSIZE    64  /* Most subgroups in a leaf of the index   */
+#define INDEXFANOUT       4  /* Most children of a node of the index    */
+#define INDEXIDENTITY    85  /* % consensus identity to share a leaf    */
+#define INDEXIDENTITYSTEP 10 /* Drop in identity for each level up      */
+#define INDEXSLACK   1.0e-9  /* Relative rise in a bound for rounding   */
+#define NULLBINS        400  /* Bins for the scores of chance matches   */
+#define NULLTOLERANCE 1.0e-9 /* Fraction of a bin counted as a tie      */
 
-/* Used to store info on a subgroup                                     */
+/* Scores added by each residue code for a subgroup at a reference
+   position in a model's table; the maximum scores follow
+*/
+#define PROFTABLE(model, g, i)                                           \
+   ((model)->table + ((((g) * (model)->refLength) + (i)) * 2 * PROFCODES))
+
+/* The same for a node of a model's index: the highest score of any
+   subgroup below it for each code and the smallest shortfall of the
+   score from the maximum
+*/
+#define PROFNODE(model, n, i)                                            \
+   ((model)->nodeTable +                                                 \
+    ((((n) * (model)->refLength) + (i)) * 2 * PROFCODES))
+
+/* The scores of chance matches to a subgroup in a model's null table:
+   the normalized score of bin 0, the width of a bin and the chance of
+   scoring at least each of nNullBins bins
+*/
+#define PROFNULL(model, g)                                               \
+   ((model)->nullTable + ((g) * ((model)->nNullBins + 2)))
+
+/* Used to store info on a subgroup. The arrays are allocated for
+   length reference positions
+*/
 typedef struct
 {
-   REAL topScores[MAXREFSEQLEN],
-        secondScores[MAXREFSEQLEN];
+   REAL *topScores,
+        *secondScores;
    int  chainType,
-        subGroup;
+        subGroup,
+        length;
    char name[MAXBUFF],
-        topSeq[MAXBUFF],
-        secondSeq[MAXBUFF];
+        *topSeq,
+        *secondSeq;
 } SUBGROUPINFO;
 
 
 typedef struct {
-   REAL        scores[MAXREFSEQLEN][26];
-   REAL        topScores[MAXREFSEQLEN];
-   int         index, chainType, subGroup;
+   REAL        (*scores)[26];
+   REAL        *topScores;
+   int         index, chainType, subGroup, length;
    char        type[MAXWORD];
    char        name[MAXBUFF];
 } FMSUBGROUPINFO;
 
 
+/* A loaded set of subgroup data. Only one of the two arrays is used
+   depending on fullMatrix. The label identifies the model in output.
+   includeX and doProduct configure scoring (the scores are logs if
+   doProduct is set). If gapped is set a gapped alignment is also tried
+   for each subgroup. source is the model the data were loaded into
+   and is shared by copies. Every subgroup has refLength reference
+   positions. table holds the score and maximum score for each residue
+   code at each position of each subgroup (see PROFTABLE()) with the
+   model's configuration applied. The arrays of subgroups are allocated
+   for nSubGroups. A model with at least INDEXMINSUBGROUPS subgroups
+   has an index: a tree of nNodes nodes whose root is the last. Nodes
+   below nLeaves are leaves holding subgroups and the rest hold nodes;
+   the items of node n are nodeItem[nodeStart[n]] up to
+   nodeItem[nodeStart[n+1]-1]. nodeTable bounds the scores of the
+   subgroups below each node (see PROFNODE()). nNodes is 0 for a
+   smaller model. nullTable is NULL unless BuildNullScores() has been
+   used, when it holds the scores of chance matches to each subgroup
+   (see PROFNULL())
+*/
+typedef struct subgroupmodel
+{
+   SUBGROUPINFO   *subGroupInfo;
+   FMSUBGROUPINFO *fmSubGroupInfo;
+   int            nSubGroups,
+                  refLength,
+                  nNodes,
+                  nLeaves,
+                  nNullBins,
+                  *nodeStart,
+                  *nodeItem;
+   BOOL           fullMatrix,
+                  includeX,
+                  doProduct,
+                  gapped;
+   REAL           gapOpen,
+                  gapExtend,
+                  *table,
+                  *nodeTable,
+                  *nullTable;
+   struct subgroupmodel *source;
+   char           label[MAXBUFF];
+} SUBGROUPMODEL;
+
+
+/* The result of assigning a subgroup to a sequence. Subgroups are
+   identified by their index in the loaded data (-1 for no match).
+   The top* arrays hold the best nTop distinct subgroups in descending
+   order of score; best and second are copies of the first two.
+   Offsets are positive for N-terminal truncation and negative for
+   extension. The counts at the end are kept for run statistics:
+   nEvaluated is the number of (subgroup, offset) pairs scored, plus
+   the window sums made for the bounds of an index's nodes. nPruned
+   is the number of pairs an exhaustive search scores less
+   nEvaluated (never below 0): those not scored because the chain is
+   too short to extend or because the model's index showed that they
+   couldn't be ranked.
+   shortChain is set if the chain is too short to extend.
+   pValue is the chance of a random chain scoring at least as well
+   against the best subgroup and eValue the number of chance matches
+   that would score as well from all the subgroups and offsets; both
+   are -1 unless the model has a null table
+*/
+typedef struct
+{
+   REAL score,
+        secondScore,
+        pValue,
+        eValue,
+        topScore[MAXTOPK];
+   int  best,
+        second,
+        chainType,
+        subGroup,
+        nTop,
+        topId[MAXTOPK],
+        topOffset[MAXTOPK];
+   int  length,
+        nX,
+        nEvaluated,
+        nPruned;
+   BOOL shortChain;
+} SUBGROUPRESULT;
+
+
 /************************************************************************/
 /* Prototypes
 */
 BOOL FindHumanSubgroup(FILE *fp, BOOL fullMatrix, char *testSequence,
                        int *chainType, int *subGroup);
+BOOL FindHumanSubgroupResult(FILE *fp, BOOL fullMatrix, char *sequence,
+                             SUBGROUPRESULT *result);
 void FindSubgroupSetOptions(BOOL verbose, BOOL includeX, BOOL doProduct);
+BOOL FindSubgroupSetTopK(int topK);
+BOOL FindSubgroupSetSplit(int nParts);
+BOOL LoadSubgroupModel(FILE *fp, BOOL fullMatrix);
+int  GetSubgroupCount(void);
+char *GetSubgroupName(int id);
+char *ChainTypeLabel(int chainType);
+int  GetSubgroupChainType(int id);
+BOOL GetSubgroupProfile(int id, int pos, REAL *freq);
+SUBGROUPMODEL *GetDefaultModel(void);
+SUBGROUPMODEL *ReadSubgroupModel(FILE *fp, BOOL fullMatrix, char *label);
+void FreeSubgroupModel(SUBGROUPMODEL *model);
+BOOL ConfigureSubgroupModel(SUBGROUPMODEL *model, BOOL includeX,
+                            BOOL doProduct);
+SUBGROUPMODEL *CopySubgroupModel(SUBGROUPMODEL *model, char *label);
+void SetSubgroupGaps(SUBGROUPMODEL *model, BOOL gapped, REAL gapOpen,
+                     REAL gapExtend);
+BOOL ScoreSubgroupModels(SUBGROUPMODEL **models, int nModels,
+                         char *sequence, SUBGROUPRESULT *results);
+char *ModelSubgroupName(SUBGROUPMODEL *model, int id);
+int  BestModel(SUBGROUPRESULT *results, int nModels);
+BOOL SameScoreScale(SUBGROUPMODEL **models, int nModels);
 
 /* Not for end-user use                                                 */
-int ReadFullMatrix(FILE *fp, FMSUBGROUPINFO *fullMatrix);
-REAL CalcFullScore(FMSUBGROUPINFO subGroupInfo, char *sequence,
-                   int offset, int offsetType, BOOL includeX);
+int ReadSubgroupData(FILE *fp, SUBGROUPINFO **subGroupInfo);
+int InitializeAllSubgroups(SUBGROUPINFO *subGroupInfo);
+BOOL AllocSubgroupInfo(SUBGROUPINFO *subGroupInfo, int length);
+void FreeSubgroupData(SUBGROUPINFO *subGroupInfo, int nSubGroups);
+int ReadFullMatrix(FILE *fp, FMSUBGROUPINFO **fullMatrix);
 void fmTakeLogs(FMSUBGROUPINFO *subGroupInfo, int nSubGroups);
+BOOL fmAllocSubgroupInfo(FMSUBGROUPINFO *subGroupInfo, int length);
+void fmFreeSubgroupData(FMSUBGROUPINFO *subGroupInfo, int nSubGroups);
+BOOL BuildProfileTable(SUBGROUPMODEL *model);
+void EncodeProfileChain(char *sequence, int length, unsigned char *code,
+                        int nCodes);
+void ScoreProfileStarts(SUBGROUPMODEL *model, int sgNum,
+                        unsigned char *code, int nStarts, REAL *score,
+                        REAL *scoreMax);
+void ScoreProfileStart(SUBGROUPMODEL *model, int sgNum,
+                       unsigned char *code, int start, REAL *score,
+                       REAL *scoreMax);
+void ScoreTableStarts(REAL *table, int refLength, unsigned char *code,
+                      int nStarts, REAL *score, REAL *scoreMax);
+void ScoreTableStart(REAL *table, int refLength, unsigned char *code,
+                     int start, REAL *score, REAL *scoreMax);
+BOOL BuildProfileIndex(SUBGROUPMODEL *model);
+void FreeProfileIndex(SUBGROUPMODEL *model);
+BOOL BuildNullScores(SUBGROUPMODEL *model);
+void FreeNullScores(SUBGROUPMODEL *model);
+REAL NullPValue(SUBGROUPMODEL *model, int sgNum, REAL score);
+REAL CalcGappedScore(SUBGROUPMODEL *model, int sgNum, char *sequence,
+                     int length, int *offset);
@@ -0,0 +1,543 @@
+/*************************************************************************
+
+   Program:    hsubgroup
+   File:       summary.c
+
+   Version:    V3.24
+   Date:       18.10.26
+   Function:   Summary of the assignments of a whole run
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Collects the report written by hsubgroup --summary in place of a
+   result for every chain: the number of chains won by each subgroup,
+   of each chain type and in each input file, with the mean score,
+   score quantiles, mean margin over the second best subgroup and a
+   histogram of the margins for each.
+
+   Scores are kept in a histogram with bins of 1 so quantiles are
+   interpolated within a bin and two SUMMARYs can be merged by adding
+   the counts. Margins are binned at 1, 2, 5, 10, 20 and 50. A chain
+   with no match scores 0 with no margin.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V3.24 18.10.26   Original
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bioplib/MathType.h"
+#include "bioplib/SysDefs.h"
+#include "subgroup.h"
+#include "summary.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define NOCHAINTYPE (SUMMARYCHAINTYPES - 1)  /* Chain type of no match  */
+
+/************************************************************************/
+/* Globals
+*/
+static REAL sMarginEdges[SUMMARYMARGINBINS-1] = {1.0, 2.0, 5.0, 10.0,
+                                                 20.0, 50.0};
+
+/************************************************************************/
+/* Prototypes
+*/
+static void AddGroup(SUMGROUP *dest, SUMGROUP *src);
+static REAL ScoreQuantile(SUMGROUP *group, REAL fraction);
+static int  CompareFiles(const void *a, const void *b);
+static void WriteGroup(FILE *fp, SUMGROUP *group, long total,
+                       int format);
+static void WriteJSONName(FILE *fp, char *name);
+
+
+/************************************************************************/
+/*>int ParseSummaryFormat(char *name)
+   ----------------------------------
+*//**
+   \param[in]   name    Format name (tsv or json)
+   \return              SUMMARY_TSV or SUMMARY_JSON (-1 if not known)
+
+-  18.10.26 Original   By: ACRM
+*/
+int ParseSummaryFormat(char *name)
+{
+   if(!strcmp(name, "tsv"))
+      return(SUMMARY_TSV);
+   if(!strcmp(name, "json"))
+      return(SUMMARY_JSON);
+   return(-1);
+}
+
+
+/************************************************************************/
+/*>BOOL InitSummary(SUMMARY *summary, int nSubGroups)
+   --------------------------------------------------
+*//**
+   \param[out]  summary      Summary to clear
+   \param[in]   nSubGroups   Number of subgroups that can win
+   \return                   Success (FALSE if no memory)
+
+-  18.10.26 Original   By: ACRM
+*/
+BOOL InitSummary(SUMMARY *summary, int nSubGroups)
+{
+   memset(summary, 0, sizeof(SUMMARY));
+   if((summary->subgroups = (SUMGROUP *)calloc(nSubGroups+1,
+                                               sizeof(SUMGROUP)))==NULL)
+      return(FALSE);
+   summary->nSubGroups = nSubGroups;
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void FreeSummary(SUMMARY *summary)
+   ----------------------------------
+*//**
+   \param[in,out] summary   Summary whose groups are freed
+
+-  18.10.26 Original   By: ACRM
+*/
+void FreeSummary(SUMMARY *summary)
+{
+   int i;
+
+   for(i=0; i<summary->nFiles; i++)
+      free(summary->files[i].name);
+   if(summary->files != NULL)
+      free(summary->files);
+   if(summary->subgroups != NULL)
+      free(summary->subgroups);
+   summary->files      = NULL;
+   summary->subgroups  = NULL;
+   summary->nFiles     = summary->maxFiles = 0;
+   summary->nSubGroups = 0;
+}
+
+
+/************************************************************************/
+/*>BOOL StartSummaryFile(SUMMARY *summary, char *name, int order)
+   --------------------------------------------------------------
+*//**
+   \param[in,out] summary   The summary
+   \param[in]     name      Input file name (copied)
+   \param[in]     order     Position of the file in the input, for
+                            sorting the files in the report
+   \return                  Success (FALSE if no memory)
+
+   Chains added after this are counted for this file
+
+-  18.10.26 Original   By: ACRM
+*/
+BOOL StartSummaryFile(SUMMARY *summary, char *name, int order)
+{
+   SUMFILE *file;
+
+   if(summary->nFiles >= summary->maxFiles)
+   {
+      SUMFILE *files;
+      int     maxFiles = 2 * summary->maxFiles + 16;
+
+      if((files = (SUMFILE *)realloc(summary->files,
+                                     maxFiles * sizeof(SUMFILE)))==NULL)
+         return(FALSE);
+      summary->files    = files;
+      summary->maxFiles = maxFiles;
+   }
+
+   file = &(summary->files[summary->nFiles]);
+   memset(file, 0, sizeof(SUMFILE));
+   if((file->name = (char *)malloc(strlen(name)+1))==NULL)
+      return(FALSE);
+   strcpy(file->name, name);
+   file->order = order;
+   summary->nFiles++;
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void AddSummaryChain(SUMMARY *summary, SUBGROUPRESULT *result)
+   --------------------------------------------------------------
+*//**
+   \param[in,out] summary   The summary
+   \param[in]     result    Result for one chain
+
+   Adds a chain to its winning subgroup, its chain type, the current
+   file and the totals
+
+-  18.10.26 Original   By: ACRM
+*/
+void AddSummaryChain(SUMMARY *summary, SUBGROUPRESULT *result)
+{
+   SUMGROUP *groups[4];
+   REAL     score  = 0.0,
+            margin = 0.0;
+   int      nGroups = 0,
+            scoreBin,
+            marginBin,
+            chainType = NOCHAINTYPE,
+            i;
+
+   if(result->best >= 0)
+   {
+      score  = result->score;
+      margin = result->score - result->secondScore;
+      if((result->chainType >= 0) && (result->chainType < NOCHAINTYPE))
+         chainType = result->chainType;
+   }
+
+   scoreBin = (int)score;
+   if(scoreBin < 0)
+      scoreBin = 0;
+   else if(scoreBin >= SUMMARYSCOREBINS)
+      scoreBin = SUMMARYSCOREBINS - 1;
+   for(marginBin=0;
+       (marginBin < SUMMARYMARGINBINS-1) &&
+       (margin >= sMarginEdges[marginBin]);
+       marginBin++);
+
+   groups[nGroups++] = &(summary->all);
+   groups[nGroups++] = &(summary->chainTypes[chainType]);
+   groups[nGroups++] = &(summary->subgroups[(result->best >= 0) ?
+                                            result->best :
+                                            summary->nSubGroups]);
+   if(summary->nFiles)
+      groups[nGroups++] = &(summary->files[summary->nFiles-1].group);
+
+   for(i=0; i<nGroups; i++)
+   {
+      groups[i]->chains++;
+      groups[i]->scoreBins[scoreBin]++;
+      groups[i]->marginBins[marginBin]++;
+      groups[i]->sumScore  += score;
+      groups[i]->sumMargin += margin;
+   }
+}
+
+
+/************************************************************************/
+/*>BOOL MergeSummary(SUMMARY *dest, SUMMARY *src)
+   ----------------------------------------------
+*//**
+   \param[in,out] dest   Summary to add to
+   \param[in]     src    Summary to be added
+   \return               Success (FALSE if no memory)
+
+   Adds the summary collected by one thread into the totals. The files
+   are added to the list of files as each file is only processed by
+   one thread. Subgroups are only added if both have the same number.
+
+-  18.10.26 Original   By: ACRM
+*/
+BOOL MergeSummary(SUMMARY *dest, SUMMARY *src)
+{
+   int i;
+
+   AddGroup(&(dest->all), &(src->all));
+   for(i=0; i<SUMMARYCHAINTYPES; i++)
+      AddGroup(&(dest->chainTypes[i]), &(src->chainTypes[i]));
+   if(dest->nSubGroups == src->nSubGroups)
+   {
+      for(i=0; i<=dest->nSubGroups; i++)
+         AddGroup(&(dest->subgroups[i]), &(src->subgroups[i]));
+   }
+
+   for(i=0; i<src->nFiles; i++)
+   {
+      if(!StartSummaryFile(dest, src->files[i].name, src->files[i].order))
+         return(FALSE);
+      dest->files[dest->nFiles-1].group = src->files[i].group;
+   }
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>BOOL WriteSummary(FILE *fp, SUMMARY *summary, int format)
+   ---------------------------------------------------------
+*//**
+   \param[in]     fp        Output file
+   \param[in,out] summary   The summary (files are sorted into input
+                            order)
+   \param[in]     format    SUMMARY_TSV or SUMMARY_JSON
+   \return                  Success
+
+   Writes the report. Chain types and subgroups with no chains are
+   omitted. TSV has a header line then a row for all the chains and
+   for each file, chain type and subgroup. JSON is a single object.
+
+-  18.10.26 Original   By: ACRM
+*/
+BOOL WriteSummary(FILE *fp, SUMMARY *summary, int format)
+{
+   long total = summary->all.chains;
+   int  i;
+   BOOL first;
+
+   if(summary->nFiles > 1)
+      qsort(summary->files, summary->nFiles, sizeof(SUMFILE),
+            CompareFiles);
+
+   if(format == SUMMARY_JSON)
+   {
+      fprintf(fp, "{\"margin_bins\":[0");
+      for(i=0; i<SUMMARYMARGINBINS-1; i++)
+         fprintf(fp, ",%g", sMarginEdges[i]);
+      fprintf(fp, "],\"all\":{");
+      WriteGroup(fp, &(summary->all), total, format);
+
+      fprintf(fp, "},\"files\":[");
+      for(i=0; i<summary->nFiles; i++)
+      {
+         fprintf(fp, "%s{\"file\":", (i ? "," : ""));
+         WriteJSONName(fp, summary->files[i].name);
+         putc(',', fp);
+         WriteGroup(fp, &(summary->files[i].group), total, format);
+         putc('}', fp);
+      }
+
+      fprintf(fp, "],\"chain_types\":[");
+      for(i=0, first=TRUE; i<SUMMARYCHAINTYPES; i++)
+      {
+         if(summary->chainTypes[i].chains == 0)
+            continue;
+         fprintf(fp, "%s{\"chain_type\":\"%s\",", (first ? "" : ","),
+                 (i < NOCHAINTYPE) ? ChainTypeLabel(i) : "NONE");
+         WriteGroup(fp, &(summary->chainTypes[i]), total, format);
+         putc('}', fp);
+         first = FALSE;
+      }
+
+      fprintf(fp, "],\"subgroups\":[");
+      for(i=0, first=TRUE; i<=summary->nSubGroups; i++)
+      {
+         if(summary->subgroups[i].chains == 0)
+            continue;
+         fprintf(fp, "%s{\"id\":%d,\"name\":", (first ? "" : ","),
+                 (i < summary->nSubGroups) ? i : -1);
+         WriteJSONName(fp, (i < summary->nSubGroups) ?
+                           GetSubgroupName(i) : "(no match)");
+         putc(',', fp);
+         WriteGroup(fp, &(summary->subgroups[i]), total, format);
+         putc('}', fp);
+         first = FALSE;
+      }
+      fprintf(fp, "]}\n");
+   }
+   else
+   {
+      fprintf(fp, "#group\tid\tname\tchains\tfraction\tmean_score\tp10\t\
+p50\tp90\tmean_margin");
+      fprintf(fp, "\tmargin_0");
+      for(i=0; i<SUMMARYMARGINBINS-1; i++)
+         fprintf(fp, "\tmargin_%g", sMarginEdges[i]);
+      fprintf(fp, "\nall\t-1\tall\t");
+      WriteGroup(fp, &(summary->all), total, format);
+
+      for(i=0; i<summary->nFiles; i++)
+      {
+         fprintf(fp, "file\t%d\t%s\t", summary->files[i].order,
+                 summary->files[i].name);
+         WriteGroup(fp, &(summary->files[i].group), total, format);
+      }
+      for(i=0; i<SUMMARYCHAINTYPES; i++)
+      {
+         if(summary->chainTypes[i].chains == 0)
+            continue;
+         fprintf(fp, "chaintype\t%d\t%s\t", (i < NOCHAINTYPE) ? i : -1,
+                 (i < NOCHAINTYPE) ? ChainTypeLabel(i) : "NONE");
+         WriteGroup(fp, &(summary->chainTypes[i]), total, format);
+      }
+      for(i=0; i<=summary->nSubGroups; i++)
+      {
+         if(summary->subgroups[i].chains == 0)
+            continue;
+         fprintf(fp, "subgroup\t%d\t%s\t",
+                 (i < summary->nSubGroups) ? i : -1,
+                 (i < summary->nSubGroups) ? GetSubgroupName(i) :
+                                             "(no match)");
+         WriteGroup(fp, &(summary->subgroups[i]), total, format);
+      }
+   }
+
+   return(!ferror(fp));
+}
+
+
+/************************************************************************/
+/*>static void AddGroup(SUMGROUP *dest, SUMGROUP *src)
+   ---------------------------------------------------
+*//**
+   \param[in,out] dest   Group to add to
+   \param[in]     src    Group to be added
+
+-  18.10.26 Original   By: ACRM
+*/
+static void AddGroup(SUMGROUP *dest, SUMGROUP *src)
+{
+   int i;
+
+   dest->chains    += src->chains;
+   dest->sumScore  += src->sumScore;
+   dest->sumMargin += src->sumMargin;
+   for(i=0; i<SUMMARYSCOREBINS; i++)
+      dest->scoreBins[i] += src->scoreBins[i];
+   for(i=0; i<SUMMARYMARGINBINS; i++)
+      dest->marginBins[i] += src->marginBins[i];
+}
+
+
+/************************************************************************/
+/*>static REAL ScoreQuantile(SUMGROUP *group, REAL fraction)
+   ---------------------------------------------------------
+*//**
+   \param[in]   group      The group
+   \param[in]   fraction   Fraction of the chains (0 to 1)
+   \return                 Score below which that fraction of the
+                           chains lie, interpolated within its bin
+
+-  18.10.26 Original   By: ACRM
+*/
+static REAL ScoreQuantile(SUMGROUP *group, REAL fraction)
+{
+   REAL need  = fraction * group->chains,
+        value;
+   long count = 0;
+   int  bin;
+
+   for(bin=0; bin<SUMMARYSCOREBINS; bin++)
+   {
+      if(group->scoreBins[bin] &&
+         (count + group->scoreBins[bin] >= need))
+      {
+         value = bin + (need - count) / group->scoreBins[bin];
+         return((value > 100.0) ? 100.0 : value);
+      }
+      count += group->scoreBins[bin];
+   }
+   return(0.0);
+}
+
+
+/************************************************************************/
+/*>static int CompareFiles(const void *a, const void *b)
+   -----------------------------------------------------
+*//**
+   \param[in]   a      A SUMFILE
+   \param[in]   b      Another SUMFILE
+   \return             Sorting order by position in the input
+
+-  18.10.26 Original   By: ACRM
+*/
+static int CompareFiles(const void *a, const void *b)
+{
+   return(((SUMFILE *)a)->order - ((SUMFILE *)b)->order);
+}
+
+
+/************************************************************************/
+/*>static void WriteGroup(FILE *fp, SUMGROUP *group, long total,
+                          int format)
+   -------------------------------------------------------------
+*//**
+   \param[in]   fp       Output file
+   \param[in]   group    The group
+   \param[in]   total    Number of chains in the run
+   \param[in]   format   SUMMARY_TSV (writes the rest of a row) or
+                         SUMMARY_JSON (writes the members)
+
+-  18.10.26 Original   By: ACRM
+*/
+static void WriteGroup(FILE *fp, SUMGROUP *group, long total,
+                       int format)
+{
+   REAL n        = (group->chains ? (REAL)group->chains : 1.0),
+        fraction = (total ? (REAL)group->chains / total : 0.0);
+   int  i;
+
+   if(format == SUMMARY_JSON)
+   {
+      fprintf(fp, "\"chains\":%ld,\"fraction\":%.6f,\"mean_score\":%.3f,\
+\"p10\":%.3f,\"p50\":%.3f,\"p90\":%.3f,\"mean_margin\":%.3f,\"margins\":[",
+              group->chains, fraction, group->sumScore / n,
+              ScoreQuantile(group, 0.1), ScoreQuantile(group, 0.5),
+              ScoreQuantile(group, 0.9), group->sumMargin / n);
+      for(i=0; i<SUMMARYMARGINBINS; i++)
+         fprintf(fp, "%s%ld", (i ? "," : ""), group->marginBins[i]);
+      putc(']', fp);
+   }
+   else
+   {
+      fprintf(fp, "%ld\t%.6f\t%.3f\t%.3f\t%.3f\t%.3f\t%.3f",
+              group->chains, fraction, group->sumScore / n,
+              ScoreQuantile(group, 0.1), ScoreQuantile(group, 0.5),
+              ScoreQuantile(group, 0.9), group->sumMargin / n);
+      for(i=0; i<SUMMARYMARGINBINS; i++)
+         fprintf(fp, "\t%ld", group->marginBins[i]);
+      putc('\n', fp);
+   }
+}
+
+
+/************************************************************************/
+/*>static void WriteJSONName(FILE *fp, char *name)
+   -----------------------------------------------
+*//**
+   \param[in]   fp      Output file
+   \param[in]   name    String to write as a quoted JSON string
+
+-  18.10.26 Original   By: ACRM
+*/
+static void WriteJSONName(FILE *fp, char *name)
+{
+   putc('"', fp);
+   for(; *name; name++)
+   {
+      if((*name == '"') || (*name == '\\'))
+         putc('\\', fp);
+      if((unsigned char)*name >= ' ')
+         putc(*name, fp);
+   }
+   putc('"', fp);
+}
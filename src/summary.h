@@ -0,0 +1,112 @@
+/*************************************************************************
+
+   Program:    hsubgroup
+   File:       summary.h
+
+   Version:    V3.24
+   Date:       18.10.26
+   Function:   Summary of the assignments of a whole run
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V3.24 18.10.26   Original
+
+*************************************************************************/
+#ifndef _SUMMARY_H
+#define _SUMMARY_H
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define SUMMARY_TSV         1
+#define SUMMARY_JSON        2
+
+#define SUMMARYSCOREBINS  101  /* Score histogram bins of 1 from 0 to 100
+                                  (the last is for 100)                 */
+#define SUMMARYMARGINBINS   7  /* Margin histogram bins (see summary.c) */
+#define SUMMARYCHAINTYPES   4  /* Heavy, kappa, lambda and no match     */
+
+/* Totals and histograms for a group of chains                          */
+typedef struct
+{
+   long chains,
+        scoreBins[SUMMARYSCOREBINS],
+        marginBins[SUMMARYMARGINBINS];
+   REAL sumScore,
+        sumMargin;
+} SUMGROUP;
+
+/* The chains from one input file. order is its position in the input  */
+typedef struct
+{
+   char     *name;
+   int      order;
+   SUMGROUP group;
+} SUMFILE;
+
+/* The summary of a run, grouped by winning subgroup, chain type and
+   input file. Each thread should collect into its own copy which is
+   merged into the main one with MergeSummary() when the thread
+   finishes, so no locking is needed while scoring
+*/
+typedef struct
+{
+   SUMGROUP all,
+            chainTypes[SUMMARYCHAINTYPES],
+            *subgroups;              /* nSubGroups+1; last is for no
+                                        match                           */
+   SUMFILE  *files;
+   int      nSubGroups,
+            nFiles,
+            maxFiles;
+} SUMMARY;
+
+
+/************************************************************************/
+/* Prototypes
+*/
+int  ParseSummaryFormat(char *name);
+BOOL InitSummary(SUMMARY *summary, int nSubGroups);
+void FreeSummary(SUMMARY *summary);
+BOOL StartSummaryFile(SUMMARY *summary, char *name, int order);
+void AddSummaryChain(SUMMARY *summary, SUBGROUPRESULT *result);
+BOOL MergeSummary(SUMMARY *dest, SUMMARY *src);
+BOOL WriteSummary(FILE *fp, SUMMARY *summary, int format);
+
+#endif
@@ -0,0 +1,149 @@
+/*************************************************************************
+
+   Program:    fmtcheck
+   File:       fmtcheck.c
+
+   Version:    V1.0
+   Date:       18.10.26
+   Function:   Checks FormatReal() against printf()
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Formats values with FormatReal() and with sprintf("%f") and reports
+   any that differ. The values are random numbers, the same numbers
+   half way between two values of the sixth decimal place (as written
+   in decimal, so the nearest double may be either side of the tie),
+   their negatives, zero and negative zero.
+
+**************************************************************************
+
+   Usage:
+   ======
+   fmtcheck [count]
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V1.0  18.10.26   Original
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bioplib/MathType.h"
+#include "bioplib/SysDefs.h"
+#include "../subgroup.h"
+#include "../output.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define DEFAULTCOUNT 1000000
+#define MAXREPORT    10
+
+/************************************************************************/
+/* Prototypes
+*/
+int main(int argc, char **argv);
+static BOOL Check(REAL value, int *nBad);
+
+
+/************************************************************************/
+/*>int main(int argc, char **argv)
+   -------------------------------
+*//**
+   Main program. Exits with status 1 if any value differs
+
+-  18.10.26 Original   By: ACRM
+*/
+int main(int argc, char **argv)
+{
+   char text[64];
+   long count = DEFAULTCOUNT,
+        i;
+   int  nBad  = 0;
+   REAL value;
+
+   if((argc > 1) && (sscanf(argv[1], "%ld", &count) != 1))
+   {
+      fprintf(stderr, "Usage: fmtcheck [count]\n");
+      return(1);
+   }
+
+   srand(1);
+   Check(0.0, &nBad);
+   Check(-0.0, &nBad);
+   Check(-1.0e-9, &nBad);
+   for(i=0; i<count; i++)
+   {
+      /* A tie such as 0.3514505 is read from its decimal text          */
+      sprintf(text, "%d.%06d5", rand() % 1000, rand() % 1000000);
+      value = atof(text);
+      Check(value, &nBad);
+      Check(-value, &nBad);
+
+      value = (REAL)rand() / RAND_MAX * 1000.0;
+      Check(value, &nBad);
+      Check(-value, &nBad);
+   }
+
+   printf("%d of %ld values differ from printf()\n", nBad, 4*count+3);
+   return(nBad ? 1 : 0);
+}
+
+
+/************************************************************************/
+/*>static BOOL Check(REAL value, int *nBad)
+   ----------------------------------------
+*//**
+   \param[in]     value   Value to format
+   \param[in,out] nBad    Count of values that differ
+   \return                FormatReal() matches sprintf()
+
+-  18.10.26 Original   By: ACRM
+*/
+static BOOL Check(REAL value, int *nBad)
+{
+   char fast[64],
+        slow[64];
+
+   FormatReal(fast, value);
+   sprintf(slow, "%f", value);
+   if(strcmp(fast, slow))
+   {
+      if((*nBad)++ < MAXREPORT)
+         fprintf(stderr, "%.17g: FormatReal() gives %s, printf() %s\n",
+                 value, fast, slow);
+      return(FALSE);
+   }
+   return(TRUE);
+}
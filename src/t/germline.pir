@@ -0,0 +1,36 @@
+>P1;c0
+chain 0
+FHHLTQSPGTLSESPGERATLAGNFLMDACCKTHHVIMTWPHDLEHEKNWVVFKDHMANQDHWCARLVITAPRGRVCAFLSYSVCRIHDAQFACVKMDIAVFENHKSGRYFVMGPWHLYKR*
+>P1;c1
+chain 1
+FTQSAGTLSLSFGERATLDAWVARVQNYFGCANWDCEFFAKIWWHDNQNSPTHKVHQIPHEMGPIMVNCHGMLYREAGVNHGKGEHPVQLHDLSTRIYCKMPWFMMRGTERFFAPGFE*
+>P1;c2
+chain 2
+DVLTQPAQVSKSPGQSITIIRLLPNALFEMIITWMFYCNGWKTPCYILMMTYCAQLAEFWLECKCYSSCHHCNKNTIMMSCWFFWHICDCCHNQGHHNIIAQMVPFMFERLPPYEHMWNP*
+>P1;c3
+chain 3
+NKGIVLTQSPGTLSESPGERATLLSCPFYRLMYWENQIEAREMYSYHETAVLQHMQYHGGCSQEGAWCDRWQNHTCNSDNGPIDTKVWCWQFTKQIMQHVEHNVSVGMPEIPQRPYLFHMAVD*
+>P1;c4
+chain 4
+MDIQMRVSPSSLAASVGDRVTVVECDGLQCDEHYFRAGHHHGANTAICYFGEIQFHNCDNLLCHSADTCDSHEEACQRECAVAYKEKLGNCEVMMFTVQDVKVYDREECCDCFHQLVVILD*
+>P1;c5
+chain 5
+VMTQSPESLPVTPAAPWSIAADFISHEDKEHFLFMFVFEWPSICRIVVTSWHLHNLAYSTGPWKFKRPGWYARLQQWQQPGVYPHHDRTWMIPDLEEPAHYPVRPKDIPETLRLKQTRI*
+>P1;c6
+chain 6
+RTNZAALTQPASVSGVPGQSITIDMKSHTNCPQVMSAEMYRRTEKFHARVADFAVCAYDRSPNQAHGAFWDHHIASMIWFQPTSHPKTLIGNAQKNENNGQDDIICHKFMYHCSHYEIATVKAD*
+>P1;c7
+chain 7
+QWLELTQEPAVSVALGQTVRITCTRCMGWHWMPKRYFVPIFMWHIPASLFWHMMKCATDIPWGTWVCTHIITMQMCAVYRMMGISAPCLVQALFFPAQSYFHEMSQDMNHDHYQEWQVFTPQQ*
+>P1;c8
+chain 8
+SVLTQDPNRSVALGQTVRIVPNNISQRITEFHFYWIFMQRRREHARPSHWYRDWGRLCPYLGGRLLASSLNVSMDDSVGRQHMKFKPMAYDRVRNSLPLEACAFAKGCSQWQMPTHFYWAQ*
+>P1;c9
+chain 9
+EALTQPDSASGSPGVSYTISMASQHIRGGFVGRNEILYQQRAPFQTKPYNLQSYWEMEGFLTTGDRSQYETVSPVPNLLRSRLKSIMHTVVQLEVCMPSEDERMLPDNHSDDRNMLEPCH*
+>P1;c10
+chain 10
+PSYELTEWPSESVSPHRTARIWRYDDFSNKCKHYTGTVTGRGVQQFWIALWCYCGPRFTYHVRHEFVEKLAVWNMLTTCMAAPRGYYPHWAHFSCNPQGSGGTYGREYVHAWKANDMQNWS*
+>P1;c11
+chain 11
+MSYRLTQPPSVSVSPGQTARLCINWNWEKMQCYEVWIGWWPAHNIDTHVHYTYSFQVANQEFSQMERVQKARNALMFPMVSDMTPCVATRSFIWEMEHFINKFCQLLKQDTAKELCYHKCE*
@@ -0,0 +1,38 @@
+>P1;ChainL
+Indel variant of 1yqv
+MDIVLTQSPAIMSASPGEKVTMTCSASSSV
+NYMYWYQQKSGTSPKRWIYDTSKLASGVPV
+RFSGSGSGTSYSLTISSMETEDAATYYCQQ
+WGRNPTFGGGTKLEIKRADAAPTVSIFPPS*
+>P1;ChainL_ins
+Indel variant of 1yqv
+MDIVLTQSGPAIMSASPGEKVTMTCSASSS
+VNYMYWYQQKSGTSPKRWIYDTSKLASGVP
+VRFSGSGSGTSYSLTISSMETEDAATYYCQ
+QWGRNPTFGGGTKLEIKRADAAPTVSIFPP
+S*
+>P1;ChainL_del
+Indel variant of 1yqv
+MDIVLTQSAIMSASPGEKVTMTCSASSSVN
+YMYWYQQKSGTSPKRWIYDTSKLASGVPVR
+FSGSGSGTSYSLTISSMETEDAATYYCQQW
+GRNPTFGGGTKLEIKRADAAPTVSIFPPS*
+>P1;ChainH
+Indel variant of 1yqv
+EVQLQQSGAELMKPGASVKISCKASGYTFS
+DYWIEWVKQRPGHGLEWIGEILPGSGSTNY
+HERFKGKATFTADTSSSTAYMQLNSLTSED
+SGVYYCLHGNYDFDGWGQGTTLTVSSAKTT*
+>P1;ChainH_ins
+Indel variant of 1yqv
+EVQLQQSGGAELMKPGASVKISCKASGYTF
+SDYWIEWVKQRPGHGLEWIGEILPGSGSTN
+YHERFKGKATFTADTSSSTAYMQLNSLTSE
+DSGVYYCLHGNYDFDGWGQGTTLTVSSAKT
+T*
+>P1;ChainH_del
+Indel variant of 1yqv
+EVQLQQSGELMKPGASVKISCKASGYTFSD
+YWIEWVKQRPGHGLEWIGEILPGSGSTNYH
+ERFKGKATFTADTSSSTAYMQLNSLTSEDS
+GVYYCLHGNYDFDGWGQGTTLTVSSAKTT*
@@ -0,0 +1,24 @@
+>P1;scFv
+Synthetic construct from 1yqv
+EVQLQQSGAELMKPGASVKISCKASGYTFS
+DYWIEWVKQRPGHGLEWIGEILPGSGSTNY
+HERFKGKATFTADTSSSTAYMQLNSLTSED
+SGVYYCLHGNYDFDGWGQGTTLTVSSGGGG
+SGGGGSGGGGSMDIVLTQSPAIMSASPGEK
+VTMTCSASSSVNYMYWYQQKSGTSPKRWIY
+DTSKLASGVPVRFSGSGSGTSYSLTISSME
+TEDAATYYCQQWGRNPTFGGGTKLEIKR*
+>P1;Fusion
+Synthetic construct from 1yqv
+DIVLTQSPAIMSASPGEKVTMTCSASSSVN
+YMYWYQQKSGTSPKRWIYDTSKLASGVPVR
+FSGSGSGTSYSLTISSMETEDAATYYCQQW
+GRNPTFGGGTKLEIKRADAAPTVSIFPPSS
+EQLTSGGASVVCFLNNFYPKDINVKWKIDG
+SERQNGVLNSWTDQDSKDSTYSMSSTLTLT
+KDEYERHNSYTCEATHKTSTSPIVKSFNRN
+GGGGSGGGGSGGGGSEVQLQQSGAELMKPG
+ASVKISCKASGYTFSDYWIEWVKQRPGHGL
+EWIGEILPGSGSTNYHERFKGKATFTADTS
+SSTAYMQLNSLTSEDSGVYYCLHGNYDFDG
+WGQGTTLTVSS*
@@ -29,3 +29,448 @@ if [ $? -ne 0 ]; then
 else
    echo "hsubgroup (with datafile): test passed";
 fi
+
+rm -f ./test.out
+
+../hsubgroup -F tsv ./test.pir > test.out
+
+diff -w test.tsv.compare test.out
+
+if [ $? -ne 0 ]; then
+   echo "hsubgroup (TSV output): unexpected output!";
+   exit 1
+else
+   echo "hsubgroup (TSV output): test passed";
+fi
+
+rm -f ./test.out
+
+../hsubgroup -v -k 3 ./test.pir > test.out
+
+diff -w test.top3.compare test.out
+
+if [ $? -ne 0 ]; then
+   echo "hsubgroup (top 3 ranking): unexpected output!";
+   exit 1
+else
+   echo "hsubgroup (top 3 ranking): test passed";
+fi
+
+rm -f ./test.out
+
+../hsgen -d $datafile -n 6 -s 42 -t 6 -e 5 -x 0.02 -u 0.3 -l 20:30 -F fasta > test.out
+
+diff -w test.gen.compare test.out
+
+if [ $? -ne 0 ]; then
+   echo "hsgen (synthetic sequences): unexpected output!";
+   exit 1
+else
+   echo "hsgen (synthetic sequences): test passed";
+fi
+
+rm -f ./test.out ./test.shard*
+
+../hsubgroup -F tsv --shard 1/3 ./test.pir test.shard1
+../hsubgroup -F tsv --shard 2/3 ./test.pir test.shard2
+../hsubgroup -F tsv --shard 3/3 ./test.pir test.shard3
+../hsmerge test.shard1 test.shard2 test.shard3 > test.out
+
+diff -w test.tsv.compare test.out
+
+if [ $? -ne 0 ]; then
+   echo "hsubgroup (shards merged): unexpected output!";
+   exit 1
+else
+   echo "hsubgroup (shards merged): test passed";
+fi
+
+rm -f ./test.shard*
+
+rm -f ./test.out ./test.pir.tsv
+
+../hsubgroup -F tsv -j 2 -L - <<END
+./test.pir
+END
+
+diff -w test.tsv.compare test.pir.tsv
+
+if [ $? -ne 0 ]; then
+   echo "hsubgroup (many-files mode): unexpected output!";
+   exit 1
+else
+   echo "hsubgroup (many-files mode): test passed";
+fi
+
+rm -f ./test.pir.tsv
+
+rm -f ./test.out
+
+../hsubgroup -F tsv -mf ../../data/mouse_full.dat ./test.pir test.out
+
+diff -w test.models.compare test.out
+
+if [ $? -ne 0 ]; then
+   echo "hsubgroup (several models): unexpected output!";
+   exit 1
+else
+   echo "hsubgroup (several models): test passed";
+fi
+
+rm -f ./test.out
+
+rm -f ./test.out
+
+../hsubgroup -F tsv --mutscan ./1yqv.pir test.out
+
+diff -w test.mutscan.compare test.out
+
+if [ $? -ne 0 ]; then
+   echo "hsubgroup (mutational scan): unexpected output!";
+   exit 1
+else
+   echo "hsubgroup (mutational scan): test passed";
+fi
+
+rm -f ./test.out
+
+../hsubgroup -F tsv --humanise 12 --margin=5 ./1yqv.pir test.out
+
+diff -w test.humanise.compare test.out
+
+if [ $? -ne 0 ]; then
+   echo "hsubgroup (humanisation): unexpected output!";
+   exit 1
+else
+   echo "hsubgroup (humanisation): test passed";
+fi
+
+rm -f ./test.out
+
+../hsubgroup -F tsv --domains ./scfv.pir test.out
+
+diff -w test.domains.compare test.out
+
+if [ $? -ne 0 ]; then
+   echo "hsubgroup (domain scan): unexpected output!";
+   exit 1
+else
+   echo "hsubgroup (domain scan): test passed";
+fi
+
+rm -f ./test.out
+
+../hsubgroup -F tsv --dna ./1yqv.fna test.out
+
+diff -w test.dna.compare test.out
+
+if [ $? -ne 0 ]; then
+   echo "hsubgroup (nucleotide input): unexpected output!";
+   exit 1
+else
+   echo "hsubgroup (nucleotide input): test passed";
+fi
+
+rm -f ./test.out
+
+../hsubgroup -F tsv --gapped ./indel.pir test.out
+
+diff -w test.gapped.compare test.out
+
+if [ $? -ne 0 ]; then
+   echo "hsubgroup (gapped alignment): unexpected output!";
+   exit 1
+else
+   echo "hsubgroup (gapped alignment): test passed";
+fi
+
+rm -f ./test.out
+
+../hsubgroup -F tsv -d ./vdomain.dat ./indel.pir test.out
+
+diff -w test.vdomain.compare test.out
+
+if [ $? -ne 0 ]; then
+   echo "hsubgroup (variable-domain profiles): unexpected output!";
+   exit 1
+else
+   echo "hsubgroup (variable-domain profiles): test passed";
+fi
+
+rm -f ./test.out
+
+../hsubgroup -F tsv -k 3 -d ./germline.dat ./germline.pir test.out
+
+diff -w test.germline.compare test.out
+
+if [ $? -ne 0 ]; then
+   echo "hsubgroup (indexed germline profiles): unexpected output!";
+   exit 1
+else
+   echo "hsubgroup (indexed germline profiles): test passed";
+fi
+
+rm -f ./test.out
+
+../hsubgroup -F tsv --gapped --split=3 ./indel.pir test.out
+
+diff -w test.gapped.compare test.out
+
+if [ $? -ne 0 ]; then
+   echo "hsubgroup (split between threads): unexpected output!";
+   exit 1
+else
+   echo "hsubgroup (split between threads): test passed";
+fi
+
+rm -f ./test.out
+
+../hsubgroup -F tsv --pvalues ./test.pir test.out
+
+diff -w test.pvalues.compare test.out
+
+if [ $? -ne 0 ]; then
+   echo "hsubgroup (p-values): unexpected output!";
+   exit 1
+else
+   echo "hsubgroup (p-values): test passed";
+fi
+
+rm -f ./test.out
+
+../hsubgroup --summary -j 2 ./test.pir ./indel.pir ./test.pir > test.out
+
+diff -w test.summary.compare test.out
+
+if [ $? -ne 0 ]; then
+   echo "hsubgroup (summary): unexpected output!";
+   exit 1
+else
+   echo "hsubgroup (summary): test passed";
+fi
+
+rm -f ./test.out
+
+# Times and memory vary from run to run so are masked; the counts and
+# the layout must match
+../hsubgroup --stats ./test.pir 2> test.stats > test.out
+
+diff -w test.out.compare test.out && \
+sed -e 's/[0-9][0-9]*\.[0-9][0-9]*$/TIME/' \
+    -e 's/^\( *Peak RSS (KB) *\)[0-9][0-9]*$/\1RSS/' test.stats | \
+diff -w test.stats.compare -
+
+if [ $? -ne 0 ]; then
+   echo "hsubgroup (run statistics): unexpected output!";
+   exit 1
+else
+   echo "hsubgroup (run statistics): test passed";
+fi
+
+rm -f ./test.out ./test.stats
+
+../hsubgroup --stats=json ./test.pir 2> test.stats > test.out
+
+diff -w test.out.compare test.out && \
+sed -e 's/\("[a-z0-9_]*":\)[0-9][0-9]*\.[0-9][0-9]*/\1TIME/g' \
+    -e 's/"peak_rss_kb":[0-9][0-9]*/"peak_rss_kb":RSS/' test.stats | \
+diff -w test.statsjson.compare -
+
+if [ $? -ne 0 ]; then
+   echo "hsubgroup (run statistics JSON): unexpected output!";
+   exit 1
+else
+   echo "hsubgroup (run statistics JSON): test passed";
+fi
+
+rm -f ./test.out ./test.stats
+
+# --perf implies --stats. Which counters can be opened depends on the
+# machine, so the table is checked for its layout: a row of stage names
+# then one row of five numbers per counter, or a note that there are
+# none
+../hsubgroup --perf ./test.pir 2> test.stats > test.out
+
+diff -w test.out.compare test.out && \
+sed -n '/^Performance counters/q;p' test.stats | \
+sed -e 's/[0-9][0-9]*\.[0-9][0-9]*$/TIME/' \
+    -e 's/^\( *Peak RSS (KB) *\)[0-9][0-9]*$/\1RSS/' | \
+diff -w test.stats.compare - && \
+sed -n '/^Performance counters/,$p' test.stats | awk '
+   NR==1 && /^Performance counters unavailable/  { none=1; next }
+   NR==1 && /^Performance counters/              { next }
+   NR==2 && none && /^   Software timing only$/  { ok=1; next }
+   NR==2 && !none && $1=="load" && $2=="parse/chain" && \
+      $3=="score/chain" && $4=="output/chain" && $5=="score/eval" && \
+      NF==5                                      { next }
+   NR>2 && !none && NF==6 && $2$3$4$5$6 ~ /^[0-9.]+$/ { ok=1; next }
+                                                 { bad=1 }
+   END { exit((ok && !bad) ? 0 : 1) }'
+
+if [ $? -ne 0 ]; then
+   echo "hsubgroup (performance counters): unexpected output!";
+   exit 1
+else
+   echo "hsubgroup (performance counters): test passed";
+fi
+
+rm -f ./test.out ./test.stats
+
+# Watch mode. A file renamed into the directory must be scored, its
+# output written to done and the input moved there. The program is then
+# stopped with SIGTERM and must exit cleanly
+rm -rf ./test.watch
+mkdir test.watch
+
+../hsubgroup -F tsv --watch test.watch &
+pid=$!
+cp ./test.pir test.watch/.test.pir
+mv test.watch/.test.pir test.watch/test.pir
+for i in $(seq 200)
+do
+   [ -f test.watch/done/test.pir ] && break
+   sleep 0.05
+done
+kill -TERM $pid
+wait $pid && \
+[ ! -f test.watch/test.pir ] && \
+diff -w test.tsv.compare test.watch/done/test.pir.tsv
+
+if [ $? -ne 0 ]; then
+   echo "hsubgroup (watch mode): unexpected output!";
+   exit 1
+else
+   echo "hsubgroup (watch mode): test passed";
+fi
+
+rm -rf ./test.watch
+
+# A run with checkpoints is killed once it has written one, then
+# resumed. The result must be the same as an uninterrupted run. A resume
+# with a different data file or options must be refused and leave the
+# output alone, even though human.dat gives the same subgroups as the
+# built-in data
+rm -f ./test.out ./test.big*
+for i in $(seq 2000)
+do
+   cat ./test.pir
+done > test.big.pir
+
+../hsubgroup ./test.big.pir test.big.compare
+
+../hsubgroup --checkpoint=0.05 ./test.big.pir test.out &
+pid=$!
+while kill -0 $pid 2>/dev/null && [ ! -s test.out.ckpt ]
+do
+   sleep 0.01
+done
+kill -9 $pid 2>/dev/null
+wait $pid 2>/dev/null
+cp test.out test.big.killed
+
+[ -s test.out.ckpt ] && \
+! ../hsubgroup --resume -d $datafile ./test.big.pir test.out \
+   2> /dev/null && \
+! ../hsubgroup --resume -x ./test.big.pir test.out 2> /dev/null && \
+! ../hsubgroup --resume --gapped ./test.big.pir test.out \
+   2> /dev/null && \
+! ../hsubgroup --resume --pvalues ./test.big.pir test.out \
+   2> /dev/null && \
+cmp -s test.out test.big.killed && \
+../hsubgroup --resume ./test.big.pir test.out && \
+[ ! -f test.out.ckpt ] && \
+cmp test.big.compare test.out
+
+if [ $? -ne 0 ]; then
+   echo "hsubgroup (checkpoint and resume): unexpected output!";
+   exit 1
+else
+   echo "hsubgroup (checkpoint and resume): test passed";
+fi
+
+rm -f ./test.out ./test.out.ckpt ./test.big*
+
+# Several configurations. Each configuration's rows, without the model
+# column, must be the same as a separate run with those options. The
+# sums and products (-p) can't be compared so there must be no winner
+# column
+rm -f ./test.out ./test.config
+
+../hsubgroup -F tsv --config x --config p \
+   --config f:../../data/mouse_full.dat ./test.pir > test.out
+
+head -1 test.out | grep -q $'\tmodel\tchaintype\t'
+status=$?
+for config in "builtin|" "x:builtin|-x" "p:builtin|-p" \
+   "f:mouse_full|-f -d ../../data/mouse_full.dat"
+do
+   label=${config%|*}
+   options=${config#*|}
+   awk -F'\t' -v label="$label" '$3 == label' test.out | \
+      cut -f1,2,4- > test.config
+   ../hsubgroup -F tsv $options ./test.pir | grep -v '^#' | \
+      diff -w - test.config || status=1
+   [ -s test.config ] || status=1
+done
+
+if [ $status -ne 0 ]; then
+   echo "hsubgroup (several configurations): unexpected output!";
+   exit 1
+else
+   echo "hsubgroup (several configurations): test passed";
+fi
+
+rm -f ./test.out ./test.config
+
+# The static tracepoints. Each file with probes is compiled with
+# NO_PROBES, which must leave no notes, and, if <sys/sdt.h> is there,
+# with HAVE_SYS_SDT_H, which must leave a note for each probe
+CC=${CC:-cc}
+COPT=${COPT:-}
+rm -f ./test.out ./probes.o
+
+for file in hsubgroup filepool sophie
+do
+   $CC $COPT -DNO_PROBES -c -o probes.o ../$file.c || exit 1
+   readelf -n probes.o | sed -n 's/^ *Name: //p' >> test.out
+done
+
+if [ -s test.out ]; then
+   echo "hsubgroup (probes disabled): unexpected output!";
+   exit 1
+else
+   echo "hsubgroup (probes disabled): test passed";
+fi
+
+rm -f ./test.out ./probes.o
+
+if echo '#include <sys/sdt.h>' | $CC -E -x c - > /dev/null 2>&1; then
+   for file in hsubgroup filepool sophie
+   do
+      $CC $COPT -DHAVE_SYS_SDT_H -c -o probes.o ../$file.c || exit 1
+      readelf -n probes.o | sed -n 's/^ *Name: //p' >> test.out
+   done
+   LC_ALL=C sort -u test.out | diff -w test.probes.compare -
+
+   if [ $? -ne 0 ]; then
+      echo "hsubgroup (probes enabled): unexpected output!";
+      exit 1
+   else
+      echo "hsubgroup (probes enabled): test passed";
+   fi
+else
+   echo "hsubgroup (probes enabled): skipped, no <sys/sdt.h>";
+fi
+
+rm -f ./test.out ./probes.o
+
+./fmtcheck 200000 > test.out
+
+if [ $? -ne 0 ]; then
+   echo "FormatReal (same as printf): unexpected output!";
+   exit 1
+else
+   echo "FormatReal (same as printf): test passed";
+fi
+
+rm -f ./test.out
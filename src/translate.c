@@ -0,0 +1,268 @@
+/*************************************************************************
+
+   Program:    hsubgroup
+   File:       translate.c
+
+   Version:    V3.19
+   Date:       18.10.26
+   Function:   Translation of nucleotide chains
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Frames are numbered 1 to 3 for the forward strand (starting at the
+   first, second and third nucleotide) and -1 to -3 for the reverse
+   complement (starting at the last, second last and third last).
+
+   Each nucleotide is looked up in a table giving a 2-bit code (A, C,
+   G and T or U) and the three codes for a codon index the standard
+   genetic code. A codon with any other character (N and the other
+   ambiguity codes) is translated as X. The reverse strand is read
+   backwards using the complement of each code, so it is never built.
+
+   Only the residues that affect scoring are needed so only as many
+   codons of a frame are translated as the longest profile and the
+   largest extension use (MAXFRAMECODONS for the standard profiles).
+   Translation also stops at a stop codon as a stop ends a chain in
+   the input.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V3.17 18.10.26   Original
+   V3.19 18.10.26   Translates enough codons for the longest profile
+   V3.26 18.10.26   Frames are only compared on one score scale
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bioplib/MathType.h"
+#include "bioplib/SysDefs.h"
+#include "subgroup.h"
+#include "translate.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define NUCOTHER  4        /* Code for anything other than A, C, G, T/U */
+
+/* The standard genetic code indexed by 16*first + 4*second + third
+   with A=0, C=1, G=2 and T=3
+*/
+#define GENETICCODE "KNKNTTTTRSRSIIMIQHQHPPPPRRRRLLLLEDEDAAAAGGGGVVVV\
+*Y*YSSSS*CWCLFLF"
+
+/************************************************************************/
+/* Globals
+*/
+static unsigned char sNucCode[256];
+static BOOL          sNucCodeReady = FALSE;
+
+/************************************************************************/
+/* Prototypes
+*/
+static void InitNucCode(void);
+
+
+/************************************************************************/
+/*>static void InitNucCode(void)
+   -----------------------------
+*//**
+   Fills in the table of nucleotide codes
+
+-  18.10.26 Original   By: ACRM
+*/
+static void InitNucCode(void)
+{
+   int i;
+
+   for(i=0; i<256; i++)
+      sNucCode[i] = NUCOTHER;
+   sNucCode['A'] = sNucCode['a'] = 0;
+   sNucCode['C'] = sNucCode['c'] = 1;
+   sNucCode['G'] = sNucCode['g'] = 2;
+   sNucCode['T'] = sNucCode['t'] = 3;
+   sNucCode['U'] = sNucCode['u'] = 3;
+   sNucCodeReady = TRUE;
+}
+
+
+/************************************************************************/
+/*>int TranslateFrame(char *dna, int length, int frame, char *protein,
+                      int maxCodons)
+   -------------------------------------------------------------------
+*//**
+   \param[in]   dna        Nucleotide sequence
+   \param[in]   length     Length of the nucleotide sequence
+   \param[in]   frame      Frame (1 to 3 or -1 to -3)
+   \param[out]  protein    Translation (NUL terminated; must have space
+                           for maxCodons+1 characters)
+   \param[in]   maxCodons  Most codons to translate
+   \return                 Length of the translation
+
+   Translates the start of a frame up to the first stop codon
+
+-  18.10.26 Original   By: ACRM
+*/
+int TranslateFrame(char *dna, int length, int frame, char *protein,
+                   int maxCodons)
+{
+   unsigned char *nuc = (unsigned char *)dna;
+   int           nCodons, i, pos, step,
+                 c1, c2, c3;
+   char          aa;
+
+   if(!sNucCodeReady)
+      InitNucCode();
+
+   /* Position of the first nucleotide of the first codon and the
+      direction of reading
+   */
+   if(frame > 0)
+   {
+      pos  = frame - 1;
+      step = 1;
+   }
+   else
+   {
+      pos  = length + frame;
+      step = -1;
+   }
+
+   nCodons = (length - ((frame > 0) ? frame : -frame) + 1) / 3;
+   if(nCodons > maxCodons)
+      nCodons = maxCodons;
+
+   for(i=0; i<nCodons; i++, pos += 3*step)
+   {
+      c1 = sNucCode[nuc[pos]];
+      c2 = sNucCode[nuc[pos+step]];
+      c3 = sNucCode[nuc[pos+2*step]];
+
+      if((c1 == NUCOTHER) || (c2 == NUCOTHER) || (c3 == NUCOTHER))
+      {
+         aa = 'X';
+      }
+      else
+      {
+         /* The complement of a code is 3 minus the code                */
+         if(step < 0)
+         {
+            c1 = 3 - c1;
+            c2 = 3 - c2;
+            c3 = 3 - c3;
+         }
+         if((aa = GENETICCODE[(c1 << 4) | (c2 << 2) | c3]) == '*')
+            break;
+      }
+      protein[i] = aa;
+   }
+   protein[i] = '\0';
+   return(i);
+}
+
+
+/************************************************************************/
+/*>int BestFrame(SUBGROUPMODEL **models, int nModels, char *dna,
+                 int nFrames, SUBGROUPRESULT *results,
+                 SUBGROUPRESULT *work)
+   -------------------------------------------------------------
+*//**
+   \param[in]   models     The models
+   \param[in]   nModels    Number of models
+   \param[in]   dna        Nucleotide sequence
+   \param[in]   nFrames    DNAFRAMES_FORWARD or DNAFRAMES_ALL
+   \param[out]  results    Result for each model in the best frame
+   \param[out]  work       Space for nModels results
+   \return                 The best frame (0 if there is no memory)
+
+   Scores the translation of each frame and keeps the results from the
+   frame where the best model scores highest. If the models mix sums
+   and products (-p) only the first model's score is used. The first
+   frame wins a tie.
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 Translates enough codons for the longest profile
+-  18.10.26 Uses the first model if the scores can't be compared
+*/
+int BestFrame(SUBGROUPMODEL **models, int nModels, char *dna,
+              int nFrames, SUBGROUPRESULT *results,
+              SUBGROUPRESULT *work)
+{
+   char *protein;
+   int  length    = strlen(dna),
+        maxCodons = 0,
+        bestFrame = 0,
+        nCompare,         /* Models whose scores are compared      */
+        f, frame, m;
+   REAL score,
+        bestScore = 0.0;
+
+   for(m=0; m<nModels; m++)
+   {
+      if(models[m]->refLength > maxCodons)
+         maxCodons = models[m]->refLength;
+   }
+   maxCodons += MAXEXTENSION - 1;
+   nCompare   = SameScoreScale(models, nModels) ? nModels : 1;
+   if((protein = (char *)malloc(maxCodons + 1))==NULL)
+      return(0);
+
+   for(f=0; f<nFrames; f++)
+   {
+      frame = (f < DNAFRAMES_FORWARD) ? (f + 1) :
+                                        (DNAFRAMES_FORWARD - 1 - f);
+      TranslateFrame(dna, length, frame, protein, maxCodons);
+      if(!ScoreSubgroupModels(models, nModels, protein, work))
+      {
+         free(protein);
+         return(0);
+      }
+
+      m     = BestModel(work, nCompare);
+      score = (m >= 0) ? work[m].score : 0.0;
+      if((bestFrame == 0) || (score > bestScore))
+      {
+         bestFrame = frame;
+         bestScore = score;
+         for(m=0; m<nModels; m++)
+            results[m] = work[m];
+      }
+   }
+   free(protein);
+   return(bestFrame);
+}
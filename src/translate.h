@@ -0,0 +1,75 @@
+/*************************************************************************
+
+   Program:    hsubgroup
+   File:       translate.h
+
+   Version:    V3.19
+   Date:       18.10.26
+   Function:   Translation of nucleotide chains
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Translates nucleotide chains so that they can be assigned to
+   subgroups without a separate translation step.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V3.17 18.10.26   Original
+   V3.19 18.10.26   MAXFRAMECODONS is for the standard profile length
+
+*************************************************************************/
+#ifndef _TRANSLATE_H
+#define _TRANSLATE_H
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define DNAFRAMES_FORWARD  3
+#define DNAFRAMES_ALL      6
+#define MAXFRAMECODONS     (MAXREFSEQLEN + MAXEXTENSION - 1) /* Codons
+                              translated for each frame with standard
+                              length profiles                          */
+
+/************************************************************************/
+/* Prototypes
+*/
+int TranslateFrame(char *dna, int length, int frame, char *protein,
+                   int maxCodons);
+int BestFrame(SUBGROUPMODEL **models, int nModels, char *dna,
+              int nFrames, SUBGROUPRESULT *results,
+              SUBGROUPRESULT *work);
+
+#endif
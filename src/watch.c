@@ -0,0 +1,309 @@
+/*************************************************************************
+
+   Program:    hsubgroup
+   File:       watch.c
+
+   Version:    V3.25
+   Date:       18.10.26
+   Function:   Watch a spool directory for new input files
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   --watch mode. The model stays loaded and files that appear in the
+   spool directory are classified on the worker pool. Files must be
+   renamed into the directory once complete (e.g. written as a dot
+   file or in another directory on the same file system and then
+   moved), since only rename events (IN_MOVED_TO) are acted on. Names
+   starting with '.' are ignored. Files already in the directory at
+   startup are processed first.
+
+   Each output is written to the done subdirectory (or the -O
+   directory) and the input is then moved to done or, if it could not
+   be read or the output written, to failed. Runs until interrupted
+   (SIGINT or SIGTERM); files already queued are finished first.
+
+   inotify is Linux-specific; elsewhere --watch gives an error.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V3.11 18.10.26   Original
+   V3.25 18.10.26   Directory paths are built with snprintf()
+
+*************************************************************************/
+/* Includes
+*/
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#  include <sys/inotify.h>
+#endif
+#include "bioplib/MathType.h"
+#include "bioplib/SysDefs.h"
+#include "subgroup.h"
+#include "stats.h"
+#include "summary.h"
+#include "filepool.h"
+#include "watch.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define EVENTBUFFSIZE 65536
+
+/************************************************************************/
+/* Globals
+*/
+static volatile sig_atomic_t sStop = 0;
+
+/************************************************************************/
+/* Prototypes
+*/
+static void StopWatching(int sig);
+static BOOL MakeDirectory(char *parent, char *name, char *path);
+static BOOL QueueIfFile(FILEPOOL *pool, char *dir, char *name);
+static BOOL ScanDirectory(FILEPOOL *pool, char *dir);
+
+
+/************************************************************************/
+/*>static void StopWatching(int sig)
+   ---------------------------------
+*//**
+   \param[in]   sig    Signal number
+
+   Signal handler to stop watching
+
+-  18.10.26 Original   By: ACRM
+*/
+static void StopWatching(int sig)
+{
+   sStop = 1;
+}
+
+
+/************************************************************************/
+/*>static BOOL MakeDirectory(char *parent, char *name, char *path)
+   ---------------------------------------------------------------
+*//**
+   \param[in]   parent   Parent directory
+   \param[in]   name     Subdirectory name
+   \param[out]  path     Full path (MAXBUFF characters)
+   \return               The directory exists (FALSE if the path is too
+                         long)
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 snprintf() to catch a path that is too long
+*/
+static BOOL MakeDirectory(char *parent, char *name, char *path)
+{
+   int length = snprintf(path, MAXBUFF, "%s/%s", parent, name);
+
+   if((length < 0) || (length >= MAXBUFF))
+      return(FALSE);
+   return((mkdir(path, 0777) == 0) || (errno == EEXIST));
+}
+
+
+/************************************************************************/
+/*>static BOOL QueueIfFile(FILEPOOL *pool, char *dir, char *name)
+   --------------------------------------------------------------
+*//**
+   \param[in]   pool    The worker pool
+   \param[in]   dir     Spool directory
+   \param[in]   name    Name in the directory
+   \return              Success (FALSE if no memory)
+
+   Queues a regular file unless its name starts with '.' or the path
+   is too long
+
+-  18.10.26 Original   By: ACRM
+-  18.10.26 snprintf() to catch a path that is too long
+*/
+static BOOL QueueIfFile(FILEPOOL *pool, char *dir, char *name)
+{
+   char        path[MAXBUFF];
+   struct stat st;
+   int         length;
+
+   if(name[0] == '.')
+      return(TRUE);
+   length = snprintf(path, MAXBUFF, "%s/%s", dir, name);
+   if((length < 0) || (length >= MAXBUFF))
+      return(TRUE);
+   if(stat(path, &st) || !S_ISREG(st.st_mode))
+      return(TRUE);
+   return(QueueFile(pool, path));
+}
+
+
+/************************************************************************/
+/*>static BOOL ScanDirectory(FILEPOOL *pool, char *dir)
+   ----------------------------------------------------
+*//**
+   \param[in]   pool    The worker pool
+   \param[in]   dir     Spool directory
+   \return              Success
+
+   Queues the files already in the directory
+
+-  18.10.26 Original   By: ACRM
+*/
+static BOOL ScanDirectory(FILEPOOL *pool, char *dir)
+{
+   DIR           *dp;
+   struct dirent *entry;
+   BOOL          ok = TRUE;
+
+   if((dp = opendir(dir))==NULL)
+      return(FALSE);
+   while(ok && ((entry = readdir(dp)) != NULL))
+      ok = QueueIfFile(pool, dir, entry->d_name);
+   closedir(dp);
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>int WatchDirectory(POOLOPTIONS *opts, int format, BOOL verbose,
+                      int topK, BOOL doStats, RUNSTATS *stats)
+   ---------------------------------------------------------------
+*//**
+   \param[in,out] opts      Many-files options with the watch directory
+                            (the done and failed directories are set)
+   \param[in]     format    OUTFORMAT_ value
+   \param[in]     verbose   Verbose text output
+   \param[in]     topK      Number of subgroups ranked
+   \param[in]     doStats   Collect statistics
+   \param[in,out] stats     Statistics from the workers are added here
+   \return                  Number of files that failed (-1 if the
+                            directory could not be watched)
+
+   Processes files as they arrive until interrupted. The model must
+   already be loaded.
+
+-  18.10.26 Original   By: ACRM
+*/
+int WatchDirectory(POOLOPTIONS *opts, int format, BOOL verbose,
+                   int topK, BOOL doStats, RUNSTATS *stats)
+{
+#ifdef __linux__
+   static char      events[EVENTBUFFSIZE];
+   struct sigaction action;
+   FILEPOOL         *pool;
+   int              fd;
+   BOOL             ok = TRUE;
+
+   if(!MakeDirectory(opts->watchDir, WATCHDONE, opts->doneDir) ||
+      !MakeDirectory(opts->watchDir, WATCHFAILED, opts->failedDir))
+   {
+      fprintf(stderr, "hsubgroup Error: Unable to create done and \
+failed directories in %s\n", opts->watchDir);
+      return(-1);
+   }
+   if(!opts->outDir[0])
+      strcpy(opts->outDir, opts->doneDir);
+
+   /* Watch before scanning so nothing is missed. A file seen twice is
+      skipped by the worker once it has been moved
+   */
+   if(((fd = inotify_init()) < 0) ||
+      (inotify_add_watch(fd, opts->watchDir, IN_MOVED_TO) < 0))
+   {
+      fprintf(stderr, "hsubgroup Error: Unable to watch %s\n",
+              opts->watchDir);
+      return(-1);
+   }
+
+   /* No SA_RESTART so that read() is interrupted                       */
+   action.sa_handler = StopWatching;
+   action.sa_flags   = 0;
+   sigemptyset(&action.sa_mask);
+   sigaction(SIGINT,  &action, NULL);
+   sigaction(SIGTERM, &action, NULL);
+   
+   if((pool = StartFilePool(opts, format, verbose, topK, doStats,
+                            opts->nThreads))==NULL)
+   {
+      close(fd);
+      return(-1);
+   }
+
+   ok = ScanDirectory(pool, opts->watchDir);
+   
+   while(ok && !sStop)
+   {
+      ssize_t nRead = read(fd, events, EVENTBUFFSIZE);
+      char    *chp;
+
+      if(nRead <= 0)
+      {
+         if((nRead < 0) && (errno == EINTR))
+            continue;
+         fprintf(stderr, "hsubgroup Error: Unable to read events for \
+%s\n", opts->watchDir);
+         break;
+      }
+
+      for(chp=events; chp < events + nRead; )
+      {
+         struct inotify_event *event = (struct inotify_event *)chp;
+
+         if(event->mask & IN_Q_OVERFLOW)
+            ok = ok && ScanDirectory(pool, opts->watchDir);
+         else if(event->len && !(event->mask & IN_ISDIR))
+            ok = ok && QueueIfFile(pool, opts->watchDir, event->name);
+         chp += sizeof(struct inotify_event) + event->len;
+      }
+   }
+   close(fd);
+
+   if(!ok)
+      fprintf(stderr, "hsubgroup Error: Unable to queue files from %s\n",
+              opts->watchDir);
+   return(FinishFilePool(pool, stats));
+#else
+   fprintf(stderr, "hsubgroup Error: --watch is only available on \
+Linux\n");
+   return(-1);
+#endif
+}
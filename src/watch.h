@@ -0,0 +1,66 @@
+/*************************************************************************
+
+   Program:    hsubgroup
+   File:       watch.h
+
+   Version:    V3.11
+   Date:       18.10.26
+   Function:   Watch a spool directory for new input files
+
+   Copyright:  (c) Dr. Andrew C. R. Martin / UCL 1997-2026
+   Author:     Dr. Andrew C. R. Martin
+   Address:    Biomolecular Structure & Modelling Unit,
+               Department of Biochemistry & Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   EMail:      andrew@bioinf.org.uk
+
+**************************************************************************
+
+   This program is not in the public domain, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified. If someone
+   else breaks this code, I don't want to be blamed for code that does not
+   work!
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+   V3.11 18.10.26   Original
+
+*************************************************************************/
+#ifndef _WATCH_H
+#define _WATCH_H
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define WATCHDONE     "done"    /* Subdirectories for processed inputs  */
+#define WATCHFAILED   "failed"
+
+/************************************************************************/
+/* Prototypes
+*/
+int WatchDirectory(POOLOPTIONS *opts, int format, BOOL verbose,
+                   int topK, BOOL doStats, RUNSTATS *stats);
+
+#endif